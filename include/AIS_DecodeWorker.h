@@ -0,0 +1,157 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  AIS sentence framing and assembly worker
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef __AIS_DECODEWORKER_H__
+#define __AIS_DECODEWORKER_H__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//  Which fields of an AIS_VDXReport the message carried
+enum {
+    AIS_VDX_POSITION    = 1 << 0,       // lat, lon and b_position_valid
+    AIS_VDX_NAVSTATUS   = 1 << 1,
+    AIS_VDX_SOG         = 1 << 2,
+    AIS_VDX_COG         = 1 << 3,
+    AIS_VDX_HDG         = 1 << 4,
+    AIS_VDX_ROTAIS      = 1 << 5,
+    AIS_VDX_ROTIND      = 1 << 6,
+    AIS_VDX_UTC_SEC     = 1 << 7,
+    AIS_VDX_UTC_HM      = 1 << 8,       // utc_hour and utc_min
+    AIS_VDX_SOTDMA      = 1 << 9,       // sync_state and slot_to
+    AIS_VDX_BLUE_PADDLE = 1 << 10,
+    AIS_VDX_CLASS       = 1 << 11,
+    AIS_VDX_STATIC      = 1 << 12,      // counts as a static report
+    AIS_VDX_NAME        = 1 << 13,
+    AIS_VDX_NAME_EXT    = 1 << 14,
+    AIS_VDX_CALLSIGN    = 1 << 15,
+    AIS_VDX_IMO         = 1 << 16,
+    AIS_VDX_SHIPTYPE    = 1 << 17,
+    AIS_VDX_DIMENSIONS  = 1 << 18,
+    AIS_VDX_ETA         = 1 << 19,
+    AIS_VDX_DRAFT       = 1 << 20,
+    AIS_VDX_DESTINATION = 1 << 21,
+    AIS_VDX_ALTITUDE    = 1 << 22,      // SAR aircraft position report
+    AIS_VDX_EURO_INLAND = 1 << 23,
+    AIS_VDX_TEXT        = 1 << 24,      // safety related broadcast text
+    AIS_VDX_AREA_NOTICE = 1 << 25       // payload kept, decoded by the GUI
+};
+
+//  A VDM/VDO message decoded into plain fields, ready to merge into its target
+struct AIS_VDXReport
+{
+    int         mmsi;
+    int         msg_id;
+    bool        b_vdo;
+    bool        b_parsed;               // a message type the decoder understands
+    bool        b_posn_report;
+    unsigned int fields;                // AIS_VDX_* flags
+
+    int         nav_status;
+    double      lat, lon;
+    bool        b_position_valid;       // false if the target reports "unavailable"
+    double      sog, cog, hdg;
+    int         rot_ais, rot_ind;
+    int         utc_hour, utc_min, utc_sec;
+    int         sync_state, slot_to;
+    int         blue_paddle;
+    int         ais_class;
+    char        ship_name[21];
+    char        ship_name_ext[15];
+    char        call_sign[8];
+    int         imo;
+    unsigned char ship_type;
+    int         dim_a, dim_b, dim_c, dim_d;
+    int         eta_mo, eta_day, eta_hr, eta_min;
+    double      draft;
+    char        destination[21];
+    int         altitude;
+    char        euro_vin[9];
+    double      euro_length, euro_beam, euro_draft;
+    int         un_shiptype;
+    std::string text;
+    std::string payload;                // the assembled message
+};
+
+struct AIS_DecodeStats
+{
+    long        sentences;          // VDM/VDO sentences received
+    long        messages;           // complete messages handed out
+    long        coalesced;          // position reports replaced by a newer one in the same batch
+    long        bad;                // too long, bad checksum or malformed
+    long        broken;             // multi-part messages abandoned with parts missing
+    long        overflow;           // sentences dropped because the queue was full
+};
+
+//  Checks, splits, assembles and decodes !AIVDM/!AIVDO sentences on a thread of
+//  its own.  Decoded reports collect in a batch which the GUI takes at its own
+//  cadence, and only has to merge into its targets.
+//  Within a batch, a position report supersedes an earlier, not yet taken,
+//  position report from the same target, so a busy feed costs the GUI one
+//  target update per vessel per batch.
+class AIS_DecodeWorker
+{
+public:
+    AIS_DecodeWorker();
+    ~AIS_DecodeWorker();
+
+    void Push(const char *sentence);
+    void TakeBatch(std::vector<AIS_VDXReport> &batch);
+    AIS_DecodeStats GetStats();
+    static bool ParseReport(AIS_VDXReport &report);
+    bool IsIdle();
+
+private:
+    struct Fragment {
+        int         nparts;
+        int         next;
+        std::string data;
+    };
+
+    void WorkerLoop();
+    bool AssembleSentence(const std::string &sentence, AIS_VDXReport &report);
+    void AddToBatch(AIS_VDXReport &report);
+
+    std::thread             m_thread;
+    std::mutex              m_mutex;        // guards the queues and stats
+    std::condition_variable m_work_cond;
+    std::vector<std::string> m_input;
+    std::vector<AIS_VDXReport> m_batch;
+    std::unordered_map<int, size_t> m_batch_position;  // mmsi -> pending position report
+    AIS_DecodeStats         m_stats;
+    bool                    m_busy;
+    bool                    m_bquit;
+
+    std::map<int, Fragment> m_fragments;    // worker thread only
+    long                    m_broken;       // worker thread only, added to m_stats per pass
+};
+
+#endif
@@ -25,8 +25,14 @@
 #ifndef __AIS_DECODER_H__
 #define __AIS_DECODER_H__
 
+#include <wx/stopwatch.h>
+
 #include "ais.h"
+#include "AIS_DecodeWorker.h"
 #include <map>
+#include <queue>
+
+class AIS_Target_Data;
 
 #define TRACKTYPE_DEFAULT       0
 #define TRACKTYPE_ALWAYS        1
@@ -56,6 +62,41 @@ public:
 
 WX_DEFINE_ARRAY_PTR(MMSIProperties *, ArrayOfMMSIProperties);
 
+//  Targets whose CPA/TCPA is calculated together, one column per input
+struct AIS_CPA_Batch
+{
+    void clear( void );
+    void Add( AIS_Target_Data *ptarget );
+
+    std::vector<AIS_Target_Data *> target;
+    std::vector<double> lat, lon, cog, sog;
+    std::vector<double> tcpa;                   // hours
+    std::vector<unsigned char> mode;
+};
+
+//  A target due for a look by OnTimerAIS()
+struct AIS_AgingEntry
+{
+    time_t      due;
+    int         mmsi;
+
+    bool operator>( const AIS_AgingEntry &other ) const { return due > other.due; }
+};
+
+typedef std::priority_queue<AIS_AgingEntry, std::vector<AIS_AgingEntry>,
+                            std::greater<AIS_AgingEntry> > AIS_AgingQueue;
+
+struct AIS_CPA_Stats
+{
+    long        cycles;                 // UpdateAllCPA() passes
+    int         last_recomputed;        // in the most recent pass
+    int         last_unchanged;
+    int         last_deferred;
+    long        recomputed;             // totals over all passes
+    long        unchanged;              // neither the target nor own-ship moved
+    long        deferred;               // own-ship moved, target too far away to matter yet
+};
+
 class AIS_Decoder : public wxEvtHandler
 {
 
@@ -74,6 +115,8 @@ public:
     bool IsAISAlertGeneral(void) { return m_bGeneralAlert; }
     AIS_Error DecodeSingleVDO( const wxString& str, GenericPosDatEx *pos, wxString *acc );
     void DeletePersistentTrack( Track *track );
+    void ReplayBenchmark( const wxString &fileName );
+    AIS_CPA_Stats GetCPAStats( void ){ return m_cpa_stats; }
     std::map<int, Track*> m_persistent_tracks;
     
 private:
@@ -83,16 +126,30 @@ private:
     void OnTimerAIS(wxTimerEvent& event);
     void OnTimerAISAudio(wxTimerEvent& event);
     void OnTimerDSC( wxTimerEvent& event );
+    void OnTimerAISBatch( wxTimerEvent& event );
+    void ApplyDecodedBatch( void );
     
     bool NMEACheckSumOK(const wxString& str);
-    bool Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd);
+    bool ApplyVDXReport( const AIS_VDXReport &report, AIS_Target_Data *ptd, time_t now_ticks );
+    void ParseAreaNotice( AIS_Bitstring *bstr, AIS_Target_Data *ptd );
     void UpdateAllCPA(void);
     void UpdateOneCPA(AIS_Target_Data *ptarget);
+    void ComputeCPABatch(AIS_CPA_Batch &batch);
     void UpdateAllAlarms(void);
+    void GetAgingLimits(AIS_Target_Data *td, double &marklost_secs, double &removelost_secs);
+    time_t NextAgingTime(AIS_Target_Data *td, time_t after);
+    void ScheduleAging(AIS_Target_Data *td, time_t due);
+    void ScheduleAgingOnReport(AIS_Target_Data *td);
+    bool AgeTarget(AIS_Target_Data *td, time_t now);
     void UpdateAllTracks(void);
     void UpdateOneTrack(AIS_Target_Data *ptarget);
     void BuildERIShipTypeHash(void);
     AIS_Target_Data *ProcessDSx( const wxString& str, bool b_take_dsc = false );
+    bool IsMMSIIgnored( int mmsi );
+    AIS_Target_Data *FindOrCreateTarget( int mmsi, bool &bnewtarget, int &last_report_ticks );
+    AIS_Error MergeVDXReport( const AIS_VDXReport &report, time_t now_ticks );
+    void CommitTargetData( AIS_Target_Data *pTargetData, int mmsi, bool b_vdo,
+                           bool bdecode_result, bool bnewtarget );
     void SendJSONMsg( AIS_Target_Data *pTarget );
     
     AIS_Target_Hash *AISTargetList;
@@ -120,6 +177,23 @@ private:
     wxTimer          m_dsc_timer;
     wxString         m_dsc_last_string;
     std::vector<int> m_MMSI_MismatchVec;
+
+    AIS_DecodeWorker m_decode_worker;
+    std::vector<AIS_VDXReport> m_decoded_batch;
+    wxTimer          m_batch_timer;
+    wxStopWatch      m_decode_stats_sw;
+
+    AIS_CPA_Batch    m_cpa_batch;
+    AIS_CPA_Batch    m_cpa_single;
+    AIS_CPA_Stats    m_cpa_stats;
+    unsigned int     m_cpa_cycle;
+    unsigned int     m_cpa_own_gen;
+    double           m_cpa_own_lat, m_cpa_own_lon, m_cpa_own_cog, m_cpa_own_sog;
+    bool             m_cpa_own_gps_valid;
+
+    AIS_AgingQueue   m_aging_queue;
+    bool             m_aging_bMarkLost, m_aging_bRemoveLost, m_aging_bInlandEcdis;
+    double           m_aging_MarkLost_Mins, m_aging_RemoveLost_Mins;
     
 DECLARE_EVENT_TABLE()
 };
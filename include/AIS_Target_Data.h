@@ -129,6 +129,17 @@ public:
     double                    TCPA;                     // Minutes
     double                    CPA;                      // Nautical Miles
 
+    //      Inputs to the last CPA calculation, see AIS_Decoder::UpdateAllCPA()
+    double                    cpa_lat, cpa_lon, cpa_cog, cpa_sog;
+    bool                      cpa_positionOnceValid;
+    bool                      cpa_OwnShip;
+    unsigned int              cpa_own_gen;              // own-ship vector generation used
+    unsigned int              cpa_due_cycle;            // recalculate by this cycle, even if unchanged
+
+    //      Lost/stale target handling, see AIS_Decoder::OnTimerAIS()
+    time_t                    aging_due;                // next change of state by age, 0 if none
+    time_t                    aging_queued;             // earliest entry in the aging queue, 0 if none
+
     bool                      b_show_AIS_CPA;           //TR 2012.06.28: Show AIS-CPA
     
     bool                      b_show_track;
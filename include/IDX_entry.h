@@ -94,6 +94,14 @@ public:
     time_t      epoch;
     int         epoch_year;
 
+    // Per station harmonic tables, kept for two adjacent years (see happy_new_year())
+    Station_Data *m_tables_sta;              // Reference station the tables were built for
+    int         m_tables_year[2];            // Year held in each slot, 0 if empty
+    time_t      m_tables_epoch[2];
+    double      *m_tables;                   // Per slot: num_csts multipliers, then num_csts phases
+    double      *m_multipliers;              // Current year's slot
+    double      *m_phases;
+
     // Cached values
     time_t      recent_highlow_calc_time;
     float       recent_high_level;
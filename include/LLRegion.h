@@ -69,11 +69,19 @@ public:
     LLRegion( size_t n, const double *points );
 
     static bool PointsCCW( size_t n, const double *points );
+
+    // Intersect, Union and Subtract use a clipper of our own, which only
+    // reads its argument and keeps no global state, so regions may be combined
+    // on worker threads.  Of the const methods, only GetBox() writes, as it caches
+    // the box.  The GLU tessellator is kept for comparison.
+    static void UseGLUClipper( bool use );
+    static bool IsUsingGLUClipper();
     
     void Print() const;
     void plot(const char*fn) const;
     
     LLBBox GetBox() const;
+    double GetArea() const;
     bool IntersectOut(const LLBBox &box) const;
     
     bool Contains(float lat, float lon) const;
@@ -92,10 +100,15 @@ public:
     std::list<poly_contour> contours;
 
 private:
+    enum { CLIP_INTERSECT, CLIP_UNION, CLIP_SUBTRACT };
+
+    LLBBox ComputeBox() const;
     bool NoIntersection(const LLBBox& box) const;
     bool NoIntersection(const LLRegion& region) const;
     void PutContours(work &w, const LLRegion& region, bool reverse=false);
     void Put(const LLRegion& region, int winding_rule, bool reverse=false);
+    bool ClipContained(const LLRegion& region, int op);
+    void Clip(const LLRegion& region, int op);
     void InitBox( float minlat, float minlon, float maxlat, float maxlon);
     void InitPoints( size_t n, const double *points );
     void AdjustLongitude();
@@ -0,0 +1,53 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Read-only memory mapped files
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+// A whole file mapped read-only into memory.
+// The file handle is closed as soon as the mapping exists, so an open
+// MappedFile does not hold a file descriptor.
+// If the platform cannot map the file, IsOk() returns false and the caller
+// is expected to fall back to ordinary stream reads.
+class MappedFile
+{
+public:
+    MappedFile(const wxString& fileName);
+    ~MappedFile();
+
+    bool IsOk() const { return m_data != NULL; }
+    const unsigned char *GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    unsigned char *m_data;
+    size_t m_size;
+
+    wxDECLARE_NO_COPY_CLASS(MappedFile);
+};
+
+#endif
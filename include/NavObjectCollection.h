@@ -25,6 +25,9 @@
 #ifndef __NAVOBJECTCOLLECTION_H__
 #define __NAVOBJECTCOLLECTION_H__
 
+#include <map>
+#include <string>
+
 #include "pugixml.hpp"
 #include "Route.h"
 #include "RoutePoint.h"
@@ -94,7 +97,7 @@ public:
     bool AddGPXWaypoint(RoutePoint *pWP );
     
     bool CreateAllGPXObjects();
-    bool LoadAllGPXObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox = false);
+    bool LoadAllGPXObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox = false, bool b_progress = false );
     int LoadAllGPXObjectsAsLayer(int layer_id, bool b_layerviz);
     
     bool SaveFile( const wxString filename );
@@ -113,12 +116,15 @@ class NavObjectChanges : public NavObjectCollection1
 public:
     NavObjectChanges();
     NavObjectChanges( wxString file_name );
-    ~NavObjectChanges();
+    virtual ~NavObjectChanges();
     
-    void AddRoute( Route *pr, const char *action );           // support "changes" file set
-    void AddTrack( Track *pr, const char *action );
-    void AddWP( RoutePoint *pr, const char *action );
-    void AddTrackPoint( TrackPoint *pWP, const char *action, const wxString& parent_GUID );
+    virtual void AddRoute( Route *pr, const char *action );           // support "changes" file set
+    virtual void AddTrack( Track *pr, const char *action );
+    virtual void AddWP( RoutePoint *pr, const char *action );
+    virtual void AddTrackPoint( Track *pTrack, int index, const char *action );
+
+    //  Brings the saved objects up to date without a full rewrite, where the set can
+    virtual bool Sync() { return false; }
     
     bool ApplyChanges(void);
     
@@ -127,5 +133,59 @@ public:
     
 };
 
+#ifdef USE_NAVOBJ_DB
+
+namespace SQLite { class Database; }
+
+//  What the store last wrote for one object
+struct NavObjectStoreEntry
+{
+    wxInt64         id;             // row id, which its track points' rows carry
+    int             kind;
+    wxUint64        hash;           // of the GPX text in its row
+    const Track     *track;         // tracks: the points' rows were written from this track,
+    unsigned int    revision;       //   at this revision,
+    int             nPoints;        //   in this many rows,
+    wxInt64         next_seq;       //   and the next appended point takes this seq
+};
+
+//  The navigation objects kept in an SQLite database, a row for each waypoint,
+//  route and track, and a row for each track point.  The change hooks write
+//  only the rows they touch, so an edit costs the size of the edit rather than
+//  a rewrite of every object.  Rows hold the object as GPX, the same text the
+//  changes file and navobj.xml carry.
+class NavObjectStore : public NavObjectChanges
+{
+public:
+    NavObjectStore( wxString file_name );
+    ~NavObjectStore();
+
+    bool IsOpen() { return m_db != NULL; }
+    bool IsNew();
+
+    void AddRoute( Route *pr, const char *action );
+    void AddTrack( Track *pr, const char *action );
+    void AddWP( RoutePoint *pr, const char *action );
+    void AddTrackPoint( Track *pTrack, int index, const char *action );
+
+    bool Sync();
+    int LoadAllObjects();
+
+    void Checkpoint();
+    bool Backup( const wxString &file_name );
+
+private:
+    void PutObject( const std::string &guid, int kind, const std::string &gpx );
+    void PutTrack( Track *pTrack );
+    void WriteTrackPoints( Track *pTrack, NavObjectStoreEntry &entry );
+    void DeleteObject( const std::string &guid );
+    void Invalidate( const std::string &guid );
+
+    SQLite::Database                            *m_db;
+    std::map<std::string, NavObjectStoreEntry>  m_stored;
+};
+
+#endif
+
 
 #endif
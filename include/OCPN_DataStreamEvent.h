@@ -27,8 +27,35 @@
 
 #include <wx/event.h>
 #include <string>
+#include <vector>
+#include <memory>
 
 class DataStream;
+struct OCPN_DataStreamBatch;
+
+//  Sentences the multiplexer and the AIS decoder route on
+enum NMEA_SentenceId
+{
+    NMEA_ID_OTHER = 0,
+    NMEA_ID_VDM,
+    NMEA_ID_VDO,
+    NMEA_ID_FRPOS,
+    NMEA_ID_CDDS,                       // CDDSC and CDDSE
+    NMEA_ID_TLL,
+    NMEA_ID_TTM,
+    NMEA_ID_OSD,
+    NMEA_ID_WPL
+};
+
+//  What the consumers need to know about a sentence, worked out once where the
+//  sentence is read, so routing and filtering need not parse it again
+struct NMEA_SentenceHeader
+{
+    char            address[6];         // talker and formatter, e.g. "GPGGA" or "FRPOS"
+    unsigned char   id;                 // NMEA_SentenceId
+    bool            checksum_ok;
+    unsigned int    offset;             // start of the sentence proper, past any NMEA 4 tag block
+};
 
 class OCPN_DataStreamEvent: public wxEvent
 {
@@ -37,10 +64,17 @@ public:
     ~OCPN_DataStreamEvent( );
 
     // accessors
-    void SetNMEAString(std::string string) { m_NMEAstring = string; }
+    void SetNMEAString(std::string string);
     void SetStream( DataStream *pDS ) { m_pDataStream = pDS; }
-    std::string GetNMEAString() { return m_NMEAstring; }
+    const std::string &GetNMEAString() const;
     DataStream *GetStream() { return m_pDataStream; }
+    const NMEA_SentenceHeader &GetHeader() const { return m_header; }
+    bool ChecksumOK();
+
+    //  Several sentences from one read may travel in one event
+    void SetBatch( std::shared_ptr<OCPN_DataStreamBatch> batch ) { m_batch = batch; }
+    size_t GetBatchCount() const;
+    OCPN_DataStreamEvent &GetBatchItem( size_t i );
     
     // required for sending with wxPostEvent()
     wxEvent *Clone() const;
@@ -48,8 +82,17 @@ public:
     wxString ProcessNMEA4Tags();
 
 private:
-    std::string m_NMEAstring;
+    void Classify();
+
+    std::shared_ptr<const std::string> m_NMEAstring;   // shared by the clones posted to each consumer
+    NMEA_SentenceHeader m_header;
     DataStream *m_pDataStream;
+    std::shared_ptr<OCPN_DataStreamBatch> m_batch;
+};
+
+struct OCPN_DataStreamBatch
+{
+    std::vector<OCPN_DataStreamEvent> events;
 };
 
 #endif
@@ -119,12 +119,10 @@ private:
     void ThreadMessage(const wxString &msg);
     bool OpenComPortPhysical(const wxString &com_name, int baud_rate);
     void CloseComPortPhysical();
-    void Parse_And_Send_Posn(const char *s);
     size_t WriteComPortPhysical(char *msg);
     size_t WriteComPortPhysical(const wxString& string);
 #else
     void ThreadMessage(const wxString &msg);
-    void Parse_And_Send_Posn(const char *s);
     int OpenComPortPhysical(const wxString &com_name, int baud_rate);
     int CloseComPortPhysical(int fd);
     int WriteComPortPhysical(int port_descriptor, const wxString& string);
@@ -135,6 +133,8 @@ private:
     void HandleASuccessfulRead( char *buf, int nread );
     wxCriticalSection       m_outCritical;
 #endif
+    void FrameAndSend(const char *data, size_t nread);
+
     wxEvtHandler            *m_pMessageTarget;
     DataStream              *m_launcher;
     wxString                m_PortName;
@@ -142,11 +142,8 @@ private:
 
     dsPortType              m_io_select;
 
-    char                    *put_ptr;
-    char                    *tak_ptr;
-
     char                    *rx_buffer;
-    char                    *temp_buf;
+    size_t                  m_rx_len;
 
     unsigned long           error;
 
@@ -163,7 +160,6 @@ private:
 
 #ifdef __WXMSW__
     HANDLE                  m_hSerialComm;
-    bool                    m_nl_found;
 #endif
 
 };
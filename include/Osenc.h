@@ -80,6 +80,10 @@ WX_DEFINE_ARRAY_PTR(float *, SENCFloatPtrArray);
 #define CELL_NOCOVR_RECORD                      99
 #define CELL_EXTENT_RECORD                      100
 
+//  As VECTOR_EDGE_NODE_TABLE_RECORD, with the lat/lon bounding box of each
+//  edge (double minlat, minlon, maxlat, maxlon) following its point count
+#define VECTOR_EDGE_NODE_TABLE_EXT_RECORD       101
+
 
 //--------------------------------------------------------------------------
 //      Utility Structures
@@ -382,6 +386,60 @@ private:
 };
 
 
+//--------------------------------------------------------------------------
+//      Osenc_instreamMapped definition
+//      Reads from the whole file mapped read-only.  Records are copied out
+//      of the mapping, since their fields are not aligned.
+//--------------------------------------------------------------------------
+class MappedFile;
+
+class Osenc_instreamMapped : public Osenc_instream
+{
+public:
+    Osenc_instreamMapped();
+    ~Osenc_instreamMapped();
+    
+    bool Open( const wxString &senc_file_name );
+    void Close();
+    
+    Osenc_instream &Read(void *buffer, size_t size);
+    bool IsOk();
+    bool isAvailable();
+    void Shutdown();
+    
+private:
+    MappedFile          *m_map;
+    size_t              m_pos;
+    bool                m_ok;
+    
+};
+
+
+//--------------------------------------------------------------------------
+//      OsencArena definition
+//      Carves many small allocations out of a few large blocks, all of
+//      which are released together when the arena is deleted.
+//--------------------------------------------------------------------------
+#define OSENC_ARENA_BLOCK_SIZE          (256 * 1024)
+
+class OsencArena
+{
+public:
+    OsencArena();
+    ~OsencArena();
+    
+    void *Alloc( size_t size );
+    size_t GetSize(){ return m_size; }
+    
+private:
+    std::vector<unsigned char *> m_blocks;
+    unsigned char       *m_run;
+    size_t              m_left;
+    size_t              m_size;
+    
+};
+
+
 
 //--------------------------------------------------------------------------
 //      Osenc_outstream definition
@@ -453,7 +511,9 @@ public:
     int ingest200(const wxString &senc_file_name,
                S57ObjVector *pObjectVector,
                VE_ElementVector *pVEArray,
-               VC_ElementVector *pVCArray);
+               VC_ElementVector *pVCArray,
+               OsencArena *pElementArena = NULL,
+               OsencArena *pPointArena = NULL);
     
     //  SENC creation, by Version desired...
     void SetLODMeters(double meters){ m_LOD_meters = meters;}
@@ -25,6 +25,12 @@
 #ifndef __QUIT_H__
 #define __QUIT_H__
 
+#include <wx/stopwatch.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "chart1.h"
 #include "LLRegion.h"
 #include "OCPNRegion.h"
@@ -59,11 +65,9 @@ public:
         b_include = false;
         b_eclipsed = false;
         b_locked = false;
-        last_factor = -1;
     }
 
     const LLRegion &GetCandidateRegion();
-    LLRegion &GetReducedCandidateRegion(double factor);
     void SetScale(int scale);
     bool Scale_eq( int b ) const { return abs ( ChartScale - b) <= rounding; }
     bool Scale_ge( int b ) const { return  Scale_eq( b ) || ChartScale > b; }
@@ -74,11 +78,20 @@ public:
     bool b_include;
     bool b_eclipsed;
     bool b_locked;
+};
 
-private:
-    double last_factor;
-    LLRegion reduced_candidate_region;
-
+//  Region work done by Quilt::Compose(), accumulated since the quilt was created
+struct QuiltComposeStats
+{
+    long        composes;
+    long        regions_cached;     // coverage and reduced regions found in the cache
+    long        regions_built;      // coverage and reduced regions computed
+    long        patches_reused;     // patch regions carried over from the last compose
+    long        patches_built;      // patch regions computed
+    double      ms_candidates;      // building the candidate array
+    double      ms_select;          // choosing the candidates to include
+    double      ms_patches;         // computing the patch regions
+    double      ms_total;           // all of Compose(), including chart loads
 };
 
 WX_DECLARE_LIST( QuiltPatch, PatchList );
@@ -155,6 +168,11 @@ public:
         m_bquiltskew = g_bopengl;
         //  Quilting of different projections is allowed for OpenGL only
         m_bquiltanyproj = g_bopengl;
+
+        //  The chart database may have changed under us
+        m_coverage_cache.clear();
+        m_reduced_region_cache.clear();
+        m_patch_cache.clear();
     }
     void AdjustQuiltVP( ViewPort &vp_last, ViewPort &vp_proposed );
 
@@ -227,8 +245,32 @@ public:
 
     int GetNomScaleMin(int scale, ChartTypeEnum type, ChartFamilyEnum family);
     int GetNomScaleMax(int scale, ChartTypeEnum type, ChartFamilyEnum family);
+
+    const QuiltComposeStats &GetComposeStats() { return m_compose_stats; }
     
 private:
+    //  The chart coverage used to decide if a chart is on screen, as
+    //  GetChartQuiltRegion() would find it, before clipping to the screen
+    struct CoverageRegion {
+        LLRegion region;
+        bool     b_full;                // covers any screen
+    };
+
+    //  A patch region, less the regions of the larger scale patches
+    //  composed before it.  It does not depend on the viewport, so it holds
+    //  for as long as the same patches come before it.
+    struct PatchRegion {
+        int      dbIndex;
+        bool     b_first;               // cm93 reference chart, composed ahead of the rest
+        bool     b_subtract;
+        LLRegion unclipped;
+        LLRegion covered;               // m_covered_region after this patch
+    };
+
+    bool IsChartCoverageInView( int dbIndex, const ChartTableEntry &cte, const LLBBox &viewbox );
+    LLRegion &GetReducedCandidateRegion( QuiltCandidate *pqc, int level );
+    void ComposePatchRegions( const LLRegion &cvp_region, bool b_has_overlays );
+
     bool DoRenderQuiltRegionViewOnDC( wxMemoryDC &dc, ViewPort &vp, OCPNRegion &chart_region );
     bool DoRenderQuiltRegionViewOnDCTextOnly( wxMemoryDC& dc, ViewPort &vp, OCPNRegion &chart_region );
     
@@ -281,6 +323,14 @@ private:
     
     bool m_bquiltskew;
     bool m_bquiltanyproj;
+
+    std::map<int, CoverageRegion> m_coverage_cache;
+    std::map<std::pair<int, int>, LLRegion> m_reduced_region_cache;    // (dbIndex, reduction level)
+    int m_reduce_level;
+    std::vector<PatchRegion> m_patch_cache;         // in the order last composed
+
+    QuiltComposeStats m_compose_stats;
+    wxStopWatch m_compose_stats_sw;
 };
 
 #endif
@@ -0,0 +1,108 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Background SENC build scheduler
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __SENCBUILDSCHEDULER_H__
+#define __SENCBUILDSCHEDULER_H__
+
+#include <wx/stopwatch.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
+
+class ChartDB;
+class S57ClassRegistrar;
+
+// Checks ENC cells and converts stale or missing SENCs on a small pool of
+// worker threads, one cell per task, nearest the current view first.
+// While a worker is rebuilding a cell's SENC, s57chart::Init() declines to
+// open it so the other charts of the quilt stand in, rather than blocking on
+// the conversion.  Cells that are only queued are taken back by Init() and
+// opened in the foreground as usual.  The main thread polls TakeCompleted()
+// to redraw as declined cells become available.
+class SENCBuildScheduler
+{
+public:
+    SENCBuildScheduler();
+    ~SENCBuildScheduler();
+
+    int ScheduleChartDB(ChartDB *pChartDB);
+    void Schedule(const wxString &path000, double lat, double lon);
+    void SetFocus(double lat, double lon);
+
+    bool IsBuilding(const wxString &path000);
+    int TakeCompleted();
+
+    int GetQueueDepth();
+    int GetActiveCount();
+    int GetCheckedCount();
+    int GetBuiltCount();
+    int GetFailedCount();
+    bool IsBusy();
+
+private:
+    struct Task {
+        wxString path;
+        double   lat, lon;
+    };
+
+    enum {
+        SENC_TASK_CURRENT,
+        SENC_TASK_BUILT,
+        SENC_TASK_FAILED
+    };
+
+    void WorkerLoop();
+    Task TakeNextTask();
+    bool IsActive(const wxString &path000);
+    int BuildCell(const wxString &path000, S57ClassRegistrar *&poRegistrar);
+    static std::string PathKey(const wxString &path000);
+
+    std::vector<std::thread> m_threads;
+    std::mutex          m_mutex;            // guards everything below
+    std::condition_variable m_work_cond;
+    std::condition_variable m_check_cond;   // a worker finished checking a cell
+
+    std::vector<Task>   m_queue;
+    std::unordered_set<std::string> m_queued;   // paths in m_queue
+    std::vector<wxString> m_active;
+    std::unordered_set<std::string> m_building; // active cells found stale, being rebuilt
+    std::unordered_set<std::string> m_declined; // cells Init() turned away while building
+    double              m_focus_lat, m_focus_lon;
+
+    int                 m_nchecked;
+    int                 m_nbuilt;
+    int                 m_nfailed;
+    int                 m_ncompleted;       // finished since the last TakeCompleted()
+    bool                m_bquit;
+    wxStopWatch         m_sw;
+};
+
+#endif
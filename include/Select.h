@@ -24,6 +24,11 @@
 #ifndef __SELECT_H__
 #define __SELECT_H__
 
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "SelectItem.h"
 #include "Route.h"
 
@@ -38,9 +43,56 @@
 #define SELTYPE_TRACKSEGMENT         0x0100
 #define SELTYPE_DRAGHANDLE           0x0200
 
-class TrackPoint;
 class Track;
 
+//      Lat/lon grid over the select list, keyed by selection type, so that
+//      selection queries only test items near the cursor.
+//      Items are filed at three cell sizes; a query uses the finest size at
+//      which the search window covers only a few cells.
+#define SELECT_INDEX_LEVELS 3
+
+class SelectIndex
+{
+public:
+    SelectIndex();
+
+    void Add( SelectItem *pitem, wxSelectableItemListNode *node, bool bfront );
+    void Remove( SelectItem *pitem );
+    void Update( SelectItem *pitem );           // refile after the item's position changed
+    void Clear();
+    void Reserve( size_t n );                   // room for n more items, ahead of a bulk add
+
+    bool Contains( SelectItem *pitem ) const { return m_filed.count( pitem ) != 0; }
+    wxSelectableItemListNode *GetNode( SelectItem *pitem ) const;
+    SelectItem *FindData( const void *pdata, int seltype ) const;
+
+    //  Items of seltype whose extent is within radius of slat/slon, in select list order.
+    //  Returns false if the window is too large to be worth indexing.
+    bool GetCandidates( float slat, float slon, float radius, int seltype,
+                        std::vector<SelectItem *> &result ) const;
+
+private:
+    struct Filed {
+        long long order;                        // position in the select list
+        wxSelectableItemListNode *node;
+        float lat0, lon0, lat1, lon1;           // extent the item was filed under
+        bool bspan;                             // not gridded, always a candidate
+    };
+
+    void File( SelectItem *pitem, const Filed &f, bool badd );
+    bool CellRange( int level, float lat0, float lon0, float lat1, float lon1,
+                    int &x0, int &y0, int &x1, int &y1 ) const;
+    static wxUint64 CellKey( int seltype, int level, int cx, int cy );
+    static int TypeLevelKey( int seltype, int level ) { return seltype * SELECT_INDEX_LEVELS + level; }
+    static void GetExtent( SelectItem *pitem, Filed &f );
+
+    std::unordered_map<wxUint64, std::unordered_set<SelectItem *> > m_cells;
+    std::map<int, std::unordered_set<SelectItem *> > m_large;      // items too big to grid, per type and level
+    std::unordered_map<SelectItem *, Filed> m_filed;
+    std::map<std::pair<const void *, int>, std::vector<SelectItem *> > m_data;
+    long long m_front_order, m_back_order;
+};
+
 class Select
 {
 public:
@@ -51,11 +103,11 @@ public:
 
     bool IsSelectableRoutePointValid(RoutePoint *pRoutePoint );
     bool AddSelectableRoutePoint( float slat, float slon, RoutePoint *pRoutePointAdd );
+    void AddSelectableRoutePoints( const std::vector<RoutePoint *> &points );
     bool AddSelectableRouteSegment( float slat1, float slon1, float slat2, float slon2,
             RoutePoint *pRoutePointAdd1, RoutePoint *pRoutePointAdd2, Route *pRoute );
 
-    bool AddSelectableTrackSegment( float slat1, float slon1, float slat2, float slon2,
-                                    TrackPoint *pTrackPointAdd1, TrackPoint *pTrackPointAdd2, Track *pTrack );
+    bool AddSelectableTrackSegment( Track *pTrack, int index );
 
     SelectItem *FindSelection( float slat, float slon, int fseltype );
     SelectableItemList FindSelectionList( float slat, float slon, int fseltype );
@@ -67,7 +119,7 @@ public:
     bool AddAllSelectableTrackSegments( Track *pr );
     bool AddAllSelectableRoutePoints( Route *pr );
     bool UpdateSelectableRouteSegments( RoutePoint *prp );
-    bool DeletePointSelectableTrackSegments( TrackPoint *pt );
+    bool DeletePointSelectableTrackSegments( Track *pTrack, int index );
     bool IsSegmentSelected( float a, float b, float c, float d, float slat, float slon );
     bool IsSelectableSegmentSelected( float slat, float slon, SelectItem *pFindSel );
 
@@ -77,6 +129,7 @@ public:
     bool DeleteAllPoints( void );
     bool DeleteSelectablePoint( void *data, int SeltypeToDelete );
     bool ModifySelectablePoint( float slat, float slon, void *data, int fseltype );
+    bool UpdateSelectablePoint( SelectItem *pitem, float slat, float slon );
 
     //    Delete all selectable points in list by type
     bool DeleteAllSelectableTypePoints( int SeltypeToDelete );
@@ -92,8 +145,12 @@ public:
 
 private:
     void CalcSelectRadius();
+    wxSelectableItemListNode *AddItem( SelectItem *pitem, bool bfront );
+    void DeleteItem( SelectItem *pitem );
+    void GetCandidates( float slat, float slon, int fseltype, std::vector<SelectItem *> &result );
 
     SelectableItemList *pSelectList;
+    SelectIndex m_index;
     int pixelRadius;
     float selectRadius;
 };
@@ -34,6 +34,7 @@
 #include <vector>
 #include <list>
 #include <deque>
+#include <map>
 
 #include "Route.h"
 
@@ -45,6 +46,11 @@ struct SubTrack
     double            m_scale;
 };
 
+#define TRACKPOINT_TIME_LEN     21      // "YYYY-MM-DDThh:mm:ssZ" and the nul
+
+//  A single track point.  Points held by a Track live in the Track's columns;
+//  the TrackPoint objects it hands out are views of them, made on request and
+//  owned by the Track.  Change a track's points through the Track.
 class TrackPoint
 {
 public:
@@ -56,13 +62,25 @@ public:
       wxDateTime GetCreateTime(void);
       void SetCreateTime( wxDateTime dt );
       void Draw(ocpnDC& dc );
-      const char *GetTimeString() { return m_timestring; }
+      const char *GetTimeString() { return m_timestring[0] ? m_timestring : NULL; }
       
       double            m_lat, m_lon;
       int               m_GPXTrkSegNo;
 private:
+      friend class Track;
+
       void SetCreateTime( wxString ts );
-      char             *m_timestring;
+      void SetTime( wxInt64 time );
+
+      wxInt64           m_time;         // seconds of the time fields, counted as if UTC
+      char              m_timestring[TRACKPOINT_TIME_LEN];
+};
+
+//  The points of a track from first on carry GPX segment number segno
+struct TrackSegmentRun
+{
+    int               first;
+    int               segno;
 };
 
 //----------------------------------------------------------------------------
@@ -76,15 +94,23 @@ public:
     virtual ~Track();
 
     void Draw(ocpnDC& dc, ViewPort &VP, const LLBBox &box);
-    int GetnPoints(void){ return TrackPoints.size(); }
+    int GetnPoints(void) const { return m_PointLat.size(); }
     
     
     void SetVisible(bool visible = true) { m_bVisible = visible; }
     TrackPoint *GetPoint( int nWhichPoint );
     TrackPoint *GetLastPoint();
     void AddPoint( TrackPoint *pNewPoint );
-    void AddPointFinalized( TrackPoint *pNewPoint );
-    TrackPoint* AddNewPoint( vector2D point, wxDateTime time );
+    void AddPoint( double lat, double lon, wxDateTime time, int segno = 1 );
+    void AddGPXPoint( double lat, double lon, const char *gpx_time, int segno );
+    void AddNewPoint( vector2D point, wxDateTime time );
+
+    //  Point data straight from the columns, without making views
+    double GetPointLat( int nWhichPoint ) const { return m_PointLat[nWhichPoint]; }
+    double GetPointLon( int nWhichPoint ) const { return m_PointLon[nWhichPoint]; }
+    wxDateTime GetPointCreateTime( int nWhichPoint ) const;
+    const char *GetPointTimeString( int nWhichPoint, char *buf ) const;
+    int GetPointSegNo( int nWhichPoint ) const;
     
     void SetListed(bool listed = true) { m_bListed = listed; }
     virtual bool IsRunning() { return false; }
@@ -92,6 +118,9 @@ public:
     bool IsVisible() { return m_bVisible; }
     bool IsListed() { return m_bListed; }
 
+    //  Bumped by every change to the points, so a copy of them can tell it is stale
+    unsigned int GetRevision() const { return m_Revision; }
+
     int GetCurrentTrackSeg(){ return m_CurrentTrackSeg; }
     void SetCurrentTrackSeg(int seg){ m_CurrentTrackSeg = seg; }
 
@@ -106,11 +135,11 @@ public:
             return m_TrackNameString;
         } else {
             wxString name;
-            TrackPoint *rp = NULL;
-            if((int) TrackPoints.size() > 0)
-                rp = TrackPoints[0];
-            if( rp && rp->GetCreateTime().IsValid() ) name = rp->GetCreateTime().FormatISODate() + _T(" ")
-                + rp->GetCreateTime().FormatISOTime();   //name = rp->m_CreateTime.Format();
+            wxDateTime created;
+            if(GetnPoints() > 0)
+                created = GetPointCreateTime(0);
+            if( created.IsValid() ) name = created.FormatISODate() + _T(" ")
+                + created.FormatISOTime();   //name = rp->m_CreateTime.Format();
             else
                 name = _("(Unnamed Track)");
             return name;
@@ -144,16 +173,34 @@ public:
 
 protected:
     void Segments(std::list< std::list<wxPoint> > &pointlists, const LLBBox &box, double scale);
-    void DouglasPeuckerReducer( std::vector<TrackPoint*>& list,
-                                std::vector<bool> & keeplist,
+    void DouglasPeuckerReducer( std::vector<bool> & keeplist,
                                 int from, int to, double delta );
-    double GetXTE(TrackPoint *fm1, TrackPoint *fm2, TrackPoint *to);
+    double GetXTE( int fm1, int fm2, int to );
     double GetXTE( double fm1Lat, double fm1Lon, double fm2Lat, double fm2Lon, double toLat, double toLon  );
-            
-    std::vector<TrackPoint*>     TrackPoints;
+
+    void SetPoint( int nWhichPoint, double lat, double lon, wxDateTime time );
+    void RemovePoint( int nWhichPoint );
+
+    //  The points, as columns: about 20 bytes a point against 80 or more
+    //  for a heap TrackPoint with its time string
+    std::vector<double>          m_PointLat;
+    std::vector<double>          m_PointLon;
+    std::vector<wxInt32>         m_PointTime;       // seconds from m_TimeBase
+    wxInt64                      m_TimeBase;
+    std::map<int, wxInt64>       m_FarTimes;        // times too far from m_TimeBase for m_PointTime
+    std::vector<TrackSegmentRun> m_SegmentRuns;
+    std::map<int, TrackPoint*>   m_PointViews;      // views handed out, by point
+    unsigned int                 m_Revision;
+
     std::vector<std::vector <SubTrack> > SubTracks;
 
 private:
+    void AppendPoint( double lat, double lon, wxInt64 time, int segno );
+    wxInt64 GetPointTime( int nWhichPoint ) const;
+    void SetPointTime( int nWhichPoint, wxInt64 time );
+    void KeepPoints( const std::vector<bool> &keeplist );
+    void FinalizeLastPoint();
+
     void GetPointLists(std::list< std::list<wxPoint> > &pointlists,
                        ViewPort &VP, const LLBBox &box );
     void Finalize();
@@ -202,10 +249,10 @@ class ActiveTrack : public wxEvtHandler, public Track
             double            m_prev_dist;
             wxDateTime        m_prev_time;
 
-            TrackPoint        *m_lastStoredTP;
-            TrackPoint        *m_removeTP;
-            TrackPoint        *m_prevFixedTP;
-            TrackPoint        *m_fixedTP;
+            int               m_lastStoredTP;       // point indices, -1 for none
+            int               m_removeTP;
+            int               m_prevFixedTP;
+            int               m_fixedTP;
             int               m_track_run;
             double            m_minTrackpoint_delta;
             
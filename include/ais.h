@@ -60,6 +60,7 @@
 
 #define TIMER_AIS_MSEC      998
 #define TIMER_AIS_AUDIO_MSEC 2000
+#define TIMER_AIS_BATCH_MSEC 250                // cadence of decoded VDM/VDO delivery to the GUI
 
 enum {
     tlTRK = 0,
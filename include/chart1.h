@@ -619,6 +619,7 @@ enum {
     TIMER_AIS1,
     TIMER_DSC,
     TIMER_AISAUDIO,
+    TIMER_AISBATCH,
     AIS_SOCKET_ID,
     FRAME_TIMER_DOG,
     FRAME_TC_TIMER,
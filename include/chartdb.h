@@ -125,6 +125,9 @@ public:
 
       int  BuildChartStack(ChartStack * cstk, float lat, float lon);
       int  BuildChartStack(ChartStack * cstk, float lat, float lon, int db_add );
+      //  Without the chart table index every chart is tested, as BuildChartStack once did.
+      //  Kept for comparison, see -benchmark_chartstack.
+      static void UseChartTableIndex( bool use );
       bool EqualStacks(ChartStack *, ChartStack *);
       bool CopyStack(ChartStack *pa, ChartStack *pb);
       wxString GetFullPath(ChartStack *ps, int stackindex);
@@ -309,6 +309,43 @@ public:
 WX_DECLARE_OBJARRAY(ChartTableEntry, ChartTable);
 WX_DECLARE_OBJARRAY(ChartClassDescriptor, ArrayOfChartClassDescriptor);
 
+//    A multi-level lat/lon grid over the chart table bounding boxes.
+//    Each entry is filed in the finest level where its box spans only a few cells,
+//    so a point query touches one cell per level instead of the whole table.
+//    Longitudes are binned modulo 360, so charts extending beyond 180 degrees are found
+//    for either representation of the query longitude.
+
+#define CHART_INDEX_LEVELS      3
+
+class ChartTableIndex
+{
+public:
+    ChartTableIndex() : m_bvalid(false) {}
+
+    void Build(const ChartTable &table);
+    void Invalidate() { m_bvalid = false; }
+    bool IsValid() const { return m_bvalid; }
+
+    //  Fill result with the ascending db indices of all charts whose bounding box
+    //  may contain lat/lon.  Exact tests are left to the caller.
+    void Query(float lat, float lon, std::vector<int> &result) const;
+
+    //  db indices of all plugin charts, which may need re-enabling before use
+    const std::vector<int> &GetPlugInEntries() const { return m_plugin_entries; }
+
+private:
+    int CellKey(int level, int row, int col) const { return row * m_ncols[level] + col; }
+    int RowOf(int level, float lat) const;
+    int ColOf(int level, float lon) const;
+
+    bool m_bvalid;
+    int m_ncols[CHART_INDEX_LEVELS];
+    int m_nrows[CHART_INDEX_LEVELS];
+    std::map<int, std::vector<int> > m_cells[CHART_INDEX_LEVELS];
+    std::vector<int> m_global;             // entries too large for any grid level
+    std::vector<int> m_plugin_entries;
+};
+
 class ChartDatabase
 {
 public:
@@ -365,6 +402,8 @@ public:
     std::vector<float> GetReducedPlyPoints(int dbIndex);
     std::vector<float> GetReducedAuxPlyPoints(int dbIndex, int iTable);
 
+    const ChartTableIndex &GetChartTableIndex();
+
 protected:
     virtual ChartBase *GetChart(const wxChar *theFilePath, ChartClassDescriptor &chart_desc) const;
     int AddChartDirectory(const wxString &theDir, bool bshow_prog);
@@ -400,6 +439,8 @@ private:
     int         m_nentries;
 
     LLBBox m_dummy_bbox;
+
+    ChartTableIndex m_chart_index;
 };
 
 
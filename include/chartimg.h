@@ -31,6 +31,8 @@
 #define _CHARTIMG_H_
 
 
+#include <functional>
+
 #include "chartbase.h"
 #include "georef.h"                 // for GeoRef type
 #include "OCPNRegion.h"
@@ -45,6 +47,7 @@ typedef enum ScaleTypeEnum
 
 
 class WXDLLEXPORT ChartImg;
+class MappedFile;
 
 //-----------------------------------------------------------------------------
 //    Constants, etc.
@@ -196,6 +199,9 @@ protected:
       virtual bool GetAndScaleData(unsigned char *ppn, size_t data_size,
                                    wxRect& source, int source_stride, wxRect& dest, int dest_stride,
                                    double scale_factor, ScaleTypeEnum scale_type);
+      void DecodeChartRows(wxRect& source, unsigned char *pPix, int sub_samp, int first, int last);
+      bool IsDecodeReentrant() const { return m_mapped_bitmap != NULL; }
+      void ForEachRowBand(int nrows, const std::function<void(int, int)> &func);
       bool RenderViewOnDC(wxMemoryDC& dc, const ViewPort& VPoint);
 
       bool IsCacheValid(){ return cached_image_ok; }
@@ -210,6 +216,9 @@ protected:
 
       virtual void InvalidateLineCache();
       virtual bool CreateLineIndex(void);
+      wxString GetLineIndexCachePath(void);
+      bool LoadLineIndexCache(void);
+      void SaveLineIndexCache(void);
 
 
       virtual wxBitmap *CreateThumbnail(int tnx, int tny, ColorScheme cs);
@@ -277,6 +286,8 @@ protected:
       wxInputStream    *ifs_hdr;
       wxInputStream    *ifss_bitmap;
       wxBufferedInputStream *ifs_bitmap;
+      wxString          m_BitmapDataPath;     // the uncompressed file holding the scan lines
+      MappedFile       *m_mapped_bitmap;      // read-only mapping of m_BitmapDataPath, if available
 
       wxString          *pBitmapFilePath;
 
@@ -67,7 +67,9 @@
 #include <initguid.h>
 #endif
 #include <string>
+#include <atomic>
 #include "ConnectionParams.h"
+#include "OCPN_DataStreamEvent.h"
 #include "dsPortType.h"
 
 //----------------------------------------------------------------------------
@@ -176,6 +178,7 @@ public:
     void SetOutputFilter(wxArrayString filter) { m_output_filter = filter; }
     void SetOutputFilterType(ListType filter_type) { m_output_filter_type = filter_type; }
     bool SentencePassesFilter(const wxString& sentence, FilterDirection direction);
+    bool SentencePassesFilter(const NMEA_SentenceHeader& header, FilterDirection direction);
     bool ChecksumOK(const std::string& sentence);
     bool GetGarminMode(){ return m_bGarmin_GRMN_mode; }
 
@@ -188,6 +191,12 @@ public:
     bool GetChecksumCheck(){ return m_bchecksumCheck; }
     ConnectionType GetConnectionType(){ return m_connection_type; }
 
+    //  Input throughput, counted by whichever thread reads the port
+    void AddRxStats(long bytes, long sentences, long dropped);
+    long GetRxBytes(){ return m_rx_bytes; }
+    long GetRxSentences(){ return m_rx_sentences; }
+    long GetRxDropped(){ return m_rx_dropped; }
+
     int                 m_Thread_run_flag;
 private:
     void Init(void);
@@ -247,6 +256,10 @@ private:
     wxTimer             m_socketread_watchdog_timer;
     int                 m_dog_value;
 
+    std::atomic<long>   m_rx_bytes;
+    std::atomic<long>   m_rx_sentences;
+    std::atomic<long>   m_rx_dropped;           // sentences, or runs of junk, thrown away
+
 DECLARE_EVENT_TABLE()
 };
 
@@ -30,10 +30,14 @@
 #include <wx/timer.h>
 #include <stdint.h>
 
+#include <memory>
+#include <vector>
+
 #include "ocpn_types.h"
 #include "bbox.h"
 
 class glTextureDescriptor;
+class MappedFile;
 
 #define COMPRESSED_CACHE_MAGIC 0xf013  // change this when the format changes
 
@@ -115,6 +119,7 @@ public:
     int GetTextureLevel( glTextureDescriptor *ptd, const wxRect &rect, int level,  ColorScheme color_scheme );
     bool UpdateCacheAllLevels( const wxRect &rect, ColorScheme color_scheme, unsigned char **compcomp_array, int *compcomp_size);
     bool IsLevelInCache( int level, const wxRect &rect, ColorScheme color_scheme );
+    void ReadAhead( int base_level, const wxRect &rect, ColorScheme color_scheme );
     wxString GetChartPath(){ return m_ChartPath; }
     wxString GetHashKey(){ return m_HashKey; }
     void SetHashKey( wxString key ){ m_HashKey = key; }
@@ -135,6 +140,7 @@ public:
 
     void PrepareTiles(const ViewPort &vp, bool use_norm_vp, ChartBase *pChart);
     glTexTile** GetTiles(int &num) { num = m_ntex; return m_tiles; }
+    bool GetTileBox(const wxRect &rect, LLBBox &box) const;
     void GetCenter(double &lat, double &lon) { lat = m_clat, lon = m_clon; }
 
 private:
@@ -148,6 +154,13 @@ private:
     
     void DeleteSingleTexture( glTextureDescriptor *ptd );
 
+    std::shared_ptr<MappedFile> GetMap(size_t end);
+    void ReleaseMap();
+    bool ReadCacheData(size_t offset, void *data, size_t size);
+    bool ReadCompressedTile(const CatalogEntryValue *p, unsigned char *tex_data, int size);
+    bool OpenCacheFile();
+    void CloseCacheFile();
+
     CatalogEntryValue *GetCacheEntryValue(int level, int x, int y, ColorScheme color_scheme);
     bool AddCacheEntryValue(const CatalogEntry &p);
     int  ArrayIndex(int x, int y) const { return ((y / m_tex_dim) * m_stride) + (x / m_tex_dim); } 
@@ -170,7 +183,10 @@ private:
 
     bool	m_catalogCorrupted;
     
-    wxFFile     *m_fs;
+    wxFFile     *m_fs;                  // open only while the cache is written
+    std::shared_ptr<MappedFile> m_map;  // read-only view of the cache file, see GetMap()
+    std::vector<uint16_t> m_readahead;  // per tile, levels already queued for read ahead
+    ColorScheme m_readahead_scheme;
     uint32_t    m_chart_date_binary;
     uint32_t    m_chartfile_date_binary;
     uint32_t    m_chartfile_size;
@@ -0,0 +1,101 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Headless builder for the compressed raster texture cache
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __GLTEXCACHEBUILDER_H__
+#define __GLTEXCACHEBUILDER_H__
+
+#include <wx/stopwatch.h>
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "ocpn_types.h"
+
+class ChartDB;
+class ChartBaseBSB;
+class glTexFactory;
+
+// Fills the compressed raster texture cache without a window or a GL context,
+// for the -build_gl_raster_cache command line options.  Tile rows of every
+// chart are shared out to worker threads, each decoding from an instance of
+// the chart of its own.  Tiles are compressed by JobTicket::DoJob() and written
+// by glTexFactory, as in the GUI, so the files are the ones the GUI would
+// write.  The catalog is brought up to date after every tile, so an
+// interrupted run resumes where it stopped, and tiles already in a current
+// cache are skipped.
+class glTexCacheBuilder
+{
+public:
+    glTexCacheBuilder();
+    ~glTexCacheBuilder();
+
+    void AddChart(const wxString &path);
+    int AddChartDB(ChartDB *pChartDB);
+    int AddDirectory(const wxString &dir);
+
+    bool Run(int nthreads);
+
+private:
+    struct Chart {
+        wxString        path;
+        glTexFactory   *pFact;
+        std::mutex      mutex;          // guards pFact
+        int             rows_left;
+    };
+
+    struct Row {
+        Chart          *chart;
+        int             y;
+        std::vector<int> x;             // tiles missing from the cache
+    };
+
+    static void SetupCompression();
+    int Plan(Chart *chart);
+    void WorkerLoop();
+    long BuildTile(Chart *chart, ChartBaseBSB *pchart, const wxRect &rect);
+    void Report(bool final);
+
+    wxArrayString       m_paths;
+    std::vector<Chart*> m_charts;
+    std::vector<Row>    m_rows;
+    ColorScheme         m_scheme;
+
+    std::mutex          m_mutex;        // guards everything below
+    std::condition_variable m_done_cond;
+    size_t              m_next_row;
+    int                 m_nactive;
+    long                m_tiles_total;
+    long                m_tiles_done;
+    long                m_tiles_failed;
+    double              m_bytes_in;     // chart bits decoded
+    double              m_bytes_out;    // compressed texture written
+    wxStopWatch         m_sw;
+};
+
+#endif
@@ -27,9 +27,18 @@
 #ifndef __GLTEXTUREMANAGER_H__
 #define __GLTEXTUREMANAGER_H__
 
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "bbox.h"
+
 const wxEventType wxEVT_OCPN_COMPRESSIONTHREAD = wxNewEventType();
 
 class JobTicket;
+class ViewPort;
 class wxGenericProgressDialog;
 
 WX_DECLARE_LIST(JobTicket, JobList);
@@ -49,18 +58,6 @@ public:
 
 
 
-class CompressionPoolThread : public wxThread
-{
-public:
-    CompressionPoolThread(JobTicket *ticket, wxEvtHandler *message_target);
-    void *Entry();
-    
-    wxEvtHandler        *m_pMessageTarget;
-    JobTicket           *m_ticket;
-};
-
-
-
 class OCPN_CompressionThreadEvent: public wxEvent
 {
 public:
@@ -82,7 +79,6 @@ private:
     JobTicket  * m_ticket;
 };
 
-class CompressionPoolThread;
 class JobTicket
 {
 public:
@@ -96,8 +92,11 @@ public:
     int         level_min_request;
     int         ident;
     bool        b_throttle;
+    double      priority;       // lower runs first
+    long        serial;         // newer first among equal priorities
+    LLBBox      box;            // extent of the tile, invalid for whole chart jobs
     
-    CompressionPoolThread *pthread;
+    wxEvtHandler *pMessageTarget;
     unsigned char *level0_bits;
     unsigned char *comp_bits_array[10];
     wxString    m_ChartPath;
@@ -111,6 +110,39 @@ public:
 };
 
 
+//  Long lived compression threads.  Each worker has its own queue, tickets of
+//  one chart go to the same worker so its chart bits stay warm in that
+//  thread, and an idle worker steals from the longest queue of the others.
+//  Throttled tickets leave a core free for the GUI.
+class CompressionWorkerPool
+{
+public:
+    CompressionWorkerPool(int nthreads, wxEvtHandler *message_target);
+    ~CompressionWorkerPool();
+
+    void Submit(JobTicket *ticket);
+    int GetThreadCount() const { return m_workers.size(); }
+
+private:
+    struct Worker {
+        std::thread             thread;
+        std::deque<JobTicket*>  queue;
+    };
+
+    void WorkerLoop(unsigned int index);
+    JobTicket *TakeTicket(unsigned int index);
+    bool CanStart(JobTicket *ticket) const;
+    void RunTicket(JobTicket *ticket);
+
+    std::vector<Worker*>    m_workers;
+    std::mutex              m_mutex;        // guards the queues and counters
+    std::condition_variable m_work_cond;
+    wxEvtHandler            *m_pMessageTarget;
+    int                     m_running;
+    int                     m_max_throttled;
+    bool                    m_bquit;
+};
+
 //      This is a hashmap with Chart full path as key, and glTexFactory as value
 WX_DECLARE_STRING_HASH_MAP( glTexFactory*, ChartPathHashTexfactType );
 
@@ -127,7 +159,8 @@ public:
                       bool b_throttle_thread, bool b_nolimit, bool b_postZip, bool b_inplace);
 
     int GetRunningJobCount(){ return running_list.GetCount(); }
-    int GetJobCount(){ return GetRunningJobCount() + todo_list.GetCount(); }
+    int GetJobCount(){ return GetRunningJobCount() + m_todo.size(); }
+    void SetViewPort(ViewPort &vp);
     bool AsJob( wxString const &chart_path ) const;
     void PurgeJobList( wxString chart_path = wxEmptyString );
     void ClearJobList();
@@ -144,12 +177,18 @@ public:
 
 private:    
     bool DoJob( JobTicket *pticket );
-    bool DoThreadJob(JobTicket* pticket);
     bool StartTopJob();
+    double JobPriority(JobTicket *ticket);
+    void SortJobs();
     
-    JobList             running_list;
-    JobList             todo_list;
+    JobList             running_list;       // handed to the pool, not yet returned
+    std::vector<JobTicket*> m_todo;         // heap, best ticket first
+    long                m_serial;
     int                 m_max_jobs;
+    CompressionWorkerPool *m_pool;
+
+    LLBBox              m_vp_box;           // last rendered viewport
+    double              m_vp_clat, m_vp_clon, m_vp_radius;
 
     int		m_prevMemUsed;
 
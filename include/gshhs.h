@@ -94,6 +94,42 @@ typedef std::vector<contour> contour_list;
 
 //==========================================================================
 
+/* Immutable segment index used for land crossing tests.  The land (level 1)
+   polygon edges of every one degree cell are bucketed into the GSSH_SUBM x
+   GSSH_SUBM sub cells their bounding box touches, with coordinates stored
+   relative to the cell origin.  Once built, queries need no locking so any
+   number of threads may test segments concurrently. */
+
+struct GshhsLandEdge {
+    float x1, y1, x2, y2;
+};
+
+class GshhsLandIndex {
+public:
+    GshhsLandIndex();
+
+    void AddCell( int x0, int y0, const contour_list &poly1 );
+
+    /* lon may be given in either -180..180 or 0..360 */
+    bool Crosses( double lat1, double lon1, double lat2, double lon2 ) const;
+
+    /* segments holds count quadruples of lat1, lon1, lat2, lon2,
+       returns the number of segments crossing land */
+    int CrossesBatch( const double *segments, int count, bool *result ) const;
+
+    size_t GetEdgeCount() const { return m_edges.size(); }
+    size_t GetCellCount() const { return m_ncells; }
+
+private:
+    bool CrossesSubCell( int clon, int clat, double x1, double y1,
+                         double x2, double y2 ) const;
+
+    int m_cell[360][180];           // index into m_offsets blocks, or -1
+    size_t m_ncells;
+    std::vector<wxUint32> m_offsets; // GSSH_SUBM*GSSH_SUBM+1 per cell
+    std::vector<GshhsLandEdge> m_edges;
+};
+
 
 class GshhsPolyCell {
 public:
@@ -151,6 +187,7 @@ public:
 
     void InitializeLoadQuality( int quality ); // 5 levels: 0=low ... 4=full
     bool crossing1( wxLineF trajectWorld );
+    void BuildLandIndex( GshhsLandIndex &index );
     int currentQuality;
     int ReadPolyVersion();
     int GetPolyVersion() { return polyHeader.version; }
@@ -247,6 +284,7 @@ public:
 
     //    bool crossing( wxLineF traject, wxLineF trajectWorld ) const;
     bool crossing1( wxLineF trajectWorld );
+    void BuildLandIndex( GshhsLandIndex &index );
     int ReadPolyVersion();
     bool qualityAvailable[6];
 
@@ -285,6 +323,11 @@ inline bool GshhsReader::crossing1(wxLineF trajectWorld )
 {
     return this->gshhsPoly_reader->crossing1(trajectWorld );
 }
+
+inline void GshhsReader::BuildLandIndex( GshhsLandIndex &index )
+{
+    this->gshhsPoly_reader->BuildLandIndex( index );
+}
 #define GSHHS_SCL    1.0e-6    /* Convert micro-degrees to degrees */
 
 //-------------------------------------------------------------------------------
@@ -309,5 +352,7 @@ private:
 void gshhsCrossesLandInit();
 void gshhsCrossesLandReset();
 bool gshhsCrossesLand(double lat1, double lon1, double lat2, double lon2);
+int gshhsCrossesLandBatch(const double *segments, int count, bool *result);
+bool gshhsCrossesLandBenchmark(int count);
 
 #endif
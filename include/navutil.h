@@ -89,6 +89,7 @@ class wxGenericProgressDialog;
 class ocpnDC;
 class NavObjectCollection1;
 class NavObjectChanges;
+class NavObjectStore;
 class TrackPoint;
 class TrackList;
 
@@ -140,7 +141,9 @@ public:
       virtual void AddNewWayPoint(RoutePoint *pWP, int ConfigRouteNum = -1);
       virtual void UpdateWayPoint(RoutePoint *pWP);
       virtual void DeleteWayPoint(RoutePoint *pWP);
-      virtual void AddNewTrackPoint( TrackPoint *pWP, const wxString& parent_GUID );
+      virtual void AddNewTrackPoint( Track *pt, int index );
+      virtual void UpdateTrackPoint( Track *pt, int index );
+      virtual void DeleteTrackPoint( Track *pt, int index );
 
       virtual void CreateConfigGroups ( ChartGroupArray *pGroupArray );
       virtual void DestroyConfigGroups ( void );
@@ -161,7 +164,7 @@ public:
       bool ExportGPXTracks(wxWindow* parent, TrackList *pRoutes, const wxString suggestedName = _T("tracks"));
       bool ExportGPXWaypoints(wxWindow* parent, RoutePointList *pRoutePoints, const wxString suggestedName = _T("waypoints"));
 
-      void CreateRotatingNavObjBackup();
+      void CreateRotatingNavObjBackup( const wxString &file, NavObjectStore *pStore = NULL );
 
       double st_lat, st_lon, st_view_scale, st_rotation;      // startup values
       bool  st_bFollow;
@@ -170,6 +173,7 @@ public:
 
       wxString                m_sNavObjSetFile;
       wxString                m_sNavObjSetChangesFile;
+      wxString                m_sNavObjSetStoreFile;
 
       NavObjectChanges        *m_pNavObjectChangesSet;
       NavObjectCollection1    *m_pNavObjectInputSet;
@@ -724,6 +724,9 @@ extern DECL_EXP wxString getUsrDistanceUnit_Plugin( int unit = -1 );
 extern DECL_EXP wxString getUsrSpeedUnit_Plugin( int unit = -1 );
 extern DECL_EXP wxString GetNewGUID();
 extern "C" DECL_EXP bool PlugIn_GSHHS_CrossesLand(double lat1, double lon1, double lat2, double lon2);
+//  Tests count segments at once; segments holds count quadruples of lat1, lon1, lat2, lon2.
+//  Fills result[0..count-1] and returns the number of segments crossing land.
+extern "C" DECL_EXP int PlugIn_GSHHS_CrossesLandBatch(const double *segments, int count, bool *result);
 extern DECL_EXP void PlugInPlaySound( wxString &sound_file );
 
 
@@ -27,6 +27,10 @@
 #define __ROUTEMAN_H__
 
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "chart1.h"                 // for ColorScheme definition
 #include <wx/imaglist.h>
 #include "styles.h"
@@ -59,6 +63,42 @@ class MarkIcon;
 WX_DEFINE_SORTED_ARRAY(MarkIcon*, SortedArrayOfMarkIcon); 
 WX_DEFINE_ARRAY(MarkIcon*, ArrayOfMarkIcon); 
 
+//----------------------------------------------------------------------------
+//   RoutePointIndex
+//   A lat/lon grid and a GUID hash over the RoutePoints owned by WayPointman
+//----------------------------------------------------------------------------
+
+class RoutePointIndex
+{
+public:
+      RoutePointIndex();
+
+      void Add(RoutePoint *prp);
+      void Remove(RoutePoint *prp);
+      void Update(RoutePoint *prp);           // refile after the point has moved
+      void Clear();
+      void Reserve(size_t n);                 // room for n more points, ahead of a bulk add
+
+      //  Points filed within radius_deg (lat and lon) of lat/lon, in WayPointman list order.
+      //  Returns false if the window is too large to be worth indexing.
+      bool GetCandidates(double lat, double lon, double radius_deg, std::vector<RoutePoint *> &result) const;
+      RoutePoint *FindGUID(const wxString &guid) const;
+
+private:
+      struct Filed {
+            long long order;                    // position in the WayPointman list
+            int cx, cy;
+            std::string guid;
+      };
+
+      static wxUint64 CellKey(int cx, int cy);
+
+      std::unordered_map<wxUint64, std::vector<RoutePoint *> > m_cells;
+      std::unordered_map<RoutePoint *, Filed> m_filed;
+      std::unordered_map<std::string, std::vector<RoutePoint *> > m_guids;
+      long long m_next_order;
+};
+
 //----------------------------------------------------------------------------
 //   Routeman
 //----------------------------------------------------------------------------
@@ -179,6 +219,10 @@ public:
       wxString CreateGUID(RoutePoint *pRP);
       RoutePoint *GetNearbyWaypoint(double lat, double lon, double radius_meters);
       RoutePoint *GetOtherNearbyWaypoint(double lat, double lon, double radius_meters, const wxString &guid);
+      int GetWaypointsInRadius(double lat, double lon, double radius_meters, std::vector<RoutePoint *> &result);
+      int GetNearestWaypoints(double lat, double lon, unsigned int k, double max_radius_meters,
+                              std::vector<RoutePoint *> &result);
+      RoutePoint *FindWaypointByNameAndPosition(const wxString &name, double lat, double lon);
       void SetColorScheme(ColorScheme cs);
       bool SharedWptsExist();
       void DeleteAllWaypoints(bool b_delete_used);
@@ -198,7 +242,9 @@ public:
       wxImageList *Getpmarkicon_image_list( int nominal_height );
       
       bool AddRoutePoint(RoutePoint *prp);
+      void AddRoutePoints(const std::vector<RoutePoint *> &points);
       bool RemoveRoutePoint(RoutePoint *prp);
+      void UpdateRoutePointPosition(RoutePoint *prp);
       RoutePointList *GetWaypointList(void) { return m_pWayPointList; }
 
       MarkIcon *ProcessIcon(wxBitmap pimage, const wxString & key, const wxString & description);
@@ -209,7 +255,9 @@ private:
       wxImage CreateDimImage( wxImage &image, double factor );
       
       void ProcessUserIcons( ocpnStyle::Style* style );
+      void GetCandidates(double lat, double lon, double radius_deg, std::vector<RoutePoint *> &result);
       RoutePointList    *m_pWayPointList;
+      RoutePointIndex   m_index;
       wxBitmap *CreateDimBitmap(wxBitmap *pBitmap, double factor);
 
       wxImageList       *pmarkicon_image_list;        // Current wxImageList, updated on colorscheme change
@@ -27,6 +27,7 @@
 #define _S52PLIB_H_
 
 #include <vector>
+#include <unordered_map>
 
 #include "s52s57.h"                 //types
 
@@ -36,6 +37,7 @@ class wxGLContext;
 #include "ocpn_types.h"
 
 #include <wx/dcgraph.h>         // supplemental, for Mac
+#include <wx/stopwatch.h>
 
 //    wxWindows Hash Map Declarations
 #include <wx/hashmap.h>
@@ -46,8 +48,6 @@ WX_DECLARE_HASH_MAP( int, wxString, wxIntegerHash, wxIntegerEqual, MyNatsurHash
 
 WX_DEFINE_SORTED_ARRAY( LUPrec *, wxArrayOfLUPrec );
 
-WX_DECLARE_LIST( S52_TextC, TextObjList );
-
 struct CARC_Buffer {
     unsigned char color[3][4];
     float line_width[3];
@@ -97,6 +97,39 @@ private:
 };
 
     
+//-----------------------------------------------------------------------------
+//    Text declutter grid
+//    A uniform screen space grid of the rectangles of text drawn so far in a frame,
+//    so that the overlap test for a new label only looks at nearby labels.
+//-----------------------------------------------------------------------------
+class S52TextGrid
+{
+public:
+    S52TextGrid();
+
+    void Clear();
+    void Add( S52_TextC *ptext );               // file ptext at its current rText, refiling if present
+    bool Contains( S52_TextC *ptext ) const { return m_filed.count( ptext ) != 0; }
+    bool Intersects( const wxRect &test_rect, const S52_TextC *pexclude );
+    void Offset( int dx, int dy, const wxRect &rScreen );
+
+    size_t GetCount() const { return m_filed.size(); }
+    int GetQueryCount() const { return m_nQueries; }
+    int GetTestCount() const { return m_nTests; }
+
+private:
+    void Remove( S52_TextC *ptext, const wxRect &rect );
+    void CellRange( const wxRect &rect, int &x0, int &y0, int &x1, int &y1 ) const;
+    static wxInt64 CellKey( int cx, int cy ) { return ( (wxInt64) cx << 32 ) | (wxUint32) cy; }
+
+    std::unordered_map<wxInt64, std::vector<S52_TextC *> > m_cells;
+    std::unordered_map<S52_TextC *, wxRect> m_filed;  // rect each text was filed under
+    int m_origin_x, m_origin_y;                          // accumulated pan offset
+
+    int m_nQueries;                                      // per frame statistics
+    int m_nTests;
+};
+
 //-----------------------------------------------------------------------------
 //    s52plib definition
 //-----------------------------------------------------------------------------
@@ -149,6 +182,7 @@ public:
     void ComputeCSRules( ObjRazRules *rzRules );
 
     static void DestroyLUP( LUPrec *pLUP );
+    static void CompileLUPAttributes( LUPrec *pLUP );
     static void ClearRulesCache( Rule *pR );
     DisCat findLUPDisCat(const char *objectName, LUPname TNAM);
     
@@ -351,6 +385,7 @@ private:
 
     LUPrec *FindBestLUP( wxArrayOfLUPrec *LUPArray, unsigned int startIndex, unsigned int count,
                               S57Obj *pObj, bool bStrict );
+    void CompileLUPArrays( void );
     
     void SetGLClipRect(const ViewPort &vp, const wxRect &rect);
     
@@ -398,7 +433,12 @@ private:
     int m_colortable_index;
     int m_colortable_index_save;
 
-    TextObjList m_textObjList;
+    S52TextGrid m_textGrid;
+    long m_textStatsFrames;                 // text declutter totals since the last log
+    double m_textStatsFiled;
+    double m_textStatsQueries;
+    double m_textStatsTests;
+    wxStopWatch m_textStatsSW;
 
     wxString m_ColorScheme;
 
@@ -34,12 +34,13 @@
 
 #include <vector>
 
-#define CURRENT_SENC_FORMAT_VERSION  200
+#define CURRENT_SENC_FORMAT_VERSION  201
 
 //    Fwd Defns
 class wxArrayOfS57attVal;
 class OGREnvelope;
 class OGRGeometry;
+class OsencArena;
 
 // name of the addressed look up table set (fifth letter)
 typedef enum _LUPname{
@@ -182,6 +183,24 @@ typedef struct _Rules{
 
 // LOOKUP MODULE CLASS
 
+//  A LUP attribute condition, precompiled from the ATTCArray string form
+typedef enum _LUPAttCondType{
+   LUP_ATTC_INVALID,                // malformed, never matches
+   LUP_ATTC_ANY,                    // ' ', any object value matches
+   LUP_ATTC_UNDEFINED,              // '?', never counted as a match
+   LUP_ATTC_VALUE                   // compare against value
+}LUPAttCondType;
+
+typedef struct _LUPAttCond{
+   wxUint64       code;             // packed 6 char attribute acronym
+   LUPAttCondType type;
+   int            ival;             // value as integer
+   float          fval;             // value as float
+   int           *ilist;            // value as integer list
+   int            nilist;
+   char          *sval;             // value as string
+}LUPAttCond;
+
 class LUPrec{
 public:
    int            RCID;             // record identifier
@@ -198,6 +217,8 @@ public:
    int            nSequence;        // A sequence number, indicating order of encounter in
                                     //  the PLIB file
    Rules          *ruleList;        // rasterization rule list
+   LUPAttCond     *ATTCCond;        // ATTCArray compiled for matching, one per entry
+   int             nATTCCond;
 };
 
 // Conditional Symbology
@@ -378,6 +399,9 @@ public:
       // Private Methods
 private:
       void Init();
+      S57attVal *NewAttValue();
+      void *AllocAttribute( size_t size );
+      void AddAttributeAcronym( const char *acronym );
     
 public:
       // Instance Data
@@ -417,6 +441,8 @@ public:
       int                     Scamin;                 // SCAMIN attribute decoded during load
       bool                    bIsClone;
       int                     nRef;                   // Reference counter, to signal OK for deletion
+      OsencArena              *m_arena;               // If set, this object and its attributes live in
+                                                      // the chart's arena, and must be destroyed, not deleted
       bool                    bIsAton;                // This object is an aid-to-navigation
       bool                    bIsAssociable;          // This object is DRGARE or DEPARE
 
@@ -90,6 +90,7 @@ class S57Obj;
 class VE_Element;
 class VC_Element;
 class connector_segment;
+class OsencArena;
 
 #include <wx/dynarray.h>
 
@@ -171,6 +172,7 @@ public:
       int BuildRAZFromSENCFile(const wxString& SENCPath);
       static void GetChartNameFromTXT(const wxString& FullPath, wxString &Name);
       wxString buildSENCName( const wxString& name);
+      static wxString buildThumbnailName( const wxString& SENCFileName );
       
       //    DEPCNT VALDCO array access
       bool GetNearestSafeContour(double safe_cnt, double &next_safe_cnt);
@@ -237,6 +239,8 @@ public:
       struct _chart_context     *m_this_chart_context;
 
       InitReturn FindOrCreateSenc( const wxString& name, bool b_progress = true );
+      InitReturn CheckSenc( const wxString& name, bool &bbuild_new_senc );
+      InitReturn RebuildSenc( bool b_progress = true, S57ClassRegistrar *poRegistrar = NULL );
       
 protected:
     void AssembleLineGeometry( void );
@@ -257,7 +261,8 @@ private:
       
 
       InitReturn PostInit( ChartInitFlag flags, ColorScheme cs );
-      int BuildSENCFile(const wxString& FullPath000, const wxString& SENCFileName, bool b_progress = true);
+      int BuildSENCFile(const wxString& FullPath000, const wxString& SENCFileName, bool b_progress = true,
+                        S57ClassRegistrar *poRegistrar = NULL);
       
       void SetLinePriorities(void);
 
@@ -345,6 +350,12 @@ private:
       std::vector<connector_segment *> m_pcs_vector;
       std::vector<VE_Element *> m_pve_vector;
       
+      //  Objects with their attributes, edge elements, and the edge and connected
+      //  node points, of a chart loaded from a SENC.  The points are dropped once
+      //  they are copied to the line vertex buffer, the rest when the chart is unloaded.
+      OsencArena  *m_element_arena;
+      OsencArena  *m_point_arena;
+      
 
       wxString    m_TempFilePath;
 protected:      
@@ -100,6 +100,7 @@ public:
     }
 
     bool GetTideOrCurrent(time_t t, int idx, float &value, float& dir);
+    bool GetTideOrCurrentSeries(const time_t *t, int n, int idx, float *value, float *dir);
     bool GetTideOrCurrent15(time_t t, int idx, float &tcvalue, float& dir, bool &bnew_val);
     bool GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now, float &tcvalue_prev, bool &w_t);
     void GetHightOrLowTide(time_t t, int sch_step_1, int sch_step_2, float tide_val ,bool w_t , int idx, float &tcvalue, time_t &tctime);
@@ -141,9 +141,6 @@ void AISTargetQueryDialog::OnIdTrkCreateClick( wxCommandEvent& event )
             }
             else
             {
-                TrackPoint *tp = NULL;
-                TrackPoint *tp1 = NULL;
-                    
                 Track *t = new Track();
 
                 t->SetName( wxString::Format( _T("AIS %s (%u) %s %s"), td->GetFullName().c_str(), td->MMSI, wxDateTime::Now().FormatISODate().c_str(), wxDateTime::Now().FormatISOTime().c_str() ) );
@@ -152,13 +149,11 @@ void AISTargetQueryDialog::OnIdTrkCreateClick( wxCommandEvent& event )
                 {
                     AISTargetTrackPoint *ptrack_point = node->GetData();
                     vector2D point( ptrack_point->m_lon, ptrack_point->m_lat );
-                    tp1 = t->AddNewPoint( point, wxDateTime(ptrack_point->m_time).ToUTC() );
-                    if( tp )
+                    t->AddNewPoint( point, wxDateTime(ptrack_point->m_time).ToUTC() );
+                    if( t->GetnPoints() > 1 )
                     {
-                        pSelect->AddSelectableTrackSegment( tp->m_lat, tp->m_lon, tp1->m_lat,
-                            tp1->m_lon, tp, tp1, t );
+                        pSelect->AddSelectableTrackSegment( t, t->GetnPoints() - 2 );
                     }
-                    tp = tp1;
                     node = node->GetNext();
                 }
                 
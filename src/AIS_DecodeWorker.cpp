@@ -0,0 +1,554 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  AIS sentence framing and assembly worker
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <utility>
+
+#include "AIS_DecodeWorker.h"
+#include "AIS_Bitstring.h"
+#include "ais.h"
+
+#define AIS_DECODE_MAX_QUEUE    50000           // sentences waiting for the worker
+#define AIS_DECODE_MAX_FIELDS   8
+
+AIS_DecodeWorker::AIS_DecodeWorker()
+{
+    memset(&m_stats, 0, sizeof m_stats);
+    m_busy = false;
+    m_bquit = false;
+    m_broken = 0;
+    m_thread = std::thread(&AIS_DecodeWorker::WorkerLoop, this);
+}
+
+AIS_DecodeWorker::~AIS_DecodeWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bquit = true;
+    }
+    m_work_cond.notify_all();
+    m_thread.join();
+}
+
+void AIS_DecodeWorker::Push(const char *sentence)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.sentences++;
+        if(m_input.size() >= AIS_DECODE_MAX_QUEUE) {
+            m_stats.overflow++;
+            return;
+        }
+        m_input.push_back(sentence);
+    }
+    m_work_cond.notify_one();
+}
+
+void AIS_DecodeWorker::TakeBatch(std::vector<AIS_VDXReport> &batch)
+{
+    batch.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    batch.swap(m_batch);
+    m_batch_position.clear();
+}
+
+AIS_DecodeStats AIS_DecodeWorker::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+//  True when every sentence pushed so far has been assembled into the batch
+bool AIS_DecodeWorker::IsIdle()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_input.empty() && !m_busy;
+}
+
+void AIS_DecodeWorker::WorkerLoop()
+{
+    std::vector<std::string> work;
+    std::vector<AIS_VDXReport> done;
+    long bad = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_bquit) {
+        if(m_input.empty()) {
+            m_work_cond.wait(lock);
+            continue;
+        }
+
+        work.swap(m_input);
+        m_busy = true;
+        lock.unlock();
+
+        for(unsigned int i = 0 ; i < work.size() ; i++) {
+            AIS_VDXReport report;
+            if(AssembleSentence(work[i], report)) {
+                ParseReport(report);
+                done.push_back(AIS_VDXReport());
+                std::swap(done.back(), report);
+            }
+            else if(report.msg_id < 0)
+                bad++;
+        }
+        work.clear();
+
+        lock.lock();
+        for(unsigned int i = 0 ; i < done.size() ; i++)
+            AddToBatch(done[i]);
+        done.clear();
+        m_stats.bad += bad;
+        m_stats.broken += m_broken;
+        bad = 0;
+        m_broken = 0;
+        m_busy = false;
+    }
+}
+
+//  Position reports which fully replace the previous one from the same target
+static bool IsPositionReport(int msg_id)
+{
+    return msg_id == 1 || msg_id == 2 || msg_id == 3 || msg_id == 18 || msg_id == 27;
+}
+
+//  Called with m_mutex held
+void AIS_DecodeWorker::AddToBatch(AIS_VDXReport &report)
+{
+    m_stats.messages++;
+
+    if(IsPositionReport(report.msg_id)) {
+        std::unordered_map<int, size_t>::iterator it = m_batch_position.find(report.mmsi);
+        if(it != m_batch_position.end() && m_batch[it->second].b_vdo == report.b_vdo) {
+            std::swap(m_batch[it->second], report);
+            m_stats.coalesced++;
+            return;
+        }
+        m_batch_position[report.mmsi] = m_batch.size();
+    }
+
+    m_batch.push_back(AIS_VDXReport());
+    std::swap(m_batch.back(), report);
+}
+
+//  Check one sentence and add it to any multi-part message it belongs to.
+//  Returns true with msg.payload and msg.b_vdo filled in when a message is
+//  complete.  On a bad sentence msg.msg_id is left negative.
+bool AIS_DecodeWorker::AssembleSentence(const std::string &sentence, AIS_VDXReport &msg)
+{
+    msg.msg_id = -1;
+
+    //  Make some simple tests for validity
+    size_t len = sentence.size();
+    if(len > 100 || len < 7)
+        return false;
+
+    const char *str = sentence.c_str();
+    const char *star = (const char *)memchr(str, '*', len);
+    if(!star || star + 3 > str + len)
+        return false;
+
+    unsigned char checksum_value = 0;
+    for(const char *p = str + 1 ; p < star ; p++)         // Skip over the leading ! or $
+        checksum_value ^= *p;
+
+    char hex[3] = { star[1], star[2], 0 };
+    char *hex_end;
+    if(strtol(hex, &hex_end, 16) != checksum_value || hex_end != hex + 2)
+        return false;
+
+    if(str[3] != 'V' || str[4] != 'D')
+        return false;
+
+    //  Split the fields up to the checksum, in place
+    const char *field[AIS_DECODE_MAX_FIELDS];
+    int field_len[AIS_DECODE_MAX_FIELDS];
+    int nfields = 0;
+    const char *p = str;
+    while(nfields < AIS_DECODE_MAX_FIELDS) {
+        const char *comma = (const char *)memchr(p, ',', star - p);
+        const char *end = comma ? comma : star;
+        field[nfields] = p;
+        field_len[nfields] = end - p;
+        nfields++;
+        if(!comma)
+            break;
+        p = comma + 1;
+    }
+    if(nfields < 6)
+        return false;
+
+    int nsentences = atoi(field[1]);
+    int isentence = atoi(field[2]);
+    int sequence_id = field_len[3] ? atoi(field[3]) : -1;
+    int channel = field_len[4] ? field[4][0] : 0;
+    std::string data(field[5], field_len[5]);
+
+    msg.b_vdo = str[5] == 'O';
+
+    if(nsentences < 1 || isentence < 1 || isentence > nsentences)
+        return false;
+
+    msg.msg_id = 0;                             // the sentence itself is good
+    if(nsentences == 1) {
+        msg.payload.swap(data);
+    }
+    else {
+        int key = (sequence_id + 1) * 256 + channel;
+        if(isentence == 1) {
+            Fragment &frag = m_fragments[key];
+            if(frag.next)
+                m_broken++;
+            frag.nparts = nsentences;
+            frag.next = 2;
+            frag.data.swap(data);
+            return false;
+        }
+
+        std::map<int, Fragment>::iterator it = m_fragments.find(key);
+        if(it == m_fragments.end()) {
+            m_broken++;
+            return false;
+        }
+
+        Fragment &frag = it->second;
+        if(frag.nparts != nsentences || frag.next != isentence) {
+            m_fragments.erase(it);
+            m_broken++;
+            return false;
+        }
+
+        frag.data += data;
+        frag.next++;
+        if(isentence < nsentences)
+            return false;
+
+        msg.payload.swap(frag.data);
+        m_fragments.erase(it);
+    }
+
+    //  Need the message id and MMSI at least
+    if(msg.payload.size() < 7 || msg.payload.size() >= AIS_MAX_MESSAGE_LEN)
+        return false;
+
+    return true;
+}
+
+//  Longitude and latitude, in 1/10000 minute, from the given bit positions
+static void GetPosition(AIS_Bitstring &bstr, int lon_sp, int lat_sp, AIS_VDXReport &r)
+{
+    int lon = bstr.GetInt(lon_sp, 28);
+    if(lon & 0x08000000)                    // negative?
+        lon |= 0xf0000000;
+    r.lon = lon / 600000.;
+
+    int lat = bstr.GetInt(lat_sp, 27);
+    if(lat & 0x04000000)                    // negative?
+        lat |= 0xf8000000;
+    r.lat = lat / 600000.;
+
+    //  Ship does not report Lat or Lon "unavailable"
+    r.b_position_valid = (r.lon <= 180.) && (r.lat <= 90.);
+    r.fields |= AIS_VDX_POSITION;
+}
+
+//  Decode the assembled payload of a report into its plain fields, as
+//  AIS_Decoder once did straight into the target.  Runs on the worker, so
+//  nothing here may touch the target list.  The payload is dropped unless
+//  the GUI still needs it.  Returns report.b_parsed.
+bool AIS_DecodeWorker::ParseReport(AIS_VDXReport &report)
+{
+    AIS_VDXReport &r = report;
+    AIS_Bitstring bstr(r.payload.c_str());
+
+    r.msg_id = bstr.GetInt(1, 6);
+    r.mmsi = bstr.GetInt(9, 30);               // MMSI is always in the same spot in the bitstream
+    r.b_parsed = false;
+    r.b_posn_report = false;
+    r.fields = 0;
+
+    switch(r.msg_id) {
+        case 1:                                 // Position Report
+        case 2:
+        case 3: {
+            r.nav_status = bstr.GetInt(39, 4);
+            r.sog = 0.1 * (bstr.GetInt(51, 10));
+            GetPosition(bstr, 62, 90, r);
+            r.cog = 0.1 * (bstr.GetInt(117, 12));
+            r.hdg = 1.0 * (bstr.GetInt(129, 9));
+
+            r.rot_ais = bstr.GetInt(43, 8);
+            double rot_dir = 1.0;
+            if(r.rot_ais == 128)
+                r.rot_ais = -128;               // not available codes as -128
+            else if((r.rot_ais & 0x80) == 0x80) {
+                r.rot_ais = r.rot_ais - 256;    // convert to twos complement
+                rot_dir = -1.0;
+            }
+            r.rot_ind = wxRound(rot_dir * pow((((double) r.rot_ais) / 4.733), 2)); // Convert to indicated ROT
+
+            r.utc_sec = bstr.GetInt(138, 6);
+            r.fields |= AIS_VDX_NAVSTATUS | AIS_VDX_SOG | AIS_VDX_COG | AIS_VDX_HDG |
+                        AIS_VDX_ROTAIS | AIS_VDX_ROTIND | AIS_VDX_UTC_SEC;
+
+            if((1 == r.msg_id) || (2 == r.msg_id)) {        // decode SOTDMA per 7.6.7.2.2
+                r.sync_state = bstr.GetInt(151, 2);
+                r.slot_to = bstr.GetInt(153, 2);
+                r.fields |= AIS_VDX_SOTDMA;
+                if((r.slot_to == 1) && (r.sync_state == 0)) {       // UTCDirect follows
+                    r.utc_hour = bstr.GetInt(155, 5);
+                    r.utc_min = bstr.GetInt(160, 7);
+                    r.fields |= AIS_VDX_UTC_HM;
+                }
+            }
+
+            //    Capture Euro Inland special passing arrangement signal ("stbd-stbd")
+            r.blue_paddle = bstr.GetInt(144, 2);
+            r.fields |= AIS_VDX_BLUE_PADDLE;
+
+            //    Check for SART and friends by looking at first two digits of MMSI
+            r.fields |= AIS_VDX_CLASS;
+            if(r.mmsi / 10000000 == 97) {
+                r.ais_class = AIS_SART;
+                r.fields |= AIS_VDX_STATIC;     // won't get a static report, so fake it
+            }
+            else
+                r.ais_class = AIS_CLASS_A;
+
+            r.b_parsed = true;
+            r.b_posn_report = true;
+            break;
+        }
+
+        case 18:
+        case 19: {                              // Class B mes_ID 19 Is same as mes_ID 18 until bit 139
+            r.nav_status = UNDEFINED;           // Class B targets have no status.  Enforce this...
+            r.sog = 0.1 * (bstr.GetInt(47, 10));
+            GetPosition(bstr, 58, 86, r);
+            r.cog = 0.1 * (bstr.GetInt(113, 12));
+            r.hdg = 1.0 * (bstr.GetInt(125, 9));
+            r.utc_sec = bstr.GetInt(134, 6);
+            r.ais_class = AIS_CLASS_B;
+            r.fields |= AIS_VDX_NAVSTATUS | AIS_VDX_SOG | AIS_VDX_COG | AIS_VDX_HDG |
+                        AIS_VDX_UTC_SEC | AIS_VDX_CLASS;
+
+            if(r.msg_id == 19) {                //  From bit 140 and forward data as of mes 5
+                bstr.GetStr(144, 120, &r.ship_name[0], 20);
+                r.ship_type = (unsigned char) bstr.GetInt(264, 8);
+                r.dim_a = bstr.GetInt(272, 9);
+                r.dim_b = bstr.GetInt(281, 9);
+                r.dim_c = bstr.GetInt(290, 6);
+                r.dim_d = bstr.GetInt(296, 6);
+                r.fields |= AIS_VDX_NAME | AIS_VDX_SHIPTYPE | AIS_VDX_DIMENSIONS;
+            }
+
+            r.b_parsed = true;
+            r.b_posn_report = true;
+            break;
+        }
+
+        case 5: {
+            r.ais_class = AIS_CLASS_A;
+            r.fields |= AIS_VDX_CLASS;
+
+//          Get the AIS Version indicator
+//          0 = station compliant with Recommendation ITU-R M.1371-1
+//          1 = station compliant with Recommendation ITU-R M.1371-3
+//          2-3 = station compliant with future editions
+            int AIS_version_indicator = bstr.GetInt(39, 2);
+            if(AIS_version_indicator < 4) {
+                r.imo = bstr.GetInt(41, 30);
+                bstr.GetStr(71, 42, &r.call_sign[0], 7);
+                bstr.GetStr(113, 120, &r.ship_name[0], 20);
+                r.ship_type = (unsigned char) bstr.GetInt(233, 8);
+
+                r.dim_a = bstr.GetInt(241, 9);
+                r.dim_b = bstr.GetInt(250, 9);
+                r.dim_c = bstr.GetInt(259, 6);
+                r.dim_d = bstr.GetInt(265, 6);
+
+                r.eta_mo = bstr.GetInt(275, 4);
+                r.eta_day = bstr.GetInt(279, 5);
+                r.eta_hr = bstr.GetInt(284, 5);
+                r.eta_min = bstr.GetInt(289, 6);
+
+                r.draft = (double) (bstr.GetInt(295, 8)) / 10.0;
+
+                bstr.GetStr(303, 120, &r.destination[0], 20);
+
+                r.fields |= AIS_VDX_IMO | AIS_VDX_CALLSIGN | AIS_VDX_NAME | AIS_VDX_SHIPTYPE |
+                            AIS_VDX_DIMENSIONS | AIS_VDX_ETA | AIS_VDX_DRAFT |
+                            AIS_VDX_DESTINATION | AIS_VDX_STATIC;
+                r.b_parsed = true;
+            }
+            break;
+        }
+
+        case 24: {
+            int part_number = bstr.GetInt(39, 2);
+            if(0 == part_number) {
+                bstr.GetStr(41, 120, &r.ship_name[0], 20);
+                r.fields |= AIS_VDX_NAME;
+                r.b_parsed = true;
+            } else if(1 == part_number) {
+                r.ship_type = (unsigned char) bstr.GetInt(41, 8);
+                bstr.GetStr(91, 42, &r.call_sign[0], 7);
+
+                r.dim_a = bstr.GetInt(133, 9);
+                r.dim_b = bstr.GetInt(142, 9);
+                r.dim_c = bstr.GetInt(151, 6);
+                r.dim_d = bstr.GetInt(157, 6);
+                r.fields |= AIS_VDX_SHIPTYPE | AIS_VDX_CALLSIGN | AIS_VDX_DIMENSIONS;
+                r.b_parsed = true;
+            }
+            break;
+        }
+
+        case 4: {                               // base station
+            r.ais_class = AIS_BASE;
+            r.utc_hour = bstr.GetInt(62, 5);
+            r.utc_min = bstr.GetInt(67, 6);
+            r.utc_sec = bstr.GetInt(73, 6);
+            GetPosition(bstr, 80, 108, r);
+            r.cog = -1.;
+            r.hdg = 511;
+            r.sog = -1.;
+            r.fields |= AIS_VDX_CLASS | AIS_VDX_UTC_HM | AIS_VDX_UTC_SEC |
+                        AIS_VDX_COG | AIS_VDX_HDG | AIS_VDX_SOG;
+
+            r.b_parsed = true;
+            r.b_posn_report = true;
+            break;
+        }
+
+        case 9: {                               // Special Position Report (Standard SAR Aircraft Position Report)
+            r.sog = bstr.GetInt(51, 10);
+            GetPosition(bstr, 62, 90, r);
+            r.cog = 0.1 * (bstr.GetInt(117, 12));
+            r.altitude = bstr.GetInt(39, 12);
+            r.fields |= AIS_VDX_SOG | AIS_VDX_COG | AIS_VDX_ALTITUDE;
+
+            r.b_parsed = true;
+            r.b_posn_report = true;
+            break;
+        }
+
+        case 21: {                              // Test Message (Aid to Navigation)
+            r.ship_type = (unsigned char) bstr.GetInt(39, 5);
+            r.imo = 0;
+            r.sog = 0;
+            r.hdg = 0;
+            r.cog = 0;
+            r.rot_ais = -128;                   // i.e. not available
+            r.dim_a = bstr.GetInt(220, 9);
+            r.dim_b = bstr.GetInt(229, 9);
+            r.dim_c = bstr.GetInt(238, 6);
+            r.dim_d = bstr.GetInt(244, 6);
+            r.draft = 0;
+
+            r.utc_sec = bstr.GetInt(254, 6);
+
+            int offpos = bstr.GetInt(260, 1);   // off position flag
+            int virt = bstr.GetInt(270, 1);     // virtual flag
+
+            if(virt)
+                r.nav_status = ATON_VIRTUAL;
+            else
+                r.nav_status = ATON_REAL;
+            if(r.utc_sec <= 59 /*&& !virt*/) {
+                r.nav_status += 1;
+                if(offpos)
+                    r.nav_status += 1;
+            }
+
+            bstr.GetStr(44, 120, &r.ship_name[0], 20); // short name only, extension wont fit in Ship structure
+
+            if(bstr.GetBitCount() > 276) {
+                int nx = ((bstr.GetBitCount() - 272) / 6) * 6;
+                bstr.GetStr(273, nx, &r.ship_name_ext[0], 14);
+                r.ship_name_ext[14] = 0;
+            } else {
+                r.ship_name_ext[0] = 0;
+            }
+
+            r.ais_class = AIS_ATON;
+            GetPosition(bstr, 165, 193, r);
+
+            r.fields |= AIS_VDX_SHIPTYPE | AIS_VDX_IMO | AIS_VDX_SOG | AIS_VDX_HDG | AIS_VDX_COG |
+                        AIS_VDX_ROTAIS | AIS_VDX_DIMENSIONS | AIS_VDX_DRAFT | AIS_VDX_UTC_SEC |
+                        AIS_VDX_NAVSTATUS | AIS_VDX_NAME | AIS_VDX_NAME_EXT | AIS_VDX_CLASS;
+            r.b_parsed = true;
+            r.b_posn_report = true;
+            break;
+        }
+
+        case 8: {                               // Binary Broadcast
+            int dac = bstr.GetInt(41, 10);
+            int fi = bstr.GetInt(51, 6);
+            if(dac == 200 && fi == 10) {        // European inland, "Inland ship static and voyage related data"
+                bstr.GetStr(57, 48, &r.euro_vin[0], 8);
+                r.euro_length = ((double) bstr.GetInt(105, 13)) / 10.0;
+                r.euro_beam = ((double) bstr.GetInt(118, 10)) / 10.0;
+                r.un_shiptype = bstr.GetInt(128, 14);
+                r.euro_draft = ((double) bstr.GetInt(145, 11)) / 100.0;
+                r.fields |= AIS_VDX_EURO_INLAND;
+                r.b_parsed = true;
+            }
+            if(dac == 1 && fi == 22 && bstr.GetBitCount() >= 111) {  // IMO Area Notice
+                r.fields |= AIS_VDX_AREA_NOTICE;
+                r.b_parsed = true;
+            }
+            break;
+        }
+
+        case 14: {                              // Safety Related Broadcast
+            //  Always capture the MSG_14 text
+            if(bstr.GetBitCount() > 40) {
+                char msg_14_text[969];          // GetStr() terminates after max_len characters
+                int nx = ((bstr.GetBitCount() - 40) / 6) * 6;
+                int nd = bstr.GetStr(41, nx, msg_14_text, 968);
+                nd = wxMax(0, nd);
+                nd = wxMin(nd, 967);
+                r.text.assign(msg_14_text, nd);
+                r.fields |= AIS_VDX_TEXT;
+            }
+            r.b_parsed = true;
+            break;
+        }
+
+        default:                                // 6 Addressed Binary Message, 7 Binary Ack, ...
+            break;
+    }
+
+    if(!(r.fields & AIS_VDX_AREA_NOTICE))
+        std::string().swap(r.payload);
+
+    return r.b_parsed;
+}
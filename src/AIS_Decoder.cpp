@@ -31,6 +31,7 @@
 #include "georef.h"
 #include "OCPN_DataStreamEvent.h"
 #include <fstream>
+#include <unordered_map>
 #include "OCPNPlatform.h"
 #include "pluginmanager.h"
 #include "Track.h"
@@ -103,6 +104,7 @@ BEGIN_EVENT_TABLE(AIS_Decoder, wxEvtHandler)
     EVT_TIMER(TIMER_AIS1, AIS_Decoder::OnTimerAIS)
     EVT_TIMER(TIMER_AISAUDIO, AIS_Decoder::OnTimerAISAudio)
     EVT_TIMER(TIMER_DSC, AIS_Decoder::OnTimerDSC)
+    EVT_TIMER(TIMER_AISBATCH, AIS_Decoder::OnTimerAISBatch)
 END_EVENT_TABLE()
 
 static int n_msgs;
@@ -153,6 +155,20 @@ AIS_Decoder::AIS_Decoder( wxFrame *parent )
     
     m_ptentative_dsctarget = NULL;
     m_dsc_timer.SetOwner( this, TIMER_DSC );
+
+    //  VDM/VDO sentences are assembled off the GUI thread, and collected at a steady pace
+    m_batch_timer.SetOwner( this, TIMER_AISBATCH );
+    m_batch_timer.Start( TIMER_AIS_BATCH_MSEC, wxTIMER_CONTINUOUS );
+
+    memset( &m_cpa_stats, 0, sizeof m_cpa_stats );
+    m_cpa_cycle = 0;
+    m_cpa_own_gen = 1;
+    m_cpa_own_lat = m_cpa_own_lon = m_cpa_own_cog = m_cpa_own_sog = NAN;
+    m_cpa_own_gps_valid = false;
+
+    //  Forces a first scheduling pass in OnTimerAIS()
+    m_aging_bMarkLost = m_aging_bRemoveLost = m_aging_bInlandEcdis = false;
+    m_aging_MarkLost_Mins = m_aging_RemoveLost_Mins = -1.;
     
 
     //  Create/connect a dynamic event handler slot for wxEVT_OCPN_DATASTREAM(s)
@@ -182,6 +198,7 @@ AIS_Decoder::~AIS_Decoder( void )
     m_dsc_timer.Stop();
     m_AIS_Audio_Alert_Timer.Stop();
     TimerAIS.Stop();
+    m_batch_timer.Stop();
 
 #ifdef AIS_DEBUG
     printf("First message[1, 2] ticks: %d  Last Message [1,2]ticks %d  Difference:  %d\n", first_rx_ticks, rx_ticks, rx_ticks - first_rx_ticks);
@@ -265,24 +282,110 @@ void AIS_Decoder::BuildERIShipTypeHash(void)
 //----------------------------------------------------------------------------------
 void AIS_Decoder::OnEvtAIS( OCPN_DataStreamEvent& event )
 {
-    wxString message = event.ProcessNMEA4Tags();
+    const NMEA_SentenceHeader &header = event.GetHeader();
 
     int nr = 0;
-    if( !message.IsEmpty() )
+    if( ( header.id == NMEA_ID_VDM ) || ( header.id == NMEA_ID_VDO ) )
     {
-        if( message.Mid( 3, 3 ).IsSameAs( _T("VDM") ) ||
-            message.Mid( 3, 3 ).IsSameAs( _T("VDO") ) ||
-            message.Mid( 1, 5 ).IsSameAs( _T("FRPOS") ) ||
-            message.Mid( 1, 2 ).IsSameAs( _T("CD") ) ||
-            message.Mid( 3, 3 ).IsSameAs( _T("TLL") ) ||
-            message.Mid( 3, 3 ).IsSameAs( _T("TTM") ) ||
-            message.Mid( 3, 3 ).IsSameAs( _T("OSD") ) ||
-            ( g_bWplIsAprsPosition && message.Mid( 3, 3 ).IsSameAs( _T("WPL") ) ) )
-        {
-                nr = Decode( message );
-                gFrame->TouchAISActive();
+        //  Straight from the event's buffer to the worker
+        m_decode_worker.Push( event.GetNMEAString().c_str() + header.offset );
+        gFrame->TouchAISActive();
+    }
+    else if( ( header.id == NMEA_ID_FRPOS ) ||
+        !strncmp( header.address, "CD", 2 ) ||
+        ( header.id == NMEA_ID_TLL ) ||
+        ( header.id == NMEA_ID_TTM ) ||
+        ( header.id == NMEA_ID_OSD ) ||
+        ( g_bWplIsAprsPosition && ( header.id == NMEA_ID_WPL ) ) )
+    {
+        wxString message = event.ProcessNMEA4Tags();
+        if( !message.IsEmpty() ) {
+            nr = Decode( message );
+            gFrame->TouchAISActive();
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------
+//     Apply the VDM/VDO messages assembled by the decode worker
+//----------------------------------------------------------------------------------
+void AIS_Decoder::OnTimerAISBatch( wxTimerEvent& event )
+{
+    ApplyDecodedBatch();
+
+    //  Log the decode rate now and then, while AIS is arriving
+    if( m_decode_stats_sw.Time() > 600000 ) {
+        AIS_DecodeStats stats = m_decode_worker.GetStats();
+        if( stats.sentences ) {
+            wxLogMessage( _T("AIS decode: %ld sentences, %ld messages (%ld coalesced), %ld bad, %ld broken, %ld dropped"),
+                          stats.sentences, stats.messages, stats.coalesced, stats.bad,
+                          stats.broken, stats.overflow );
         }
+        if( m_cpa_stats.cycles ) {
+            wxLogMessage( _T("AIS CPA: %ld passes, %ld targets recalculated, %ld unchanged, %ld deferred"),
+                          m_cpa_stats.cycles, m_cpa_stats.recomputed, m_cpa_stats.unchanged,
+                          m_cpa_stats.deferred );
+        }
+        m_decode_stats_sw.Start();
+    }
+}
+
+void AIS_Decoder::ApplyDecodedBatch( void )
+{
+    m_decode_worker.TakeBatch( m_decoded_batch );
+    if( m_decoded_batch.empty() )
+        return;
+
+    wxDateTime now = wxDateTime::Now();
+    now.MakeGMT();
+    time_t now_ticks = now.GetTicks();
+
+    for( unsigned int i = 0; i < m_decoded_batch.size(); i++ ) {
+        MergeVDXReport( m_decoded_batch[i], now_ticks );
+        n_msgs++;
+    }
+    m_decoded_batch.clear();
+}
+
+//----------------------------------------------------------------------------------
+//      Feed a recorded NMEA file through the VDM/VDO pipeline as fast as it will go,
+//      and log the sustained rate.  The targets replayed stay in the target list.
+//----------------------------------------------------------------------------------
+void AIS_Decoder::ReplayBenchmark( const wxString &fileName )
+{
+    std::ifstream infile( fileName.mb_str() );
+    if( !infile ) {
+        wxLogMessage( _T("AIS replay: cannot open ") + fileName );
+        return;
     }
+
+    std::vector<std::string> lines;
+    std::string line;
+    while( getline( infile, line ) ) {
+        while( !line.empty() && ( line[line.size() - 1] == '\r' || line[line.size() - 1] == '\n' ) )
+            line.erase( line.size() - 1 );
+        if( line.size() > 6 && line[3] == 'V' && line[4] == 'D' )
+            lines.push_back( line );
+    }
+
+    AIS_DecodeStats before = m_decode_worker.GetStats();
+    wxStopWatch sw;
+
+    for( unsigned int i = 0; i < lines.size(); i++ ) {
+        m_decode_worker.Push( lines[i].c_str() );
+        if( ( i % 1000 ) == 999 )
+            ApplyDecodedBatch();
+    }
+    while( !m_decode_worker.IsIdle() )
+        wxMilliSleep( 1 );
+    ApplyDecodedBatch();
+
+    long ms = wxMax( sw.Time(), 1L );
+    AIS_DecodeStats after = m_decode_worker.GetStats();
+    long messages = after.messages - before.messages;
+    wxLogMessage( _T("AIS replay: %lu sentences, %ld messages (%ld coalesced) in %ld ms, %.0f sentences/s, %.0f messages/s"),
+                  (unsigned long) lines.size(), messages, after.coalesced - before.coalesced, ms,
+                  lines.size() * 1000. / ms, messages * 1000. / ms );
 }
 
 //----------------------------------------------------------------------------------
@@ -359,12 +462,16 @@ AIS_Error AIS_Decoder::DecodeSingleVDO( const wxString& str, GenericPosDatEx *po
     }
 
 
-    //  Create the bit accessible string
-    AIS_Bitstring strbit( string_to_parse.mb_str() );
+    AIS_VDXReport report;
+    report.payload = string_to_parse.mb_str();
+    AIS_DecodeWorker::ParseReport( report );
+
+    wxDateTime now = wxDateTime::Now();
+    now.MakeGMT();
 
     AIS_Target_Data TargetData;
 
-    bool bdecode_result = Parse_VDXBitstring( &strbit, &TargetData );
+    bool bdecode_result = ApplyVDXReport( report, &TargetData, now.GetTicks() );
 
     if(bdecode_result) {
         switch(TargetData.MID)
@@ -469,7 +576,6 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
     double aprs_mins, aprs_degs;
 
     AIS_Target_Data *pTargetData = 0;
-    AIS_Target_Data *pStaleTarget = NULL;
     bool bnewtarget = false;
     int last_report_ticks;
     
@@ -778,168 +884,217 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
             }
         }
 
-        if( mmsi || ( !string_to_parse.IsEmpty() && ( string_to_parse.Len() < AIS_MAX_MESSAGE_LEN ) ) ) {
+        if( !mmsi ) {
+            //  Plain AIS, wait for the last part of a multi-sentence message
+            n_msgs++;
+            if( string_to_parse.IsEmpty() || ( string_to_parse.Len() >= AIS_MAX_MESSAGE_LEN ) )
+                return AIS_Partial;
 
-            //  Create the bit accessible string
             wxCharBuffer abuf = string_to_parse.ToUTF8();
             if( !abuf.data() )                            // badly formed sentence?
                 return AIS_GENERIC_ERROR;
-            
-            AIS_Bitstring strbit( abuf.data() );
 
-            //  Extract the MMSI
-            if( !mmsi ) mmsi = strbit.GetInt( 9, 30 );
-            long mmsi_long = mmsi;
+            AIS_VDXReport report;
+            report.payload = abuf.data();
+            report.b_vdo = str.Mid( 3, 3 ).IsSameAs( _T("VDO") );
+            AIS_DecodeWorker::ParseReport( report );
 
-            // Check to see if this MMSI has been configured to be ignored completely...
-            for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
-                MMSIProperties *props =  g_MMSI_Props_Array[i];
-                if(mmsi == props->MMSI){
-                    if(props->m_bignore)
-                        return AIS_NoError;
-                    else
-                        break;
-                }
-            }
-            
-             //  Search the current AISTargetList for an MMSI match
-            AIS_Target_Hash::iterator it = AISTargetList->find( mmsi );
-            if( it == AISTargetList->end() )                  // not found
-                    {
-                pTargetData = new AIS_Target_Data;
-                bnewtarget = true;
-                m_n_targets++;
-            } else {
-                pTargetData = it->second;          // find current entry
-                pStaleTarget = pTargetData;        // save a pointer to stale data
-            }
-            // XXX Should be ?
-            // assert(pTargetData != 0);
-
-            //  Grab the stale targets's last report time
-             wxDateTime now = wxDateTime::Now();
+            wxDateTime now = wxDateTime::Now();
             now.MakeGMT();
+            return MergeVDXReport( report, now.GetTicks() );
+        }
 
-            if( pStaleTarget )
-                last_report_ticks = pStaleTarget->PositionReportTicks;
-            else
-                last_report_ticks = now.GetTicks();
-
-            // Delete the stale AIS Target selectable point
-            if( pStaleTarget )
-                pSelectAIS->DeleteSelectablePoint( (void *) mmsi_long, SELTYPE_AISTARGET );
-
-            bool bhad_name = false;
-            if( pStaleTarget ) bhad_name = pStaleTarget->b_nameValid;
-
-            if (pTargetData) {
-              if( gpsg_mmsi ) {
-                pTargetData->PositionReportTicks = now.GetTicks();
-                pTargetData->StaticReportTicks = now.GetTicks();
-                pTargetData->m_utc_hour = gpsg_utc_hour;
-                pTargetData->m_utc_min = gpsg_utc_min;
-                pTargetData->m_utc_sec = gpsg_utc_sec;
-                pTargetData->m_date_string = gpsg_date;
-                pTargetData->MMSI = gpsg_mmsi;
-                pTargetData->NavStatus = 0; // underway
-                pTargetData->Lat = gpsg_lat;
-                pTargetData->Lon = gpsg_lon;
-                pTargetData->b_positionOnceValid = true;
-                pTargetData->COG = gpsg_cog;
-                pTargetData->SOG = gpsg_sog;
-                pTargetData->ShipType = 52; // buddy
-                pTargetData->Class = AIS_GPSG_BUDDY;
-                strcpy( pTargetData->ShipName, gpsg_name_str );
-                pTargetData->b_nameValid = true;
-                pTargetData->b_active = true;
-                pTargetData->b_lost = false;
-
-                bdecode_result = true;
-              } else if( arpa_mmsi ) {
-                pTargetData->m_utc_hour = arpa_utc_hour;
-                pTargetData->m_utc_min = arpa_utc_min;
-                pTargetData->m_utc_sec = arpa_utc_sec;
-                pTargetData->MMSI = arpa_mmsi;
-                pTargetData->NavStatus = 15; // undefined
-                if( str.Mid( 3, 3 ).IsSameAs( _T("TLL") ) ) {
-                    if( !bnewtarget ) {
-                        int age_of_last = ( now.GetTicks() - pTargetData->PositionReportTicks );
-                        if ( age_of_last > 0 ) {
-                            ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, arpa_lat, arpa_lon, &pTargetData->COG, &pTargetData->SOG );
-                            pTargetData->SOG = pTargetData->SOG * 3600 / age_of_last;
-                        }
-                    }
-                    pTargetData->Lat = arpa_lat;
-                    pTargetData->Lon = arpa_lon;
-                } else if( str.Mid( 3, 3 ).IsSameAs( _T("TTM") ) ) {
-                    if( arpa_dist != 0. ) //Not a new or turned off target
-                        ll_gc_ll( gLat, gLon, arpa_brg, arpa_dist, &pTargetData->Lat, &pTargetData->Lon );
-                    else
-                        arpa_lost = true;
-                    pTargetData->COG = arpa_cog;
-                    pTargetData->SOG = arpa_sog;
-                }
-                pTargetData->PositionReportTicks = now.GetTicks();
-                pTargetData->StaticReportTicks = now.GetTicks();
-                pTargetData->b_positionOnceValid = true;
-                pTargetData->ShipType = 55; // arpa
-                pTargetData->Class = AIS_ARPA;
-
-                strcpy( pTargetData->ShipName, arpa_name_str);
-                if( arpa_status != _T("Q") )
-                    pTargetData->b_nameValid = true;
-                else
-                    pTargetData->b_nameValid = false;
-                pTargetData->b_active = !arpa_lost;
-                pTargetData->b_lost = arpa_nottracked;
-
-                bdecode_result = true;
-              } else if( aprs_mmsi ) {
-                pTargetData->m_utc_hour = now.GetHour();
-                pTargetData->m_utc_min = now.GetMinute();
-                pTargetData->m_utc_sec = now.GetSecond();
-                pTargetData->MMSI = aprs_mmsi;
-                pTargetData->NavStatus = 15; // undefined
+        if( IsMMSIIgnored( mmsi ) )
+            return AIS_NoError;
+
+        //  Search the current AISTargetList for an MMSI match
+        pTargetData = FindOrCreateTarget( mmsi, bnewtarget, last_report_ticks );
+
+        wxDateTime now = wxDateTime::Now();
+        now.MakeGMT();
+
+        if (pTargetData) {
+          if( gpsg_mmsi ) {
+            pTargetData->PositionReportTicks = now.GetTicks();
+            pTargetData->StaticReportTicks = now.GetTicks();
+            pTargetData->m_utc_hour = gpsg_utc_hour;
+            pTargetData->m_utc_min = gpsg_utc_min;
+            pTargetData->m_utc_sec = gpsg_utc_sec;
+            pTargetData->m_date_string = gpsg_date;
+            pTargetData->MMSI = gpsg_mmsi;
+            pTargetData->NavStatus = 0; // underway
+            pTargetData->Lat = gpsg_lat;
+            pTargetData->Lon = gpsg_lon;
+            pTargetData->b_positionOnceValid = true;
+            pTargetData->COG = gpsg_cog;
+            pTargetData->SOG = gpsg_sog;
+            pTargetData->ShipType = 52; // buddy
+            pTargetData->Class = AIS_GPSG_BUDDY;
+            strcpy( pTargetData->ShipName, gpsg_name_str );
+            pTargetData->b_nameValid = true;
+            pTargetData->b_active = true;
+            pTargetData->b_lost = false;
+
+            bdecode_result = true;
+          } else if( arpa_mmsi ) {
+            pTargetData->m_utc_hour = arpa_utc_hour;
+            pTargetData->m_utc_min = arpa_utc_min;
+            pTargetData->m_utc_sec = arpa_utc_sec;
+            pTargetData->MMSI = arpa_mmsi;
+            pTargetData->NavStatus = 15; // undefined
+            if( str.Mid( 3, 3 ).IsSameAs( _T("TLL") ) ) {
                 if( !bnewtarget ) {
-                    int age_of_last = (now.GetTicks() - pTargetData->PositionReportTicks);
+                    int age_of_last = ( now.GetTicks() - pTargetData->PositionReportTicks );
                     if ( age_of_last > 0 ) {
-                        ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, aprs_lat, aprs_lon, &pTargetData->COG, &pTargetData->SOG );
+                        ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, arpa_lat, arpa_lon, &pTargetData->COG, &pTargetData->SOG );
                         pTargetData->SOG = pTargetData->SOG * 3600 / age_of_last;
                     }
                 }
-                pTargetData->PositionReportTicks = now.GetTicks();
-                pTargetData->StaticReportTicks = now.GetTicks();
-                pTargetData->Lat = aprs_lat;
-                pTargetData->Lon = aprs_lon;
-                pTargetData->b_positionOnceValid = true;
-                pTargetData->ShipType = 56; // aprs
-                pTargetData->Class = AIS_APRS;
-                strcpy( pTargetData->ShipName, aprs_name_str);
+                pTargetData->Lat = arpa_lat;
+                pTargetData->Lon = arpa_lon;
+            } else if( str.Mid( 3, 3 ).IsSameAs( _T("TTM") ) ) {
+                if( arpa_dist != 0. ) //Not a new or turned off target
+                    ll_gc_ll( gLat, gLon, arpa_brg, arpa_dist, &pTargetData->Lat, &pTargetData->Lon );
+                else
+                    arpa_lost = true;
+                pTargetData->COG = arpa_cog;
+                pTargetData->SOG = arpa_sog;
+            }
+            pTargetData->PositionReportTicks = now.GetTicks();
+            pTargetData->StaticReportTicks = now.GetTicks();
+            pTargetData->b_positionOnceValid = true;
+            pTargetData->ShipType = 55; // arpa
+            pTargetData->Class = AIS_ARPA;
+
+            strcpy( pTargetData->ShipName, arpa_name_str);
+            if( arpa_status != _T("Q") )
                 pTargetData->b_nameValid = true;
-                pTargetData->b_active = true;
-                pTargetData->b_lost = false;
-
-                bdecode_result = true;
-              } else{
-                // The normal Plain-Old AIS target code path....
-                bdecode_result = Parse_VDXBitstring( &strbit, pTargetData );       // Parse the new data
-              }
-              //     Update the most recent report period
-              pTargetData->RecentPeriod = pTargetData->PositionReportTicks - last_report_ticks;
+            else
+                pTargetData->b_nameValid = false;
+            pTargetData->b_active = !arpa_lost;
+            pTargetData->b_lost = arpa_nottracked;
+
+            bdecode_result = true;
+          } else if( aprs_mmsi ) {
+            pTargetData->m_utc_hour = now.GetHour();
+            pTargetData->m_utc_min = now.GetMinute();
+            pTargetData->m_utc_sec = now.GetSecond();
+            pTargetData->MMSI = aprs_mmsi;
+            pTargetData->NavStatus = 15; // undefined
+            if( !bnewtarget ) {
+                int age_of_last = (now.GetTicks() - pTargetData->PositionReportTicks);
+                if ( age_of_last > 0 ) {
+                    ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, aprs_lat, aprs_lon, &pTargetData->COG, &pTargetData->SOG );
+                    pTargetData->SOG = pTargetData->SOG * 3600 / age_of_last;
+                }
             }
-            ret = AIS_NoError;
-        } else{
-            ret = AIS_Partial;                // accumulating parts of a multi-sentence message
-            pTargetData = 0;
+            pTargetData->PositionReportTicks = now.GetTicks();
+            pTargetData->StaticReportTicks = now.GetTicks();
+            pTargetData->Lat = aprs_lat;
+            pTargetData->Lon = aprs_lon;
+            pTargetData->b_positionOnceValid = true;
+            pTargetData->ShipType = 56; // aprs
+            pTargetData->Class = AIS_APRS;
+            strcpy( pTargetData->ShipName, aprs_name_str);
+            pTargetData->b_nameValid = true;
+            pTargetData->b_active = true;
+            pTargetData->b_lost = false;
+
+            bdecode_result = true;
+          }
+          //     Update the most recent report period
+          pTargetData->RecentPeriod = pTargetData->PositionReportTicks - last_report_ticks;
         }
-        
+        ret = AIS_NoError;
 
+        CommitTargetData( pTargetData, mmsi, false, bdecode_result, bnewtarget );
+
+    n_msgs++;
+#ifdef AIS_DEBUG
+    if((n_msgs % 10000) == 0)
+    printf("n_msgs %10d m_n_targets: %6d  n_msg1: %10d  n_msg5+24: %10d  n_new5: %10d \n", n_msgs, m_n_targets, n_msg1, n_msg5 + n_msg24, n_newname);
+#endif
+
+    return ret;
+}
+
+//----------------------------------------------------------------------------------
+//      Target bookkeeping shared by the sentence decoders
+//----------------------------------------------------------------------------------
+bool AIS_Decoder::IsMMSIIgnored( int mmsi )
+{
+    // Check to see if this MMSI has been configured to be ignored completely...
+    for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
+        MMSIProperties *props =  g_MMSI_Props_Array[i];
+        if(mmsi == props->MMSI)
+            return props->m_bignore;
+    }
+    return false;
+}
+
+AIS_Target_Data *AIS_Decoder::FindOrCreateTarget( int mmsi, bool &bnewtarget, int &last_report_ticks )
+{
+    AIS_Target_Data *pTargetData;
+
+    AIS_Target_Hash::iterator it = AISTargetList->find( mmsi );
+    if( it == AISTargetList->end() ) {                 // not found
+        pTargetData = new AIS_Target_Data;
+        bnewtarget = true;
+        m_n_targets++;
+
+        wxDateTime now = wxDateTime::Now();
+        now.MakeGMT();
+        last_report_ticks = now.GetTicks();
+    } else {
+        pTargetData = it->second;          // find current entry
+        bnewtarget = false;
+
+        //  Grab the stale targets's last report time
+        last_report_ticks = pTargetData->PositionReportTicks;
+
+        // Delete the stale AIS Target selectable point
+        long mmsi_long = mmsi;
+        pSelectAIS->DeleteSelectablePoint( (void *) mmsi_long, SELTYPE_AISTARGET );
+    }
+
+    return pTargetData;
+}
+
+//----------------------------------------------------------------------------------
+//      Merge a decoded VDM/VDO report into its target
+//----------------------------------------------------------------------------------
+AIS_Error AIS_Decoder::MergeVDXReport( const AIS_VDXReport &report, time_t now_ticks )
+{
+    if( IsMMSIIgnored( report.mmsi ) )
+        return AIS_NoError;
+
+    bool bnewtarget;
+    int last_report_ticks;
+    AIS_Target_Data *pTargetData = FindOrCreateTarget( report.mmsi, bnewtarget, last_report_ticks );
+
+    // The normal Plain-Old AIS target code path....
+    bool bdecode_result = ApplyVDXReport( report, pTargetData, now_ticks );
+
+    //     Update the most recent report period
+    pTargetData->RecentPeriod = pTargetData->PositionReportTicks - last_report_ticks;
+
+    CommitTargetData( pTargetData, report.mmsi, report.b_vdo, bdecode_result, bnewtarget );
+
+    return AIS_NoError;
+}
+
+//----------------------------------------------------------------------------------
+//      Record a freshly decoded report in the target list, or discard it
+//----------------------------------------------------------------------------------
+void AIS_Decoder::CommitTargetData( AIS_Target_Data *pTargetData, int mmsi, bool b_vdo,
+                                    bool bdecode_result, bool bnewtarget )
+{
         if(pTargetData){
             //  pTargetData is valid, either new or existing. Continue processing
 
             m_pLatestTargetData = pTargetData;
 
-            if( str.Mid( 3, 3 ).IsSameAs( _T("VDO") ) )
+            if( b_vdo )
                 pTargetData->b_OwnShip = true;
 
             // Check to see if this MMSI wants VDM translated to VDO or whether we want to persist it's track...
@@ -1024,6 +1179,7 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
                 }
                 
                 ( *AISTargetList )[pTargetData->MMSI] = pTargetData;            // update the hash table entry
+                ScheduleAgingOnReport( pTargetData );
 
                 if( !pTargetData->area_notices.empty() ) {
                     AIS_Target_Hash::iterator it = AIS_AreaNotice_Sources->find( pTargetData->MMSI );
@@ -1069,14 +1225,6 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
                 }
             }
         }
-
-    n_msgs++;
-#ifdef AIS_DEBUG
-    if((n_msgs % 10000) == 0)
-    printf("n_msgs %10d m_n_targets: %6d  n_msg1: %10d  n_msg5+24: %10d  n_new5: %10d \n", n_msgs, m_n_targets, n_msg1, n_msg5 + n_msg24, n_newname);
-#endif
-
-    return ret;
 }
 
 AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
@@ -1257,6 +1405,7 @@ AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
             m_pLatestTargetData = pTargetData;
             
             ( *AISTargetList )[pTargetData->MMSI] = pTargetData;            // update the hash table entry
+            ScheduleAgingOnReport( pTargetData );
                 
             long mmsi_long = pTargetData->MMSI;
 
@@ -1284,541 +1433,204 @@ AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
 
 
 //----------------------------------------------------------------------------
-//      Parse a NMEA VDM/VDO Bitstring
+//      Merge a VDM/VDO report decoded by AIS_DecodeWorker::ParseReport()
+//      into its target.  Returns true if the message type was understood.
 //----------------------------------------------------------------------------
-bool AIS_Decoder::Parse_VDXBitstring( AIS_Bitstring *bstr, AIS_Target_Data *ptd )
+bool AIS_Decoder::ApplyVDXReport( const AIS_VDXReport &report, AIS_Target_Data *ptd, time_t now_ticks )
 {
-    bool parse_result = false;
-    bool b_posn_report = false;
-
-    wxDateTime now = wxDateTime::Now();
-    now.MakeGMT( );                    
-    int message_ID = bstr->GetInt( 1, 6 );        // Parse on message ID
-    ptd->MID = message_ID;
-    ptd->MMSI = bstr->GetInt( 9, 30 );           // MMSI is always in the same spot in the bitstream
-
-    switch( message_ID ){
-        case 1:                                 // Position Report
-        case 2:
-        case 3: {
-            n_msg1++;
-
-            ptd->NavStatus = bstr->GetInt( 39, 4 );
-            ptd->SOG = 0.1 * ( bstr->GetInt( 51, 10 ) );
-
-            int lon = bstr->GetInt( 62, 28 );
-            if( lon & 0x08000000 )                    // negative?
-            lon |= 0xf0000000;
-            double lon_tentative = lon / 600000.;
-
-            int lat = bstr->GetInt( 90, 27 );
-            if( lat & 0x04000000 )                    // negative?
-            lat |= 0xf8000000;
-            double lat_tentative = lat / 600000.;
-
-            if( ( lon_tentative <= 180. ) && ( lat_tentative <= 90. ) ) // Ship does not report Lat or Lon "unavailable"
-                    {
-                ptd->Lon = lon_tentative;
-                ptd->Lat = lat_tentative;
-                ptd->b_positionDoubtful = false;
-                ptd->b_positionOnceValid = true;          // Got the position at least once
-                ptd->PositionReportTicks = now.GetTicks();
-            } else
-                ptd->b_positionDoubtful = true;
-
-            //    decode balance of message....
-            ptd->COG = 0.1 * ( bstr->GetInt( 117, 12 ) );
-            ptd->HDG = 1.0 * ( bstr->GetInt( 129, 9 ) );
-
-            ptd->ROTAIS = bstr->GetInt( 43, 8 );
-            double rot_dir = 1.0;
-
-            if( ptd->ROTAIS == 128 ) ptd->ROTAIS = -128;              // not available codes as -128
-            else if( ( ptd->ROTAIS & 0x80 ) == 0x80 ) {
-                ptd->ROTAIS = ptd->ROTAIS - 256;       // convert to twos complement
-                rot_dir = -1.0;
-            }
-
-            ptd->ROTIND = wxRound( rot_dir * pow( ( ( (double) ptd->ROTAIS ) / 4.733 ), 2 ) ); // Convert to indicated ROT
-
-            ptd->m_utc_sec = bstr->GetInt( 138, 6 );
-
-            if( ( 1 == message_ID ) || ( 2 == message_ID ) )      // decode SOTDMA per 7.6.7.2.2
-                    {
-                ptd->SyncState = bstr->GetInt( 151, 2 );
-                ptd->SlotTO = bstr->GetInt( 153, 2 );
-                if( ( ptd->SlotTO == 1 ) && ( ptd->SyncState == 0 ) ) // UTCDirect follows
-                        {
-                    ptd->m_utc_hour = bstr->GetInt( 155, 5 );
-
-                    ptd->m_utc_min = bstr->GetInt( 160, 7 );
-
-                    if( ( ptd->m_utc_hour < 24 ) && ( ptd->m_utc_min < 60 )
-                            && ( ptd->m_utc_sec < 60 ) ) {
-                        wxDateTime rx_time( ptd->m_utc_hour, ptd->m_utc_min, ptd->m_utc_sec );
-                        rx_ticks = rx_time.GetTicks();
-                        if( !b_firstrx ) {
-                            first_rx_ticks = rx_ticks;
-                            b_firstrx = true;
-                        }
-                    }
-                }
-            }
-
-            //    Capture Euro Inland special passing arrangement signal ("stbd-stbd")
-            ptd->blue_paddle = bstr->GetInt( 144, 2 );
-            ptd->b_blue_paddle = ( ptd->blue_paddle == 2 );             // paddle is set
-
-            ptd->Class = AIS_CLASS_A;
-
-            //    Check for SART and friends by looking at first two digits of MMSI
-            int mmsi_start = ptd->MMSI / 10000000;
+    const unsigned int fields = report.fields;
+
+    ptd->MID = report.msg_id;
+    ptd->MMSI = report.mmsi;
+
+    if( report.msg_id >= 1 && report.msg_id <= 3 )
+        n_msg1++;
+    else if( report.msg_id == 5 )
+        n_msg5++;
+    else if( report.msg_id == 24 && ( fields & AIS_VDX_NAME ) )
+        n_msg24++;
+
+    if( fields & AIS_VDX_POSITION ) {
+        if( report.b_position_valid ) {
+            ptd->Lon = report.lon;
+            ptd->Lat = report.lat;
+            ptd->b_positionDoubtful = false;
+            ptd->b_positionOnceValid = true;          // Got the position at least once
+            ptd->PositionReportTicks = now_ticks;
+        } else
+            ptd->b_positionDoubtful = true;
+    }
 
-            if( mmsi_start == 97 ) {
-                ptd->Class = AIS_SART;
-                ptd->StaticReportTicks = now.GetTicks(); // won't get a static report, so fake it here
+    if( fields & AIS_VDX_NAVSTATUS ) ptd->NavStatus = report.nav_status;
+    if( fields & AIS_VDX_SOG ) ptd->SOG = report.sog;
+    if( fields & AIS_VDX_COG ) ptd->COG = report.cog;
+    if( fields & AIS_VDX_HDG ) ptd->HDG = report.hdg;
+    if( fields & AIS_VDX_ROTAIS ) ptd->ROTAIS = report.rot_ais;
+    if( fields & AIS_VDX_ROTIND ) ptd->ROTIND = report.rot_ind;
+    if( fields & AIS_VDX_UTC_SEC ) ptd->m_utc_sec = report.utc_sec;
+    if( fields & AIS_VDX_UTC_HM ) {
+        ptd->m_utc_hour = report.utc_hour;
+        ptd->m_utc_min = report.utc_min;
+    }
+    if( fields & AIS_VDX_SOTDMA ) {
+        ptd->SyncState = report.sync_state;
+        ptd->SlotTO = report.slot_to;
+    }
 
-                //    On receipt of Msg 3, force any existing SART target out of acknowledge mode
-                //    by adjusting its ack_time to yesterday
-                //    This will cause any previously "Acknowledged" SART to re-alert.
-                
-                //    On reflection, re-alerting seems a little excessive in real life use.
-                //    After all, the target is on-screen, and in the AIS target list.
-                //    So lets just honor the programmed ACK timout value for SART targets as well
-                //ptd->m_ack_time = wxDateTime::Now() - wxTimeSpan::Day();
+    //  UTCDirect time of a SOTDMA position report
+    if( ( fields & AIS_VDX_UTC_HM ) && ( ( 1 == report.msg_id ) || ( 2 == report.msg_id ) ) ) {
+        if( ( ptd->m_utc_hour < 24 ) && ( ptd->m_utc_min < 60 ) && ( ptd->m_utc_sec < 60 ) ) {
+            wxDateTime rx_time( ptd->m_utc_hour, ptd->m_utc_min, ptd->m_utc_sec );
+            rx_ticks = rx_time.GetTicks();
+            if( !b_firstrx ) {
+                first_rx_ticks = rx_ticks;
+                b_firstrx = true;
             }
-
-            parse_result = true;                // so far so good
-            b_posn_report = true;
-
-            break;
-        }
-
-        case 18: {
-            ptd->NavStatus = UNDEFINED;         // Class B targets have no status.  Enforce this...
-
-            ptd->SOG = 0.1 * ( bstr->GetInt( 47, 10 ) );
-
-            int lon = bstr->GetInt( 58, 28 );
-            if( lon & 0x08000000 )                    // negative?
-            lon |= 0xf0000000;
-            double lon_tentative = lon / 600000.;
-
-            int lat = bstr->GetInt( 86, 27 );
-            if( lat & 0x04000000 )                    // negative?
-            lat |= 0xf8000000;
-            double lat_tentative = lat / 600000.;
-
-            if( ( lon_tentative <= 180. ) && ( lat_tentative <= 90. ) ) // Ship does not report Lat or Lon "unavailable"
-                    {
-                ptd->Lon = lon_tentative;
-                ptd->Lat = lat_tentative;
-                ptd->b_positionDoubtful = false;
-                ptd->b_positionOnceValid = true;          // Got the position at least once
-                ptd->PositionReportTicks = now.GetTicks();
-            } else
-                ptd->b_positionDoubtful = true;
-
-            ptd->COG = 0.1 * ( bstr->GetInt( 113, 12 ) );
-            ptd->HDG = 1.0 * ( bstr->GetInt( 125, 9 ) );
-
-            ptd->m_utc_sec = bstr->GetInt( 134, 6 );
-
-            ptd->Class = AIS_CLASS_B;
-
-            parse_result = true;                // so far so good
-            b_posn_report = true;
-
-            break;
         }
+    }
 
-        case 19: {                              // Class B mes_ID 19 Is same as mes_ID 18 until bit 139
-            ptd->NavStatus = UNDEFINED;         // Class B targets have no status.  Enforce this...
-            ptd->SOG = 0.1 * (bstr->GetInt(47, 10));
-            int lon = bstr->GetInt(58, 28);
-            if (lon & 0x08000000)                    // negative?
-                lon |= 0xf0000000;
-            double lon_tentative = lon / 600000.;
-
-            int lat = bstr->GetInt(86, 27);
-            if (lat & 0x04000000)                    // negative?
-                lat |= 0xf8000000;
-            double lat_tentative = lat / 600000.;
-
-            if ((lon_tentative <= 180.) && (lat_tentative <= 90.)) // Ship does not report Lat or Lon "unavailable"
-            {
-                ptd->Lon = lon_tentative;
-                ptd->Lat = lat_tentative;
-                ptd->b_positionDoubtful = false;
-                ptd->b_positionOnceValid = true;          // Got the position at least once
-                ptd->PositionReportTicks = now.GetTicks();
-            } else
-                ptd->b_positionDoubtful = true;
-
-            ptd->COG = 0.1 * (bstr->GetInt(113, 12));
-            ptd->HDG = 1.0 * (bstr->GetInt(125, 9));
-            ptd->m_utc_sec = bstr->GetInt(134, 6);
-            //From bit 140 and forward data as of mes 5
-            bstr->GetStr(144, 120, &ptd->ShipName[0], 20);
-            ptd->b_nameValid = true;
-            ptd->ShipType = (unsigned char)bstr->GetInt(264, 8);
-            ptd->DimA = bstr->GetInt(272, 9);
-            ptd->DimB = bstr->GetInt(281, 9);
-            ptd->DimC = bstr->GetInt(290, 6);
-            ptd->DimD = bstr->GetInt(296, 6);
-
-            ptd->Class = AIS_CLASS_B;
-            parse_result = true;         // so far so good
-            b_posn_report = true;
-
-            break;
-        }
-
-        case 5: {
-            n_msg5++;
-            ptd->Class = AIS_CLASS_A;
-
-//          Get the AIS Version indicator
-//          0 = station compliant with Recommendation ITU-R M.1371-1
-//          1 = station compliant with Recommendation ITU-R M.1371-3
-//          2-3 = station compliant with future editions
-            int AIS_version_indicator = bstr->GetInt( 39, 2 );
-            if( AIS_version_indicator < 4 ) {
-                ptd->IMO = bstr->GetInt( 41, 30 );
-
-                bstr->GetStr( 71, 42, &ptd->CallSign[0], 7 );
-                bstr->GetStr( 113, 120, &ptd->ShipName[0], 20 );
-                ptd->b_nameValid = true;
-
-                ptd->ShipType = (unsigned char) bstr->GetInt( 233, 8 );
-
-                ptd->DimA = bstr->GetInt( 241, 9 );
-                ptd->DimB = bstr->GetInt( 250, 9 );
-                ptd->DimC = bstr->GetInt( 259, 6 );
-                ptd->DimD = bstr->GetInt( 265, 6 );
-
-                ptd->ETA_Mo = bstr->GetInt( 275, 4 );
-                ptd->ETA_Day = bstr->GetInt( 279, 5 );
-                ptd->ETA_Hr = bstr->GetInt( 284, 5 );
-                ptd->ETA_Min = bstr->GetInt( 289, 6 );
-
-                ptd->Draft = (double) ( bstr->GetInt( 295, 8 ) ) / 10.0;
-
-                bstr->GetStr( 303, 120, &ptd->Destination[0], 20 );
-
-                ptd->StaticReportTicks = now.GetTicks();
-
-                parse_result = true;
-            }
-
-            break;
-        }
+    if( fields & AIS_VDX_BLUE_PADDLE ) {
+        ptd->blue_paddle = report.blue_paddle;
+        ptd->b_blue_paddle = ( ptd->blue_paddle == 2 );             // paddle is set
+    }
+    if( fields & AIS_VDX_CLASS ) ptd->Class = report.ais_class;
+    if( fields & AIS_VDX_STATIC ) ptd->StaticReportTicks = now_ticks;
 
-        case 24: {
-            int part_number = bstr->GetInt( 39, 2 );
-            if( 0 == part_number ) {
-                bstr->GetStr( 41, 120, &ptd->ShipName[0], 20 );
-                ptd->b_nameValid = true;
-                parse_result = true;
-                n_msg24++;
-            } else if( 1 == part_number ) {
-                ptd->ShipType = (unsigned char) bstr->GetInt( 41, 8 );
-                bstr->GetStr( 91, 42, &ptd->CallSign[0], 7 );
-
-                ptd->DimA = bstr->GetInt( 133, 9 );
-                ptd->DimB = bstr->GetInt( 142, 9 );
-                ptd->DimC = bstr->GetInt( 151, 6 );
-                ptd->DimD = bstr->GetInt( 157, 6 );
-                parse_result = true;
-            }
-            break;
-        }
-        case 4:                                    // base station
-        {
-            ptd->Class = AIS_BASE;
-
-            ptd->m_utc_hour = bstr->GetInt( 62, 5 );
-            ptd->m_utc_min = bstr->GetInt( 67, 6 );
-            ptd->m_utc_sec = bstr->GetInt( 73, 6 );
-            //                              (79,  1);
-            int lon = bstr->GetInt( 80, 28 );
-            if( lon & 0x08000000 )                    // negative?
-            lon |= 0xf0000000;
-            double lon_tentative = lon / 600000.;
-
-            int lat = bstr->GetInt( 108, 27 );
-            if( lat & 0x04000000 )                    // negative?
-            lat |= 0xf8000000;
-            double lat_tentative = lat / 600000.;
-
-            if( ( lon_tentative <= 180. ) && ( lat_tentative <= 90. ) ) // Ship does not report Lat or Lon "unavailable"
-                    {
-                ptd->Lon = lon_tentative;
-                ptd->Lat = lat_tentative;
-                ptd->b_positionDoubtful = false;
-                ptd->b_positionOnceValid = true;          // Got the position at least once
-                ptd->PositionReportTicks = now.GetTicks();
-            } else
-                ptd->b_positionDoubtful = true;
-
-            ptd->COG = -1.;
-            ptd->HDG = 511;
-            ptd->SOG = -1.;
-
-            parse_result = true;
-            b_posn_report = true;
+    if( fields & AIS_VDX_NAME ) {
+        strcpy( ptd->ShipName, report.ship_name );
+        ptd->b_nameValid = true;
+    }
+    if( fields & AIS_VDX_NAME_EXT ) strcpy( ptd->ShipNameExtension, report.ship_name_ext );
+    if( fields & AIS_VDX_CALLSIGN ) strcpy( ptd->CallSign, report.call_sign );
+    if( fields & AIS_VDX_IMO ) ptd->IMO = report.imo;
+    if( fields & AIS_VDX_SHIPTYPE ) ptd->ShipType = report.ship_type;
+    if( fields & AIS_VDX_DIMENSIONS ) {
+        ptd->DimA = report.dim_a;
+        ptd->DimB = report.dim_b;
+        ptd->DimC = report.dim_c;
+        ptd->DimD = report.dim_d;
+    }
+    if( fields & AIS_VDX_ETA ) {
+        ptd->ETA_Mo = report.eta_mo;
+        ptd->ETA_Day = report.eta_day;
+        ptd->ETA_Hr = report.eta_hr;
+        ptd->ETA_Min = report.eta_min;
+    }
+    if( fields & AIS_VDX_DRAFT ) ptd->Draft = report.draft;
+    if( fields & AIS_VDX_DESTINATION ) strcpy( ptd->Destination, report.destination );
 
-            break;
-        }
-        case 9:                   // Special Position Report (Standard SAR Aircraft Position Report)
-        {
-            ptd->SOG =  bstr->GetInt( 51, 10 ) ;
-            
-            int lon = bstr->GetInt( 62, 28 );
-            if( lon & 0x08000000 )                    // negative?
-            lon |= 0xf0000000;
-            double lon_tentative = lon / 600000.;
-            
-            int lat = bstr->GetInt( 90, 27 );
-            if( lat & 0x04000000 )                    // negative?
-            lat |= 0xf8000000;
-            double lat_tentative = lat / 600000.;
-            
-            if( ( lon_tentative <= 180. ) && ( lat_tentative <= 90. ) ) // Ship does not report Lat or Lon "unavailable"
-                    {
-                        ptd->Lon = lon_tentative;
-                        ptd->Lat = lat_tentative;
-                        ptd->b_positionDoubtful = false;
-                        ptd->b_positionOnceValid = true;          // Got the position at least once
-                        ptd->PositionReportTicks = now.GetTicks();
-                    } else
-                        ptd->b_positionDoubtful = true;
-                    
-            //    decode balance of message....
-            ptd->COG = 0.1 * ( bstr->GetInt( 117, 12 ) );
+    if( fields & AIS_VDX_ALTITUDE ) {
+        ptd->altitude = report.altitude;
+        ptd->b_SarAircraftPosnReport = true;
+    }
 
-            int alt_tent = bstr->GetInt( 39, 12 );
-            ptd->altitude = alt_tent;
-            
-            ptd->b_SarAircraftPosnReport = true;
-            
-            parse_result = true;
-            b_posn_report = true;
-            
-            break;
-        }
-        case 21:                                    // Test Message (Aid to Navigation)
-        {
-            ptd->ShipType = (unsigned char) bstr->GetInt( 39, 5 );
-            ptd->IMO = 0;
-            ptd->SOG = 0;
-            ptd->HDG = 0;
-            ptd->COG = 0;
-            ptd->ROTAIS = -128;                 // i.e. not available
-            ptd->DimA = bstr->GetInt( 220, 9 );
-            ptd->DimB = bstr->GetInt( 229, 9 );
-            ptd->DimC = bstr->GetInt( 238, 6 );
-            ptd->DimD = bstr->GetInt( 244, 6 );
-            ptd->Draft = 0;
-
-            ptd->m_utc_sec = bstr->GetInt( 254, 6 );
-
-            int offpos = bstr->GetInt( 260, 1 ); // off position flag
-            int virt = bstr->GetInt( 270, 1 ); // virtual flag
-
-            if( virt ) ptd->NavStatus = ATON_VIRTUAL;
-            else
-                ptd->NavStatus = ATON_REAL;
-            if( ptd->m_utc_sec <= 59 /*&& !virt*/) {
-                ptd->NavStatus += 1;
-                if( offpos ) ptd->NavStatus += 1;
-            }
+    if( fields & AIS_VDX_EURO_INLAND ) {
+        ptd->b_isEuroInland = true;
+        strcpy( ptd->Euro_VIN, report.euro_vin );
+        ptd->Euro_Length = report.euro_length;
+        ptd->Euro_Beam = report.euro_beam;
+        ptd->UN_shiptype = report.un_shiptype;
+        ptd->Euro_Draft = report.euro_draft;
+    }
 
-            bstr->GetStr( 44, 120, &ptd->ShipName[0], 20 ); // short name only, extension wont fit in Ship structure
+    if( fields & AIS_VDX_TEXT ) ptd->MSG_14_text = wxString( report.text.c_str(), wxConvUTF8 );
 
-            if( bstr->GetBitCount() > 276 ) {
-                int nx = ( ( bstr->GetBitCount() - 272 ) / 6 ) * 6;
-                bstr->GetStr( 273, nx, &ptd->ShipNameExtension[0], 14 );
-                ptd->ShipNameExtension[14] = 0;
-            } else {
-                ptd->ShipNameExtension[0] = 0;
-            }
+    if( fields & AIS_VDX_AREA_NOTICE ) {
+        AIS_Bitstring strbit( report.payload.c_str() );
+        ParseAreaNotice( &strbit, ptd );
+    }
 
-            ptd->b_nameValid = true;
+    if( report.b_posn_report ) ptd->b_lost = false;
 
-            parse_result = true;                // so far so good
+    if( report.b_parsed ) {
+        //      Revalidate the target under some conditions
+        if( !ptd->b_active && !ptd->b_positionDoubtful && report.b_posn_report ) ptd->b_active = true;
+    }
 
-            ptd->Class = AIS_ATON;
+    return report.b_parsed;
+}
 
-            int lon = bstr->GetInt( 165, 28 );
+//----------------------------------------------------------------------------
+//      Decode an IMO area notice, message 8 DAC 1 FI 22, of at least 111 bits
+//----------------------------------------------------------------------------
+void AIS_Decoder::ParseAreaNotice( AIS_Bitstring *bstr, AIS_Target_Data *ptd )
+{
+    Ais8_001_22 an;
+    an.link_id = bstr->GetInt( 57, 10 );
+    an.notice_type = bstr->GetInt( 67, 7 );
+    an.month = bstr->GetInt( 74, 4 );
+    an.day = bstr->GetInt( 78, 5 );
+    an.hour = bstr->GetInt( 83, 5 );
+    an.minute = bstr->GetInt( 88, 6 );
+    an.duration_minutes = bstr->GetInt( 94, 18 );
 
-            if( lon & 0x08000000 )                    // negative?
-            lon |= 0xf0000000;
-            double lon_tentative = lon / 600000.;
+    wxDateTime now = wxDateTime::Now();
+    now.MakeGMT();
 
-            int lat = bstr->GetInt( 193, 27 );
+    an.start_time.Set( an.day, wxDateTime::Month( an.month - 1 ), now.GetYear(),
+            an.hour, an.minute );
 
-            if( lat & 0x04000000 )                    // negative?
-            lat |= 0xf8000000;
-            double lat_tentative = lat / 600000.;
+    // msg is not supposed to be transmitted more than a day before it comes into effect,
+    // so a start_time less than a day or two away might indicate a month rollover
+    if( an.start_time > now + wxTimeSpan::Hours( 48 ) ) an.start_time.Set(
+            an.day, wxDateTime::Month( an.month - 1 ), now.GetYear() - 1,
+            an.hour, an.minute );
 
-            if( ( lon_tentative <= 180. ) && ( lat_tentative <= 90. ) ) // Ship does not report Lat or Lon "unavailable"
-                    {
-                ptd->Lon = lon_tentative;
-                ptd->Lat = lat_tentative;
-                ptd->b_positionDoubtful = false;
-                ptd->b_positionOnceValid = true;          // Got the position at least once
-                ptd->PositionReportTicks = now.GetTicks();
-            } else
-                ptd->b_positionDoubtful = true;
+    an.expiry_time = an.start_time + wxTimeSpan::Minutes( an.duration_minutes );
 
-            b_posn_report = true;
-            break;
-        }
-        case 8:                                    // Binary Broadcast
-        {
-            int dac = bstr->GetInt( 41, 10 );
-            int fi = bstr->GetInt( 51, 6 );
-            if( dac == 200 )                  // European inland
-                    {
-                if( fi == 10 )              // "Inland ship static and voyage related data"
-                        {
-                    ptd->b_isEuroInland = true;
-
-                    bstr->GetStr( 57, 48, &ptd->Euro_VIN[0], 8 );
-                    ptd->Euro_Length = ( (double) bstr->GetInt( 105, 13 ) ) / 10.0;
-                    ptd->Euro_Beam = ( (double) bstr->GetInt( 118, 10 ) ) / 10.0;
-                    ptd->UN_shiptype = bstr->GetInt( 128, 14 );
-                    ptd->Euro_Draft = ( (double) bstr->GetInt( 145, 11 ) ) / 100.0;
-                    parse_result = true;
-                }
-            }
-            if( dac == 1 )                     // IMO
-                    {
-                if( fi == 22 )                 // Area Notice
-                        {
-                    if( bstr->GetBitCount() >= 111 ) {
-                        Ais8_001_22 an;
-                        an.link_id = bstr->GetInt( 57, 10 );
-                        an.notice_type = bstr->GetInt( 67, 7 );
-                        an.month = bstr->GetInt( 74, 4 );
-                        an.day = bstr->GetInt( 78, 5 );
-                        an.hour = bstr->GetInt( 83, 5 );
-                        an.minute = bstr->GetInt( 88, 6 );
-                        an.duration_minutes = bstr->GetInt( 94, 18 );
-
-                        wxDateTime now = wxDateTime::Now();
-                        now.MakeGMT();
-
-                        an.start_time.Set( an.day, wxDateTime::Month( an.month - 1 ), now.GetYear(),
-                                an.hour, an.minute );
-
-                        // msg is not supposed to be transmitted more than a day before it comes into effect,
-                        // so a start_time less than a day or two away might indicate a month rollover
-                        if( an.start_time > now + wxTimeSpan::Hours( 48 ) ) an.start_time.Set(
-                                an.day, wxDateTime::Month( an.month - 1 ), now.GetYear() - 1,
-                                an.hour, an.minute );
-
-                        an.expiry_time = an.start_time + wxTimeSpan::Minutes( an.duration_minutes );
-
-                        // msg is not supposed to be transmitted beyond expiration, so taking into account a
-                        // fudge factor for clock issues, assume an expiry date in the past indicates incorrect year
-                        if( an.expiry_time < now - wxTimeSpan::Hours( 24 ) ) {
-                            an.start_time.Set( an.day, wxDateTime::Month( an.month - 1 ),
-                                    now.GetYear() + 1, an.hour, an.minute );
-                            an.expiry_time = an.start_time
-                                    + wxTimeSpan::Minutes( an.duration_minutes );
-                        }
+    // msg is not supposed to be transmitted beyond expiration, so taking into account a
+    // fudge factor for clock issues, assume an expiry date in the past indicates incorrect year
+    if( an.expiry_time < now - wxTimeSpan::Hours( 24 ) ) {
+        an.start_time.Set( an.day, wxDateTime::Month( an.month - 1 ),
+                now.GetYear() + 1, an.hour, an.minute );
+        an.expiry_time = an.start_time
+                + wxTimeSpan::Minutes( an.duration_minutes );
+    }
 
-                        int subarea_count = ( bstr->GetBitCount() - 111 ) / 87;
-                        for( int i = 0; i < subarea_count; ++i ) {
-                            int base = 111 + i * 87;
-                            Ais8_001_22_SubArea sa;
-                            sa.shape = bstr->GetInt( base + 1, 3 );
-                            int scale_factor = 1;
-                            if( sa.shape == AIS8_001_22_SHAPE_TEXT ) {
-                                char t[15];
-                                t[14] = 0;
-                                bstr->GetStr( base + 4, 84, t, 14 );
-                                sa.text = wxString( t, wxConvUTF8 );
-                            } else {
-                                int scale_multipliers[4] = { 1, 10, 100, 1000 };
-                                scale_factor = scale_multipliers[bstr->GetInt( base + 4, 2 )];
-                                switch( sa.shape ){
-                                    case AIS8_001_22_SHAPE_CIRCLE:
-                                    case AIS8_001_22_SHAPE_SECTOR:
-                                        sa.radius_m = bstr->GetInt( base + 58, 12 ) * scale_factor;
-                                    case AIS8_001_22_SHAPE_RECT:
-                                        sa.longitude = bstr->GetInt( base + 6, 25, true ) / 60000.0;
-                                        sa.latitude = bstr->GetInt( base + 31, 24, true ) / 60000.0;
-                                        break;
-                                    case AIS8_001_22_SHAPE_POLYLINE:
-                                    case AIS8_001_22_SHAPE_POLYGON:
-                                        for( int i = 0; i < 4; ++i ) {
-                                            sa.angles[i] = bstr->GetInt( base + 6 + i * 20, 10 )
-                                                    * 0.5;
-                                            sa.dists_m[i] = bstr->GetInt( base + 16 + i * 20, 10 )
-                                                    * scale_factor;
-                                        }
-                                }
-                                if( sa.shape == AIS8_001_22_SHAPE_RECT ) {
-                                    sa.e_dim_m = bstr->GetInt( base + 58, 8 ) * scale_factor;
-                                    sa.n_dim_m = bstr->GetInt( base + 66, 8 ) * scale_factor;
-                                    sa.orient_deg = bstr->GetInt( base + 74, 9 );
-                                }
-                                if( sa.shape == AIS8_001_22_SHAPE_SECTOR ) {
-                                    sa.left_bound_deg = bstr->GetInt( 70, 9 );
-                                    sa.right_bound_deg = bstr->GetInt( 79, 9 );
-                                }
-                            }
-                            an.sub_areas.push_back( sa );
-                        }
-                        ptd->area_notices[an.link_id] = an;
-                        parse_result = true;
+    int subarea_count = ( bstr->GetBitCount() - 111 ) / 87;
+    for( int i = 0; i < subarea_count; ++i ) {
+        int base = 111 + i * 87;
+        Ais8_001_22_SubArea sa;
+        sa.shape = bstr->GetInt( base + 1, 3 );
+        int scale_factor = 1;
+        if( sa.shape == AIS8_001_22_SHAPE_TEXT ) {
+            char t[15];
+            t[14] = 0;
+            bstr->GetStr( base + 4, 84, t, 14 );
+            sa.text = wxString( t, wxConvUTF8 );
+        } else {
+            int scale_multipliers[4] = { 1, 10, 100, 1000 };
+            scale_factor = scale_multipliers[bstr->GetInt( base + 4, 2 )];
+            switch( sa.shape ){
+                case AIS8_001_22_SHAPE_CIRCLE:
+                case AIS8_001_22_SHAPE_SECTOR:
+                    sa.radius_m = bstr->GetInt( base + 58, 12 ) * scale_factor;
+                case AIS8_001_22_SHAPE_RECT:
+                    sa.longitude = bstr->GetInt( base + 6, 25, true ) / 60000.0;
+                    sa.latitude = bstr->GetInt( base + 31, 24, true ) / 60000.0;
+                    break;
+                case AIS8_001_22_SHAPE_POLYLINE:
+                case AIS8_001_22_SHAPE_POLYGON:
+                    for( int i = 0; i < 4; ++i ) {
+                        sa.angles[i] = bstr->GetInt( base + 6 + i * 20, 10 )
+                                * 0.5;
+                        sa.dists_m[i] = bstr->GetInt( base + 16 + i * 20, 10 )
+                                * scale_factor;
                     }
-                }
             }
-            break;
-        }
-        case 14:                                    // Safety Related Broadcast
-        {
-            //  Always capture the MSG_14 text
-            char msg_14_text[968];
-            if( bstr->GetBitCount() > 40 ) {
-                int nx = ( ( bstr->GetBitCount() - 40 ) / 6 ) * 6;
-                int nd = bstr->GetStr( 41, nx, msg_14_text, 968 );
-                nd = wxMax(0, nd);
-                nd = wxMin(nd, 967);
-                msg_14_text[nd] = 0;
-                ptd->MSG_14_text = wxString( msg_14_text, wxConvUTF8 );
+            if( sa.shape == AIS8_001_22_SHAPE_RECT ) {
+                sa.e_dim_m = bstr->GetInt( base + 58, 8 ) * scale_factor;
+                sa.n_dim_m = bstr->GetInt( base + 66, 8 ) * scale_factor;
+                sa.orient_deg = bstr->GetInt( base + 74, 9 );
+            }
+            if( sa.shape == AIS8_001_22_SHAPE_SECTOR ) {
+                sa.left_bound_deg = bstr->GetInt( 70, 9 );
+                sa.right_bound_deg = bstr->GetInt( 79, 9 );
             }
-            parse_result = true;                // so far so good
-
-            break;
-        }
-
-        case 6:                                    // Addressed Binary Message
-        {
-            break;
-        }
-        case 7:                                    // Binary Ack
-        {
-            break;
-        }
-        default: {
-            break;
         }
-
-    }
-
-    if( b_posn_report ) ptd->b_lost = false;
-
-    if( true == parse_result ) {
-        //      Revalidate the target under some conditions
-        if( !ptd->b_active && !ptd->b_positionDoubtful && b_posn_report ) ptd->b_active = true;
+        an.sub_areas.push_back( sa );
     }
-
-    return parse_result;
+    ptd->area_notices[an.link_id] = an;
 }
 
 bool AIS_Decoder::NMEACheckSumOK( const wxString& str_in )
@@ -1863,17 +1675,69 @@ bool AIS_Decoder::NMEACheckSumOK( const wxString& str_in )
     return false;
 }
 
+//  Own-ship SOG/COG may be NaN, which must compare equal to itself here
+static bool SameCPAInput( double a, double b )
+{
+    return ( a == b ) || ( std::isnan( a ) && std::isnan( b ) );
+}
+
 void AIS_Decoder::UpdateAllCPA( void )
 {
-    //    Iterate thru all the targets
+    //    A new own-ship vector invalidates every target's CPA
+    if( !SameCPAInput( gLat, m_cpa_own_lat ) || !SameCPAInput( gLon, m_cpa_own_lon )
+        || !SameCPAInput( gCog, m_cpa_own_cog ) || !SameCPAInput( gSog, m_cpa_own_sog )
+        || ( bGPSValid != m_cpa_own_gps_valid ) ) {
+        m_cpa_own_lat = gLat;
+        m_cpa_own_lon = gLon;
+        m_cpa_own_cog = gCog;
+        m_cpa_own_sog = gSog;
+        m_cpa_own_gps_valid = bGPSValid;
+        m_cpa_own_gen++;
+    }
+    m_cpa_cycle++;
+
+    int n_unchanged = 0;
+    int n_deferred = 0;
+
+    //    Collect the targets that need a new calculation
+    m_cpa_batch.clear();
     AIS_Target_Hash::iterator it;
     AIS_Target_Hash *current_targets = GetTargetList();
 
     for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
         AIS_Target_Data *td = it->second;
+        if( NULL == td )
+            continue;
+
+        bool b_target_same = SameCPAInput( td->Lat, td->cpa_lat ) && SameCPAInput( td->Lon, td->cpa_lon )
+                && SameCPAInput( td->COG, td->cpa_cog ) && SameCPAInput( td->SOG, td->cpa_sog )
+                && ( td->b_positionOnceValid == td->cpa_positionOnceValid )
+                && ( td->b_OwnShip == td->cpa_OwnShip ) && ( td->cpa_own_gen != 0 );
+
+        if( b_target_same ) {
+            if( td->cpa_own_gen == m_cpa_own_gen ) {
+                n_unchanged++;
+                continue;
+            }
+            //    Only own-ship moved, and this target is far enough away to wait its turn
+            if( (int) ( td->cpa_due_cycle - m_cpa_cycle ) > 0 ) {
+                n_deferred++;
+                continue;
+            }
+        }
 
-        if( NULL != td ) UpdateOneCPA( td );
+        m_cpa_batch.Add( td );
     }
+
+    ComputeCPABatch( m_cpa_batch );
+
+    m_cpa_stats.cycles++;
+    m_cpa_stats.last_recomputed = m_cpa_batch.target.size();
+    m_cpa_stats.last_unchanged = n_unchanged;
+    m_cpa_stats.last_deferred = n_deferred;
+    m_cpa_stats.recomputed += m_cpa_stats.last_recomputed;
+    m_cpa_stats.unchanged += n_unchanged;
+    m_cpa_stats.deferred += n_deferred;
 }
 
 void AIS_Decoder::UpdateAllTracks( void )
@@ -1916,13 +1780,11 @@ void AIS_Decoder::UpdateOneTrack( AIS_Target_Data *ptarget )
         {
             t = m_persistent_tracks[ptarget->MMSI];
         }
-        TrackPoint *tp = t->GetLastPoint();
         vector2D point( ptrackpoint->m_lon, ptrackpoint->m_lat );
-        TrackPoint *tp1 = t->AddNewPoint( point, wxDateTime(ptrackpoint->m_time).ToUTC() );        
-        if( tp )
+        t->AddNewPoint( point, wxDateTime(ptrackpoint->m_time).ToUTC() );        
+        if( t->GetnPoints() > 1 )
         {
-            pSelect->AddSelectableTrackSegment( tp->m_lat, tp->m_lon, tp1->m_lat,
-                tp1->m_lon, tp, tp1, t );
+            pSelect->AddSelectableTrackSegment( t, t->GetnPoints() - 2 );
         }
         
 //We do not want dependency on the GUI here, do we?
@@ -1963,6 +1825,15 @@ void AIS_Decoder::UpdateAllAlarms( void )
 {
     m_bGeneralAlert = false;                // no alerts yet
 
+    //    Follower flags by MMSI, the first entry for an MMSI is the one that counts
+    std::unordered_map<int, bool> followers;
+    if( g_bCPAWarn ) {
+        for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
+            MMSIProperties *props =  g_MMSI_Props_Array[i];
+            followers.insert( std::make_pair( props->MMSI, props->m_bFollower ) );
+        }
+    }
+
     //    Iterate thru all the targets
     AIS_Target_Hash::iterator it;
     AIS_Target_Hash *current_targets = GetTargetList();
@@ -2023,18 +1894,11 @@ void AIS_Decoder::UpdateAllAlarms( void )
                 }
 
                 //    No alert for my Follower
-                bool hit = false;
-                for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
-                    MMSIProperties *props =  g_MMSI_Props_Array[i];
-                    if(td->MMSI == props->MMSI){
-                        if (props->m_bFollower) {
-                            hit = true;
-                            td->n_alert_state = AIS_NO_ALERT;
-                        }
-                        break;
-                    }
+                std::unordered_map<int, bool>::iterator itf = followers.find( td->MMSI );
+                if( itf != followers.end() && itf->second ) {
+                    td->n_alert_state = AIS_NO_ALERT;
+                    continue;
                 }
-                if (hit) continue;
 
                 //    Skip distant targets if requested
                 if( g_bCPAMax ) {
@@ -2078,126 +1942,219 @@ void AIS_Decoder::UpdateAllAlarms( void )
 
 void AIS_Decoder::UpdateOneCPA( AIS_Target_Data *ptarget )
 {
-    ptarget->Range_NM = -1.;            // Defaults
-    ptarget->Brg = -1.;
-
-    //    Compute the current Range/Brg to the target
-    //    This should always be possible even if GPS data is not valid
-    //    because O must always have a position for own-ship. Plugins need
-    //    AIS target range and bearing from own-ship position even if GPS is not valid.
-    double brg, dist;
-    DistanceBearingMercator( ptarget->Lat, ptarget->Lon, gLat, gLon, &brg, &dist );
-    ptarget->Range_NM = dist;
-    ptarget->Brg = brg;
-
-    if( dist <= 1e-5 ) ptarget->Brg = -1.0;             // Brg is undefined if Range == 0.
-
-    if( !ptarget->b_positionOnceValid || !bGPSValid ) {
-        ptarget->bCPA_Valid = false;
-        return;
-    }
+    m_cpa_single.clear();
+    m_cpa_single.Add( ptarget );
+    ComputeCPABatch( m_cpa_single );
+}
 
-    //    There can be no collision between ownship and itself....
-    //    This can happen if AIVDO messages are received, and there is another source of ownship position, like NMEA GLL
-    //    The two positions are always temporally out of sync, and one will always be exactly in front of the other one.
-    if( ptarget->b_OwnShip ) {
-        ptarget->CPA = 100;
-        ptarget->TCPA = -100;
-        ptarget->bCPA_Valid = false;
-        return;
-    }
+enum {
+    CPA_MODE_INVALID = 0,               // no CPA possible, leave CPA/TCPA as they are
+    CPA_MODE_OWNSHIP,                   // a report of our own position
+    CPA_MODE_STOPPED,                   // neither vessel moving
+    CPA_MODE_MOVING
+};
 
-    double cpa_calc_ownship_cog = gCog;
-    double cpa_calc_target_cog = ptarget->COG;
+#define CPA_DEFER_BUCKETS       4       // recalculate every 1, 2, 4 or 8 passes
+#define CPA_DEFER_FACTOR        10.     // defer no longer than this fraction of the time to close
+#define CPA_UNKNOWN_SOG         50.     // knots, assumed for a vessel not reporting speed
+
+void AIS_CPA_Batch::clear( void )
+{
+    target.clear();
+    lat.clear();
+    lon.clear();
+    cog.clear();
+    sog.clear();
+    tcpa.clear();
+    mode.clear();
+}
 
-//    Ownship is not reporting valid SOG, so no way to calculate CPA
-    if( std::isnan(gSog) || ( gSog > 102.2 ) ) {
-        ptarget->bCPA_Valid = false;
+void AIS_CPA_Batch::Add( AIS_Target_Data *ptarget )
+{
+    target.push_back( ptarget );
+    lat.push_back( ptarget->Lat );
+    lon.push_back( ptarget->Lon );
+    cog.push_back( ptarget->COG );
+    sog.push_back( ptarget->SOG );
+}
+
+//----------------------------------------------------------------------------------
+//      Calculate Range/Brg and CPA/TCPA for a batch of targets, and decide how
+//      long each may wait for its next calculation if only own-ship moves.
+//
+//      Targets are bucketed by a conservative time to close: the time before the
+//      target could come within the CPA warning (or CPA max) distance, if both
+//      vessels headed straight for each other at full speed.  A target is then
+//      left alone for up to a tenth of that time, and at most 8 passes.
+//----------------------------------------------------------------------------------
+void AIS_Decoder::ComputeCPABatch( AIS_CPA_Batch &batch )
+{
+    size_t n = batch.target.size();
+    if( !n )
         return;
-    }
 
-//    Ownship is maybe anchored and not reporting COG
-    if( std::isnan(gCog) || gCog == 360.0 ) {
+    batch.mode.resize( n );
+    batch.tcpa.resize( n );
+
+    //    Ownship is not reporting valid SOG, so no way to calculate CPA
+    bool b_own_valid = !std::isnan( gSog ) && ( gSog <= 102.2 );
+
+    //    Ownship is maybe anchored and not reporting COG
+    double cpa_calc_ownship_cog = gCog;
+    if( std::isnan( gCog ) || gCog == 360.0 ) {
         if( gSog < .01 ) cpa_calc_ownship_cog = 0.;          // substitute value
                                                              // for the case where SOG ~= 0, and COG is unknown.
-        else {
-            ptarget->bCPA_Valid = false;
-            return;
-        }
-    }
-
-//    Target is maybe anchored and not reporting COG
-    if( ptarget->COG == 360.0 ) {
-        if( ptarget->SOG > 102.2 ) {
-            ptarget->bCPA_Valid = false;
-            return;
-        } else if( ptarget->SOG < .01 ) cpa_calc_target_cog = 0.;           // substitute value
-                                                                            // for the case where SOG ~= 0, and COG is unknown.
-        else {
-            ptarget->bCPA_Valid = false;
-            return;
-        }
+        else
+            b_own_valid = false;
     }
 
     //    Express the SOGs as meters per hour
     double v0 = gSog * 1852.;
-    double v1 = ptarget->SOG * 1852.;
 
-    if( ( v0 < 1e-6 ) && ( v1 < 1e-6 ) ) {
-        ptarget->TCPA = 0.;
-        ptarget->CPA = 0.;
+    //    First pass, Range/Brg for every target and the kind of CPA it gets
+    for( size_t i = 0; i < n; i++ ) {
+        AIS_Target_Data *ptarget = batch.target[i];
 
-        ptarget->bCPA_Valid = false;
-    } else {
-        //    Calculate the TCPA first
+        //    Compute the current Range/Brg to the target
+        //    This should always be possible even if GPS data is not valid
+        //    because O must always have a position for own-ship. Plugins need
+        //    AIS target range and bearing from own-ship position even if GPS is not valid.
+        double brg, dist;
+        DistanceBearingMercator( batch.lat[i], batch.lon[i], gLat, gLon, &brg, &dist );
+        ptarget->Range_NM = dist;
+        ptarget->Brg = brg;
 
-        //    Working on a Reduced Lat/Lon orthogonal plotting sheet....
-        //    Get easting/northing to target,  in meters
+        if( dist <= 1e-5 ) ptarget->Brg = -1.0;             // Brg is undefined if Range == 0.
 
-        double east1 = ( ptarget->Lon - gLon ) * 60 * 1852;
-        double north1 = ( ptarget->Lat - gLat ) * 60 * 1852;
+        unsigned char mode = CPA_MODE_MOVING;
 
-        double east = east1 * ( cos( gLat * PI / 180. ) );
-        
-        double north = north1;
+        if( !ptarget->b_positionOnceValid || !bGPSValid )
+            mode = CPA_MODE_INVALID;
+
+        //    There can be no collision between ownship and itself....
+        //    This can happen if AIVDO messages are received, and there is another source of ownship position, like NMEA GLL
+        //    The two positions are always temporally out of sync, and one will always be exactly in front of the other one.
+        else if( ptarget->b_OwnShip )
+            mode = CPA_MODE_OWNSHIP;
+
+        else if( !b_own_valid )
+            mode = CPA_MODE_INVALID;
+
+        //    Target is maybe anchored and not reporting COG
+        else if( batch.cog[i] == 360.0 ) {
+            if( batch.sog[i] < .01 )
+                batch.cog[i] = 0.;          // substitute value for the case where SOG ~= 0, and COG is unknown.
+            else
+                mode = CPA_MODE_INVALID;
+        }
+
+        if( ( mode == CPA_MODE_MOVING ) && ( v0 < 1e-6 ) && ( batch.sog[i] * 1852. < 1e-6 ) )
+            mode = CPA_MODE_STOPPED;
+
+        batch.mode[i] = mode;
+    }
+
+    //    Second pass, TCPA on a Reduced Lat/Lon orthogonal plotting sheet.
+    //    Straight line arithmetic over the columns, for every target, whatever its mode.
+    double coslat = cos( gLat * PI / 180. );
+    double cosa = cos( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
+    double sina = sin( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
+
+    const double *lat = &batch.lat[0];
+    const double *lon = &batch.lon[0];
+    const double *cog = &batch.cog[0];
+    const double *sog = &batch.sog[0];
+    double *tcpa = &batch.tcpa[0];
+
+    for( size_t i = 0; i < n; i++ ) {
+        //    Get easting/northing to target,  in meters
+        double east = ( lon[i] - gLon ) * 60 * 1852 * coslat;
+        double north = ( lat[i] - gLat ) * 60 * 1852;
+
+        double v1 = sog[i] * 1852.;
 
         //    Convert COGs trigonometry to standard unit circle
-        double cosa = cos( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
-        double sina = sin( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
-        double cosb = cos( ( 90. - cpa_calc_target_cog ) * PI / 180. );
-        double sinb = sin( ( 90. - cpa_calc_target_cog ) * PI / 180. );
+        double cosb = cos( ( 90. - cog[i] ) * PI / 180. );
+        double sinb = sin( ( 90. - cog[i] ) * PI / 180. );
 
         //    These will be useful
         double fc = ( v0 * cosa ) - ( v1 * cosb );
         double fs = ( v0 * sina ) - ( v1 * sinb );
 
         double d = ( fc * fc ) + ( fs * fs );
-        double tcpa;
 
-        // the tracks are almost parallel
-        if( fabs( d ) < 1e-6 ) tcpa = 0.;
-        else
-            //    Here is the equation for t, which will be in hours
-            tcpa = ( ( fc * east ) + ( fs * north ) ) / d;
+        //    Here is the equation for t, which will be in hours
+        //    unless the tracks are almost parallel
+        tcpa[i] = ( fabs( d ) < 1e-6 ) ? 0. : ( ( fc * east ) + ( fs * north ) ) / d;
+    }
+
+    //    Third pass, CPA from the predicted positions, and the next due pass
+    double guard_NM = g_CPAWarn_NM;
+    if( g_bCPAMax ) guard_NM = wxMax( guard_NM, g_CPAMax_NM );
+    double own_sog = b_own_valid ? gSog : CPA_UNKNOWN_SOG;
+    double pass_secs = TIMER_AIS_MSEC / 1000.;
+
+    for( size_t i = 0; i < n; i++ ) {
+        AIS_Target_Data *ptarget = batch.target[i];
+
+        switch( batch.mode[i] ) {
+            case CPA_MODE_INVALID:
+                ptarget->bCPA_Valid = false;
+                break;
+
+            case CPA_MODE_OWNSHIP:
+                ptarget->CPA = 100;
+                ptarget->TCPA = -100;
+                ptarget->bCPA_Valid = false;
+                break;
+
+            case CPA_MODE_STOPPED:
+                ptarget->TCPA = 0.;
+                ptarget->CPA = 0.;
+                ptarget->bCPA_Valid = false;
+                break;
+
+            default: {
+                //    Convert to minutes
+                ptarget->TCPA = tcpa[i] * 60.;
 
-        //    Convert to minutes
-        ptarget->TCPA = tcpa * 60.;
+                //    Calculate CPA
+                //    Using TCPA, predict ownship and target positions
 
-        //    Calculate CPA
-        //    Using TCPA, predict ownship and target positions
+                double OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA;
 
-        double OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA;
+                ll_gc_ll( gLat, gLon, cpa_calc_ownship_cog, gSog * tcpa[i], &OwnshipLatCPA, &OwnshipLonCPA );
+                ll_gc_ll( lat[i], lon[i], cog[i], sog[i] * tcpa[i], &TargetLatCPA, &TargetLonCPA );
 
-        ll_gc_ll( gLat, gLon, cpa_calc_ownship_cog, gSog * tcpa, &OwnshipLatCPA, &OwnshipLonCPA );
-        ll_gc_ll( ptarget->Lat, ptarget->Lon, cpa_calc_target_cog, ptarget->SOG * tcpa,
-                &TargetLatCPA, &TargetLonCPA );
+                //   And compute the distance
+                ptarget->CPA = DistGreatCircle( OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA );
 
-        //   And compute the distance
-        ptarget->CPA = DistGreatCircle( OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA );
+                ptarget->bCPA_Valid = true;
 
-        ptarget->bCPA_Valid = true;
+                if( ptarget->TCPA < 0 ) ptarget->bCPA_Valid = false;
+                break;
+            }
+        }
 
-        if( ptarget->TCPA < 0 ) ptarget->bCPA_Valid = false;
+        //    Remember what this was calculated from
+        ptarget->cpa_lat = ptarget->Lat;
+        ptarget->cpa_lon = ptarget->Lon;
+        ptarget->cpa_cog = ptarget->COG;
+        ptarget->cpa_sog = ptarget->SOG;
+        ptarget->cpa_positionOnceValid = ptarget->b_positionOnceValid;
+        ptarget->cpa_OwnShip = ptarget->b_OwnShip;
+        ptarget->cpa_own_gen = m_cpa_own_gen;
+
+        //    And bucket it by its time to close
+        double target_sog = ( ptarget->SOG <= 102.2 ) ? ptarget->SOG : CPA_UNKNOWN_SOG;
+        double closing_kts = wxMax( own_sog + target_sog, 1. );
+        double close_secs = ( ptarget->Range_NM - guard_NM ) / closing_kts * 3600.;
+
+        int bucket = 0;
+        while( ( bucket + 1 < CPA_DEFER_BUCKETS )
+               && ( ( 1 << ( bucket + 1 ) ) * pass_secs * CPA_DEFER_FACTOR <= close_secs ) )
+            bucket++;
+        ptarget->cpa_due_cycle = m_cpa_cycle + ( 1 << bucket );
     }
 }
 
@@ -2228,6 +2185,169 @@ void AIS_Decoder::OnTimerDSC( wxTimerEvent& event )
 }
 
 
+//----------------------------------------------------------------------------------
+//      Lost target handling
+//
+//      Each target is queued for the time of its next change of state by age:
+//      marked lost, reset to an unknown position, or removed.  The queue is
+//      updated as reports arrive, so OnTimerAIS() only looks at targets which
+//      are due, rather than at the whole target list.
+//----------------------------------------------------------------------------------
+
+//  Position report ages, in seconds, past which a target is marked lost, and past
+//  which it is reset to an unknown position.  Three times the latter, in static
+//  report age, removes the target.  Negative if not applicable.
+void AIS_Decoder::GetAgingLimits( AIS_Target_Data *td, double &marklost_secs, double &removelost_secs )
+{
+    marklost_secs = -1.;
+    removelost_secs = -1.;
+
+    //        Global variables controlling lost target handling
+    //g_bMarkLost
+    //g_MarkLost_Mins       // Minutes until black "cross out
+    //g_bRemoveLost
+    //g_RemoveLost_Mins);   // minutes until target is removed from screen and internal lists
+    
+    //g_bInlandEcdis
+    
+    //      Mark lost targets if specified
+    double removelost_Mins = fmax(g_RemoveLost_Mins,g_MarkLost_Mins);
+    
+    if (g_bInlandEcdis && (td->Class != AIS_ARPA)) {
+        double iECD_LostTimeOut = 0.0;
+        //special rules apply for europe inland ecdis timeout settings. overrule option settings
+        //Won't apply for ARPA targets where the radar has all control
+        if ( td->Class == AIS_CLASS_B){
+            if( (td->NavStatus == MOORED) || (td->NavStatus == AT_ANCHOR) )
+                iECD_LostTimeOut = 18 * 60;
+            else
+                iECD_LostTimeOut = 180;
+            
+        }
+        if ( td->Class == AIS_CLASS_A){
+            if( (td->NavStatus == MOORED) || (td->NavStatus == AT_ANCHOR) ){
+                if(td->SOG < 3.)
+                    iECD_LostTimeOut = 18 * 60;
+                else
+                    iECD_LostTimeOut = 60;
+            }
+            else
+                iECD_LostTimeOut = 60;
+        }
+            
+        if( td->Class != AIS_GPSG_BUDDY )
+            marklost_secs = iECD_LostTimeOut;
+            
+        removelost_Mins = (2 * iECD_LostTimeOut) / 60.;
+    }               
+    else if( g_bMarkLost ) {
+        if( td->Class != AIS_GPSG_BUDDY )
+            marklost_secs = g_MarkLost_Mins * 60;
+    }
+
+    if( td->Class == AIS_SART )
+        removelost_Mins = 18.0;
+    
+    if( ( g_bRemoveLost || g_bInlandEcdis ) && ( td->Class != AIS_GPSG_BUDDY ) )
+        removelost_secs = removelost_Mins * 60;
+}
+
+//  The earliest time after "after" at which the target changes state by age, or 0
+time_t AIS_Decoder::NextAgingTime( AIS_Target_Data *td, time_t after )
+{
+    //  A lost ARPA target would be deleted at once
+    if( ( g_bRemoveLost || g_bInlandEcdis ) && ( td->Class == AIS_ARPA ) && td->b_lost )
+        return after + 1;
+
+    double marklost_secs, removelost_secs;
+    GetAgingLimits( td, marklost_secs, removelost_secs );
+
+    //  An age limit is passed once the age, in whole seconds, exceeds it
+    time_t limit[3];
+    int nlimit = 0;
+    if( marklost_secs >= 0. )
+        limit[nlimit++] = td->PositionReportTicks + (time_t) floor( marklost_secs ) + 1;
+    if( removelost_secs >= 0. ) {
+        limit[nlimit++] = td->PositionReportTicks + (time_t) floor( removelost_secs ) + 1;
+        limit[nlimit++] = td->StaticReportTicks + (time_t) floor( removelost_secs * 3 ) + 1;
+    }
+
+    time_t due = 0;
+    for( int i = 0; i < nlimit; i++ ) {
+        if( limit[i] > after && ( !due || limit[i] < due ) )
+            due = limit[i];
+    }
+    return due;
+}
+
+//  Queue the target for "due".  A target has at most one live entry in the queue,
+//  the earliest; later ones are picked up again when it comes round.
+void AIS_Decoder::ScheduleAging( AIS_Target_Data *td, time_t due )
+{
+    td->aging_due = due;
+    if( due && ( !td->aging_queued || due < td->aging_queued ) ) {
+        AIS_AgingEntry entry;
+        entry.due = due;
+        entry.mmsi = td->MMSI;
+        m_aging_queue.push( entry );
+        td->aging_queued = due;
+    }
+}
+
+//  A report may have reset the target's ages, or changed its class or status
+void AIS_Decoder::ScheduleAgingOnReport( AIS_Target_Data *td )
+{
+    wxDateTime now = wxDateTime::Now();
+    now.MakeGMT();
+
+    //  A limit already passed must be applied again, the report may have undone it
+    time_t due = NextAgingTime( td, 0 );
+    if( due && due <= now.GetTicks() )
+        due = now.GetTicks();
+
+    ScheduleAging( td, due );
+}
+
+//  Apply the lost target rules to one target, returns true if it is to be removed
+bool AIS_Decoder::AgeTarget( AIS_Target_Data *td, time_t now )
+{
+    int target_posn_age = now - td->PositionReportTicks;
+    int target_static_age = now - td->StaticReportTicks;
+
+    double marklost_secs, removelost_secs;
+    GetAgingLimits( td, marklost_secs, removelost_secs );
+
+    //      Mark lost targets if specified
+    if( ( marklost_secs >= 0. ) && ( target_posn_age > marklost_secs ) )
+        td->b_active = false;
+
+    //      Remove lost targets if specified
+
+    if( g_bRemoveLost || g_bInlandEcdis ) {
+        bool b_arpalost = ( td->Class == AIS_ARPA  && td->b_lost ); //A lost ARPA target would be deleted at once
+        if ( ( ( removelost_secs >= 0. ) && ( target_posn_age > removelost_secs ) ) || b_arpalost ) {
+            //      So mark the target as lost, with unknown position, and make it not selectable
+            td->b_lost = true;
+            td->b_positionOnceValid = false;
+            td->COG = 360.0;
+            td->SOG = 103.0;
+            td->HDG = 511.0;
+            td->ROTAIS = -128;
+
+            long mmsi_long = td->MMSI;
+            pSelectAIS->DeleteSelectablePoint( (void *) mmsi_long, SELTYPE_AISTARGET );
+
+            //      If we have not seen a static report in 3 times the removal spec,
+            //      then remove the target from all lists
+            //      or a lost ARPA target.
+            if ( target_static_age > removelost_secs * 3 || b_arpalost )
+                return true;
+        }
+    }
+
+    return false;
+}
+
 void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
 {
     TimerAIS.Stop();
@@ -2237,109 +2357,77 @@ void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
 
     wxDateTime now = wxDateTime::Now();
     now.MakeGMT();
+    time_t now_ticks = now.GetTicks();
 
     AIS_Target_Hash::iterator it;
     AIS_Target_Hash *current_targets = GetTargetList();
 
-    it = ( *current_targets ).begin();
     std::vector<int> remove_array;                    // collector for MMSI of targets to be removed
-    
-    while( it != ( *current_targets ).end() ) {
-        bool b_new_it = false;
 
-        AIS_Target_Data *td = it->second;
+    //  New lost target settings, so every target needs a new due time
+    if( ( g_bMarkLost != m_aging_bMarkLost ) || ( g_MarkLost_Mins != m_aging_MarkLost_Mins )
+        || ( g_bRemoveLost != m_aging_bRemoveLost ) || ( g_RemoveLost_Mins != m_aging_RemoveLost_Mins )
+        || ( g_bInlandEcdis != m_aging_bInlandEcdis ) ) {
+        m_aging_bMarkLost = g_bMarkLost;
+        m_aging_MarkLost_Mins = g_MarkLost_Mins;
+        m_aging_bRemoveLost = g_bRemoveLost;
+        m_aging_RemoveLost_Mins = g_RemoveLost_Mins;
+        m_aging_bInlandEcdis = g_bInlandEcdis;
 
-        if( NULL == td )                        // This should never happen, but I saw it once....
-                {
-            current_targets->erase( it );
-            break;                          // leave the loop
+        for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
+            if( it->second )
+                ScheduleAgingOnReport( it->second );
         }
+    }
 
-        int target_posn_age = now.GetTicks() - td->PositionReportTicks;
-        int target_static_age = now.GetTicks() - td->StaticReportTicks;
-
-        //        Global variables controlling lost target handling
-        //g_bMarkLost
-        //g_MarkLost_Mins       // Minutes until black "cross out
-        //g_bRemoveLost
-        //g_RemoveLost_Mins);   // minutes until target is removed from screen and internal lists
-        
-        //g_bInlandEcdis
-        
-        //      Mark lost targets if specified
-        double removelost_Mins = fmax(g_RemoveLost_Mins,g_MarkLost_Mins);
-        
-        if (g_bInlandEcdis && (td->Class != AIS_ARPA)) {
-            double iECD_LostTimeOut = 0.0;
-            //special rules apply for europe inland ecdis timeout settings. overrule option settings
-            //Won't apply for ARPA targets where the radar has all control
-            if ( td->Class == AIS_CLASS_B){
-                if( (td->NavStatus == MOORED) || (td->NavStatus == AT_ANCHOR) )
-                    iECD_LostTimeOut = 18 * 60;
-                else
-                    iECD_LostTimeOut = 180;
-                
-            }
-            if ( td->Class == AIS_CLASS_A){
-                if( (td->NavStatus == MOORED) || (td->NavStatus == AT_ANCHOR) ){
-                    if(td->SOG < 3.)
-                        iECD_LostTimeOut = 18 * 60;
-                    else
-                        iECD_LostTimeOut = 60;
-                }
-                else
-                    iECD_LostTimeOut = 60;
+    //  Superseded entries only leave the queue as they come due, so rebuild it
+    //  now and then if they pile up
+    if( m_aging_queue.size() > 4 * current_targets->size() + 64 ) {
+        m_aging_queue = AIS_AgingQueue();
+        for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
+            if( it->second ) {
+                it->second->aging_queued = 0;
+                ScheduleAging( it->second, it->second->aging_due );
             }
-                
-            if( ( target_posn_age > iECD_LostTimeOut ) && ( td->Class != AIS_GPSG_BUDDY ) )
-                    td->b_active = false;
-                
-            removelost_Mins = (2 * iECD_LostTimeOut) / 60.;
-        }               
-        else if( g_bMarkLost ) {
-            if( ( target_posn_age > g_MarkLost_Mins * 60 ) && ( td->Class != AIS_GPSG_BUDDY ) )
-                td->b_active = false;
         }
+    }
 
-        if( td->Class == AIS_SART )
-            removelost_Mins = 18.0;
-        
-        //      Remove lost targets if specified
-
-        if( g_bRemoveLost || g_bInlandEcdis ) {
-            bool b_arpalost = ( td->Class == AIS_ARPA  && td->b_lost ); //A lost ARPA target would be deleted at once
-            if ( ( ( target_posn_age > removelost_Mins * 60 ) && ( td->Class != AIS_GPSG_BUDDY ) ) || b_arpalost ) {
-                //      So mark the target as lost, with unknown position, and make it not selectable
-                td->b_lost = true;
-                td->b_positionOnceValid = false;
-                td->COG = 360.0;
-                td->SOG = 103.0;
-                td->HDG = 511.0;
-                td->ROTAIS = -128;
-
-                long mmsi_long = td->MMSI;
-                pSelectAIS->DeleteSelectablePoint( (void *) mmsi_long, SELTYPE_AISTARGET );
+    //  Look at the targets which are due
+    while( !m_aging_queue.empty() && m_aging_queue.top().due <= now_ticks ) {
+        AIS_AgingEntry entry = m_aging_queue.top();
+        m_aging_queue.pop();
 
-                //      If we have not seen a static report in 3 times the removal spec,
-                //      then remove the target from all lists
-                //      or a lost ARPA target.
-                if ( target_static_age > removelost_Mins * 60 * 3 || b_arpalost )
-                    remove_array.push_back(td->MMSI);         //Add this target to removal list
-            }
-        }
-        
-        // Remove any targets specified as to be "ignored", so that they won't trigger phantom alerts (e.g. SARTs)
-        for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
-            MMSIProperties *props =  g_MMSI_Props_Array[i];
-            if(td->MMSI == props->MMSI){
-                if(props->m_bignore)
-                    remove_array.push_back(td->MMSI);         //Add this target to removal list
-                break;
-            }
+        it = current_targets->find( entry.mmsi );
+        if( it == current_targets->end() || NULL == it->second )
+            continue;
+
+        AIS_Target_Data *td = it->second;
+        if( td->aging_queued != entry.due )         // superseded by an earlier entry
+            continue;
+        td->aging_queued = 0;
+
+        if( !td->aging_due )
+            continue;
+        if( td->aging_due > now_ticks ) {           // its reports moved it on since
+            ScheduleAging( td, td->aging_due );
+            continue;
         }
-        
 
-        ++it;
+        if( AgeTarget( td, now_ticks ) )
+            remove_array.push_back( td->MMSI );         //Add this target to removal list
+        else
+            ScheduleAging( td, NextAgingTime( td, now_ticks ) );
+    }
+
+    // Remove any targets specified as to be "ignored", so that they won't trigger phantom alerts (e.g. SARTs)
+    // The first entry for an MMSI is the one that counts
+    std::unordered_map<int, bool> props_seen;
+    for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
+        MMSIProperties *props =  g_MMSI_Props_Array[i];
+        if( !props_seen.insert( std::make_pair( props->MMSI, true ) ).second )
+            continue;
+        if( props->m_bignore && current_targets->count( props->MMSI ) )
+            remove_array.push_back( props->MMSI );         //Add this target to removal list
     }
 
     //  Remove all the targets collected in remove_array in one pass
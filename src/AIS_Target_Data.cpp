@@ -168,6 +168,13 @@ AIS_Target_Data::AIS_Target_Data()
     b_active = false;
     blue_paddle = 0;
     bCPA_Valid = false;
+    cpa_lat = cpa_lon = cpa_cog = cpa_sog = 0.;
+    cpa_positionOnceValid = false;
+    cpa_OwnShip = false;
+    cpa_own_gen = 0;                    // never calculated
+    cpa_due_cycle = 0;
+    aging_due = 0;
+    aging_queued = 0;
     ROTIND = 0;
     b_show_track = g_bAISShowTracks;
     b_SarAircraftPosnReport = false;
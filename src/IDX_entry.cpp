@@ -37,5 +37,6 @@ IDX_entry::IDX_entry()
 IDX_entry::~IDX_entry()
 {
     free(IDX_tzname);
+    free(m_tables);
 }
 
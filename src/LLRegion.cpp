@@ -29,8 +29,13 @@
 #include <string.h>
 #include <math.h>
 
+#include <vector>
+#include <algorithm>
+
 #include "LLRegion.h"
 
+static bool s_use_glu_clipper = false;
+
 static inline double cross(const contour_pt &v1, const contour_pt &v2)
 {
     return v1.y*v2.x - v1.x*v2.y;
@@ -117,8 +122,18 @@ LLBBox LLRegion::GetBox() const
     if(contours.empty())
         return LLBBox(); // invalid box
 
-    if(m_box.GetValid())
-        return m_box;
+    if(!m_box.GetValid()) {
+        LLBBox &box = const_cast<LLBBox&>(m_box);
+        box = ComputeBox();
+    }
+    return m_box;
+}
+
+// the box of the contours, without touching the cached m_box
+LLBBox LLRegion::ComputeBox() const
+{
+    if(contours.empty())
+        return LLBBox(); // invalid box
 
     // there are 3 possible longitude bounds: -180 to 180, 0 to 360, -360 to 0
     double minlat = 90, minlon[3] = {180, 360, 0};
@@ -166,9 +181,23 @@ LLBBox LLRegion::GetBox() const
         if(d[k] < d[mink])
             mink = k;
 
-    LLBBox &box = const_cast<LLBBox&>(m_box);
+    LLBBox box;
     box.Set(minlat, minlon[mink], maxlat, maxlon[mink]);
-    return m_box;
+    return box;
+}
+
+// area in square degrees, holes subtracted
+double LLRegion::GetArea() const
+{
+    double area = 0;
+    for(std::list<poly_contour>::const_iterator i = contours.begin(); i != contours.end(); i++) {
+        contour_pt l = *i->rbegin();
+        for(poly_contour::const_iterator j = i->begin(); j != i->end(); j++) {
+            area += l.x*j->y - j->x*l.y;
+            l = *j;
+        }
+    }
+    return area / 2;
 }
 
 static inline int ComputeState(const LLBBox &box, const contour_pt &p)
@@ -198,8 +227,9 @@ inline bool TestPoint(contour_pt p0, contour_pt p1, double x, double y)
 
 bool LLRegion::IntersectOut(const LLBBox &box) const
 {
-    // First do faster test of bounding boxes
-    if(GetBox().IntersectOut(box))
+    // First do faster test of bounding boxes, without caching it, as the region may be shared
+    LLBBox rbox = m_box.GetValid() ? m_box : ComputeBox();
+    if(rbox.IntersectOut(box))
         return true;
 
     return NoIntersection(box);
@@ -312,6 +342,16 @@ static void /*APIENTRY*/ LLerrorCallback(GLenum errorCode)
     //exit (0);
 }
 
+void LLRegion::UseGLUClipper(bool use)
+{
+    s_use_glu_clipper = use;
+}
+
+bool LLRegion::IsUsingGLUClipper()
+{
+    return s_use_glu_clipper;
+}
+
 void LLRegion::Intersect(const LLRegion& region)
 {
     if(NoIntersection(region)) {
@@ -319,7 +359,10 @@ void LLRegion::Intersect(const LLRegion& region)
         return;
     }
 
-    Put(region, GLU_TESS_WINDING_ABS_GEQ_TWO, false);
+    if(s_use_glu_clipper)
+        Put(region, GLU_TESS_WINDING_ABS_GEQ_TWO, false);
+    else if(!ClipContained(region, CLIP_INTERSECT))
+        Clip(region, CLIP_INTERSECT);
 }
 
 void LLRegion::Union(const LLRegion& region)
@@ -329,7 +372,10 @@ void LLRegion::Union(const LLRegion& region)
         return;
     }
 
-    Put(region, GLU_TESS_WINDING_POSITIVE, false);
+    if(s_use_glu_clipper)
+        Put(region, GLU_TESS_WINDING_POSITIVE, false);
+    else if(!ClipContained(region, CLIP_UNION))
+        Clip(region, CLIP_UNION);
 }
 
 void LLRegion::Subtract(const LLRegion& region)
@@ -337,7 +383,469 @@ void LLRegion::Subtract(const LLRegion& region)
     if(NoIntersection(region))
         return;
     
-    Put(region, GLU_TESS_WINDING_POSITIVE, true);
+    if(s_use_glu_clipper)
+        Put(region, GLU_TESS_WINDING_POSITIVE, true);
+    else if(!ClipContained(region, CLIP_SUBTRACT))
+        Clip(region, CLIP_SUBTRACT);
+}
+
+// ----------------------
+// Boolean operations without the tessellator
+//
+// Both regions are cut into edges which meet only at their ends, coincident
+// edges are merged, and the winding number on either side of each edge is
+// found by casting a ray down from its middle.  The edges with the inside of
+// the result on one side only are the new boundary, which is linked into
+// contours with the inside on the left, as the tessellator leaves them.
+// The winding rules are those given to the tessellator, applied to the sum of
+// the windings of both regions, so the results are the same.
+
+// points closer than this to an edge are taken to lie on it
+#define CLIP_SNAP 1e-10
+
+struct clip_point_lt
+{
+    bool operator()(const contour_pt &a, const contour_pt &b) const {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+};
+
+static inline bool ClipPointEqual(const contour_pt &a, const contour_pt &b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+struct clip_bounds
+{
+    double minx, miny, maxx, maxy;
+
+    void Expand(const poly_contour &c) {
+        for(poly_contour::const_iterator j = c.begin(); j != c.end(); j++) {
+            minx = wxMin(minx, j->x), maxx = wxMax(maxx, j->x);
+            miny = wxMin(miny, j->y), maxy = wxMax(maxy, j->y);
+        }
+    }
+
+    void Set(const std::list<poly_contour> &contours) {
+        minx = miny = INFINITY, maxx = maxy = -INFINITY;
+        for(std::list<poly_contour>::const_iterator i = contours.begin(); i != contours.end(); i++)
+            Expand(*i);
+    }
+
+    bool Out(const clip_bounds &b) const {
+        return minx > b.maxx || maxx < b.minx || miny > b.maxy || maxy < b.miny;
+    }
+};
+
+struct clip_split
+{
+    double along;
+    contour_pt p;
+
+    bool operator<(const clip_split &s) const { return along < s.along; }
+};
+
+struct clip_segment
+{
+    contour_pt p0, p1;
+    double minx, maxx, miny, maxy;
+    double len;
+    std::vector<clip_split> splits;
+};
+
+struct clip_edge
+{
+    int a, b;   // vertices, a < b
+    int d;      // net count of edges running from a to b
+
+    bool operator<(const clip_edge &e) const { return a < e.a || (a == e.a && b < e.b); }
+};
+
+// Contours clear of the box of the other region have nothing to cut them, and
+// the windings of the other region are zero around them.  These are copied to
+// the result as they are when keep is set, otherwise dropped.  This takes the
+// contours of a region not to cross one another, as the operations leave them.
+static void AddClipSegments(std::vector<clip_segment> &segs, std::list<poly_contour> &result,
+                            const std::list<poly_contour> &contours, const clip_bounds &other,
+                            bool reverse, bool keep)
+{
+    for(std::list<poly_contour>::const_iterator i = contours.begin(); i != contours.end(); i++) {
+        clip_bounds b = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+        b.Expand(*i);
+        if(b.Out(other)) {
+            if(keep)
+                result.push_back(*i);
+            continue;
+        }
+
+        contour_pt l = *i->rbegin();
+        for(poly_contour::const_iterator j = i->begin(); j != i->end(); j++) {
+            contour_pt p = *j;
+            if(!ClipPointEqual(l, p)) {
+                clip_segment s;
+                s.p0 = reverse ? p : l;
+                s.p1 = reverse ? l : p;
+                s.minx = wxMin(l.x, p.x), s.maxx = wxMax(l.x, p.x);
+                s.miny = wxMin(l.y, p.y), s.maxy = wxMax(l.y, p.y);
+                s.len = sqrt(dist2(vector(l, p)));
+                segs.push_back(s);
+            }
+            l = p;
+        }
+    }
+}
+
+// if p lies inside segment s, remember to split s there
+static bool SplitAtPoint(clip_segment &s, const contour_pt &p)
+{
+    contour_pt d = vector(s.p0, s.p1), v = vector(s.p0, p);
+    if(fabs(cross(d, v)) > CLIP_SNAP*s.len)
+        return false;
+
+    double along = dot(d, v) / s.len;
+    if(along <= CLIP_SNAP || along >= s.len - CLIP_SNAP)
+        return false;
+
+    clip_split split = {along, p};
+    s.splits.push_back(split);
+    return true;
+}
+
+static void SplitSegments(clip_segment &p, clip_segment &q)
+{
+    // ends which touch the other segment, including overlapping collinear segments
+    bool touch = SplitAtPoint(p, q.p0);
+    touch |= SplitAtPoint(p, q.p1);
+    touch |= SplitAtPoint(q, p.p0);
+    touch |= SplitAtPoint(q, p.p1);
+    if(touch)
+        return;
+
+    // proper crossing, each segment must have its ends on either side of the other
+    contour_pt dp = vector(p.p0, p.p1), dq = vector(q.p0, q.p1);
+    double a0 = cross(dq, vector(q.p0, p.p0)), a1 = cross(dq, vector(q.p0, p.p1));
+    double snapq = CLIP_SNAP*q.len;
+    if((a0 > -snapq && a1 > -snapq) || (a0 < snapq && a1 < snapq))
+        return;
+
+    double b0 = cross(dp, vector(p.p0, q.p0)), b1 = cross(dp, vector(p.p0, q.p1));
+    double snapp = CLIP_SNAP*p.len;
+    if((b0 > -snapp && b1 > -snapp) || (b0 < snapp && b1 < snapp))
+        return;
+
+    // the same point is used for both, so the pieces meet exactly
+    double t = a0 / (a0 - a1);
+    clip_split sp = {t*p.len, {p.p0.y + t*dp.y, p.p0.x + t*dp.x}};
+    clip_split sq = {dot(dq, vector(q.p0, sp.p)) / q.len, sp.p};
+    p.splits.push_back(sp);
+    q.splits.push_back(sq);
+}
+
+struct clip_xindex_lt
+{
+    clip_xindex_lt(const std::vector<clip_segment> &s) : segs(s) {}
+    bool operator()(int a, int b) const { return segs[a].minx < segs[b].minx; }
+    const std::vector<clip_segment> &segs;
+};
+
+// find where the segments meet, sweeping across in longitude
+static void SplitAllSegments(std::vector<clip_segment> &segs)
+{
+    std::vector<int> order(segs.size());
+    for(size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), clip_xindex_lt(segs));
+
+    std::vector<int> active;
+    for(size_t i = 0; i < order.size(); i++) {
+        clip_segment &s = segs[order[i]];
+
+        size_t n = 0;
+        for(size_t j = 0; j < active.size(); j++) {
+            clip_segment &a = segs[active[j]];
+            if(a.maxx < s.minx - CLIP_SNAP)
+                continue;       // passed, never needed again
+            active[n++] = active[j];
+
+            if(a.maxy >= s.miny - CLIP_SNAP && a.miny <= s.maxy + CLIP_SNAP)
+                SplitSegments(a, s);
+        }
+        active.resize(n);
+        active.push_back(order[i]);
+    }
+}
+
+// winding number at (x, y) from edges below it, with x taken as just to the right
+// so vertices and vertical edges count once
+struct clip_windings
+{
+    clip_windings(const std::vector<contour_pt> &v, const std::vector<clip_edge> &e)
+        : verts(v), edges(e)
+    {
+        minx = verts.front().x;
+        double range = verts.back().x - minx;
+        nbuckets = wxMax(1, wxMin((int)(edges.size() / 4), 1<<16));
+        scale = range > 0 ? nbuckets / range : 0;
+
+        // bucket every edge which is not vertical across the longitudes it spans
+        start.assign(nbuckets + 1, 0);
+        for(int pass = 0; pass < 2; pass++) {
+            for(size_t i = 0; i < edges.size(); i++) {
+                const contour_pt &a = verts[edges[i].a], &b = verts[edges[i].b];
+                if(a.x == b.x)
+                    continue;
+                for(int k = Bucket(a.x), end = Bucket(b.x); k <= end; k++)
+                    if(pass)
+                        items[fill[k]++] = i;
+                    else
+                        start[k+1]++;
+            }
+            if(!pass) {
+                for(int k = 0; k < nbuckets; k++)
+                    start[k+1] += start[k];
+                items.resize(start[nbuckets]);
+                fill.assign(start.begin(), start.end() - 1);
+            }
+        }
+    }
+
+    int Bucket(double x) const {
+        int k = (int)((x - minx) * scale);
+        return wxMax(0, wxMin(k, nbuckets - 1));
+    }
+
+    int Below(double x, double y, int skip) const {
+        int w = 0, k = Bucket(x);
+        for(int i = start[k]; i < start[k+1]; i++) {
+            int e = items[i];
+            const contour_pt &a = verts[edges[e].a], &b = verts[edges[e].b];
+            if(e == skip || x < a.x || x >= b.x)
+                continue;
+            if(a.y + (x - a.x)*(b.y - a.y)/(b.x - a.x) < y)
+                w += edges[e].d;
+        }
+        return w;
+    }
+
+    const std::vector<contour_pt> &verts;
+    const std::vector<clip_edge> &edges;
+    double minx, scale;
+    int nbuckets;
+    std::vector<int> start, fill, items;
+};
+
+static inline bool ClipInside(bool intersect, int winding)
+{
+    // GLU_TESS_WINDING_ABS_GEQ_TWO for intersections, otherwise GLU_TESS_WINDING_POSITIVE
+    return intersect ? abs(winding) >= 2 : winding > 0;
+}
+
+static inline void LinkContour(std::list<poly_contour> &contours, const std::vector<contour_pt> &verts,
+                               const std::vector<int> &path, size_t from)
+{
+    if(path.size() - from < 3)
+        return;
+    poly_contour c;
+    for(size_t i = from; i < path.size(); i++)
+        c.push_back(verts[path[i]]);
+    contours.push_back(c);
+}
+
+// true if the region is one rectangle, counter clockwise, with sides along the meridians and parallels
+static bool IsClipRectangle(const LLRegion& region, double &minx, double &miny, double &maxx, double &maxy)
+{
+    if(region.contours.size() != 1 || region.contours.front().size() != 4)
+        return false;
+
+    const poly_contour &c = region.contours.front();
+    contour_pt l = *c.rbegin();
+    minx = maxx = l.x, miny = maxy = l.y;
+    for(poly_contour::const_iterator j = c.begin(); j != c.end(); j++) {
+        if(j->x != l.x && j->y != l.y)
+            return false;
+        minx = wxMin(minx, j->x), maxx = wxMax(maxx, j->x);
+        miny = wxMin(miny, j->y), maxy = wxMax(maxy, j->y);
+        l = *j;
+    }
+    return minx < maxx && miny < maxy && region.GetArea() > 0;
+}
+
+static bool RegionInRectangle(const LLRegion& region, double minx, double miny, double maxx, double maxy)
+{
+    for(std::list<poly_contour>::const_iterator i = region.contours.begin(); i != region.contours.end(); i++)
+        for(poly_contour::const_iterator j = i->begin(); j != i->end(); j++)
+            if(j->x < minx || j->x > maxx || j->y < miny || j->y > maxy)
+                return false;
+    return true;
+}
+
+// fast path for a rectangle, such as the view or the +-180 longitude clip,
+// containing the other region
+bool LLRegion::ClipContained(const LLRegion& region, int op)
+{
+    double minx, miny, maxx, maxy;
+    if(IsClipRectangle(region, minx, miny, maxx, maxy) &&
+       RegionInRectangle(*this, minx, miny, maxx, maxy)) {
+        if(op == CLIP_SUBTRACT)
+            Clear();
+        else if(op == CLIP_UNION) {
+            contours = region.contours;
+            m_box.Invalidate();
+        }
+        return true;
+    }
+
+    if(op != CLIP_SUBTRACT && IsClipRectangle(*this, minx, miny, maxx, maxy) &&
+       RegionInRectangle(region, minx, miny, maxx, maxy)) {
+        if(op == CLIP_INTERSECT) {
+            contours = region.contours;
+            m_box.Invalidate();
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void LLRegion::Clip(const LLRegion& region, int op)
+{
+    std::list<poly_contour> mine;
+    mine.swap(contours);
+    m_box.Invalidate();
+
+    clip_bounds bounds, rbounds;
+    bounds.Set(mine);
+    rbounds.Set(region.contours);
+
+    std::vector<clip_segment> segs;
+    AddClipSegments(segs, contours, mine, rbounds, false, op != CLIP_INTERSECT);
+    AddClipSegments(segs, contours, region.contours, bounds, op == CLIP_SUBTRACT, op == CLIP_UNION);
+    mine.clear();
+    if(segs.empty())
+        return;
+
+    SplitAllSegments(segs);
+
+    // cut the segments into pieces, numbering their vertices
+    size_t npieces = segs.size();
+    for(size_t i = 0; i < segs.size(); i++)
+        npieces += segs[i].splits.size();
+
+    std::vector<contour_pt> verts;
+    verts.reserve(npieces);
+    for(size_t i = 0; i < segs.size(); i++) {
+        clip_segment &s = segs[i];
+        std::sort(s.splits.begin(), s.splits.end());
+        verts.push_back(s.p0);
+        for(size_t j = 0; j < s.splits.size(); j++)
+            verts.push_back(s.splits[j].p);
+    }
+    std::sort(verts.begin(), verts.end(), clip_point_lt());
+    verts.erase(std::unique(verts.begin(), verts.end(), ClipPointEqual), verts.end());
+
+    std::vector<clip_edge> edges;
+    edges.reserve(npieces);
+    for(size_t i = 0; i < segs.size(); i++) {
+        clip_segment &s = segs[i];
+        int a = std::lower_bound(verts.begin(), verts.end(), s.p0, clip_point_lt()) - verts.begin();
+        for(size_t j = 0; j <= s.splits.size(); j++) {
+            const contour_pt &p = j < s.splits.size() ? s.splits[j].p : s.p1;
+            int b = std::lower_bound(verts.begin(), verts.end(), p, clip_point_lt()) - verts.begin();
+            if(a != b) {
+                clip_edge e = {wxMin(a, b), wxMax(a, b), a < b ? 1 : -1};
+                edges.push_back(e);
+            }
+            a = b;
+        }
+    }
+    segs.clear();
+
+    // merge coincident edges, dropping those which cancel
+    std::sort(edges.begin(), edges.end());
+    size_t n = 0;
+    for(size_t i = 0; i < edges.size(); i++) {
+        if(n && edges[n-1].a == edges[i].a && edges[n-1].b == edges[i].b)
+            edges[n-1].d += edges[i].d;
+        else {
+            if(n && !edges[n-1].d)
+                n--;
+            edges[n++] = edges[i];
+        }
+    }
+    if(n && !edges[n-1].d)
+        n--;
+    edges.resize(n);
+    if(edges.empty())
+        return;
+
+    // keep the edges with the inside on one side only, directed with the inside on
+    // the left.  Edges run up or to the right from a to b, so the side above, or to
+    // the left of a vertical edge, has the winding of the other side plus d.
+    bool intersect = op == CLIP_INTERSECT;
+    clip_windings windings(verts, edges);
+    std::vector<int> from, to;
+    for(size_t i = 0; i < edges.size(); i++) {
+        const contour_pt &a = verts[edges[i].a], &b = verts[edges[i].b];
+        double x = a.x == b.x ? a.x : (a.x + b.x) / 2;
+        int w = windings.Below(x, (a.y + b.y) / 2, i);
+        bool in_right = ClipInside(intersect, w), in_left = ClipInside(intersect, w + edges[i].d);
+        if(in_left == in_right)
+            continue;
+        from.push_back(in_left ? edges[i].a : edges[i].b);
+        to.push_back(in_left ? edges[i].b : edges[i].a);
+    }
+
+    // link the boundary, splitting off a contour each time a vertex is met again
+    std::vector<int> out_start(verts.size() + 1, 0), out, in_count(verts.size(), 0);
+    for(size_t i = 0; i < from.size(); i++) {
+        out_start[from[i]+1]++;
+        in_count[to[i]]++;
+    }
+    for(size_t v = 0; v < verts.size(); v++)
+        out_start[v+1] += out_start[v];
+    std::vector<int> next(out_start.begin(), out_start.end() - 1);
+    out.resize(from.size());
+    for(size_t i = 0; i < from.size(); i++)
+        out[next[from[i]]++] = to[i];
+    next.assign(out_start.begin(), out_start.end() - 1);
+
+    std::vector<int> path, pos(verts.size(), -1);
+    // vertices with more edges out than in start chains left open by rounding,
+    // walk those first so each is closed on itself
+    for(int pass = 0; pass < 2; pass++)
+        for(size_t s = 0; s < verts.size(); s++) {
+            while(next[s] < out_start[s+1]) {
+                int unbalanced = out_start[s+1] - next[s] - in_count[s];
+                if(!pass && unbalanced <= 0)
+                    break;
+
+                int v = s;
+                path.push_back(v);
+                pos[v] = 0;
+                while(next[v] < out_start[v+1]) {
+                    int u = out[next[v]++];
+                    in_count[u]--;
+                    if(pos[u] >= 0) {
+                        size_t from_pos = pos[u];
+                        LinkContour(contours, verts, path, from_pos);
+                        for(size_t k = from_pos + 1; k < path.size(); k++)
+                            pos[path[k]] = -1;
+                        path.resize(from_pos + 1);
+                    } else {
+                        pos[u] = path.size();
+                        path.push_back(u);
+                    }
+                    v = u;
+                }
+
+                LinkContour(contours, verts, path, 0);
+                for(size_t k = 0; k < path.size(); k++)
+                    pos[path[k]] = -1;
+                path.clear();
+            }
+        }
+
+    Optimize();
 }
 
 // ----------------------
@@ -644,7 +1152,8 @@ bool LLRegion::NoIntersection(const LLRegion& region) const
     if(Empty() || region.Empty())
         return true;
     
-    LLBBox box = GetBox(), rbox = region.GetBox();
+    // the argument is only read, it may be shared with other threads
+    LLBBox box = GetBox(), rbox = region.m_box.GetValid() ? region.m_box : region.ComputeBox();
     return box.IntersectOut(rbox) || NoIntersection(rbox) || region.NoIntersection(box);
 }
 
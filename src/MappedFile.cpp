@@ -0,0 +1,110 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Read-only memory mapped files
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.             *
+ ***************************************************************************
+ *
+ */
+
+// For compilers that support precompilation, includes "wx.h".
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#ifdef __WXMSW__
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const wxString& fileName)
+{
+    m_data = NULL;
+    m_size = 0;
+
+#ifdef __WXMSW__
+    //  Writers may append to a mapped file, as the compressed texture cache does
+    HANDLE hFile = CreateFileW(fileName.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                               NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(hFile == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(hFile, &size) || size.QuadPart == 0 ||
+       (unsigned long long)size.QuadPart > (size_t)-1) {
+        CloseHandle(hFile);
+        return;
+    }
+
+    HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+    if(!hMapping)
+        return;
+
+    void *data = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);                      // the view keeps the mapping alive
+    if(!data)
+        return;
+
+    m_data = (unsigned char *)data;
+    m_size = (size_t)size.QuadPart;
+#else
+    int fd = open(fileName.fn_str(), O_RDONLY);
+    if(fd < 0)
+        return;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0 ||
+       (unsigned long long)st.st_size > (size_t)-1) {
+        close(fd);
+        return;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);                                  // the mapping keeps the file alive
+    if(data == MAP_FAILED)
+        return;
+
+    m_data = (unsigned char *)data;
+    m_size = st.st_size;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    if(!m_data)
+        return;
+
+#ifdef __WXMSW__
+    UnmapViewOfFile(m_data);
+#else
+    munmap(m_data, m_size);
+#endif
+}
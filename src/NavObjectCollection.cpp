@@ -22,12 +22,26 @@
  ***************************************************************************
  */
 
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <wx/progdlg.h>
+#include <wx/stopwatch.h>
+#include <wx/thread.h>
+
 #include "NavObjectCollection.h"
 #include "routeman.h"
 #include "navutil.h"
 #include "Select.h"
 #include "Track.h"
 
+#ifdef USE_NAVOBJ_DB
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <SQLiteCpp/Backup.h>
+#endif
+
 extern WayPointman *pWayPointMan;
 extern Routeman    *g_pRouteMan;
 extern MyConfig    *pConfig;
@@ -53,7 +67,157 @@ NavObjectCollection1::~NavObjectCollection1()
 
 
 
-static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node, 
+//  The fields of a GPX <wpt> node, as read from the document.  Strings point into the
+//  document, and sym and guid are NULL where the file gives none.  Reading needs only
+//  pugixml, so the waypoints of a large file can be read on several threads before the
+//  RoutePoints are made.
+struct GPXWptRecord
+{
+    pugi::xml_node node;
+    double lat, lon;                            // lon normalized, as RoutePoint does
+    const char *sym, *time, *name, *desc, *type, *guid;
+    int viz, viz_name;                          // -1 if not given
+    bool auto_name, shared;
+    bool has_links;
+    const char *arrival_radius;
+    pugi::xml_node range_rings;
+
+    //  Duplicate detection key: the name, and the position on a GPX_DUP_QUANTUM grid
+    wxUint64 name_hash;
+    int cx, cy;
+};
+
+//  Waypoints closer than this in lat and lon, with the same name, are duplicates
+#define GPX_DUP_QUANTUM         1.e-6           // degrees
+
+//  Files with fewer waypoints than this are read on the calling thread only
+#define GPX_PARALLEL_MIN_WPTS   4096
+
+//  wxString::ToLong() for the flags of a waypoint, without leaving the document's UTF-8
+static bool GPXReadLong( const char *s, long &v )
+{
+    if( !*s )
+        return false;
+    char *end;
+    long r = strtol( s, &end, 10 );
+    if( *end )
+        return false;
+    v = r;
+    return true;
+}
+
+static int GPXReadFlag( pugi::xml_node node )
+{
+    long v = 0;
+    GPXReadLong( node.first_child().value(), v );
+    return v != 0;
+}
+
+static void GPXReadWaypoint( pugi::xml_node wpt_node, GPXWptRecord &rec )
+{
+    rec.node = wpt_node;
+    rec.lat = wpt_node.attribute( "lat" ).as_double();
+    rec.lon = wpt_node.attribute( "lon" ).as_double();
+    if( rec.lon < -180. ) rec.lon += 360.;
+    else
+        if( rec.lon > 180. ) rec.lon -= 360.;
+
+    rec.sym = NULL;
+    rec.guid = NULL;
+    rec.time = rec.name = rec.desc = rec.type = "";
+    rec.viz = rec.viz_name = -1;
+    rec.auto_name = rec.shared = false;
+    rec.has_links = false;
+    rec.arrival_radius = NULL;
+    rec.range_rings = pugi::xml_node();
+
+    for( pugi::xml_node child = wpt_node.first_child(); child != 0; child = child.next_sibling() ) {
+        const char *pcn = child.name();
+
+        if( !strcmp( pcn, "sym" ) )
+            rec.sym = child.first_child().value();
+        else if( !strcmp( pcn, "time") )
+            rec.time = child.first_child().value();
+        else if( !strcmp( pcn, "name") )
+            rec.name = child.first_child().value();
+        else if( !strcmp( pcn, "desc") )
+            rec.desc = child.first_child().value();
+        else if( !strcmp( pcn, "type") )
+            rec.type = child.first_child().value();
+        else if( !strcmp( pcn, "link") )
+            rec.has_links = true;
+
+    //    OpenCPN Extensions....
+        else if( !strcmp( pcn, "extensions") ) {
+            for( pugi::xml_node ext_child = child.first_child(); ext_child; ext_child = ext_child.next_sibling() ) {
+                const char *ext_name = ext_child.name();
+                if( !strcmp( ext_name, "opencpn:guid" ) )
+                    rec.guid = ext_child.first_child().value();
+                else if( !strcmp( ext_name, "opencpn:viz" ) )
+                    rec.viz = GPXReadFlag( ext_child );
+                else if( !strcmp( ext_name, "opencpn:viz_name" ) )
+                    rec.viz_name = GPXReadFlag( ext_child );
+                else if( !strcmp( ext_name, "opencpn:auto_name" ) )
+                    rec.auto_name = GPXReadFlag( ext_child );
+                else if( !strcmp( ext_name, "opencpn:shared" ) )
+                    rec.shared = GPXReadFlag( ext_child );
+                else if( !strcmp( ext_name, "opencpn:arrival_radius" ) )
+                    rec.arrival_radius = ext_child.first_child().value();
+                else if( !strcmp( ext_name, "opencpn:waypoint_range_rings" ) )
+                    rec.range_rings = ext_child;
+            }
+        }
+    }
+
+    //  64 bit FNV-1a of the name
+    wxUint64 hash = wxULL(14695981039346656037);
+    for( const char *p = rec.name; *p; p++ ) {
+        hash ^= (unsigned char) *p;
+        hash *= wxULL(1099511628211);
+    }
+    rec.name_hash = hash;
+    rec.cx = (int) floor( rec.lon / GPX_DUP_QUANTUM );
+    rec.cy = (int) floor( rec.lat / GPX_DUP_QUANTUM );
+}
+
+static void GPXReadWaypoints( const std::vector<pugi::xml_node> &nodes, std::vector<GPXWptRecord> &records,
+                              size_t first, size_t last )
+{
+    for( size_t i = first; i < last; i++ )
+        GPXReadWaypoint( nodes[i], records[i] );
+}
+
+//  Reads every <wpt> child of the gpx node, in document order.  Large files are split
+//  into runs of nodes read concurrently; the document is only read, which pugixml allows.
+static void GPXReadAllWaypoints( pugi::xml_node objects, std::vector<GPXWptRecord> &records )
+{
+    std::vector<pugi::xml_node> nodes;
+    for( pugi::xml_node object = objects.child( "wpt" ); object; object = object.next_sibling( "wpt" ) )
+        nodes.push_back( object );
+
+    records.resize( nodes.size() );
+
+    int nthreads = wxMin( wxThread::GetCPUCount(), 8 );
+    nthreads = wxMin( nthreads, (int) ( nodes.size() / GPX_PARALLEL_MIN_WPTS ) );
+    if( nthreads < 2 ) {
+        GPXReadWaypoints( nodes, records, 0, nodes.size() );
+        return;
+    }
+
+    size_t run = ( nodes.size() + nthreads - 1 ) / nthreads;
+    std::vector<std::thread> threads;
+    for( int i = 1; i < nthreads; i++ ) {
+        size_t first = wxMin( i * run, nodes.size() );
+        size_t last = wxMin( first + run, nodes.size() );
+        threads.push_back( std::thread( GPXReadWaypoints, std::cref( nodes ), std::ref( records ), first, last ) );
+    }
+    GPXReadWaypoints( nodes, records, 0, wxMin( run, nodes.size() ) );
+
+    for( unsigned int i = 0; i < threads.size(); i++ )
+        threads[i].join();
+}
+
+static RoutePoint * GPXCreateWaypoint( const GPXWptRecord &rec,
                                wxString def_symbol_name,
                                wxString GUID,
                                bool b_fullviz,
@@ -62,27 +226,12 @@ static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node,
                                int layer_id
                              )
 {
-    bool bviz = false;
-    bool bviz_name = false;
-    bool bauto_name = false;
-    bool bshared = false;
-    bool b_propvizname = false;
-    bool b_propviz = false;
-    bool bviz_waypointrangerings = false;
-
-    wxString SymString = def_symbol_name;       // default icon
-    wxString NameString;
-    wxString DescString;
-    wxString TypeString;
-    wxString GuidString = GUID;         // default
-    wxString TimeString;
-    wxDateTime dt;
+    wxString SymString = rec.sym ? wxString::FromUTF8( rec.sym ) : def_symbol_name;
+    wxString GuidString = rec.guid ? wxString::FromUTF8( rec.guid ) : GUID;
     RoutePoint *pWP;
     
     HyperlinkList *linklist = NULL;
 
-    double rlat = wpt_node.attribute( "lat" ).as_double();
-    double rlon = wpt_node.attribute( "lon" ).as_double();
     double ArrivalRadius = 0;
     int     l_iWaypointRangeRingsNumber = -1;
     float   l_fWaypointRangeRingsStep = -1;
@@ -91,33 +240,9 @@ static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node,
     wxColour    l_wxcWaypointRangeRingsColour;
     l_wxcWaypointRangeRingsColour.Set( _T( "#FFFFFF" ) );
 
-    for( pugi::xml_node child = wpt_node.first_child(); child != 0; child = child.next_sibling() ) {
-        const char *pcn = child.name();
-        
-        if( !strcmp( pcn, "sym" ) ) {
-            SymString = wxString::FromUTF8( child.first_child().value() );
-        }
-        else
-        if( !strcmp( pcn, "time") ) 
-            TimeString = wxString::FromUTF8( child.first_child().value() );
-
-        else
-        if( !strcmp( pcn, "name") ) {
-                NameString = wxString::FromUTF8( child.first_child().value() );
-        } 
-        
-        else
-        if( !strcmp( pcn, "desc") ) {
-                DescString = wxString::FromUTF8( child.first_child().value() );
-        }
-        
-        else
-        if( !strcmp( pcn, "type") ) {
-                TypeString = wxString::FromUTF8( child.first_child().value() );
-        }
-        
-        else              // Read hyperlink
-        if( !strcmp( pcn, "link") ) {
+    // Read hyperlinks
+    if( rec.has_links ) {
+        for( pugi::xml_node child = rec.node.child( "link" ); child; child = child.next_sibling( "link" ) ) {
             wxString HrefString;
             wxString HrefTextString;
             wxString HrefTypeString;
@@ -140,65 +265,23 @@ static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node,
             link->LType = HrefTypeString;
             linklist->Append( link );
         }
+    }
 
-    //    OpenCPN Extensions....
-        else
-        if( !strcmp( pcn, "extensions") ) {
-            for( pugi::xml_node ext_child = child.first_child(); ext_child; ext_child = ext_child.next_sibling() ) {
-                wxString ext_name = wxString::FromUTF8( ext_child.name() );
-                if( ext_name == _T ( "opencpn:guid" ) ) {
-                  GuidString = wxString::FromUTF8( ext_child.first_child().value() );
-                }
-                else
-                if( ext_name == _T ( "opencpn:viz" ) ) {
-                    b_propviz = true;
-                    wxString s = wxString::FromUTF8( ext_child.first_child().value() );
-                    long v = 0;
-                    if( s.ToLong( &v ) )
-                        bviz = ( v != 0 );
-                }
-                else
-                if( ext_name == _T ( "opencpn:viz_name" ) ) {
-                    b_propvizname = true;
-                    wxString s = wxString::FromUTF8( ext_child.first_child().value() );
-                    long v = 0;
-                    if( s.ToLong( &v ) )
-                        bviz_name = ( v != 0 );
-                }
-                else
-                if( ext_name == _T ( "opencpn:auto_name" ) ) {
-                    wxString s = wxString::FromUTF8( ext_child.first_child().value() );
-                    long v = 0;
-                    if( s.ToLong( &v ) )
-                        bauto_name = ( v != 0 );
-                }
-                else
-                if( ext_name  == _T ( "opencpn:shared" ) ) {
-                    wxString s = wxString::FromUTF8( ext_child.first_child().value() );
-                    long v = 0;
-                    if( s.ToLong( &v ) )
-                        bshared = ( v != 0 );
-                }
-                if( ext_name == _T ( "opencpn:arrival_radius" ) ) {
-                    wxString::FromUTF8(ext_child.first_child().value()).ToDouble(&ArrivalRadius ) ;
-                }
-                if ( ext_name == _T("opencpn:waypoint_range_rings") ) {
-                    for ( pugi::xml_attribute attr = ext_child.first_attribute(); attr; attr = attr.next_attribute() ) {
-                        if ( wxString::FromUTF8(attr.name()) == _T("number") )
-                            l_iWaypointRangeRingsNumber = attr.as_int();
-                        else if ( wxString::FromUTF8(attr.name()) == _T("step") )
-                            l_fWaypointRangeRingsStep = attr.as_float();
-                        else if ( wxString::FromUTF8(attr.name()) == _T("units") )
-                            l_pWaypointRangeRingsStepUnits = attr.as_int();
-                        else if ( wxString::FromUTF8(attr.name()) == _T("visible") )
-                            l_bWaypointRangeRingsVisible =  attr.as_bool();
-                        else if ( wxString::FromUTF8(attr.name()) == _T("colour") )
-                            l_wxcWaypointRangeRingsColour.Set( wxString::FromUTF8( attr.as_string() ) );
-                    }
-                }
-             }// for 
-        } //extensions
-    }   // for
+    if( rec.arrival_radius )
+        wxString::FromUTF8( rec.arrival_radius ).ToDouble( &ArrivalRadius );
+
+    for ( pugi::xml_attribute attr = rec.range_rings.first_attribute(); attr; attr = attr.next_attribute() ) {
+        if ( wxString::FromUTF8(attr.name()) == _T("number") )
+            l_iWaypointRangeRingsNumber = attr.as_int();
+        else if ( wxString::FromUTF8(attr.name()) == _T("step") )
+            l_fWaypointRangeRingsStep = attr.as_float();
+        else if ( wxString::FromUTF8(attr.name()) == _T("units") )
+            l_pWaypointRangeRingsStepUnits = attr.as_int();
+        else if ( wxString::FromUTF8(attr.name()) == _T("visible") )
+            l_bWaypointRangeRingsVisible =  attr.as_bool();
+        else if ( wxString::FromUTF8(attr.name()) == _T("colour") )
+            l_wxcWaypointRangeRingsColour.Set( wxString::FromUTF8( attr.as_string() ) );
+    }
 
     // Create waypoint
 
@@ -207,9 +290,9 @@ static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node,
             GuidString = pWayPointMan->CreateGUID(NULL);
     }
 
-    pWP = new RoutePoint( rlat, rlon, SymString, NameString, GuidString, false ); // do not add to global WP list yet...
-    pWP->m_MarkDescription = DescString;
-    pWP->m_bIsolatedMark = bshared;      // This is an isolated mark
+    pWP = new RoutePoint( rec.lat, rec.lon, SymString, wxString::FromUTF8( rec.name ), GuidString, false ); // do not add to global WP list yet...
+    pWP->m_MarkDescription = wxString::FromUTF8( rec.desc );
+    pWP->m_bIsolatedMark = rec.shared;      // This is an isolated mark
     pWP->SetWaypointArrivalRadius( ArrivalRadius );
     pWP->SetWaypointRangeRingsNumber( l_iWaypointRangeRingsNumber );
     pWP->SetWaypointRangeRingsStep( l_fWaypointRangeRingsStep );
@@ -217,16 +300,16 @@ static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node,
     pWP->SetShowWaypointRangeRings( l_bWaypointRangeRingsVisible );
     pWP->SetWaypointRangeRingsColour( l_wxcWaypointRangeRingsColour );
 
-    if( b_propvizname )
-        pWP->m_bShowName = bviz_name;
+    if( rec.viz_name >= 0 )
+        pWP->m_bShowName = ( rec.viz_name != 0 );
     else
         if( b_fullviz )
             pWP->m_bShowName = true;
         else
             pWP->m_bShowName = false;
 
-    if( b_propviz )
-        pWP->m_bIsVisible = bviz;
+    if( rec.viz >= 0 )
+        pWP->m_bIsVisible = ( rec.viz != 0 );
     else
         if( b_fullviz )
             pWP->m_bIsVisible = true;
@@ -238,11 +321,11 @@ static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node,
         pWP->SetListed( false );
     }
    
-    pWP->m_bKeepXRoute = bshared;
-    pWP->m_bDynamicName = bauto_name;
+    pWP->m_bKeepXRoute = rec.shared;
+    pWP->m_bDynamicName = rec.auto_name;
 
-    if(TimeString.Len()) {
-        pWP->m_timestring = TimeString;
+    if( *rec.time ) {
+        pWP->m_timestring = wxString::FromUTF8( rec.time );
         pWP->SetCreateTime(wxInvalidDateTime);          // cause deferred timestamp parsing
     }
         
@@ -255,9 +338,24 @@ static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node,
     return pWP ;
 }
 
-static TrackPoint * GPXLoadTrackPoint1( pugi::xml_node &wpt_node )
+static RoutePoint * GPXLoadWaypoint1( pugi::xml_node &wpt_node, 
+                               wxString def_symbol_name,
+                               wxString GUID,
+                               bool b_fullviz,
+                               bool b_layer,
+                               bool b_layerviz,
+                               int layer_id
+                             )
 {
-    wxString TimeString;
+    GPXWptRecord rec;
+    GPXReadWaypoint( wpt_node, rec );
+    return GPXCreateWaypoint( rec, def_symbol_name, GUID, b_fullviz, b_layer, b_layerviz, layer_id );
+}
+
+//  Track points go straight into the track's columns, no TrackPoint is made
+static void GPXLoadTrackPoint1( pugi::xml_node &wpt_node, Track *pTrack, int GPXSeg )
+{
+    const char *TimeString = NULL;
 
     double rlat = wpt_node.attribute( "lat" ).as_double();
     double rlon = wpt_node.attribute( "lon" ).as_double();
@@ -265,7 +363,7 @@ static TrackPoint * GPXLoadTrackPoint1( pugi::xml_node &wpt_node )
     for( pugi::xml_node child = wpt_node.first_child(); child != 0; child = child.next_sibling() ) {
         const char *pcn = child.name();
         if( !strcmp( pcn, "time") ) 
-            TimeString = wxString::FromUTF8( child.first_child().value() );
+            TimeString = child.first_child().value();
 
     //    OpenCPN Extensions....
         else
@@ -278,8 +376,7 @@ static TrackPoint * GPXLoadTrackPoint1( pugi::xml_node &wpt_node )
         } //extensions
     }   // for
 
-    // Create waypoint
-    return new TrackPoint( rlat, rlon, TimeString );
+    pTrack->AddGPXPoint( rlat, rlon, TimeString, GPXSeg );
 }
 
 static Track *GPXLoadTrack1( pugi::xml_node &trk_node, bool b_fullviz,
@@ -300,8 +397,6 @@ static Track *GPXLoadTrack1( pugi::xml_node &trk_node, bool b_fullviz,
         pTentTrack = new Track();
         GPXSeg = 0;   
         
-        TrackPoint *pWp = NULL;
-        
         for( pugi::xml_node tschild = trk_node.first_child(); tschild; tschild = tschild.next_sibling() ) {
             wxString ChildName = wxString::FromUTF8( tschild.name() );
             if( ChildName == _T ( "trkseg" ) ) {
@@ -309,12 +404,8 @@ static Track *GPXLoadTrack1( pugi::xml_node &trk_node, bool b_fullviz,
                 
                 //    Official GPX spec calls for trkseg to have children trkpt
                 for( pugi::xml_node tpchild = tschild.first_child(); tpchild; tpchild = tpchild.next_sibling() ) {
-                    wxString tpChildName = wxString::FromUTF8( tpchild.name() );
-                    if( tpChildName == _T("trkpt") ) {
-                        pWp = ::GPXLoadTrackPoint1(tpchild);
-                        pTentTrack->AddPoint( pWp );          // defer BBox calculation
-                        pWp->m_GPXTrkSegNo = GPXSeg;
-                    }
+                    if( !strcmp( tpchild.name(), "trkpt" ) )
+                        ::GPXLoadTrackPoint1( tpchild, pTentTrack, GPXSeg );    // defer BBox calculation
                 }
             }
             else
@@ -726,21 +817,21 @@ static bool GPXCreateWpt( pugi::xml_node node, RoutePoint *pr, unsigned int flag
     return true;
 }
 
-static bool GPXCreateTrkpt( pugi::xml_node node, TrackPoint *pt, unsigned int flags )
+static bool GPXCreateTrkpt( pugi::xml_node node, double lat, double lon, const char *time, unsigned int flags )
 {
     wxString s;
     pugi::xml_node child;
     pugi::xml_attribute attr;
     
-    s.Printf(_T("%.9f"), pt->m_lat);
+    s.Printf(_T("%.9f"), lat);
     node.append_attribute("lat") = s.mb_str();
-    s.Printf(_T("%.9f"), pt->m_lon);
+    s.Printf(_T("%.9f"), lon);
     node.append_attribute("lon") = s.mb_str();
  
     if(flags & OUT_TIME) {
         child = node.append_child("time");
-        if( pt->GetTimeString() )
-            child.append_child(pugi::node_pcdata).set_value(pt->GetTimeString());
+        if( time )
+            child.append_child(pugi::node_pcdata).set_value(time);
     }
     
     return true;
@@ -838,7 +929,7 @@ static bool GPXCreateTrk( pugi::xml_node node, Track *pTrack, unsigned int flags
         return true;
     
     int node2 = 0;
-    TrackPoint *prp;
+    char time[TRACKPOINT_TIME_LEN];
         
     unsigned short int GPXTrkSegNo1 = 1;
         
@@ -848,12 +939,12 @@ static bool GPXCreateTrk( pugi::xml_node node, Track *pTrack, unsigned int flags
         pugi::xml_node seg = node.append_child("trkseg");
         
         while( node2 < pTrack->GetnPoints() ) {
-            prp = pTrack->GetPoint(node2);
-            GPXTrkSegNo1 = prp->m_GPXTrkSegNo;
+            GPXTrkSegNo1 = pTrack->GetPointSegNo(node2);
             if(GPXTrkSegNo1 != GPXTrkSegNo2)
                 break;
             
-            GPXCreateTrkpt(seg.append_child("trkpt"), prp, OPT_TRACKPT);
+            GPXCreateTrkpt(seg.append_child("trkpt"), pTrack->GetPointLat(node2), pTrack->GetPointLon(node2),
+                           pTrack->GetPointTimeString(node2, time), OPT_TRACKPT);
             
             node2++;
         }
@@ -1052,19 +1143,7 @@ static bool InsertTrack( Track *pTentTrack, bool bApplyChanges = false )
             
         //    Add the selectable points and segments
                 
-        float prev_rlat = 0., prev_rlon = 0.;
-        TrackPoint *prev_pConfPoint = NULL;
-                
-        for(int i=0; i<pTentTrack->GetnPoints(); i++) {
-            TrackPoint *prp = pTentTrack->GetPoint(i);
-            
-            if( i ) pSelect->AddSelectableTrackSegment( prev_rlat, prev_rlon, prp->m_lat,
-                                                        prp->m_lon, prev_pConfPoint, prp, pTentTrack );
-                    
-            prev_rlat = prp->m_lat;
-            prev_rlon = prp->m_lon;
-            prev_pConfPoint = prp;
-        }
+        pSelect->AddAllSelectableTrackSegments( pTentTrack );
     } else
         delete pTentTrack;
     return bAddtrack;
@@ -1111,8 +1190,7 @@ static void UpdateRouteA( Route *pTentRoute )
 		RoutePoint *ex_rp = ::WaypointExists( prp->m_GUID );
 		if( ex_rp ) {
 			pSelect->DeleteSelectableRoutePoint(ex_rp);
-			ex_rp->m_lat = prp->m_lat;
-			ex_rp->m_lon = prp->m_lon;
+			ex_rp->SetPosition( prp->m_lat, prp->m_lon );
 			ex_rp->SetIconName( prp->GetIconName() );
 			ex_rp->m_MarkDescription = prp->m_MarkDescription;
 			ex_rp->SetName( prp->GetName() );
@@ -1300,33 +1378,102 @@ bool NavObjectCollection1::SaveFile( const wxString filename )
     return true;
 }
 
-bool NavObjectCollection1::LoadAllGPXObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox )
+//  Imports of more objects than this show a progress dialog
+#define GPX_IMPORT_PROGRESS_MIN 2000
+
+static wxUint64 GPXDupKey( wxUint64 name_hash, int cx, int cy )
+{
+    wxUint64 key = name_hash;
+    key ^= (wxUint64) (wxUint32) cx * wxULL(0x9E3779B97F4A7C15);
+    key ^= (wxUint64) (wxUint32) cy * wxULL(0xC2B2AE3D27D4EB4F);
+    return key;
+}
+
+bool NavObjectCollection1::LoadAllGPXObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox, bool b_progress )
 {
     wpt_duplicates = 0;
     pugi::xml_node objects = this->child("gpx");
     if (objects.first_child() == nullptr)
         return false;
+
+    wxStopWatch sw;
+
+    std::vector<GPXWptRecord> records;
+    GPXReadAllWaypoints( objects, records );
+
+    int count = records.size();
     for (pugi::xml_node object = objects.first_child(); object; object = object.next_sibling())
-    {
-        if( !strcmp(object.name(), "wpt") ) {
-            RoutePoint *pWp = ::GPXLoadWaypoint1( object, _T("circle"), _T(""), b_full_viz, false, false, 0 );
-            
-            pWp->m_bIsolatedMark = true;      // This is an isolated mark
-            RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon );
-            if( !pExisting ) {
-                    if( NULL != pWayPointMan )
-                        pWayPointMan->AddRoutePoint( pWp );
-                     pSelect->AddSelectableRoutePoint( pWp->m_lat, pWp->m_lon, pWp );
-                     LLBBox wptbox;
-                     wptbox.Set(pWp->m_lat, pWp->m_lon, pWp->m_lat, pWp->m_lon);
-                     BBox.Expand(wptbox);
-            }
-            else {
-                delete pWp;
-                wpt_duplicates++;
+        if( !strcmp(object.name(), "trk") || !strcmp(object.name(), "rte") )
+            count++;
+
+    wxProgressDialog *pprog = NULL;
+    if( b_progress && count > GPX_IMPORT_PROGRESS_MIN ) {
+        pprog = new wxProgressDialog( _("Import GPX file"), _T("0/0"), count, NULL,
+                                      wxPD_APP_MODAL | wxPD_SMOOTH |
+                                      wxPD_ELAPSED_TIME | wxPD_ESTIMATED_TIME | wxPD_REMAINING_TIME );
+        pprog->SetSize( 400, wxDefaultCoord );
+        pprog->Centre();
+    }
+
+    //  Waypoints first, added as one batch so that the file's routes find them.
+    //  A waypoint is a duplicate if one of the same name lies within GPX_DUP_QUANTUM,
+    //  either among those already loaded or earlier in this file.  The file's own are
+    //  hashed by name and grid cell; a match may lie in a neighbouring cell.
+    std::vector<RoutePoint *> added;
+    added.reserve( records.size() );
+    std::unordered_multimap<wxUint64, size_t> added_keys;
+    added_keys.reserve( records.size() );
+
+    int ic = 0;
+    for( size_t i = 0; i < records.size(); i++, ic++ ) {
+        if( pprog && !( ic % 256 ) ) {
+            wxString msg;
+            msg.Printf(_T("%d/%d"), ic, count);
+            pprog->Update( ic, msg );
+        }
+
+        const GPXWptRecord &rec = records[i];
+
+        bool b_dup = false;
+        for( int dy = -1; dy <= 1 && !b_dup; dy++ ) {
+            for( int dx = -1; dx <= 1 && !b_dup; dx++ ) {
+                typedef std::unordered_multimap<wxUint64, size_t>::const_iterator KeyIter;
+                std::pair<KeyIter, KeyIter> range = added_keys.equal_range( GPXDupKey( rec.name_hash, rec.cx + dx, rec.cy + dy ) );
+                for( KeyIter it = range.first; it != range.second; ++it ) {
+                    const GPXWptRecord &other = records[it->second];
+                    if( fabs( rec.lat - other.lat ) < GPX_DUP_QUANTUM && fabs( rec.lon - other.lon ) < GPX_DUP_QUANTUM
+                        && !strcmp( rec.name, other.name ) ) {
+                        b_dup = true;
+                        break;
+                    }
+                }
             }
         }
-        else if( !strcmp(object.name(), "trk") ) {
+        if( !b_dup )
+            b_dup = ( WaypointExists( wxString::FromUTF8( rec.name ), rec.lat, rec.lon ) != NULL );
+
+        if( b_dup ) {
+            wpt_duplicates++;
+            continue;
+        }
+
+        RoutePoint *pWp = GPXCreateWaypoint( rec, _T("circle"), _T(""), b_full_viz, false, false, 0 );
+        pWp->m_bIsolatedMark = true;      // This is an isolated mark
+        added.push_back( pWp );
+        added_keys.insert( std::make_pair( GPXDupKey( rec.name_hash, rec.cx, rec.cy ), i ) );
+
+        LLBBox wptbox;
+        wptbox.Set(pWp->m_lat, pWp->m_lon, pWp->m_lat, pWp->m_lon);
+        BBox.Expand(wptbox);
+    }
+
+    if( NULL != pWayPointMan )
+        pWayPointMan->AddRoutePoints( added );
+    pSelect->AddSelectableRoutePoints( added );
+
+    for (pugi::xml_node object = objects.first_child(); object; object = object.next_sibling())
+    {
+        if( !strcmp(object.name(), "trk") ) {
             Track *pTrack = GPXLoadTrack1( object, b_full_viz, false, false, 0);
             if (InsertTrack( pTrack ) && b_compute_bbox && pTrack->IsVisible()) {
                         //BBox.Expand(pTrack->GetBBox());
@@ -1339,7 +1486,21 @@ bool NavObjectCollection1::LoadAllGPXObjects( bool b_full_viz, int &wpt_duplicat
                 BBox.Expand(pRoute->GetBBox());
             }
         }
+        else
+            continue;
+
+        ic++;
+        if( pprog ) {
+            wxString msg;
+            msg.Printf(_T("%d/%d"), ic, count);
+            pprog->Update( ic, msg );
+        }
     }
+
+    delete pprog;
+
+    wxLogMessage( _T("GPX load: %d waypoints (%d duplicates), %d routes and tracks in %ld ms"),
+                  (int) records.size(), wpt_duplicates, count - (int) records.size(), sw.Time() );
     
     return true;
 }
@@ -1349,20 +1510,24 @@ int NavObjectCollection1::LoadAllGPXObjectsAsLayer(int layer_id, bool b_layerviz
     if(!pWayPointMan)
         return 0;
     
-    int n_obj = 0;
     pugi::xml_node objects = this->child("gpx");
+
+    //  Layer waypoints are not checked for duplicates
+    std::vector<GPXWptRecord> records;
+    GPXReadAllWaypoints( objects, records );
+
+    std::vector<RoutePoint *> added( records.size() );
+    for( size_t i = 0; i < records.size(); i++ ) {
+        added[i] = GPXCreateWaypoint( records[i], _T("circle"), _T(""), true, true, b_layerviz, layer_id );
+        added[i]->m_bIsolatedMark = true;      // This is an isolated mark
+    }
+    pWayPointMan->AddRoutePoints( added );
+    pSelect->AddSelectableRoutePoints( added );
+
+    int n_obj = added.size();
     
     for (pugi::xml_node object = objects.first_child(); object; object = object.next_sibling())
     {
-        if( !strcmp(object.name(), "wpt") ) {
-            RoutePoint *pWp = ::GPXLoadWaypoint1( object, _T("circle"), _T(""), true, true, b_layerviz, layer_id );
-            
-            pWp->m_bIsolatedMark = true;      // This is an isolated mark
-            pWayPointMan->AddRoutePoint( pWp );
-            pSelect->AddSelectableRoutePoint( pWp->m_lat, pWp->m_lon, pWp );
-            n_obj++;
-        }
-        else{
             if( !strcmp(object.name(), "trk") ) {
                 Track *pTrack = GPXLoadTrack1( object, false, true, b_layerviz, layer_id);
                 n_obj++;
@@ -1374,7 +1539,6 @@ int NavObjectCollection1::LoadAllGPXObjectsAsLayer(int layer_id, bool b_layerviz
                     n_obj++;
                     InsertRouteA( pRoute );
                 }
-        }   
     }
     
     return n_obj;
@@ -1463,12 +1627,18 @@ void NavObjectChanges::AddWP( RoutePoint *pWP, const char *action )
     fflush(m_changes_file);
 }
 
-void NavObjectChanges::AddTrackPoint( TrackPoint *pWP, const char *action, const wxString& parent_GUID )
+void NavObjectChanges::AddTrackPoint( Track *pTrack, int index, const char *action )
 {
+    //  ApplyChanges replays only the points added
+    if( strcmp( action, "add" ) )
+        return;
+
     SetRootGPXNode();
     
+    char time[TRACKPOINT_TIME_LEN];
     pugi::xml_node object = m_gpx_root.append_child("tkpt");
-    GPXCreateTrkpt(object, pWP, OPT_TRACKPT);
+    GPXCreateTrkpt(object, pTrack->GetPointLat(index), pTrack->GetPointLon(index),
+                   pTrack->GetPointTimeString(index, time), OPT_TRACKPT);
 
     pugi::xml_node xchild = object.append_child("extensions");
     
@@ -1476,7 +1646,7 @@ void NavObjectChanges::AddTrackPoint( TrackPoint *pWP, const char *action, const
     child.append_child(pugi::node_pcdata).set_value(action);
     
     pugi::xml_node gchild = xchild.append_child("opencpn:track_GUID");
-    gchild.append_child(pugi::node_pcdata).set_value(parent_GUID.mb_str());
+    gchild.append_child(pugi::node_pcdata).set_value(pTrack->m_GUID.mb_str());
 
     pugi::xml_writer_file writer(m_changes_file);
     object.print(writer, " ");
@@ -1584,10 +1754,6 @@ bool NavObjectChanges::ApplyChanges(void)
                 }
             else
                 if( !strcmp(object.name(), "tkpt") && pWayPointMan) {
-                    TrackPoint *pWp = ::GPXLoadTrackPoint1( object );
-                    
-//                        RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon );
-                        
                     pugi::xml_node xchild = object.child("extensions");
                     pugi::xml_node child = xchild.child("opencpn:action");
 
@@ -1596,12 +1762,8 @@ bool NavObjectChanges::ApplyChanges(void)
 
                     Track *pExistingTrack = TrackExists( track_GUID );
                         
-                    if(!strcmp(child.first_child().value(), "add") && pExistingTrack ) {
-                        pExistingTrack->AddPoint( pWp );
-                        pWp->m_GPXTrkSegNo = pExistingTrack->GetCurrentTrackSeg() + 1;
-                    }
-                    else
-                        delete pWp;
+                    if(!strcmp(child.first_child().value(), "add") && pExistingTrack )
+                        ::GPXLoadTrackPoint1( object, pExistingTrack, pExistingTrack->GetCurrentTrackSeg() + 1 );
                 }
 
         object = object.next_sibling();
@@ -1621,3 +1783,590 @@ bool NavObjectChanges::ApplyChanges(void)
     
     return true;
 }
+
+
+#ifdef USE_NAVOBJ_DB
+
+//----------------------------------------------------------------------------------
+//      NavObjectStore Implementation
+//----------------------------------------------------------------------------------
+
+//  Object kinds, in the order the rows are loaded: routes after the
+//  waypoints they may share
+#define STORE_WPT       0
+#define STORE_RTE       1
+#define STORE_TRK       2
+
+//  PRAGMA user_version of a store that has been filled; a new database reads 0
+#define NAVOBJ_STORE_VERSION    1
+
+class GPXTextWriter : public pugi::xml_writer
+{
+public:
+    virtual void write( const void *data, size_t size ) { m_text.append( (const char *) data, size ); }
+
+    std::string m_text;
+};
+
+static std::string GPXNodeText( pugi::xml_node node )
+{
+    GPXTextWriter writer;
+    node.print( writer, "", pugi::format_raw );
+    return writer.m_text;
+}
+
+//  64 bit FNV-1a, to tell an object's GPX from what its row holds
+static wxUint64 GPXTextHash( const std::string &text )
+{
+    wxUint64 hash = wxULL(14695981039346656037);
+    for( size_t i = 0; i < text.size(); i++ ) {
+        hash ^= (unsigned char) text[i];
+        hash *= wxULL(1099511628211);
+    }
+    return hash;
+}
+
+static std::string StoreGUID( const wxString &guid )
+{
+    return std::string( guid.ToUTF8().data() );
+}
+
+//  Savepoints rather than transactions, so they nest: a track written from
+//  a hook commits by itself, and within Sync commits with the rest
+class StoreSavepoint
+{
+public:
+    StoreSavepoint( SQLite::Database &db ) : m_db( db ), m_released( false ) { m_db.exec( "SAVEPOINT navobj" ); }
+    ~StoreSavepoint()
+    {
+        if( !m_released ) {
+            try {
+                m_db.exec( "ROLLBACK TO navobj" );
+                m_db.exec( "RELEASE navobj" );
+            }
+            catch( ... ) {
+            }
+        }
+    }
+    void Release() { m_db.exec( "RELEASE navobj" ); m_released = true; }
+
+private:
+    SQLite::Database    &m_db;
+    bool                m_released;
+};
+
+static void LogStoreError( const char *what, std::exception &e )
+{
+    wxLogMessage( _T("NavObjectStore: %s failed, %s"), wxString( what, wxConvUTF8 ).c_str(),
+                  wxString( e.what(), wxConvUTF8 ).c_str() );
+}
+
+NavObjectStore::NavObjectStore( wxString file_name )
+    : NavObjectChanges()
+{
+    m_db = NULL;
+
+    try {
+        m_db = new SQLite::Database( (const char *) file_name.mb_str(), SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE );
+
+        //  A write ahead log keeps each small edit from syncing the whole file;
+        //  a crash loses nothing committed, a power cut at most the last edits
+        m_db->exec( "PRAGMA journal_mode = WAL" );
+        m_db->exec( "PRAGMA synchronous = NORMAL" );
+
+        m_db->exec( "CREATE TABLE IF NOT EXISTS objects ("
+                    " id INTEGER PRIMARY KEY,"
+                    " guid TEXT NOT NULL UNIQUE,"
+                    " kind INTEGER NOT NULL,"
+                    " gpx TEXT NOT NULL )" );
+        m_db->exec( "CREATE TABLE IF NOT EXISTS trackpoints ("
+                    " track INTEGER NOT NULL,"
+                    " seq INTEGER NOT NULL,"
+                    " lat REAL NOT NULL,"
+                    " lon REAL NOT NULL,"
+                    " time TEXT,"
+                    " seg INTEGER NOT NULL,"
+                    " PRIMARY KEY ( track, seq ) ) WITHOUT ROWID" );
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "open", e );
+        delete m_db;
+        m_db = NULL;
+    }
+}
+
+NavObjectStore::~NavObjectStore()
+{
+    delete m_db;
+}
+
+bool NavObjectStore::IsNew()
+{
+    try {
+        return m_db->execAndGet( "PRAGMA user_version" ).getInt() == 0;
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "version", e );
+    }
+    return true;
+}
+
+//  Moves everything committed in the write ahead log into the database file
+void NavObjectStore::Checkpoint()
+{
+    if( !m_db )
+        return;
+    try {
+        m_db->exec( "PRAGMA wal_checkpoint(TRUNCATE)" );
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "checkpoint", e );
+    }
+}
+
+//  Writes a self contained copy of the store to file_name, with the SQLite online backup,
+//  rather than copying a database file whose latest edits may still be in the log
+bool NavObjectStore::Backup( const wxString &file_name )
+{
+    if( !m_db )
+        return false;
+    try {
+        SQLite::Database dest( (const char *) file_name.mb_str(), SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE );
+        {
+            SQLite::Backup backup( dest, *m_db );
+            backup.executeStep();
+            if( backup.getRemainingPageCount() != 0 )
+                return false;
+        }
+        //  The copy takes the store's WAL mode; a backup is better as one file
+        dest.exec( "PRAGMA journal_mode = DELETE" );
+        return true;
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "backup", e );
+    }
+    return false;
+}
+
+void NavObjectStore::PutObject( const std::string &guid, int kind, const std::string &gpx )
+{
+    wxUint64 hash = GPXTextHash( gpx );
+
+    std::map<std::string, NavObjectStoreEntry>::iterator it = m_stored.find( guid );
+    if( it != m_stored.end() && it->second.kind == kind && it->second.hash == hash )
+        return;
+
+    SQLite::Statement update( *m_db, "UPDATE objects SET kind = ?2, gpx = ?3 WHERE guid = ?1" );
+    update.bind( 1, guid );
+    update.bind( 2, kind );
+    update.bind( 3, gpx );
+    if( update.exec() ) {
+        m_stored[guid].kind = kind;
+        m_stored[guid].hash = hash;
+        return;
+    }
+
+    SQLite::Statement insert( *m_db, "INSERT INTO objects ( guid, kind, gpx ) VALUES ( ?1, ?2, ?3 )" );
+    insert.bind( 1, guid );
+    insert.bind( 2, kind );
+    insert.bind( 3, gpx );
+    insert.exec();
+
+    NavObjectStoreEntry entry;
+    entry.id = m_db->getLastInsertRowid();
+    entry.kind = kind;
+    entry.hash = hash;
+    entry.track = NULL;
+    entry.revision = 0;
+    entry.nPoints = 0;
+    entry.next_seq = 0;
+    m_stored[guid] = entry;
+}
+
+//  Forgets what the object's rows hold, after a failed write may have left
+//  them other than recorded, so the next write of it goes through whole
+void NavObjectStore::Invalidate( const std::string &guid )
+{
+    std::map<std::string, NavObjectStoreEntry>::iterator it = m_stored.find( guid );
+    if( it != m_stored.end() ) {
+        it->second.hash = 0;
+        it->second.track = NULL;
+    }
+}
+
+void NavObjectStore::DeleteObject( const std::string &guid )
+{
+    std::map<std::string, NavObjectStoreEntry>::iterator it = m_stored.find( guid );
+    if( it == m_stored.end() )
+        return;
+
+    StoreSavepoint savepoint( *m_db );
+
+    SQLite::Statement del( *m_db, "DELETE FROM objects WHERE guid = ?" );
+    del.bind( 1, guid );
+    del.exec();
+
+    if( it->second.kind == STORE_TRK ) {
+        SQLite::Statement delpoints( *m_db, "DELETE FROM trackpoints WHERE track = ?" );
+        delpoints.bind( 1, (long long) it->second.id );
+        delpoints.exec();
+    }
+
+    savepoint.Release();
+    m_stored.erase( it );
+}
+
+//  Writes the track's header row, and its points too if the rows do not
+//  already hold this revision of them
+void NavObjectStore::PutTrack( Track *pTrack )
+{
+    std::string guid = StoreGUID( pTrack->m_GUID );
+
+    pugi::xml_document doc;
+    pugi::xml_node node = doc.append_child( "trk" );
+    GPXCreateTrk( node, pTrack, RT_OUT_NO_RTPTS );
+
+    StoreSavepoint savepoint( *m_db );
+
+    PutObject( guid, STORE_TRK, GPXNodeText( node ) );
+
+    NavObjectStoreEntry &entry = m_stored[guid];
+    if( entry.track != pTrack || entry.revision != pTrack->GetRevision() )
+        WriteTrackPoints( pTrack, entry );
+
+    savepoint.Release();
+}
+
+void NavObjectStore::WriteTrackPoints( Track *pTrack, NavObjectStoreEntry &entry )
+{
+    SQLite::Statement del( *m_db, "DELETE FROM trackpoints WHERE track = ?" );
+    del.bind( 1, (long long) entry.id );
+    del.exec();
+
+    SQLite::Statement insert( *m_db, "INSERT INTO trackpoints ( track, seq, lat, lon, time, seg )"
+                                     " VALUES ( ?1, ?2, ?3, ?4, ?5, ?6 )" );
+    insert.bind( 1, (long long) entry.id );         // bindings outlive reset()
+
+    char time[TRACKPOINT_TIME_LEN];
+    int n = pTrack->GetnPoints();
+    for( int i = 0; i < n; i++ ) {
+        insert.bind( 2, i );
+        insert.bind( 3, pTrack->GetPointLat( i ) );
+        insert.bind( 4, pTrack->GetPointLon( i ) );
+        const char *ts = pTrack->GetPointTimeString( i, time );
+        if( ts )
+            insert.bind( 5, ts );
+        else
+            insert.bind( 5 );
+        insert.bind( 6, pTrack->GetPointSegNo( i ) );
+        insert.exec();
+        insert.reset();
+    }
+
+    entry.track = pTrack;
+    entry.revision = pTrack->GetRevision();
+    entry.nPoints = n;
+    entry.next_seq = n;
+}
+
+void NavObjectStore::AddRoute( Route *pr, const char *action )
+{
+    try {
+        if( !strcmp( action, "delete" ) )
+            DeleteObject( StoreGUID( pr->m_GUID ) );
+        else if( !pr->m_bIsInLayer && !pr->m_btemp ) {
+            pugi::xml_document doc;
+            pugi::xml_node node = doc.append_child( "rte" );
+            GPXCreateRoute( node, pr );
+            PutObject( StoreGUID( pr->m_GUID ), STORE_RTE, GPXNodeText( node ) );
+        }
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "route", e );
+        Invalidate( StoreGUID( pr->m_GUID ) );
+    }
+}
+
+void NavObjectStore::AddTrack( Track *pr, const char *action )
+{
+    try {
+        if( !strcmp( action, "delete" ) )
+            DeleteObject( StoreGUID( pr->m_GUID ) );
+        else if( !pr->m_bIsInLayer && !pr->m_btemp )
+            PutTrack( pr );
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "track", e );
+        Invalidate( StoreGUID( pr->m_GUID ) );
+    }
+}
+
+void NavObjectStore::AddWP( RoutePoint *pWP, const char *action )
+{
+    if( pWP->m_bIsInLayer || pWP->m_btemp )
+        return;
+
+    try {
+        if( !strcmp( action, "delete" ) )
+            DeleteObject( StoreGUID( pWP->m_GUID ) );
+        else if( pWP->m_bIsolatedMark ) {
+            pugi::xml_document doc;
+            pugi::xml_node node = doc.append_child( "wpt" );
+            GPXCreateWpt( node, pWP, OPT_WPT );
+            PutObject( StoreGUID( pWP->m_GUID ), STORE_WPT, GPXNodeText( node ) );
+        }
+        else if( g_pRouteMan ) {
+            //  A route's points are kept in the route's row
+            wxArrayPtrVoid *pRouteArray = g_pRouteMan->GetRouteArrayContaining( pWP );
+            if( pRouteArray ) {
+                for( unsigned int i = 0; i < pRouteArray->GetCount(); i++ )
+                    AddRoute( (Route *) pRouteArray->Item( i ), "update" );
+                delete pRouteArray;
+            }
+        }
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "waypoint", e );
+        Invalidate( StoreGUID( pWP->m_GUID ) );
+    }
+}
+
+//  Points are rows in the order of their seq, appended at the end.  A point
+//  updated or deleted is found by counting back from the last, which is cheap
+//  for the active track: it only changes its newest points.
+void NavObjectStore::AddTrackPoint( Track *pTrack, int index, const char *action )
+{
+    if( pTrack->m_bIsInLayer || pTrack->m_btemp )
+        return;
+
+    std::string guid = StoreGUID( pTrack->m_GUID );
+
+    //  A track not stored yet is written whole by AddTrack(), or by Sync().  Writing it
+    //  here would rewrite every row for each point of a track being filled.
+    std::map<std::string, NavObjectStoreEntry>::iterator it = m_stored.find( guid );
+    if( it == m_stored.end() )
+        return;
+
+    try {
+        //  The rows follow the track one change at a time; if it has changed
+        //  some other way since they were written, write it whole
+        if( it->second.track != pTrack
+            || it->second.revision + 1 != pTrack->GetRevision() ) {
+            PutTrack( pTrack );
+            return;
+        }
+        NavObjectStoreEntry &entry = it->second;
+
+        char time[TRACKPOINT_TIME_LEN];
+
+        if( !strcmp( action, "add" ) && index == entry.nPoints ) {
+            SQLite::Statement insert( *m_db, "INSERT INTO trackpoints ( track, seq, lat, lon, time, seg )"
+                                             " VALUES ( ?1, ?2, ?3, ?4, ?5, ?6 )" );
+            insert.bind( 1, (long long) entry.id );
+            insert.bind( 2, (long long) entry.next_seq );
+            insert.bind( 3, pTrack->GetPointLat( index ) );
+            insert.bind( 4, pTrack->GetPointLon( index ) );
+            const char *ts = pTrack->GetPointTimeString( index, time );
+            if( ts )
+                insert.bind( 5, ts );
+            else
+                insert.bind( 5 );
+            insert.bind( 6, pTrack->GetPointSegNo( index ) );
+            insert.exec();
+
+            entry.next_seq++;
+            entry.nPoints++;
+        }
+        else if( !strcmp( action, "update" ) && index >= 0 && index < entry.nPoints ) {
+            SQLite::Statement update( *m_db, "UPDATE trackpoints SET lat = ?2, lon = ?3, time = ?4"
+                                             " WHERE track = ?1 AND seq = ( SELECT seq FROM trackpoints"
+                                             " WHERE track = ?1 ORDER BY seq DESC LIMIT 1 OFFSET ?5 )" );
+            update.bind( 1, (long long) entry.id );
+            update.bind( 2, pTrack->GetPointLat( index ) );
+            update.bind( 3, pTrack->GetPointLon( index ) );
+            const char *ts = pTrack->GetPointTimeString( index, time );
+            if( ts )
+                update.bind( 4, ts );
+            else
+                update.bind( 4 );
+            update.bind( 5, entry.nPoints - 1 - index );
+            update.exec();
+        }
+        else if( !strcmp( action, "delete" ) && index >= 0 && index < entry.nPoints ) {
+            SQLite::Statement del( *m_db, "DELETE FROM trackpoints"
+                                          " WHERE track = ?1 AND seq = ( SELECT seq FROM trackpoints"
+                                          " WHERE track = ?1 ORDER BY seq DESC LIMIT 1 OFFSET ?2 )" );
+            del.bind( 1, (long long) entry.id );
+            del.bind( 2, entry.nPoints - 1 - index );
+            del.exec();
+
+            entry.nPoints--;
+        }
+        else {
+            PutTrack( pTrack );
+            return;
+        }
+
+        entry.revision = pTrack->GetRevision();
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "track point", e );
+        Invalidate( guid );
+    }
+}
+
+//  Brings the rows up to date with the objects in memory, writing only those
+//  that differ; it catches changes made without a hook, and objects gone.
+bool NavObjectStore::Sync()
+{
+    if( !m_db )
+        return false;
+
+    wxStopWatch sw;
+    std::set<std::string> live;
+
+    try {
+        StoreSavepoint savepoint( *m_db );
+
+        if( pWayPointMan ) {
+            wxRoutePointListNode *node = pWayPointMan->GetWaypointList()->GetFirst();
+            while( node ) {
+                RoutePoint *pr = node->GetData();
+                if( ( pr->m_bIsolatedMark ) && !( pr->m_bIsInLayer ) && !( pr->m_btemp ) ) {
+                    pugi::xml_document doc;
+                    pugi::xml_node wpt = doc.append_child( "wpt" );
+                    GPXCreateWpt( wpt, pr, OPT_WPT );
+                    std::string guid = StoreGUID( pr->m_GUID );
+                    PutObject( guid, STORE_WPT, GPXNodeText( wpt ) );
+                    live.insert( guid );
+                }
+                node = node->GetNext();
+            }
+        }
+
+        wxRouteListNode *node1 = pRouteList->GetFirst();
+        while( node1 ) {
+            Route *pRoute = node1->GetData();
+            if( !pRoute->m_bIsInLayer && !pRoute->m_btemp ) {
+                pugi::xml_document doc;
+                pugi::xml_node rte = doc.append_child( "rte" );
+                GPXCreateRoute( rte, pRoute );
+                std::string guid = StoreGUID( pRoute->m_GUID );
+                PutObject( guid, STORE_RTE, GPXNodeText( rte ) );
+                live.insert( guid );
+            }
+            node1 = node1->GetNext();
+        }
+
+        wxTrackListNode *node2 = pTrackList->GetFirst();
+        while( node2 ) {
+            Track *pTrack = node2->GetData();
+            if( pTrack->GetnPoints() && !pTrack->m_bIsInLayer && !pTrack->m_btemp ) {
+                PutTrack( pTrack );
+                live.insert( StoreGUID( pTrack->m_GUID ) );
+            }
+            node2 = node2->GetNext();
+        }
+
+        std::vector<std::string> gone;
+        for( std::map<std::string, NavObjectStoreEntry>::iterator it = m_stored.begin(); it != m_stored.end(); ++it )
+            if( !live.count( it->first ) )
+                gone.push_back( it->first );
+        for( size_t i = 0; i < gone.size(); i++ )
+            DeleteObject( gone[i] );
+
+        char pragma[40];
+        snprintf( pragma, sizeof(pragma), "PRAGMA user_version = %d", NAVOBJ_STORE_VERSION );
+        m_db->exec( pragma );
+
+        savepoint.Release();
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "sync", e );
+
+        //  What was written went with the savepoint
+        for( std::map<std::string, NavObjectStoreEntry>::iterator it = m_stored.begin(); it != m_stored.end(); ++it )
+            Invalidate( it->first );
+        return false;
+    }
+
+    wxLogMessage( _T("NavObjectStore: synced %d objects in %ld ms"), (int) live.size(), sw.Time() );
+    return true;
+}
+
+//  Loads every stored object, as LoadAllGPXObjects does a navobj.xml.  Rows are
+//  unique by GUID, so no search for duplicate waypoints is made.
+int NavObjectStore::LoadAllObjects()
+{
+    int n_obj = 0;
+    wxStopWatch sw;
+
+    try {
+        SQLite::Statement query( *m_db, "SELECT guid, kind, gpx, id FROM objects ORDER BY kind, id" );
+        SQLite::Statement points( *m_db, "SELECT lat, lon, time, seg, seq FROM trackpoints WHERE track = ? ORDER BY seq" );
+
+        while( query.executeStep() ) {
+            std::string guid = query.getColumn( 0 ).getString();
+            int kind = query.getColumn( 1 ).getInt();
+            SQLite::Column gpx = query.getColumn( 2 );
+
+            NavObjectStoreEntry entry;
+            entry.id = query.getColumn( 3 ).getInt64();
+            entry.kind = kind;
+            entry.hash = GPXTextHash( std::string( gpx.getText(), gpx.getBytes() ) );
+            entry.track = NULL;
+            entry.revision = 0;
+            entry.nPoints = 0;
+            entry.next_seq = 0;
+
+            pugi::xml_document doc;
+            if( doc.load_buffer( gpx.getText(), gpx.getBytes() ) ) {
+                pugi::xml_node object = doc.first_child();
+
+                if( kind == STORE_WPT && !strcmp( object.name(), "wpt" ) ) {
+                    RoutePoint *pWp = ::GPXLoadWaypoint1( object, _T("circle"), _T(""), false, false, false, 0 );
+                    pWp->m_bIsolatedMark = true;      // This is an isolated mark
+                    if( NULL != pWayPointMan )
+                        pWayPointMan->AddRoutePoint( pWp );
+                    pSelect->AddSelectableRoutePoint( pWp->m_lat, pWp->m_lon, pWp );
+                }
+                else if( kind == STORE_RTE && !strcmp( object.name(), "rte" ) ) {
+                    Route *pRoute = GPXLoadRoute1( object, false, false, false, 0, false );
+                    InsertRouteA( pRoute );
+                }
+                else if( kind == STORE_TRK && !strcmp( object.name(), "trk" ) ) {
+                    Track *pTrack = GPXLoadTrack1( object, false, false, false, 0 );
+
+                    int segno = 0;
+                    points.bind( 1, (long long) entry.id );
+                    while( points.executeStep() ) {
+                        segno = points.getColumn( 3 ).getInt();
+                        SQLite::Column time = points.getColumn( 2 );
+                        pTrack->AddGPXPoint( points.getColumn( 0 ).getDouble(), points.getColumn( 1 ).getDouble(),
+                                             time.isNull() ? NULL : time.getText(), segno );
+                        entry.next_seq = points.getColumn( 4 ).getInt64() + 1;
+                    }
+                    points.reset();
+                    pTrack->SetCurrentTrackSeg( segno );
+
+                    entry.revision = pTrack->GetRevision();
+                    entry.nPoints = pTrack->GetnPoints();
+                    if( InsertTrack( pTrack ) )
+                        entry.track = pTrack;
+                }
+            }
+
+            //  Rows that did not load stay known, so Sync deletes them
+            m_stored[guid] = entry;
+            n_obj++;
+        }
+    }
+    catch( std::exception &e ) {
+        LogStoreError( "load", e );
+    }
+
+    wxLogMessage( _T("NavObjectStore: loaded %d objects in %ld ms"), n_obj, sw.Time() );
+    return n_obj;
+}
+
+#endif
@@ -22,50 +22,109 @@
  ***************************************************************************
  */
 
+#include <string.h>
+
 #include "OCPN_DataStreamEvent.h"
+#include "datastream.h"
 
 OCPN_DataStreamEvent::OCPN_DataStreamEvent(wxEventType commandType, int id)
       :wxEvent(id, commandType)
 {
     m_pDataStream = NULL;
+    memset(&m_header, 0, sizeof m_header);
 }
 
 OCPN_DataStreamEvent::~OCPN_DataStreamEvent()
 {
 }
 
+void OCPN_DataStreamEvent::SetNMEAString(std::string string)
+{
+    m_NMEAstring = std::make_shared<const std::string>(std::move(string));
+    Classify();
+}
+
+const std::string &OCPN_DataStreamEvent::GetNMEAString() const
+{
+    static const std::string empty;
+    return m_NMEAstring ? *m_NMEAstring : empty;
+}
+
+//  As DataStream::ChecksumOK(), but with the checksum worked out in Classify().
+//  Sentences with no stream, as from PlugIns, are always checked.
+bool OCPN_DataStreamEvent::ChecksumOK()
+{
+    if(m_pDataStream && !m_pDataStream->GetChecksumCheck())
+        return true;
+
+    return m_header.checksum_ok;
+}
+
+size_t OCPN_DataStreamEvent::GetBatchCount() const
+{
+    return m_batch ? m_batch->events.size() : 0;
+}
+
+OCPN_DataStreamEvent &OCPN_DataStreamEvent::GetBatchItem( size_t i )
+{
+    return m_batch->events[i];
+}
+
+//----------------------------------------------------------------------------------
+//     Fill in the sentence header, once, in whichever thread made the event
+//----------------------------------------------------------------------------------
+void OCPN_DataStreamEvent::Classify()
+{
+    const std::string &str = *m_NMEAstring;
+    size_t len = str.size();
+
+    memset(&m_header, 0, sizeof m_header);
+
+    //  Skip the NMEA V4 tag block, exactly as ProcessNMEA4Tags() always has
+    size_t idxFirst = str.find('\\');
+    if(idxFirst != std::string::npos && idxFirst + 1 < len){
+        size_t idxNext = str.find('\\', idxFirst + 1);
+        size_t idxSecond = (idxNext == std::string::npos) ? 0 : idxNext - idxFirst;
+        if(idxSecond + 1 < len)
+            m_header.offset = idxSecond + 1;
+    }
+
+    const char *sentence = str.c_str() + m_header.offset;
+    strncpy(m_header.address, sentence + (sentence[0] ? 1 : 0), 5);
+
+    const char *address = m_header.address;
+    const char *formatter = address + 2;
+    if(!strncmp(formatter, "VDM", 3))
+        m_header.id = NMEA_ID_VDM;
+    else if(!strncmp(formatter, "VDO", 3))
+        m_header.id = NMEA_ID_VDO;
+    else if(!strncmp(address, "FRPOS", 5))
+        m_header.id = NMEA_ID_FRPOS;
+    else if(!strncmp(address, "CDDS", 4))
+        m_header.id = NMEA_ID_CDDS;
+    else if(!strncmp(formatter, "TLL", 3))
+        m_header.id = NMEA_ID_TLL;
+    else if(!strncmp(formatter, "TTM", 3))
+        m_header.id = NMEA_ID_TTM;
+    else if(!strncmp(formatter, "OSD", 3))
+        m_header.id = NMEA_ID_OSD;
+    else if(!strncmp(formatter, "WPL", 3))
+        m_header.id = NMEA_ID_WPL;
+
+    m_header.checksum_ok = CheckSumCheck(str);
+}
+
 //----------------------------------------------------------------------------------
 //     Strip NMEA V4 tags from message
 //----------------------------------------------------------------------------------
 wxString OCPN_DataStreamEvent::ProcessNMEA4Tags()
 {
-    wxString msg = wxString(GetNMEAString().c_str(), wxConvUTF8);
-   
-    int idxFirst =  msg.Find('\\');
-    
-    if(wxNOT_FOUND == idxFirst)
-        return msg;
-    
-    if(idxFirst < (int)msg.Length()-1){
-        int idxSecond = msg.Mid(idxFirst + 1).Find('\\') + 1;
-        if(wxNOT_FOUND != idxSecond){
-            if(idxSecond < (int)msg.Length()-1){
-                
-               // wxString tag = msg.Mid(idxFirst+1, (idxSecond - idxFirst) -1);
-                return msg.Mid(idxSecond + 1);
-            }
-        }
-    }
-    
-    return msg;
+    return wxString(GetNMEAString().c_str() + m_header.offset, wxConvUTF8);
 }
 
 
 wxEvent* OCPN_DataStreamEvent::Clone() const
 {
-    OCPN_DataStreamEvent *newevent=new OCPN_DataStreamEvent(*this);
-    newevent->m_NMEAstring=this->m_NMEAstring;
-    newevent->m_pDataStream = this->m_pDataStream;
-    return newevent;
+    //  The clone shares the sentence buffer
+    return new OCPN_DataStreamEvent(*this);
 }
-
@@ -35,6 +35,7 @@
 #endif
 
 #define DS_RX_BUFFER_SIZE 4096
+#define DS_RX_READ_SIZE   1024
 
 extern const wxEventType wxEVT_OCPN_DATASTREAM;
 const wxEventType wxEVT_OCPN_THREADMSG = wxNewEventType();
@@ -77,11 +78,8 @@ OCP_DataStreamInput_Thread::OCP_DataStreamInput_Thread(DataStream *Launcher,
 
     m_io_select = io_select;
 
-    rx_buffer = new char[DS_RX_BUFFER_SIZE + 1];
-    temp_buf = new char[DS_RX_BUFFER_SIZE + 1];
-
-    put_ptr = rx_buffer;                            // local circular queue
-    tak_ptr = rx_buffer;
+    rx_buffer = new char[DS_RX_BUFFER_SIZE + 1];    // carry-over of a partial sentence
+    m_rx_len = 0;
 
     m_baud = 4800;                                  // default
     long lbaud;
@@ -95,7 +93,6 @@ OCP_DataStreamInput_Thread::OCP_DataStreamInput_Thread(DataStream *Launcher,
 OCP_DataStreamInput_Thread::~OCP_DataStreamInput_Thread(void)
 {
     delete[] rx_buffer;
-    delete[] temp_buf;
 }
 
 void OCP_DataStreamInput_Thread::OnExit(void)
@@ -151,19 +148,6 @@ void OCP_DataStreamInput_Thread::CloseComPortPhysical()
     }
 }
 
-void OCP_DataStreamInput_Thread::Parse_And_Send_Posn(const char *buf)
-{
-    if( m_pMessageTarget ) {
-        OCPN_DataStreamEvent Nevent(wxEVT_OCPN_DATASTREAM, 0);
-        Nevent.SetNMEAString( buf );
-        Nevent.SetStream( m_launcher );
-        
-        m_pMessageTarget->AddPendingEvent(Nevent);
-    }
-    
-    return;
-}
-
 bool OCP_DataStreamInput_Thread::SetOutMsg(const wxString &msg)
 {
     if(out_que.size() < OUT_QUEUE_LENGTH){
@@ -183,7 +167,6 @@ void *OCP_DataStreamInput_Thread::Entry()
 {
     
     bool not_done = true;
-    bool nl_found = false;
     wxString msg;
     
     
@@ -206,11 +189,13 @@ void *OCP_DataStreamInput_Thread::Entry()
         if(TestDestroy())
             not_done = false;                               // smooth exit
         
-        uint8_t next_byte = 0;
-        size_t newdata = -1;
+        uint8_t rdbuf[DS_RX_READ_SIZE];
+        size_t newdata = 0;
         if( m_serial.isOpen() ) {
             try {
-                newdata = m_serial.read(&next_byte, 1);
+                //  Whatever has arrived, or wait for one byte
+                size_t navail = m_serial.available();
+                newdata = m_serial.read(rdbuf, wxMax((size_t)1, wxMin(navail, sizeof rdbuf)));
             } catch (std::exception &e) {
                 //std::cerr << "Serial read exception: " << e.what() << std::endl;
                 if(10 < retries++) {
@@ -230,64 +215,8 @@ void *OCP_DataStreamInput_Thread::Entry()
                 retries++;
         }
 
-        if(newdata == 1)
-        {
-            nl_found = false;
-            *put_ptr++ = next_byte;
-            if((put_ptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-                put_ptr = rx_buffer;
-            
-            if(0x0a == next_byte)
-                nl_found = true;
-            
-            //    Found a NL char, thus end of message?
-            if(nl_found)
-            {
-                char *tptr;
-                char *ptmpbuf;
-                
-                //    Copy the message into a temporary _buffer
-                
-                tptr = tak_ptr;
-                ptmpbuf = temp_buf;
-                
-                while((*tptr != 0x0a) && (tptr != put_ptr))
-                {
-                    *ptmpbuf++ = *tptr++;
-                    
-                    if((tptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-                        tptr = rx_buffer;
-                    
-                    wxASSERT_MSG((ptmpbuf - temp_buf) < DS_RX_BUFFER_SIZE, (const wxChar *)"temp_buf overrun1");
-                    
-                }
-                if((*tptr == 0x0a) && (tptr != put_ptr))    // well formed sentence
-                {
-                    *ptmpbuf++ = *tptr++;
-                    if((tptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-                        tptr = rx_buffer;
-                    
-                    wxASSERT_MSG((ptmpbuf - temp_buf) < DS_RX_BUFFER_SIZE, (const wxChar *)"temp_buf overrun2");
-                    
-                    *ptmpbuf = 0;
-                    
-                    tak_ptr = tptr;
-                    
-                    //    Message is ready to parse and send out
-                    //    Messages may be coming in as <blah blah><lf><cr>.
-                    //    One example device is KVH1000 heading sensor.
-                    //    If that happens, the first character of a new captured message will the <cr>,
-                    //    and we need to discard it.
-                    //    This is out of spec, but we should handle it anyway
-                    if(temp_buf[0] == '\r')
-                        Parse_And_Send_Posn(&temp_buf[1]);
-                    else
-                        Parse_And_Send_Posn(temp_buf);
-                    
-                }
-                
-            }                   //if nl
-        }                       // if newdata > 0
+        if(newdata > 0)
+            FrameAndSend((const char *)rdbuf, newdata);
         
         //      Check for any pending output message
 
@@ -330,7 +259,6 @@ void *OCP_DataStreamInput_Thread::Entry()
 {
 
     bool not_done = true;
-    bool nl_found = false;
     wxString msg;
 
 
@@ -352,15 +280,12 @@ void *OCP_DataStreamInput_Thread::Entry()
         if(TestDestroy())
             not_done = false;                               // smooth exit
 
-      //    Blocking, timeout protected read of one character at a time
+      //    Blocking, timeout protected read of whatever has arrived
       //    Timeout value is set by c_cc[VTIME]
-      //    Storing incoming characters in circular buffer
-      //    And watching for new line character
-      //     On new line character, send notification to parent
-        char next_byte = 0;
+      //    Complete sentences are sent on to the parent
+        char rdbuf[DS_RX_READ_SIZE];
         ssize_t newdata;
-        newdata = read(m_gps_fd, &next_byte, 1);            // read of one char
-                                                            // return (-1) if no data available, timeout
+        newdata = read(m_gps_fd, rdbuf, sizeof rdbuf);      // return (-1) if no data available, timeout
 
 #ifdef __WXOSX__
         if (newdata < 0 )
@@ -406,67 +331,10 @@ void *OCP_DataStreamInput_Thread::Entry()
               }
         }
 
-        //  And process any character
+        //  And process any characters
 
         if(newdata > 0)
-        {
-            nl_found = false;
-            *put_ptr++ = next_byte;
-            if((put_ptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-            put_ptr = rx_buffer;
-
-            if(0x0a == next_byte)
-            nl_found = true;
-
-
-            //    Found a NL char, thus end of message?
-            if(nl_found)
-            {
-                char *tptr;
-                char *ptmpbuf;
-
-                //    Copy the message into a temporary _buffer
-
-                tptr = tak_ptr;
-                ptmpbuf = temp_buf;
-
-                while((*tptr != 0x0a) && (tptr != put_ptr))
-                {
-                    *ptmpbuf++ = *tptr++;
-
-                    if((tptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-                    tptr = rx_buffer;
-
-                    wxASSERT_MSG((ptmpbuf - temp_buf) < DS_RX_BUFFER_SIZE, (const wxChar *)"temp_buf overrun1");
-
-                }
-                if((*tptr == 0x0a) && (tptr != put_ptr))    // well formed sentence
-                {
-                    *ptmpbuf++ = *tptr++;
-                    if((tptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-                    tptr = rx_buffer;
-
-                    wxASSERT_MSG((ptmpbuf - temp_buf) < DS_RX_BUFFER_SIZE, (const wxChar *)"temp_buf overrun2");
-
-                    *ptmpbuf = 0;
-
-                    tak_ptr = tptr;
-
-                //    Message is ready to parse and send out
-                //    Messages may be coming in as <blah blah><lf><cr>.
-                //    One example device is KVH1000 heading sensor.    
-                //    If that happens, the first character of a new captured message will the <cr>,
-                //    and we need to discard it.    
-                //    This is out of spec, but we should handle it anyway   
-                    if(temp_buf[0] == '\r')
-                        Parse_And_Send_Posn(&temp_buf[1]);
-                    else
-                        Parse_And_Send_Posn(temp_buf);
-                    
-                }
-
-            }                   //if nl
-        }                       // if newdata > 0
+            FrameAndSend(rdbuf, newdata);
 
         //      Check for any pending output message
 
@@ -533,7 +401,6 @@ void *OCP_DataStreamInput_Thread::Entry()
     int max_timeout = 5;
     int loop_timeout = 2000;
     int n_reopen_wait = 2000;
-    bool nl_found = false;
     bool b_burst_read = false;
     int dcb_read_toc = 2000;
     int dcb_read_tom = MAXDWORD;
@@ -853,20 +720,6 @@ void OCP_DataStreamInput_Thread::HandleASuccessfulRead( char *szBuf, int nread )
             ThreadMessage(msg);
         }
         
-        int nchar = nread;
-        char *pb = szBuf;
-        
-        while(nchar)
-        {
-            if(0x0a == *pb)
-                m_nl_found = true;
-            
-            *put_ptr++ = *pb++;
-            if((put_ptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-                put_ptr = rx_buffer;
-            
-            nchar--;
-        }
         if((g_total_NMEAerror_messages < g_nNMEADebug) && (g_nNMEADebug > 1000))
         {
             g_total_NMEAerror_messages++;
@@ -882,55 +735,8 @@ void OCP_DataStreamInput_Thread::HandleASuccessfulRead( char *szBuf, int nread )
         }
     }
 
-    //    Found a NL char, thus end of message?
-    if(m_nl_found)
-    {
-        char *tptr;
-        char *ptmpbuf;
-        
-        bool partial = false;
-        while (!partial)
-        {
-            
-            //    Copy the message into a temp buffer
-            
-            tptr = tak_ptr;
-            ptmpbuf = temp_buf;
-            
-            while((*tptr != 0x0a) && (tptr != put_ptr))
-            {
-                *ptmpbuf++ = *tptr++;
-                
-                if((tptr - rx_buffer) > RX_BUFFER_SIZE)
-                    tptr = rx_buffer;
-                //                    wxASSERT_MSG((ptmpbuf - temp_buf) < DS_RX_BUFFER_SIZE, "temp_buf overrun");
-            }
-            
-            if((*tptr == 0x0a) && (tptr != put_ptr))    // well formed sentence
-                    {
-                        *ptmpbuf++ = *tptr++;
-                        if((tptr - rx_buffer) > DS_RX_BUFFER_SIZE)
-                            tptr = rx_buffer;
-                        //                    wxASSERT_MSG((ptmpbuf - temp_buf) < DS_RX_BUFFER_SIZE, "temp_buf overrun");
-                            
-                            *ptmpbuf = 0;
-                            
-                            tak_ptr = tptr;
-                            
-                            // parse and send the message
-                            //                    wxString str_temp_buf(temp_buf, wxConvUTF8);
-                            if(temp_buf[0] == '\r')
-                                Parse_And_Send_Posn(&temp_buf[1]);
-                            else
-                                Parse_And_Send_Posn(temp_buf);
-                    }
-                    else
-                    {
-                        partial = true;
-                    }
-        }                 // while !partial
-        
-    }        // nl found
+    if(nread > 0)
+        FrameAndSend(szBuf, nread);
 }
 
 
@@ -938,19 +744,6 @@ void OCP_DataStreamInput_Thread::HandleASuccessfulRead( char *szBuf, int nread )
 
 #endif            // __WXMSW__
 
-void OCP_DataStreamInput_Thread::Parse_And_Send_Posn(const char *buf)
-{
-    if( m_pMessageTarget ) {
-        OCPN_DataStreamEvent Nevent(wxEVT_OCPN_DATASTREAM, 0);
-        Nevent.SetNMEAString( buf );
-        Nevent.SetStream( m_launcher );
-
-        m_pMessageTarget->AddPendingEvent(Nevent);
-    }
-
-    return;
-}
-
 void OCP_DataStreamInput_Thread::ThreadMessage(const wxString &msg)
 {
     //    Signal the main program thread
@@ -1322,3 +1115,76 @@ bool OCP_DataStreamInput_Thread::CheckComPortPhysical(int port_descriptor)
 #endif            // __WXMSW__
 #endif //ocpnUSE_NEWSERIAL
 
+//  Split what has arrived into sentences, ending at each <lf>.  All the sentences
+//  completed by one read go to the consumer in a single event.
+void OCP_DataStreamInput_Thread::FrameAndSend(const char *data, size_t nread)
+{
+    std::shared_ptr<OCPN_DataStreamBatch> batch = std::make_shared<OCPN_DataStreamBatch>();
+    long nbytes = nread;
+    long ndropped = 0;
+
+    while(nread)
+    {
+        size_t ncopy = wxMin(nread, (size_t)(DS_RX_BUFFER_SIZE - m_rx_len));
+        memcpy(rx_buffer + m_rx_len, data, ncopy);
+        data += ncopy;
+        nread -= ncopy;
+
+        size_t scan = m_rx_len;                             // no <lf> before here
+        size_t start = 0;
+        m_rx_len += ncopy;
+
+        const char *nl;
+        while((nl = (const char *)memchr(rx_buffer + scan, 0x0a, m_rx_len - scan)))
+        {
+            size_t end = nl - rx_buffer + 1;
+            const char *sentence = rx_buffer + start;
+            size_t len = end - start;
+
+            //    Messages may be coming in as <blah blah><lf><cr>.
+            //    One example device is KVH1000 heading sensor.
+            //    If that happens, the first character of a new captured message will the <cr>,
+            //    and we need to discard it.
+            //    This is out of spec, but we should handle it anyway
+            if(sentence[0] == '\r') {
+                sentence++;
+                len--;
+            }
+
+            //  As ever, the sentence stops at any embedded nul
+            const char *nul = (const char *)memchr(sentence, 0, len);
+            if(nul)
+                len = nul - sentence;
+
+            if(m_pMessageTarget) {
+                batch->events.push_back(OCPN_DataStreamEvent(wxEVT_OCPN_DATASTREAM, 0));
+                OCPN_DataStreamEvent &Nevent = batch->events.back();
+                Nevent.SetNMEAString( std::string(sentence, len) );
+                Nevent.SetStream( m_launcher );
+            }
+
+            start = scan = end;
+        }
+
+        if(start) {
+            memmove(rx_buffer, rx_buffer + start, m_rx_len - start);
+            m_rx_len -= start;
+        }
+        else if(m_rx_len == DS_RX_BUFFER_SIZE) {
+            //  A whole buffer with no <lf>, so not NMEA.  Throw it away.
+            m_rx_len = 0;
+            ndropped++;
+        }
+    }
+
+    if(batch->events.size() == 1)
+        m_pMessageTarget->AddPendingEvent(batch->events[0]);
+    else if(batch->events.size() > 1) {
+        OCPN_DataStreamEvent Nevent(wxEVT_OCPN_DATASTREAM, 0);
+        Nevent.SetStream( m_launcher );
+        Nevent.SetBatch( batch );
+        m_pMessageTarget->AddPendingEvent(Nevent);
+    }
+
+    m_launcher->AddRxStats(nbytes, batch->events.size(), ndropped);
+}
@@ -48,6 +48,9 @@
 
 #include "mygeom.h"
 #include "georef.h"
+#include "MappedFile.h"
+
+#include <new>
 
 extern s57RegistrarMgr          *m_pRegistrarMan;
 extern wxString                 g_csv_locn;
@@ -159,6 +162,112 @@ void Osenc_instreamFile::Init()
 }
 
 
+//--------------------------------------------------------------------------
+//      Osenc_instreamMapped implementation
+//--------------------------------------------------------------------------
+Osenc_instreamMapped::Osenc_instreamMapped()
+{
+    m_map = NULL;
+    m_pos = 0;
+    m_ok = false;
+}
+
+Osenc_instreamMapped::~Osenc_instreamMapped()
+{
+    Close();
+}
+
+bool Osenc_instreamMapped::Open( const wxString &senc_file_name )
+{
+    Close();
+    m_map = new MappedFile(senc_file_name);
+    m_ok = m_map->IsOk();
+    return m_ok;
+}
+
+void Osenc_instreamMapped::Close()
+{
+    delete m_map;
+    m_map = NULL;
+    m_pos = 0;
+    m_ok = false;
+}
+
+Osenc_instream &Osenc_instreamMapped::Read(void *buffer, size_t size)
+{
+    if(m_ok && (size <= m_map->GetSize() - m_pos)){
+        memcpy(buffer, m_map->GetData() + m_pos, size);
+        m_pos += size;
+    }
+    else
+        m_ok = false;
+
+    return *this;
+}
+
+bool Osenc_instreamMapped::IsOk()
+{
+    return m_ok;
+}
+
+bool Osenc_instreamMapped::isAvailable()
+{
+    return true;
+}
+
+void Osenc_instreamMapped::Shutdown()
+{
+}
+
+
+//--------------------------------------------------------------------------
+//      OsencArena implementation
+//--------------------------------------------------------------------------
+OsencArena::OsencArena()
+{
+    m_run = NULL;
+    m_left = 0;
+    m_size = 0;
+}
+
+OsencArena::~OsencArena()
+{
+    for(unsigned int i=0 ; i < m_blocks.size() ; i++)
+        free(m_blocks[i]);
+}
+
+//  Returns storage aligned for any of the types kept in a SENC, or NULL
+void *OsencArena::Alloc( size_t size )
+{
+    size = (size + 7) & ~(size_t)7;
+
+    //  Large requests get a block of their own, so as not to waste the tail of the current one
+    if(size > OSENC_ARENA_BLOCK_SIZE / 4){
+        unsigned char *block = (unsigned char *)malloc(size);
+        if(!block)
+            return NULL;
+        m_blocks.push_back(block);
+        m_size += size;
+        return block;
+    }
+
+    if(size > m_left){
+        unsigned char *block = (unsigned char *)malloc(OSENC_ARENA_BLOCK_SIZE);
+        if(!block)
+            return NULL;
+        m_blocks.push_back(block);
+        m_size += OSENC_ARENA_BLOCK_SIZE;
+        m_run = block;
+        m_left = OSENC_ARENA_BLOCK_SIZE;
+    }
+
+    void *ret = m_run;
+    m_run += size;
+    m_left -= size;
+    return ret;
+}
+
+
 //--------------------------------------------------------------------------
 //      Osenc_outstreamFile implementation
 //      A simple file stream implementation based on wxFFileOutStream
@@ -322,8 +431,15 @@ int Osenc::ingestHeader(const wxString &senc_file_name)
 //     wxBufferedInputStream fpx( fpx_u );
 
     //    Sanity check for existence of file
-    Osenc_instreamFile fpx;
-    fpx.Open( senc_file_name );
+    //    Read through a mapping of the file if we can, else as a stream
+    Osenc_instreamMapped fpm;
+    Osenc_instreamFile fpf;
+    Osenc_instream *pfpx = &fpm;
+    if( !fpm.Open( senc_file_name ) ){
+        pfpx = &fpf;
+        fpf.Open( senc_file_name );
+    }
+    Osenc_instream &fpx = *pfpx;
     if (!fpx.IsOk())
         return ERROR_SENCFILE_NOT_FOUND;
     
@@ -542,10 +658,15 @@ std::string Osenc::GetAttributeAcronymFromTypecode( int typeCode)
 }
 
 
+//  When arenas are given, the VE_Elements are built in pElementArena, and the
+//  edge and connected node points, with their VC_Elements, in pPointArena.
+//  Otherwise each is allocated on its own, to be freed by the caller.
 int Osenc::ingest200(const wxString &senc_file_name,
                   S57ObjVector *pObjectVector,
                   VE_ElementVector *pVEArray,
-                  VC_ElementVector *pVCArray)
+                  VC_ElementVector *pVCArray,
+                  OsencArena *pElementArena,
+                  OsencArena *pPointArena)
 {
     
     int ret_val = SENC_NO_ERROR;                    // default is OK
@@ -741,7 +862,14 @@ int Osenc::ingest200(const wxString &senc_file_name,
 //                     int yyp = 4;
                 
                 if(acronym.length()){
-                    obj = new S57Obj(acronym.c_str());
+                    //  With an element arena, the object body and its attributes live there
+                    void *pobj = pElementArena ? pElementArena->Alloc(sizeof(S57Obj)) : NULL;
+                    if(pobj){
+                        obj = new(pobj) S57Obj(acronym.c_str());
+                        obj->m_arena = pElementArena;
+                    }
+                    else
+                        obj = new S57Obj(acronym.c_str());
                     obj->Index = featureID;
                     
                     pObjectVector->push_back(obj);
@@ -943,12 +1071,15 @@ int Osenc::ingest200(const wxString &senc_file_name,
                 
             
             case VECTOR_EDGE_NODE_TABLE_RECORD:
+            case VECTOR_EDGE_NODE_TABLE_EXT_RECORD:
             {
                 unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
                 if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
                     dun = 1; break;
                 }
                 
+                bool b_bbox = (record.record_type == VECTOR_EDGE_NODE_TABLE_EXT_RECORD);
+                
                 //  Parse the buffer
                 uint8_t *pRun = (uint8_t *)buf;
                 
@@ -964,18 +1095,33 @@ int Osenc::ingest200(const wxString &senc_file_name,
                     int pointCount = *(int*)pRun;
                     pRun += sizeof(int);
                     
+                    double bbox[4];
+                    if( b_bbox ) {
+                        memcpy(bbox, pRun, sizeof(bbox));
+                        pRun += sizeof(bbox);
+                    }
+                    
                     float *pPoints = NULL;
                     if( pointCount ) {
-                        pPoints = (float *) malloc( pointCount * 2 * sizeof(float) );
+                        if(pPointArena)
+                            pPoints = (float *) pPointArena->Alloc( pointCount * 2 * sizeof(float) );
+                        else
+                            pPoints = (float *) malloc( pointCount * 2 * sizeof(float) );
                         memcpy(pPoints, pRun, pointCount * 2 * sizeof(float));
                     }
                     pRun += pointCount * 2 * sizeof(float);
                     
-                    VE_Element *pvee = new VE_Element;
+                    VE_Element *pvee;
+                    if(pElementArena)
+                        pvee = new(pElementArena->Alloc(sizeof(VE_Element))) VE_Element;
+                    else
+                        pvee = new VE_Element;
                     pvee->index = featureIndex;
                     pvee->nCount = pointCount;
                     pvee->pPoints = pPoints; 
                     pvee->max_priority = 0;            // Default
+                    if( b_bbox && pointCount )
+                        pvee->edgeBBox.Set( bbox[0], bbox[1], bbox[2], bbox[3] );
                     
                     pVEArray->push_back(pvee);
                     
@@ -1003,11 +1149,19 @@ int Osenc::ingest200(const wxString &senc_file_name,
                     int featureIndex = *(int*)pRun;
                     pRun += sizeof(int);
                     
-                    float *pPoint = (float *) malloc( 2 * sizeof(float) );
+                    float *pPoint;
+                    VC_Element *pvce;
+                    if(pPointArena){
+                        pPoint = (float *) pPointArena->Alloc( 2 * sizeof(float) );
+                        pvce = new(pPointArena->Alloc(sizeof(VC_Element))) VC_Element;
+                    }
+                    else{
+                        pPoint = (float *) malloc( 2 * sizeof(float) );
+                        pvce = new VC_Element;
+                    }
                     memcpy(pPoint, pRun, 2 * sizeof(float));
                     pRun += 2 * sizeof(float);
                     
-                    VC_Element *pvce = new VC_Element;
                     pvce->index = featureIndex;
                     pvce->pPoint = pPoint;
                     
@@ -1442,7 +1596,7 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
 {
     m_FullPath000 = FullPath000;
     
-    m_senc_file_create_version = 200;
+    m_senc_file_create_version = CURRENT_SENC_FORMAT_VERSION;
     
     if(!m_poRegistrar){
         errorMessage = _T("S57 Registrar not set.");
@@ -2571,7 +2725,7 @@ void Osenc::CreateSENCVectorEdgeTableRecord200( Osenc_outstream *stream, S57Read
         }
         
         if(nPoints){
-            int new_size = payloadSize + (2 * sizeof(int));
+            int new_size = payloadSize + (2 * sizeof(int)) + (4 * sizeof(double));
             pPayload = (uint8_t *)realloc(pPayload, new_size );
             pRun = pPayload + payloadSize;                   //  recalculate the running pointer,
                                                         //  since realloc may have moved memory
@@ -2622,6 +2776,10 @@ void Osenc::CreateSENCVectorEdgeTableRecord200( Osenc_outstream *stream, S57Read
             *(int *)pRun = nPointReduced;
             pRun += sizeof(int);
             
+            //  Leave room for the edge bounding box, filled in once the points are known
+            int bboxOffset = pRun - pPayload;
+            pRun += 4 * sizeof(double);
+            
             //  transcribe the (possibly) reduced linestring to the payload
             
             //  Grow the payload buffer
@@ -2648,6 +2806,21 @@ void Osenc::CreateSENCVectorEdgeTableRecord200( Osenc_outstream *stream, S57Read
                     }
                 }
             }
+            
+            //  The bounding box is taken from the points as stored, exactly as the reader would
+            double east_max = -1e7; double east_min = 1e7;
+            double north_max = -1e7; double north_min = 1e7;
+            for(float *vrun = npp ; vrun < npp_run ; vrun += 2){
+                east_max = wxMax(east_max, vrun[0]);
+                east_min = wxMin(east_min, vrun[0]);
+                north_max = wxMax(north_max, vrun[1]);
+                north_min = wxMin(north_min, vrun[1]);
+            }
+            
+            double bbox[4];
+            fromSM( east_min, north_min, m_ref_lat, m_ref_lon, &bbox[0], &bbox[1] );
+            fromSM( east_max, north_max, m_ref_lat, m_ref_lon, &bbox[2], &bbox[3] );
+            memcpy(pPayload + bboxOffset, bbox, sizeof(bbox));
     
             nFeatures++;
             
@@ -2666,7 +2839,7 @@ void Osenc::CreateSENCVectorEdgeTableRecord200( Osenc_outstream *stream, S57Read
         //  Now write the record out
         OSENC_VET_Record record;
         
-        record.record_type = VECTOR_EDGE_NODE_TABLE_RECORD;
+        record.record_type = VECTOR_EDGE_NODE_TABLE_EXT_RECORD;
         record.record_length = sizeof(OSENC_VET_Record_Base) + payloadSize + sizeof(uint32_t);
 
         // Write out the record
@@ -183,16 +183,6 @@ const LLRegion &QuiltCandidate::GetCandidateRegion()
     return candidate_region;
 }
 
-LLRegion &QuiltCandidate::GetReducedCandidateRegion(double factor)
-{
-    if(factor != last_factor) {
-        reduced_candidate_region = GetCandidateRegion();
-        reduced_candidate_region.Reduce(factor);
-        last_factor = factor;
-    }
-    return reduced_candidate_region;
-}
-
 void QuiltCandidate::SetScale( int scale )
 {
     ChartScale = scale;
@@ -233,6 +223,9 @@ Quilt::Quilt()
     m_bquiltskew = g_bopengl;
     //  Quilting of different projections is allowed for OpenGL only
     m_bquiltanyproj = g_bopengl;
+
+    m_reduce_level = 0;
+    memset( &m_compose_stats, 0, sizeof m_compose_stats );
 }
 
 Quilt::~Quilt()
@@ -582,6 +575,78 @@ LLRegion Quilt::GetChartQuiltRegion( const ChartTableEntry &cte, ViewPort &vp )
     return chart_region;
 }
 
+//  Equivalent to !GetChartQuiltRegion( cte, vp ).Empty(), for a viewport of the given box.
+//  The NoCovr regions never empty the quilt region, so only the coverage matters,
+//  and that is kept from one compose to the next.
+bool Quilt::IsChartCoverageInView( int dbIndex, const ChartTableEntry &cte, const LLBBox &viewbox )
+{
+    std::map<int, CoverageRegion>::iterator it = m_coverage_cache.find( dbIndex );
+    if( it != m_coverage_cache.end() )
+        m_compose_stats.regions_cached++;
+    else {
+        m_compose_stats.regions_built++;
+        CoverageRegion &coverage = m_coverage_cache[dbIndex];
+        coverage.b_full = false;
+
+        //    Charts which extend around the world, or near to it, or have no ply table,
+        //    and super small scale raster charts, take the whole screen
+        if( ( fabs( cte.GetLonMax() - cte.GetLonMin() ) > 180. )
+            || ( ( cte.GetScale() > 90000000 ) && ( cte.GetChartFamily() == CHART_FAMILY_RASTER ) ) )
+            coverage.b_full = true;
+        else {
+            //    Same choice of ply tables as GetChartQuiltRegion()
+            int nAuxPlyEntries = cte.GetnAuxPlyEntries();
+            bool aux_ply_skipped = false;
+            for( int ip = 0; ip < nAuxPlyEntries; ip++ ) {
+                int nAuxPly = cte.GetAuxCntTableEntry( ip );
+                if( nAuxPly > AUX_PLY_PERF_LIMIT ) {
+                    aux_ply_skipped = true;
+                    break;
+                }
+                coverage.region.Union( LLRegion( nAuxPly, cte.GetpAuxPlyTableEntry( ip ) ) );
+            }
+
+            if( aux_ply_skipped || nAuxPlyEntries == 0 ) {
+                int n_ply_entries = cte.GetnPlyEntries();
+                if( n_ply_entries >= 3 )
+                    coverage.region.Union( LLRegion( n_ply_entries, cte.GetpPlyTable() ) );
+                else
+                    coverage.b_full = true;
+            }
+        }
+
+        it = m_coverage_cache.find( dbIndex );
+    }
+
+    const CoverageRegion &coverage = it->second;
+    if( coverage.b_full )
+        return true;
+    if( coverage.region.Empty() || coverage.region.IntersectOut( viewbox ) )
+        return false;
+
+    LLRegion t_region( viewbox );
+    t_region.Intersect( coverage.region );
+    return !t_region.Empty();
+}
+
+//  The candidate region simplified for composing the quilt, to within 2^level degrees.
+//  Kept by chart and level, so that a pan reuses the regions of the last compose.
+LLRegion &Quilt::GetReducedCandidateRegion( QuiltCandidate *pqc, int level )
+{
+    std::pair<int, int> key( pqc->dbIndex, level );
+    std::map<std::pair<int, int>, LLRegion>::iterator it = m_reduced_region_cache.find( key );
+    if( it != m_reduced_region_cache.end() ) {
+        m_compose_stats.regions_cached++;
+        return it->second;
+    }
+
+    m_compose_stats.regions_built++;
+    LLRegion &reduced_region = m_reduced_region_cache[key];
+    reduced_region = pqc->GetCandidateRegion();
+    reduced_region.Reduce( ldexp( 1.0, level ) );
+    return reduced_region;
+}
+
 
 
 
@@ -1266,12 +1331,10 @@ bool Quilt::BuildExtendedChartStackAndCandidateArray(bool b_fullscreen, int ref_
                     double chart_fractional_area = 0.;
                     double quilt_area = vp_local.pix_width * vp_local.pix_height;
                 */
-                LLRegion cell_region = GetChartQuiltRegion( cte, vp_local );
-
                 // this is false if the chart has no actual overlap on screen
                 // or lots of NoCovr regions.  US3EC04.000 is a good example
                 // i.e the full bboxes overlap, but the actual vp intersect is null.
-                if( ! cell_region.Empty() ) {
+                if( IsChartCoverageInView( i, cte, viewbox ) ) {
                     // Check to see if this chart is already in the stack array
                     // by virtue of being under the Viewport center point....
                     bool b_exists = false;
@@ -1465,6 +1528,10 @@ bool Quilt::Compose( const ViewPort &vp_in )
     UnlockQuilt();
     m_bbusy = true;
 
+    wxStopWatch sw_compose;
+    wxStopWatch sw_phase;
+    m_compose_stats.composes++;
+
     ViewPort vp_local = vp_in;                   // need a non-const copy
 
     //    Get Reference Chart parameters
@@ -1544,6 +1611,9 @@ bool Quilt::Compose( const ViewPort &vp_in )
         }
     }
 
+    m_compose_stats.ms_candidates += sw_phase.TimeInMicro().ToDouble() / 1000.;
+    sw_phase.Start();
+
     bool b_has_overlays = false;
 #ifdef USE_S57
 
@@ -1583,6 +1653,21 @@ bool Quilt::Compose( const ViewPort &vp_in )
     // allow a maximum error of 8 pixels (the rendered display is much better, this is only for composing the quilt)
     const double z = 111274.96299695622; ////WGS84_semimajor_axis_meters * mercator_k0 * DEGREE;
     double factor = 8.0 / (vp_local.view_scale_ppm * z);
+
+    // The error is rounded down to a power of two, so the reduced regions serve
+    // every pan, and any zoom within the same octave
+    int level = (int)floor( log2( factor ) );
+    if( level != m_reduce_level ) {
+        // Keep the neighbouring levels, for zooming back and forth
+        std::map<std::pair<int, int>, LLRegion>::iterator it = m_reduced_region_cache.begin();
+        while( it != m_reduced_region_cache.end() ) {
+            if( abs( it->first.second - level ) > 1 )
+                m_reduced_region_cache.erase( it++ );
+            else
+                ++it;
+        }
+        m_reduce_level = level;
+    }
     
     if( pqc_ref ) {
         const ChartTableEntry &cte_ref = ChartData->GetChartTableEntry( m_refchart_dbIndex );
@@ -1590,7 +1675,7 @@ bool Quilt::Compose( const ViewPort &vp_in )
         LLRegion vpu_region( cvp_region );
 
         //LLRegion chart_region = pqc_ref->GetCandidateRegion();
-        LLRegion &chart_region = pqc_ref->GetReducedCandidateRegion(factor);
+        LLRegion &chart_region = GetReducedCandidateRegion( pqc_ref, level );
         
         if( !chart_region.Empty() ){
             vpu_region.Intersect( chart_region );
@@ -1644,7 +1729,7 @@ bool Quilt::Compose( const ViewPort &vp_in )
                     LLRegion vpu_region( cvp_region );
 
                     //LLRegion chart_region = pqc->GetCandidateRegion( );  //quilt_region;
-                    LLRegion &chart_region = pqc->GetReducedCandidateRegion(factor);
+                    LLRegion &chart_region = GetReducedCandidateRegion( pqc, level );
                     
                     if( !chart_region.Empty() ) {
                         vpu_region.Intersect( chart_region );
@@ -1696,7 +1781,7 @@ bool Quilt::Compose( const ViewPort &vp_in )
                     LLRegion vpu_region( cvp_region );
 
                     //LLRegion chart_region = pqc->GetCandidateRegion( );
-                    LLRegion &chart_region = pqc->GetReducedCandidateRegion(factor);
+                    LLRegion &chart_region = GetReducedCandidateRegion( pqc, level );
                     
                     if( !chart_region.Empty() )
                         vpu_region.Intersect( chart_region );
@@ -1800,7 +1885,7 @@ bool Quilt::Compose( const ViewPort &vp_in )
             LLRegion vpck_region( vp_local.GetBBox() );
 
             //LLRegion chart_region = pqc->GetCandidateRegion();
-            LLRegion &chart_region = pqc->GetReducedCandidateRegion(factor);
+            LLRegion &chart_region = GetReducedCandidateRegion( pqc, level );
             
             if( !chart_region.Empty() ) vpck_region.Intersect( chart_region );
 
@@ -1884,77 +1969,16 @@ bool Quilt::Compose( const ViewPort &vp_in )
         }
     }
 
+    m_compose_stats.ms_select += sw_phase.TimeInMicro().ToDouble() / 1000.;
+    sw_phase.Start();
+
     //    Generate the final render regions for the patches, one by one
 
-    m_covered_region.Clear();
 #if 1 // this does the same as before with a lot less operations if there are many charts
-    
-    //  If the reference chart is cm93, we need to render it first.
-    bool b_skipCM93 = false;
-    if(m_reference_type == CHART_TYPE_CM93COMP){
-       
-        // find cm93 in the list
-        for( int i = m_PatchList.GetCount()-1; i >=0; i-- ) {
-            wxPatchListNode *pcinode = m_PatchList.Item(i);
-            QuiltPatch *piqp = pcinode->GetData();
-            if( !piqp->b_Valid )                         // skip invalid entries
-                continue;
-        
-            const ChartTableEntry &m = ChartData->GetChartTableEntry( piqp->dbIndex );
-        
-            if(m.GetChartType() == CHART_TYPE_CM93COMP){
-                //    Start with the chart's full region coverage.
-                piqp->ActiveRegion = piqp->quilt_region;
-                piqp->ActiveRegion.Intersect(cvp_region);
-            
-                //    Update the next pass full region to remove the region just allocated
-                m_covered_region.Union( piqp->quilt_region );
-                
-                b_skipCM93 = true;      // did this already...
-                break;
-            }
-        }
-    }
-        
-     //  Proceeding from largest scale to smallest....           
-    
-    for( int i = m_PatchList.GetCount()-1; i >=0; i-- ) {
-        wxPatchListNode *pcinode = m_PatchList.Item(i);
-        QuiltPatch *piqp = pcinode->GetData();
-        if( !piqp->b_Valid )                         // skip invalid entries
-            continue;
-
-        const ChartTableEntry &cte = ChartData->GetChartTableEntry( piqp->dbIndex );
-        
-        if(b_skipCM93){
-            if(cte.GetChartType() == CHART_TYPE_CM93COMP)
-                continue;
-        }
-            
-        //    Start with the chart's full region coverage.
-        piqp->ActiveRegion = piqp->quilt_region;
-        
-        // this operation becomes expensive with lots of charts
-        if(!b_has_overlays && m_PatchList.GetCount() < 25)
-            piqp->ActiveRegion.Subtract(m_covered_region);
-
-        piqp->ActiveRegion.Intersect(cvp_region);
-
-        //    Could happen that a larger scale chart covers completely a smaller scale chart
-        if( piqp->ActiveRegion.Empty() && (piqp->dbIndex != m_refchart_dbIndex))
-            piqp->b_eclipsed = true;
-
-        //    Maintain the present full quilt coverage region
-        piqp->b_overlay = false;
-        if(cte.GetChartFamily() == CHART_FAMILY_VECTOR){
-            piqp->b_overlay = s57chart::IsCellOverlayType(cte.GetpFullPath());
-        }
-                
-        if(!piqp->b_overlay)    
-            m_covered_region.Union( piqp->quilt_region );
-    }
+    ComposePatchRegions( cvp_region, b_has_overlays );
 #else
     // this is the old algorithm does the same thing in n^2/2 operations instead of 2*n-1
+    m_covered_region.Clear();
     for( unsigned int i = 0; i < m_PatchList.GetCount(); i++ ) {
         wxPatchListNode *pcinode = m_PatchList.Item(i);
         QuiltPatch *piqp = pcinode->GetData();
@@ -2028,6 +2052,8 @@ bool Quilt::Compose( const ViewPort &vp_in )
             m_covered_region.Union( pqpi->ActiveRegion );
     }
 #endif
+    m_compose_stats.ms_patches += sw_phase.TimeInMicro().ToDouble() / 1000.;
+
     //    Restore temporary VP Rotation
     //  vp_local.SetRotationAngle( saved_vp_rotation );
 
@@ -2243,10 +2269,136 @@ bool Quilt::Compose( const ViewPort &vp_in )
 
     m_xa_hash = xa_hash;
 
+    m_compose_stats.ms_total += sw_compose.TimeInMicro().ToDouble() / 1000.;
+    if( m_compose_stats_sw.Time() > 600000 ) {
+        const QuiltComposeStats &st = m_compose_stats;
+        wxLogMessage( _T("Quilt compose: %ld composes, %.0f ms (candidates %.0f, select %.0f, patches %.0f), regions %ld cached %ld built, patches %ld reused %ld built"),
+                      st.composes, st.ms_total, st.ms_candidates, st.ms_select, st.ms_patches,
+                      st.regions_cached, st.regions_built, st.patches_reused, st.patches_built );
+        m_compose_stats_sw.Start();
+    }
+
     m_bbusy = false;
     return true;
 }
 
+//  Set each valid patch's ActiveRegion to the part of the viewport it is to render,
+//  and m_covered_region to the union of the patch regions.
+//  Patches are taken from largest scale to smallest, after a cm93 reference chart.
+//  Each patch's region less those of the patches before it is carried over from
+//  the last compose for as long as the same patches come first, so a pan over
+//  the same charts only has to clip those regions to the new viewport.
+void Quilt::ComposePatchRegions( const LLRegion &cvp_region, bool b_has_overlays )
+{
+    std::vector<QuiltPatch *> order;
+
+    //  If the reference chart is cm93, we need to render it first.
+    bool b_skipCM93 = false;
+    if(m_reference_type == CHART_TYPE_CM93COMP){
+       
+        // find cm93 in the list
+        for( int i = m_PatchList.GetCount()-1; i >=0; i-- ) {
+            wxPatchListNode *pcinode = m_PatchList.Item(i);
+            QuiltPatch *piqp = pcinode->GetData();
+            if( !piqp->b_Valid )                         // skip invalid entries
+                continue;
+        
+            const ChartTableEntry &m = ChartData->GetChartTableEntry( piqp->dbIndex );
+        
+            if(m.GetChartType() == CHART_TYPE_CM93COMP){
+                order.push_back( piqp );
+                b_skipCM93 = true;      // did this already...
+                break;
+            }
+        }
+    }
+        
+     //  Proceeding from largest scale to smallest....           
+    
+    for( int i = m_PatchList.GetCount()-1; i >=0; i-- ) {
+        wxPatchListNode *pcinode = m_PatchList.Item(i);
+        QuiltPatch *piqp = pcinode->GetData();
+        if( !piqp->b_Valid )                         // skip invalid entries
+            continue;
+
+        if(b_skipCM93){
+            const ChartTableEntry &cte = ChartData->GetChartTableEntry( piqp->dbIndex );
+            if(cte.GetChartType() == CHART_TYPE_CM93COMP)
+                continue;
+        }
+
+        order.push_back( piqp );
+    }
+
+    // this operation becomes expensive with lots of charts
+    bool b_subtract = !b_has_overlays && m_PatchList.GetCount() < 25;
+
+    //  How many patches lead off the same as last time?
+    unsigned int nreuse = 0;
+    while( nreuse < order.size() && nreuse < m_patch_cache.size() ) {
+        const PatchRegion &pr = m_patch_cache[nreuse];
+        bool b_first = b_skipCM93 && ( nreuse == 0 );
+        if( pr.dbIndex != order[nreuse]->dbIndex || pr.b_first != b_first || pr.b_subtract != b_subtract )
+            break;
+        nreuse++;
+    }
+
+    m_patch_cache.resize( nreuse );
+    if( nreuse )
+        m_covered_region = m_patch_cache[nreuse - 1].covered;
+    else
+        m_covered_region.Clear();
+
+    for( unsigned int k = 0; k < order.size(); k++ ) {
+        QuiltPatch *piqp = order[k];
+        bool b_first = b_skipCM93 && ( k == 0 );
+        bool b_reused = k < nreuse;
+
+        //    Start with the chart's full region coverage.
+        if( b_reused ) {
+            piqp->ActiveRegion = m_patch_cache[k].unclipped;
+            m_compose_stats.patches_reused++;
+        }
+        else {
+            piqp->ActiveRegion = piqp->quilt_region;
+            if( b_subtract && !b_first )
+                piqp->ActiveRegion.Subtract(m_covered_region);
+
+            PatchRegion pr;
+            pr.dbIndex = piqp->dbIndex;
+            pr.b_first = b_first;
+            pr.b_subtract = b_subtract;
+            m_patch_cache.push_back( pr );
+            m_patch_cache.back().unclipped = piqp->ActiveRegion;
+            m_compose_stats.patches_built++;
+        }
+
+        piqp->ActiveRegion.Intersect(cvp_region);
+
+        bool b_union = true;
+        if( !b_first ) {
+            const ChartTableEntry &cte = ChartData->GetChartTableEntry( piqp->dbIndex );
+
+            //    Could happen that a larger scale chart covers completely a smaller scale chart
+            if( piqp->ActiveRegion.Empty() && (piqp->dbIndex != m_refchart_dbIndex))
+                piqp->b_eclipsed = true;
+
+            piqp->b_overlay = false;
+            if(cte.GetChartFamily() == CHART_FAMILY_VECTOR){
+                piqp->b_overlay = s57chart::IsCellOverlayType(cte.GetpFullPath());
+            }
+            b_union = !piqp->b_overlay;
+        }
+
+        //    Maintain the present full quilt coverage region
+        if( !b_reused ) {
+            if( b_union )
+                m_covered_region.Union( piqp->quilt_region );
+            m_patch_cache.back().covered = m_covered_region;
+        }
+    }
+}
+
 
 
 //      Compute and update the member quilt render region, considering all scale factors, group exclusions, etc.
@@ -300,16 +300,14 @@ void RoutePoint::SetPointFromDraghandlePoint(ViewPort &vp, double lat, double lo
     cc1->GetCanvasPointPix( lat, lon, &r );
     double tlat, tlon;
     cc1->GetCanvasPixPoint(r.x - m_drag_icon_offset, r.y - m_drag_icon_offset, tlat, tlon);
-    m_lat = tlat;
-    m_lon = tlon;
+    SetPosition( tlat, tlon );
 }
 
 void RoutePoint::SetPointFromDraghandlePoint(ViewPort &vp, int x, int y)
 {
     double tlat, tlon;
     cc1->GetCanvasPixPoint(x - m_drag_icon_offset - m_draggingOffsetx, y - m_drag_icon_offset - m_draggingOffsety, tlat, tlon);
-    m_lat = tlat;
-    m_lon = tlon;
+    SetPosition( tlat, tlon );
 }
 
 void RoutePoint::PresetDragOffset( int x, int y)
@@ -993,6 +991,9 @@ void RoutePoint::SetPosition( double lat, double lon )
 {
     m_lat = lat;
     m_lon = lon;
+
+    if( NULL != pWayPointMan )
+        pWayPointMan->UpdateRoutePointPosition( this );
 }
 
 void RoutePoint::CalculateDCRect( wxDC& dc, wxRect *prect )
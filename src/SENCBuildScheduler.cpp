@@ -0,0 +1,326 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Background SENC build scheduler
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.             *
+ ***************************************************************************
+ *
+ */
+
+// For compilers that support precompilation, includes "wx.h".
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#include "dychart.h"
+#include "SENCBuildScheduler.h"
+#include "chartdb.h"
+#include "s57chart.h"
+#include "georef.h"
+
+extern wxString g_csv_locn;
+
+SENCBuildScheduler::SENCBuildScheduler()
+    : m_focus_lat(0.), m_focus_lon(0.), m_nchecked(0), m_nbuilt(0), m_nfailed(0),
+      m_ncompleted(0), m_bquit(false)
+{
+    //  Leave a core for the UI, SENC builds are heavy on memory as well as cpu
+    int nthreads = wxMax(wxMin(wxThread::GetCPUCount(), 4) - 1, 1);
+    for(int i = 0 ; i < nthreads ; i++)
+        m_threads.push_back(std::thread(&SENCBuildScheduler::WorkerLoop, this));
+}
+
+SENCBuildScheduler::~SENCBuildScheduler()
+{
+    //  Cells already being built are finished, the rest are dropped
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bquit = true;
+        m_queue.clear();
+        m_queued.clear();
+    }
+    m_work_cond.notify_all();
+    for(unsigned int i = 0 ; i < m_threads.size() ; i++)
+        m_threads[i].join();
+}
+
+//  Queue every ENC base cell in the database for checking, returns the number queued
+int SENCBuildScheduler::ScheduleChartDB(ChartDB *pChartDB)
+{
+    int n = 0;
+    for(int i = 0 ; i < pChartDB->GetChartTableEntries() ; i++) {
+        const ChartTableEntry &cte = pChartDB->GetChartTableEntry(i);
+        if(cte.GetChartType() != CHART_TYPE_S57)
+            continue;
+
+        wxString path(cte.GetpFullPath(), wxConvUTF8);
+        wxString upper = path.Upper();
+        if(!upper.EndsWith(_T(".000")) && !upper.EndsWith(_T(".000.XZ")))
+            continue;
+
+        Schedule(path, (cte.GetLatMax() + cte.GetLatMin()) / 2.,
+                 (cte.GetLonMax() + cte.GetLonMin()) / 2.);
+        n++;
+    }
+
+    wxLogMessage(_T("SENC build scheduler: %d ENC cells queued for checking"), n);
+    return n;
+}
+
+std::string SENCBuildScheduler::PathKey(const wxString &path000)
+{
+    return std::string(path000.ToUTF8().data());
+}
+
+void SENCBuildScheduler::Schedule(const wxString &path000, double lat, double lon)
+{
+    std::string key = PathKey(path000);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_queued.insert(key).second)
+            return;
+
+        Task task;
+        task.path = path000;
+        task.lat = lat;
+        task.lon = lon;
+
+        if(m_queue.empty() && m_active.empty()) {
+            m_nchecked = m_nbuilt = m_nfailed = 0;
+            m_sw.Start();
+        }
+        m_queue.push_back(task);
+    }
+    m_work_cond.notify_one();
+}
+
+void SENCBuildScheduler::SetFocus(double lat, double lon)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_focus_lat = lat;
+    m_focus_lon = lon;
+}
+
+//  True if a worker has found the cell's SENC stale and is rebuilding it.
+//  A cell still queued is taken off the queue, since the caller is about to
+//  check it in the foreground; one a worker is checking is waited for.
+bool SENCBuildScheduler::IsBuilding(const wxString &path000)
+{
+    std::string key = PathKey(path000);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if(m_queued.erase(key)) {
+        for(unsigned int i = 0 ; i < m_queue.size() ; i++)
+            if(m_queue[i].path == path000) {
+                m_queue[i] = m_queue.back();
+                m_queue.pop_back();
+                break;
+            }
+        return false;
+    }
+
+    while(IsActive(path000) && !m_building.count(key))
+        m_check_cond.wait(lock);
+
+    if(!m_building.count(key))
+        return false;
+
+    if(m_declined.insert(key).second)
+        wxLogMessage(_T("   SENC build in background for ") + path000);
+    return true;
+}
+
+//  Called with m_mutex held
+bool SENCBuildScheduler::IsActive(const wxString &path000)
+{
+    for(unsigned int i = 0 ; i < m_active.size() ; i++)
+        if(m_active[i] == path000)
+            return true;
+    return false;
+}
+
+//  Number of cells built, or declined by Init() and since finished, since the last call
+int SENCBuildScheduler::TakeCompleted()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int n = m_ncompleted;
+    m_ncompleted = 0;
+    return n;
+}
+
+int SENCBuildScheduler::GetQueueDepth()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+int SENCBuildScheduler::GetActiveCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active.size();
+}
+
+int SENCBuildScheduler::GetCheckedCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nchecked;
+}
+
+int SENCBuildScheduler::GetBuiltCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbuilt;
+}
+
+int SENCBuildScheduler::GetFailedCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nfailed;
+}
+
+bool SENCBuildScheduler::IsBusy()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_queue.empty() || !m_active.empty();
+}
+
+//  Pick the cell nearest the focus.  Called with m_mutex held.
+SENCBuildScheduler::Task SENCBuildScheduler::TakeNextTask()
+{
+    double coslat = cos(m_focus_lat * PI / 180.);
+    unsigned int best = 0;
+    double best_d = 1e30;
+    for(unsigned int i = 0 ; i < m_queue.size() ; i++) {
+        const Task &task = m_queue[i];
+        double dlon = fabs(task.lon - m_focus_lon);
+        if(dlon > 180.)
+            dlon = 360. - dlon;
+        dlon *= coslat;
+        double dlat = task.lat - m_focus_lat;
+        double d = dlat * dlat + dlon * dlon;
+        if(d < best_d) {
+            best_d = d;
+            best = i;
+        }
+    }
+
+    Task task = m_queue[best];
+    m_queue[best] = m_queue.back();
+    m_queue.pop_back();
+    m_queued.erase(PathKey(task.path));
+    return task;
+}
+
+void SENCBuildScheduler::WorkerLoop()
+{
+    //  The class registrar is not thread safe, so each worker loads its own
+    S57ClassRegistrar *registrar = NULL;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_bquit) {
+        if(m_queue.empty()) {
+            m_work_cond.wait(lock);
+            continue;
+        }
+
+        Task task = TakeNextTask();
+        m_active.push_back(task.path);
+
+        lock.unlock();
+        int result = BuildCell(task.path, registrar);
+        lock.lock();
+
+        for(unsigned int i = 0 ; i < m_active.size() ; i++)
+            if(m_active[i] == task.path) {
+                m_active.erase(m_active.begin() + i);
+                break;
+            }
+
+        //  A cell Init() turned away can be opened now, whatever the outcome
+        std::string key = PathKey(task.path);
+        m_building.erase(key);
+        if(m_declined.erase(key) || result == SENC_TASK_BUILT)
+            m_ncompleted++;
+        m_check_cond.notify_all();
+
+        m_nchecked++;
+        if(result == SENC_TASK_BUILT)
+            m_nbuilt++;
+        else if(result == SENC_TASK_FAILED)
+            m_nfailed++;
+
+        if(m_queue.empty() && m_active.empty())
+            wxLogMessage(_T("SENC build scheduler: %d cells checked, %d built, %d failed, %ld ms"),
+                         m_nchecked, m_nbuilt, m_nfailed, m_sw.Time());
+    }
+    lock.unlock();
+
+    delete registrar;
+}
+
+//  Check one cell, and convert it if its SENC is missing or out of date.
+//  Runs on a worker thread, so no progress dialog.  The worker's registrar
+//  is loaded on its first build.
+int SENCBuildScheduler::BuildCell(const wxString &path000, S57ClassRegistrar *&poRegistrar)
+{
+    s57chart chart;
+    bool bbuild;
+    if(chart.CheckSenc(path000, bbuild) != INIT_OK)
+        return SENC_TASK_FAILED;
+
+    if(!bbuild)
+        return SENC_TASK_CURRENT;
+
+    if(!poRegistrar) {
+        //  LoadInfo() reads through CPLReadLine(), which has a static buffer
+        static std::mutex load_mutex;
+        std::lock_guard<std::mutex> load_lock(load_mutex);
+
+        poRegistrar = new S57ClassRegistrar();
+        if(!poRegistrar->LoadInfo(g_csv_locn.mb_str(), FALSE)) {
+            wxLogMessage(_T("   Error: Could not load S57 ClassInfo from ") + g_csv_locn);
+            delete poRegistrar;
+            poRegistrar = NULL;
+            return SENC_TASK_FAILED;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_building.insert(PathKey(path000));
+    }
+    m_check_cond.notify_all();
+
+    if(chart.RebuildSenc(false, poRegistrar) != INIT_OK)
+        return SENC_TASK_FAILED;
+
+    //  PostInit() makes a fresh thumbnail for the new SENC when none is found
+    wxString thumb = s57chart::buildThumbnailName(chart.buildSENCName(path000));
+    if(::wxFileExists(thumb))
+        ::wxRemoveFile(thumb);
+
+    return SENC_TASK_BUILT;
+}
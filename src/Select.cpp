@@ -30,9 +30,255 @@
 #include "Track.h"
 #include "routeman.h"
 
+#include <algorithm>
+
 extern ChartCanvas *cc1;
 extern Routeman    *g_pRouteMan;
 
+//-----------------------------------------------------------------------------
+//      SelectIndex implementation
+//-----------------------------------------------------------------------------
+
+static const double s_index_cell_size[SELECT_INDEX_LEVELS] = { 1. / 64., 1. / 4., 4. };
+#define SELECT_INDEX_MAX_ITEM_CELLS     16      // items covering more cells are kept ungridded at that level
+#define SELECT_INDEX_MAX_QUERY_CELLS    64
+
+static bool IsSegmentType( int seltype )
+{
+    return ( seltype == SELTYPE_ROUTESEGMENT ) || ( seltype == SELTYPE_TRACKSEGMENT );
+}
+
+//  Segment coordinates normalized as in Select::IsSegmentSelected()
+static void NormalizeSegmentLat( float &lat ) { if( lat > 90.0 ) lat -= 180.0; }
+static void NormalizeSegmentLon( float &lon ) { if( lon > 180.0 ) lon -= 360.0; }
+
+SelectIndex::SelectIndex()
+{
+    m_front_order = 0;
+    m_back_order = 0;
+}
+
+void SelectIndex::Clear()
+{
+    m_cells.clear();
+    m_large.clear();
+    m_filed.clear();
+    m_data.clear();
+    m_front_order = 0;
+    m_back_order = 0;
+}
+
+void SelectIndex::Reserve( size_t n )
+{
+    m_filed.reserve( m_filed.size() + n );
+}
+
+wxUint64 SelectIndex::CellKey( int seltype, int level, int cx, int cy )
+{
+    int type_bit = 0;
+    while( ( type_bit < 15 ) && !( seltype & ( 1 << type_bit ) ) )
+        type_bit++;
+
+    const int offset = 1 << 28;
+    return ( (wxUint64) type_bit << 60 ) | ( (wxUint64) level << 58 )
+            | ( ( (wxUint64) ( cx + offset ) & 0x1FFFFFFF ) << 29 )
+            | ( (wxUint64) ( cy + offset ) & 0x1FFFFFFF );
+}
+
+bool SelectIndex::CellRange( int level, float lat0, float lon0, float lat1, float lon1,
+                             int &x0, int &y0, int &x1, int &y1 ) const
+{
+    double size = s_index_cell_size[level];
+    x0 = (int) floor( lon0 / size );
+    y0 = (int) floor( lat0 / size );
+    x1 = (int) floor( lon1 / size );
+    y1 = (int) floor( lat1 / size );
+
+    return ( (double) ( x1 - x0 + 1 ) * ( y1 - y0 + 1 ) ) <= SELECT_INDEX_MAX_ITEM_CELLS;
+}
+
+void SelectIndex::GetExtent( SelectItem *pitem, Filed &f )
+{
+    f.bspan = false;
+
+    if( IsSegmentType( pitem->m_seltype ) ) {
+        float a = pitem->m_slat, b = pitem->m_slat2;
+        float c = pitem->m_slon, d = pitem->m_slon2;
+        NormalizeSegmentLat( a );
+        NormalizeSegmentLat( b );
+        NormalizeSegmentLon( c );
+        NormalizeSegmentLon( d );
+
+        //  Segments spanning the prime meridian or the IDL are tested
+        //  with shifted longitudes, so are not gridded
+        if( ( c * d ) < 0. )
+            f.bspan = true;
+
+        f.lat0 = wxMin( a, b );
+        f.lat1 = wxMax( a, b );
+        f.lon0 = wxMin( c, d );
+        f.lon1 = wxMax( c, d );
+    } else {
+        f.lat0 = f.lat1 = pitem->m_slat;
+        f.lon0 = f.lon1 = pitem->m_slon;
+    }
+}
+
+void SelectIndex::File( SelectItem *pitem, const Filed &f, bool badd )
+{
+    for( int level = 0; level < SELECT_INDEX_LEVELS; level++ ) {
+        int x0, y0, x1, y1;
+        if( f.bspan || !CellRange( level, f.lat0, f.lon0, f.lat1, f.lon1, x0, y0, x1, y1 ) ) {
+            if( badd )
+                m_large[TypeLevelKey( pitem->m_seltype, level )].insert( pitem );
+            else
+                m_large[TypeLevelKey( pitem->m_seltype, level )].erase( pitem );
+            continue;
+        }
+
+        for( int cy = y0; cy <= y1; cy++ ) {
+            for( int cx = x0; cx <= x1; cx++ ) {
+                wxUint64 key = CellKey( pitem->m_seltype, level, cx, cy );
+                if( badd )
+                    m_cells[key].insert( pitem );
+                else {
+                    std::unordered_map<wxUint64, std::unordered_set<SelectItem *> >::iterator it = m_cells.find( key );
+                    if( it != m_cells.end() ) {
+                        it->second.erase( pitem );
+                        if( it->second.empty() ) m_cells.erase( it );
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SelectIndex::Add( SelectItem *pitem, wxSelectableItemListNode *node, bool bfront )
+{
+    Filed f;
+    f.order = bfront ? --m_front_order : ++m_back_order;
+    f.node = node;
+    GetExtent( pitem, f );
+
+    File( pitem, f, true );
+    m_filed[pitem] = f;
+
+    //  Track segments are looked up by their track, never by data
+    if( pitem->m_seltype != SELTYPE_TRACKSEGMENT )
+        m_data[std::make_pair( pitem->m_pData1, pitem->m_seltype )].push_back( pitem );
+}
+
+void SelectIndex::Remove( SelectItem *pitem )
+{
+    std::unordered_map<SelectItem *, Filed>::iterator it = m_filed.find( pitem );
+    if( it == m_filed.end() )
+        return;
+
+    File( pitem, it->second, false );
+    m_filed.erase( it );
+
+    std::map<std::pair<const void *, int>, std::vector<SelectItem *> >::iterator itd =
+            m_data.find( std::make_pair( pitem->m_pData1, pitem->m_seltype ) );
+    if( itd != m_data.end() ) {
+        std::vector<SelectItem *> &items = itd->second;
+        items.erase( std::remove( items.begin(), items.end(), pitem ), items.end() );
+        if( items.empty() ) m_data.erase( itd );
+    }
+}
+
+void SelectIndex::Update( SelectItem *pitem )
+{
+    std::unordered_map<SelectItem *, Filed>::iterator it = m_filed.find( pitem );
+    if( it == m_filed.end() )
+        return;
+
+    Filed f = it->second;
+    GetExtent( pitem, f );
+    if( ( f.lat0 == it->second.lat0 ) && ( f.lon0 == it->second.lon0 ) && ( f.lat1 == it->second.lat1 )
+            && ( f.lon1 == it->second.lon1 ) && ( f.bspan == it->second.bspan ) )
+        return;
+
+    File( pitem, it->second, false );
+    File( pitem, f, true );
+    it->second = f;
+}
+
+wxSelectableItemListNode *SelectIndex::GetNode( SelectItem *pitem ) const
+{
+    std::unordered_map<SelectItem *, Filed>::const_iterator it = m_filed.find( pitem );
+    return ( it == m_filed.end() ) ? NULL : it->second.node;
+}
+
+//      The first item, in select list order, carrying pdata for seltype
+SelectItem *SelectIndex::FindData( const void *pdata, int seltype ) const
+{
+    std::map<std::pair<const void *, int>, std::vector<SelectItem *> >::const_iterator itd =
+            m_data.find( std::make_pair( pdata, seltype ) );
+    if( itd == m_data.end() )
+        return NULL;
+
+    SelectItem *pfirst = NULL;
+    long long first_order = 0;
+    for( unsigned int i = 0; i < itd->second.size(); i++ ) {
+        long long order = m_filed.find( itd->second[i] )->second.order;
+        if( !pfirst || ( order < first_order ) ) {
+            pfirst = itd->second[i];
+            first_order = order;
+        }
+    }
+    return pfirst;
+}
+
+bool SelectIndex::GetCandidates( float slat, float slon, float radius, int seltype,
+                                 std::vector<SelectItem *> &result ) const
+{
+    //  Widen the window a little, so float rounding can not lose an item on a cell edge
+    double margin = radius * 1.01 + 1e-5;
+    float lat0 = slat - margin, lat1 = slat + margin;
+    float lon0 = slon - margin, lon1 = slon + margin;
+
+    int level = 0, x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    for( ; level < SELECT_INDEX_LEVELS; level++ ) {
+        CellRange( level, lat0, lon0, lat1, lon1, x0, y0, x1, y1 );
+        if( ( (double) ( x1 - x0 + 1 ) * ( y1 - y0 + 1 ) ) <= SELECT_INDEX_MAX_QUERY_CELLS )
+            break;
+    }
+    if( level == SELECT_INDEX_LEVELS )
+        return false;
+
+    std::vector<std::pair<long long, SelectItem *> > found;
+
+    for( int cy = y0; cy <= y1; cy++ ) {
+        for( int cx = x0; cx <= x1; cx++ ) {
+            std::unordered_map<wxUint64, std::unordered_set<SelectItem *> >::const_iterator it =
+                    m_cells.find( CellKey( seltype, level, cx, cy ) );
+            if( it == m_cells.end() ) continue;
+            for( std::unordered_set<SelectItem *>::const_iterator its = it->second.begin(); its != it->second.end(); ++its )
+                found.push_back( std::make_pair( m_filed.find( *its )->second.order, *its ) );
+        }
+    }
+
+    std::map<int, std::unordered_set<SelectItem *> >::const_iterator itl = m_large.find( TypeLevelKey( seltype, level ) );
+    if( itl != m_large.end() ) {
+        for( std::unordered_set<SelectItem *>::const_iterator its = itl->second.begin(); its != itl->second.end(); ++its )
+            found.push_back( std::make_pair( m_filed.find( *its )->second.order, *its ) );
+    }
+
+    //  Items spanning several cells are found more than once
+    std::sort( found.begin(), found.end() );
+    found.erase( std::unique( found.begin(), found.end() ), found.end() );
+
+    result.clear();
+    for( unsigned int i = 0; i < found.size(); i++ )
+        result.push_back( found[i].second );
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      Select implementation
+//-----------------------------------------------------------------------------
+
 Select::Select()
 {
     pSelectList = new SelectableItemList;
@@ -46,26 +292,43 @@ Select::Select()
 
 Select::~Select()
 {
+    m_index.Clear();
     pSelectList->DeleteContents( true );
     pSelectList->Clear();
     delete pSelectList;
 
 }
 
-bool Select::IsSelectableRoutePointValid(RoutePoint *pRoutePoint )
+//      Add an item to the select list, and to the index
+wxSelectableItemListNode *Select::AddItem( SelectItem *pitem, bool bfront )
 {
-    SelectItem *pFindSel;
+    wxSelectableItemListNode *node;
+    if( bfront )
+        node = pSelectList->Insert( pitem );
+    else
+        node = pSelectList->Append( pitem );
 
-//    Iterate on the select list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
+    m_index.Add( pitem, node, bfront );
+    return node;
+}
 
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == SELTYPE_ROUTEPOINT  && (RoutePoint *) pFindSel->m_pData1 == pRoutePoint)
-            return true;
-        node = node->GetNext();
-    }
-    return false;
+//      Remove an item from the index and the select list, and delete it
+void Select::DeleteItem( SelectItem *pitem )
+{
+    wxSelectableItemListNode *node = m_index.GetNode( pitem );
+    m_index.Remove( pitem );
+
+    if( node )
+        delete node;            // automatically removes from list
+    else
+        pSelectList->DeleteObject( pitem );
+
+    delete pitem;
+}
+
+bool Select::IsSelectableRoutePointValid(RoutePoint *pRoutePoint )
+{
+    return m_index.FindData( pRoutePoint, SELTYPE_ROUTEPOINT ) != NULL;
 }
 
 bool Select::AddSelectableRoutePoint( float slat, float slon, RoutePoint *pRoutePointAdd )
@@ -77,18 +340,24 @@ bool Select::AddSelectableRoutePoint( float slat, float slon, RoutePoint *pRoute
     pSelItem->m_bIsSelected = false;
     pSelItem->m_pData1 = pRoutePointAdd;
 
-    wxSelectableItemListNode *node;
-    
-    if( pRoutePointAdd->m_bIsInLayer )
-        node = pSelectList->Append( pSelItem );
-    else
-        node = pSelectList->Insert( pSelItem );
+    wxSelectableItemListNode *node = AddItem( pSelItem, !pRoutePointAdd->m_bIsInLayer );
 
     pRoutePointAdd->SetSelectNode(node);
     
     return true;
 }
 
+void Select::AddSelectableRoutePoints( const std::vector<RoutePoint *> &points )
+{
+    m_index.Reserve( points.size() );
+
+    for( unsigned int i = 0; i < points.size(); i++ ) {
+        RoutePoint *prp = points[i];
+        if( prp )
+            AddSelectableRoutePoint( prp->m_lat, prp->m_lon, prp );
+    }
+}
+
 bool Select::AddSelectableRouteSegment( float slat1, float slon1, float slat2, float slon2,
         RoutePoint *pRoutePointAdd1, RoutePoint *pRoutePointAdd2, Route *pRoute )
 {
@@ -103,9 +372,7 @@ bool Select::AddSelectableRouteSegment( float slat1, float slon1, float slat2, f
     pSelItem->m_pData2 = pRoutePointAdd2;
     pSelItem->m_pData3 = pRoute;
 
-    if( pRoute->m_bIsInLayer ) pSelectList->Append( pSelItem );
-    else
-        pSelectList->Insert( pSelItem );
+    AddItem( pSelItem, !pRoute->m_bIsInLayer );
 
     return true;
 }
@@ -122,10 +389,8 @@ bool Select::DeleteAllSelectableRouteSegments( Route *pr )
         if( pFindSel->m_seltype == SELTYPE_ROUTESEGMENT && 
             (Route *) pFindSel->m_pData3 == pr ) 
         {
-                delete pFindSel;
-                wxSelectableItemListNode *d = node;
                 node = node->GetNext();
-                pSelectList->DeleteNode( d );   //delete node;
+                DeleteItem( pFindSel );
         }
         else 
             node = node->GetNext();
@@ -136,36 +401,17 @@ bool Select::DeleteAllSelectableRouteSegments( Route *pr )
 
 bool Select::DeleteAllSelectableRoutePoints( Route *pr )
 {
-    SelectItem *pFindSel;
-
-//    Iterate on the select list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == SELTYPE_ROUTEPOINT ) {
-            RoutePoint *ps = (RoutePoint *) pFindSel->m_pData1;
-
-            //    inner loop iterates on the route's point list
-            wxRoutePointListNode *pnode = ( pr->pRoutePointList )->GetFirst();
-            while( pnode ) {
-                RoutePoint *prp = pnode->GetData();
-
-                if( prp == ps ) {
-                    delete pFindSel;
-                    pSelectList->DeleteNode( node );   //delete node;
-                    prp->SetSelectNode( NULL );
-                    
-                    node = pSelectList->GetFirst();
-
-                    goto got_next_outer_node;
-                }
-                pnode = pnode->GetNext();
-            }
+    //    Iterate on the route's point list, removing every select entry of each point
+    wxRoutePointListNode *pnode = ( pr->pRoutePointList )->GetFirst();
+    while( pnode ) {
+        RoutePoint *prp = pnode->GetData();
+
+        SelectItem *pFindSel;
+        while( ( pFindSel = m_index.FindData( prp, SELTYPE_ROUTEPOINT ) ) ) {
+            DeleteItem( pFindSel );
+            prp->SetSelectNode( NULL );
         }
-
-        node = node->GetNext();
-got_next_outer_node: continue;
+        pnode = pnode->GetNext();
     }
     return true;
 }
@@ -219,25 +465,9 @@ bool Select::AddAllSelectableRouteSegments( Route *pr )
 
 bool Select::AddAllSelectableTrackSegments( Track *pr )
 {
-    wxPoint rpt, rptn;
-    float slat1, slon1, slat2, slon2;
-
     if( pr->GetnPoints() ) {
-        TrackPoint *prp0 = pr->GetPoint(0);
-        slat1 = prp0->m_lat;
-        slon1 = prp0->m_lon;
-
-        for(int i=1; i<pr->GetnPoints(); i++) {
-            TrackPoint *prp = pr->GetPoint(i);
-            slat2 = prp->m_lat;
-            slon2 = prp->m_lon;
-
-            AddSelectableTrackSegment( slat1, slon1, slat2, slon2, prp0, prp, pr );
-
-            slat1 = slat2;
-            slon1 = slon2;
-            prp0 = prp;
-        }
+        for(int i=1; i<pr->GetnPoints(); i++)
+            AddSelectableTrackSegment( pr, i - 1 );
         return true;
     } else
         return false;
@@ -257,6 +487,7 @@ bool Select::UpdateSelectableRouteSegments( RoutePoint *prp )
             if( pFindSel->m_pData1 == prp ) {
                 pFindSel->m_slat = prp->m_lat;
                 pFindSel->m_slon = prp->m_lon;
+                m_index.Update( pFindSel );
                 ret = true;
                 ;
             }
@@ -265,6 +496,7 @@ bool Select::UpdateSelectableRouteSegments( RoutePoint *prp )
                 if( pFindSel->m_pData2 == prp ) {
                     pFindSel->m_slat2 = prp->m_lat;
                     pFindSel->m_slon2 = prp->m_lon;
+                    m_index.Update( pFindSel );
                     ret = true;
                 }
         }
@@ -284,7 +516,7 @@ SelectItem *Select::AddSelectablePoint( float slat, float slon, const void *pdat
         pSelItem->m_bIsSelected = false;
         pSelItem->m_pData1 = pdata;
 
-        pSelectList->Append( pSelItem );
+        AddItem( pSelItem, false );
     }
 
     return pSelItem;
@@ -301,28 +533,17 @@ bool Select::DeleteAllPoints( void )
 
 bool Select::DeleteSelectablePoint( void *pdata, int SeltypeToDelete )
 {
-    SelectItem *pFindSel;
-
     if( NULL != pdata ) {
-//    Iterate on the list
-        wxSelectableItemListNode *node = pSelectList->GetFirst();
+        SelectItem *pFindSel = m_index.FindData( pdata, SeltypeToDelete );
+        if( pFindSel ) {
+            DeleteItem( pFindSel );
 
-        while( node ) {
-            pFindSel = node->GetData();
-            if( pFindSel->m_seltype == SeltypeToDelete ) {
-                if( pdata == pFindSel->m_pData1 ) {
-                    delete pFindSel;
-                    delete node;
-                    
-                    if( SELTYPE_ROUTEPOINT == SeltypeToDelete ){
-                        RoutePoint *prp = (RoutePoint *)pdata;
-                        prp->SetSelectNode( NULL );
-                    }
-                    
-                    return true;
-                }
+            if( SELTYPE_ROUTEPOINT == SeltypeToDelete ){
+                RoutePoint *prp = (RoutePoint *)pdata;
+                prp->SetSelectNode( NULL );
             }
-            node = node->GetNext();
+
+            return true;
         }
     }
     return false;
@@ -337,21 +558,15 @@ bool Select::DeleteAllSelectableTypePoints( int SeltypeToDelete )
 
     while( node ) {
         pFindSel = node->GetData();
+        node = node->GetNext();
+
         if( pFindSel->m_seltype == SeltypeToDelete ) {
-            delete node;
-            
             if( SELTYPE_ROUTEPOINT == SeltypeToDelete ){
                 RoutePoint *prp = (RoutePoint *)pFindSel->m_pData1;
                 prp->SetSelectNode( NULL );
             }
-            delete pFindSel;
-            
-            node = pSelectList->GetFirst();
-            goto got_next_node;
+            DeleteItem( pFindSel );
         }
-
-        node = node->GetNext();
-        got_next_node: continue;
     }
     return true;
 }
@@ -364,8 +579,7 @@ bool Select::DeleteSelectableRoutePoint( RoutePoint *prp )
         if(node){
             SelectItem *pFindSel = node->GetData();
             if(pFindSel){
-                delete pFindSel;
-                delete node;            // automatically removes from list
+                DeleteItem( pFindSel );
                 prp->SetSelectNode( NULL );
                 return true;
             }
@@ -380,43 +594,44 @@ bool Select::DeleteSelectableRoutePoint( RoutePoint *prp )
 
 bool Select::ModifySelectablePoint( float lat, float lon, void *data, int SeltypeToModify )
 {
-    SelectItem *pFindSel;
+    SelectItem *pFindSel = m_index.FindData( data, SeltypeToModify );
+    if( !pFindSel )
+        return false;
 
-//    Iterate on the list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
+    pFindSel->m_slat = lat;
+    pFindSel->m_slon = lon;
+    m_index.Update( pFindSel );
+    return true;
+}
 
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == SeltypeToModify ) {
-            if( data == pFindSel->m_pData1 ) {
-                pFindSel->m_slat = lat;
-                pFindSel->m_slon = lon;
-                return true;
-            }
-        }
+//      Move a point item found earlier, e.g. by FindSelection()
+bool Select::UpdateSelectablePoint( SelectItem *pitem, float lat, float lon )
+{
+    if( !m_index.Contains( pitem ) )
+        return false;           // not in the list anymore
 
-        node = node->GetNext();
-    }
-    return false;
+    pitem->m_slat = lat;
+    pitem->m_slon = lon;
+    m_index.Update( pitem );
+    return true;
 }
 
-bool Select::AddSelectableTrackSegment( float slat1, float slon1, float slat2, float slon2,
-        TrackPoint *pTrackPointAdd1, TrackPoint *pTrackPointAdd2, Track *pTrack )
+//      The segment of pTrack from point index to the next one
+bool Select::AddSelectableTrackSegment( Track *pTrack, int index )
 {
     SelectItem *pSelItem = new SelectItem;
-    pSelItem->m_slat = slat1;
-    pSelItem->m_slon = slon1;
-    pSelItem->m_slat2 = slat2;
-    pSelItem->m_slon2 = slon2;
+    pSelItem->m_slat = pTrack->GetPointLat( index );
+    pSelItem->m_slon = pTrack->GetPointLon( index );
+    pSelItem->m_slat2 = pTrack->GetPointLat( index + 1 );
+    pSelItem->m_slon2 = pTrack->GetPointLon( index + 1 );
     pSelItem->m_seltype = SELTYPE_TRACKSEGMENT;
     pSelItem->m_bIsSelected = false;
-    pSelItem->m_pData1 = pTrackPointAdd1;
-    pSelItem->m_pData2 = pTrackPointAdd2;
+    pSelItem->m_pData1 = NULL;
+    pSelItem->m_pData2 = NULL;
     pSelItem->m_pData3 = pTrack;
+    pSelItem->m_Data4 = index;
 
-    if( pTrack->m_bIsInLayer ) pSelectList->Append( pSelItem );
-    else
-        pSelectList->Insert( pSelItem );
+    AddItem( pSelItem, !pTrack->m_bIsInLayer );
 
     return true;
 }
@@ -433,10 +648,8 @@ bool Select::DeleteAllSelectableTrackSegments( Track *pt )
         if( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT && 
           (Track *) pFindSel->m_pData3 == pt  ) 
         {
-            delete pFindSel;
-            wxSelectableItemListNode *d = node;
             node = node->GetNext();
-            pSelectList->DeleteNode( d );   //delete node;
+            DeleteItem( pFindSel );
         }
         else 
             node = node->GetNext();
@@ -444,7 +657,9 @@ bool Select::DeleteAllSelectableTrackSegments( Track *pt )
     return true;
 }
 
-bool Select::DeletePointSelectableTrackSegments( TrackPoint *pt )
+//      Delete the segments either side of a point about to be removed from
+//      pTrack, and renumber the segments after it
+bool Select::DeletePointSelectableTrackSegments( Track *pTrack, int index )
 {
     SelectItem *pFindSel;
 
@@ -453,15 +668,13 @@ bool Select::DeletePointSelectableTrackSegments( TrackPoint *pt )
 
     while( node ) {
         pFindSel = node->GetData();
-        if( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT &&
-            ( (TrackPoint *) pFindSel->m_pData1 == pt ||
-              (TrackPoint *) pFindSel->m_pData2 == pt ) ) {
-                delete pFindSel;
-                wxSelectableItemListNode *d = node;
-                node = node->GetNext();
-                pSelectList->DeleteNode( d );   //delete node;
-        } else
-            node = node->GetNext();
+        node = node->GetNext();
+        if( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT && (Track *) pFindSel->m_pData3 == pTrack ) {
+            if( pFindSel->m_Data4 == index - 1 || pFindSel->m_Data4 == index )
+                DeleteItem( pFindSel );
+            else if( pFindSel->m_Data4 > index )
+                pFindSel->m_Data4--;
+        }
     }
     return true;
 }
@@ -531,6 +744,26 @@ void Select::CalcSelectRadius()
     selectRadius = pixelRadius / ( cc1->GetCanvasTrueScale() * 1852 * 60 );
 }
 
+//      Items of fseltype which may be within selectRadius of slat/slon, in select list order.
+//      Uses the index, or the whole list if the select radius is very large.
+void Select::GetCandidates( float slat, float slon, int fseltype, std::vector<SelectItem *> &result )
+{
+    float qlat = slat, qlon = slon;
+    if( IsSegmentType( fseltype ) ) {
+        NormalizeSegmentLat( qlat );
+        NormalizeSegmentLon( qlon );
+    }
+
+    if( m_index.GetCandidates( qlat, qlon, selectRadius, fseltype, result ) )
+        return;
+
+    result.clear();
+    for( wxSelectableItemListNode *node = pSelectList->GetFirst(); node; node = node->GetNext() ) {
+        if( node->GetData()->m_seltype == fseltype )
+            result.push_back( node->GetData() );
+    }
+}
+
 SelectItem *Select::FindSelection( float slat, float slon, int fseltype )
 {
     float a, b, c, d;
@@ -538,39 +771,36 @@ SelectItem *Select::FindSelection( float slat, float slon, int fseltype )
 
     CalcSelectRadius();
 
-//    Iterate on the list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == fseltype ) {
-            switch( fseltype ){
-                case SELTYPE_ROUTEPOINT:
-                case SELTYPE_TIDEPOINT:
-                case SELTYPE_CURRENTPOINT:
-                case SELTYPE_AISTARGET:
-                    a = fabs( slat - pFindSel->m_slat );
-                    b = fabs( slon - pFindSel->m_slon );
-
-                    if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
-                            && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) goto find_ok;
-                    break;
-                case SELTYPE_ROUTESEGMENT:
-                case SELTYPE_TRACKSEGMENT: {
-                    a = pFindSel->m_slat;
-                    b = pFindSel->m_slat2;
-                    c = pFindSel->m_slon;
-                    d = pFindSel->m_slon2;
-
-                    if( IsSegmentSelected( a, b, c, d, slat, slon ) ) goto find_ok;
-                    break;
-                }
-                default:
-                    break;
+//    Iterate on the candidates near the cursor
+    std::vector<SelectItem *> candidates;
+    GetCandidates( slat, slon, fseltype, candidates );
+
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        pFindSel = candidates[i];
+        switch( fseltype ){
+            case SELTYPE_ROUTEPOINT:
+            case SELTYPE_TIDEPOINT:
+            case SELTYPE_CURRENTPOINT:
+            case SELTYPE_AISTARGET:
+                a = fabs( slat - pFindSel->m_slat );
+                b = fabs( slon - pFindSel->m_slon );
+
+                if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
+                        && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) goto find_ok;
+                break;
+            case SELTYPE_ROUTESEGMENT:
+            case SELTYPE_TRACKSEGMENT: {
+                a = pFindSel->m_slat;
+                b = pFindSel->m_slat2;
+                c = pFindSel->m_slon;
+                d = pFindSel->m_slon2;
+
+                if( IsSegmentSelected( a, b, c, d, slat, slon ) ) goto find_ok;
+                break;
             }
+            default:
+                break;
         }
-
-        node = node->GetNext();
     }
 
     return NULL;
@@ -579,16 +809,7 @@ SelectItem *Select::FindSelection( float slat, float slon, int fseltype )
 
 bool Select::IsSelectableSegmentSelected( float slat, float slon, SelectItem *pFindSel )
 {
-    bool valid = false;
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        if( pFindSel == node->GetData() ) {
-            valid = true;
-            break;
-        }
-        node = node->GetNext();
-    }
+    bool valid = m_index.Contains( pFindSel );
 
     if (valid == false) {
         // not in the list anymore
@@ -612,43 +833,40 @@ SelectableItemList Select::FindSelectionList( float slat, float slon, int fselty
 
     CalcSelectRadius();
 
-//    Iterate on the list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == fseltype ) {
-            switch( fseltype ){
-                case SELTYPE_ROUTEPOINT:
-                case SELTYPE_TIDEPOINT:
-                case SELTYPE_CURRENTPOINT:
-                case SELTYPE_AISTARGET:
-                case SELTYPE_DRAGHANDLE:    
-                    if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
-                            && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) {
-                        if(cc1->m_bShowNavobjects || ((RoutePoint *)pFindSel->m_pData1)->m_bIsActive || g_pRouteMan->FindRouteContainingWaypoint( (RoutePoint *)pFindSel->m_pData1 )->IsActive())
-                            ret_list.Append( pFindSel );
-                    }
-                    break;
-                case SELTYPE_ROUTESEGMENT:
-                case SELTYPE_TRACKSEGMENT: {
-                    a = pFindSel->m_slat;
-                    b = pFindSel->m_slat2;
-                    c = pFindSel->m_slon;
-                    d = pFindSel->m_slon2;
-
-                    if( IsSegmentSelected( a, b, c, d, slat, slon ) )
-                        if(cc1->m_bShowNavobjects || ((Route *)pFindSel->m_pData3)->m_bRtIsActive)
-                            ret_list.Append( pFindSel );
-
-                    break;
+//    Iterate on the candidates near the cursor
+    std::vector<SelectItem *> candidates;
+    GetCandidates( slat, slon, fseltype, candidates );
+
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        pFindSel = candidates[i];
+        switch( fseltype ){
+            case SELTYPE_ROUTEPOINT:
+            case SELTYPE_TIDEPOINT:
+            case SELTYPE_CURRENTPOINT:
+            case SELTYPE_AISTARGET:
+            case SELTYPE_DRAGHANDLE:    
+                if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
+                        && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) {
+                    if(cc1->m_bShowNavobjects || ((RoutePoint *)pFindSel->m_pData1)->m_bIsActive || g_pRouteMan->FindRouteContainingWaypoint( (RoutePoint *)pFindSel->m_pData1 )->IsActive())
+                        ret_list.Append( pFindSel );
                 }
-                default:
-                    break;
+                break;
+            case SELTYPE_ROUTESEGMENT:
+            case SELTYPE_TRACKSEGMENT: {
+                a = pFindSel->m_slat;
+                b = pFindSel->m_slat2;
+                c = pFindSel->m_slon;
+                d = pFindSel->m_slon2;
+
+                if( IsSegmentSelected( a, b, c, d, slat, slon ) )
+                    if(cc1->m_bShowNavobjects || ((Route *)pFindSel->m_pData3)->m_bRtIsActive)
+                        ret_list.Append( pFindSel );
+
+                break;
             }
+            default:
+                break;
         }
-
-        node = node->GetNext();
     }
 
     return ret_list;
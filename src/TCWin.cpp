@@ -537,9 +537,16 @@ void TCWin::OnPaint( wxPaintEvent& event )
             ptcmgr->GetTideFlowSens( m_t_graphday_00_at_station, BACKWARD_ONE_HOUR_STEP,
                                      pIDX->IDX_rec_num, tcv[0], val, wt );
 
+            //  Evaluate the whole curve in one call
+            time_t tt_curve[26];
+            float dir_curve[26];
+            for( i = 0; i < 26; i++ )
+                tt_curve[i] = m_t_graphday_00_at_station + ( i * FORWARD_ONE_HOUR_STEP );
+            ptcmgr->GetTideOrCurrentSeries( tt_curve, 26, pIDX->IDX_rec_num, tcv, dir_curve );
+
             for( i = 0; i < 26; i++ ) {
-                int tt = m_t_graphday_00_at_station + ( i * FORWARD_ONE_HOUR_STEP );
-                ptcmgr->GetTideOrCurrent( tt, pIDX->IDX_rec_num, tcv[i], dir );
+                int tt = tt_curve[i];
+                dir = dir_curve[i];
                 tt_tcv[i] = tt;                         // store the corresponding time_t value
                 if( tcv[i] > tcmax ) tcmax = tcv[i];
 
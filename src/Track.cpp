@@ -85,6 +85,8 @@ millions of points.
 #include "navutil.h"
 #include "Select.h"
 
+#include <algorithm>
+
 #ifdef ocpnUSE_GL
 #include "glChartCanvas.h"
 extern ocpnGLOptions g_GLOptions;
@@ -127,58 +129,184 @@ private:
 #include <wx/listimpl.cpp>
 WX_DEFINE_LIST ( TrackList );
 
+#define TRACKPOINT_NO_TIME      wxINT64_MIN
+
+//  m_PointTime values standing for no time, and for a time kept in m_FarTimes
+#define TRACK_TIME_NONE         wxINT32_MIN
+#define TRACK_TIME_FAR          ( wxINT32_MIN + 1 )
+
+//  Track point times are held as the seconds of their date and time fields
+//  counted as if UTC, so they come back with the same fields, and the same
+//  meaning, they were given with.
+
+//  Days from 1970-01-01 to the given (proleptic Gregorian) date
+static wxInt64 DaysFromCivil( int y, int m, int d )
+{
+    y -= m <= 2;
+    wxInt64 era = ( y >= 0 ? y : y - 399 ) / 400;
+    int yoe = (int) ( y - era * 400 );
+    int doy = ( 153 * ( m > 2 ? m - 3 : m + 9 ) + 2 ) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void CivilFromDays( wxInt64 z, int &y, int &m, int &d )
+{
+    z += 719468;
+    wxInt64 era = ( z >= 0 ? z : z - 146096 ) / 146097;
+    int doe = (int) ( z - era * 146097 );
+    int yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+    int doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+    int mp = ( 5 * doy + 2 ) / 153;
+    d = doy - ( 153 * mp + 2 ) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int) ( yoe + era * 400 ) + ( m <= 2 );
+}
+
+static wxInt64 TimeFromDateTime( const wxDateTime &dt )
+{
+    if( !dt.IsValid() )
+        return TRACKPOINT_NO_TIME;
+
+    wxDateTime::Tm tm = dt.GetTm();
+    return DaysFromCivil( tm.year, tm.mon + 1, tm.mday ) * 86400
+            + tm.hour * 3600 + tm.min * 60 + tm.sec;
+}
+
+static wxDateTime DateTimeFromTime( wxInt64 time )
+{
+    if( time == TRACKPOINT_NO_TIME )
+        return wxDateTime();
+
+    wxInt64 days = time / 86400;
+    int secs = (int) ( time % 86400 );
+    if( secs < 0 ) {
+        secs += 86400;
+        days--;
+    }
+
+    int y, m, d;
+    CivilFromDays( days, y, m, d );
+    return wxDateTime( (wxDateTime::wxDateTime_t) d, (wxDateTime::Month) ( m - 1 ), y,
+                       secs / 3600, ( secs / 60 ) % 60, secs % 60 );
+}
+
+//  Formats as "YYYY-MM-DDThh:mm:ssZ".  Returns NULL, with buf empty, if there is no time
+static const char *FormatTime( wxInt64 time, char *buf )
+{
+    buf[0] = 0;
+    if( time == TRACKPOINT_NO_TIME )
+        return NULL;
+
+    wxInt64 days = time / 86400;
+    int secs = (int) ( time % 86400 );
+    if( secs < 0 ) {
+        secs += 86400;
+        days--;
+    }
+
+    int y, m, d;
+    CivilFromDays( days, y, m, d );
+    snprintf( buf, TRACKPOINT_TIME_LEN, "%04d-%02d-%02dT%02d:%02d:%02dZ", y, m, d,
+              secs / 3600, ( secs / 60 ) % 60, secs % 60 );
+    return buf;
+}
+
+//  Reads "YYYY-MM-DDThh:mm:ss", with an optional fraction and "Z", which is what
+//  GPX files almost always have, without going through wxString and wxDateTime.
+//  Anything else is left to ParseGPXDateTime().
+static wxInt64 ParseTime( const char *ts )
+{
+    if( !ts || !*ts )
+        return TRACKPOINT_NO_TIME;
+
+    static const int width[6] = { 4, 2, 2, 2, 2, 2 };
+    static const char sep[6] = { '-', '-', 'T', ':', ':', 0 };
+    int field[6];
+
+    const char *p = ts;
+    bool bfast = true;
+    for( int i = 0; i < 6 && bfast; i++ ) {
+        field[i] = 0;
+        for( int j = 0; j < width[i]; j++, p++ ) {
+            if( *p < '0' || *p > '9' ) {
+                bfast = false;
+                break;
+            }
+            field[i] = field[i] * 10 + *p - '0';
+        }
+        if( bfast && sep[i] ) {
+            if( *p == sep[i] )
+                p++;
+            else
+                bfast = false;
+        }
+    }
+
+    if( bfast ) {
+        if( *p == '.' ) {                       // fractions of seconds are dropped, as before
+            p++;
+            while( *p >= '0' && *p <= '9' )
+                p++;
+        }
+        if( *p == 'Z' )
+            p++;
+
+        if( !*p && field[1] >= 1 && field[1] <= 12 && field[2] >= 1
+                && field[2] <= wxDateTime::GetNumberOfDays( (wxDateTime::Month) ( field[1] - 1 ), field[0] )
+                && field[3] <= 23 && field[4] <= 59 && field[5] <= 59 )
+            return DaysFromCivil( field[0], field[1], field[2] ) * 86400
+                    + field[3] * 3600 + field[4] * 60 + field[5];
+    }
+
+    wxDateTime dt;
+    wxString tstr = wxString::FromUTF8( ts );
+    ParseGPXDateTime( dt, tstr );
+    return TimeFromDateTime( dt );
+}
+
 TrackPoint::TrackPoint(double lat, double lon, wxString ts)
-    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1), m_timestring(NULL)
+    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1)
 {
     SetCreateTime(ts);
 }
 
 TrackPoint::TrackPoint(double lat, double lon, wxDateTime dt)
-    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1), m_timestring(NULL)
+    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1)
 {
     SetCreateTime(dt);
 }
 
 // Copy Constructor
 TrackPoint::TrackPoint( TrackPoint* orig )
-    : m_lat(orig->m_lat), m_lon(orig->m_lon), m_GPXTrkSegNo(1), m_timestring(NULL)
+    : m_lat(orig->m_lat), m_lon(orig->m_lon), m_GPXTrkSegNo(1)
 {
-    SetCreateTime(orig->GetCreateTime());
+    SetTime(orig->m_time);
 }
 
 TrackPoint::~TrackPoint()
 {
-    delete [] m_timestring;
 }
 
 wxDateTime TrackPoint::GetCreateTime()
 {
-    wxDateTime CreateTimeX;
-    
-    if(m_timestring) {
-        wxString ts = m_timestring;
-        ParseGPXDateTime( CreateTimeX, ts );
-    }
-    return CreateTimeX;
+    return DateTimeFromTime(m_time);
 }
 
 void TrackPoint::SetCreateTime( wxDateTime dt )
 {
-    wxString ts;
-    if(dt.IsValid())
-        ts = dt.FormatISODate().Append(_T("T")).Append(dt.FormatISOTime()).Append(_T("Z"));
-
-    SetCreateTime(ts);
+    SetTime(TimeFromDateTime(dt));
 }
 
 void TrackPoint::SetCreateTime( wxString ts )
 {
-    delete [] m_timestring;
-    if(ts.Length()) {
-        m_timestring = new char[ts.Length()+1];
-        strcpy(m_timestring, ts.mb_str());
-    } else
-        m_timestring = NULL;
+    SetTime(ParseTime(ts.ToUTF8()));
+}
+
+void TrackPoint::SetTime( wxInt64 time )
+{
+    m_time = time;
+    FormatTime(time, m_timestring);
 }
 
 void TrackPoint::Draw(ocpnDC& dc )
@@ -236,12 +364,15 @@ Track::Track()
 
     m_HyperlinkList = new HyperlinkList;
     m_HighlightedTrackPoint = -1;
+
+    m_TimeBase = TRACKPOINT_NO_TIME;
+    m_Revision = 0;
 }
 
 Track::~Track( void )
 {
-    for(size_t i = 0; i < TrackPoints.size(); i++)
-        delete TrackPoints[i];
+    for( std::map<int, TrackPoint*>::iterator it = m_PointViews.begin(); it != m_PointViews.end(); ++it )
+        delete it->second;
 
     delete m_HyperlinkList;
 }
@@ -261,14 +392,15 @@ ActiveTrack::ActiveTrack()
     SetPrecision( g_nTrackPrecision );
 
     m_prev_time = wxInvalidDateTime;
-    m_lastStoredTP = NULL;
+    m_lastStoredTP = -1;
 
     wxDateTime now = wxDateTime::Now();
 //    m_ConfigRouteNum = now.GetTicks();        // a unique number....
     trackPointState = firstPoint;
-    m_lastStoredTP = NULL;
-    m_removeTP = NULL;
-    m_fixedTP = NULL;
+    m_lastStoredTP = -1;
+    m_removeTP = -1;
+    m_fixedTP = -1;
+    m_prevFixedTP = -1;
     m_track_run = 0;
     m_CurrentTrackSeg = 0;
     m_prev_dist = 999.0;
@@ -322,8 +454,8 @@ void ActiveTrack::Stop( bool do_add_point )
             AddPointNow( true );                   // Force add last point
         else{    
             double delta = 0.0;
-            if( m_lastStoredTP )
-                delta = DistGreatCircle( gLat, gLon, m_lastStoredTP->m_lat, m_lastStoredTP->m_lon );
+            if( m_lastStoredTP >= 0 )
+                delta = DistGreatCircle( gLat, gLon, GetPointLat( m_lastStoredTP ), GetPointLon( m_lastStoredTP ) );
 
             if(  delta > m_minTrackpoint_delta ) 
                 AddPointNow( true );                   // Add last point
@@ -388,29 +520,19 @@ void Track::Clone( Track *psourcetrack, int start_nPoint, int end_nPoint, const
     m_TrackStartString = psourcetrack->m_TrackStartString;
     m_TrackEndString = psourcetrack->m_TrackEndString;
 
-    bool b_splitting = GetnPoints() == 0;
-
-    int startTrkSegNo;
-    if( b_splitting ) startTrkSegNo = psourcetrack->GetPoint( start_nPoint )->m_GPXTrkSegNo;
-    else
-        startTrkSegNo = GetLastPoint()->m_GPXTrkSegNo;
-
+    //  Copied points all go in the first segment, as they always have
     int i;
-    for( i = start_nPoint; i <= end_nPoint; i++ ) {
-
-        TrackPoint *psourcepoint = psourcetrack->GetPoint( i );
-        if(psourcepoint){
-            TrackPoint *ptargetpoint = new TrackPoint( psourcepoint);
-            
-            AddPoint( ptargetpoint );
-        }
-    }
+    for( i = wxMax( start_nPoint, 0 ); i <= end_nPoint && i < psourcetrack->GetnPoints(); i++ )
+        AppendPoint( psourcetrack->m_PointLat[i], psourcetrack->m_PointLon[i],
+                     psourcetrack->GetPointTime( i ), 1 );
+    SubTracks.clear();
 }
 
 void ActiveTrack::AdjustCurrentTrackPoint( TrackPoint *prototype )
 {
-    if(prototype) {
-        *m_lastStoredTP = *prototype;
+    if(prototype && m_lastStoredTP >= 0) {
+        SetPoint( m_lastStoredTP, prototype->m_lat, prototype->m_lon, prototype->GetCreateTime() );
+        pConfig->UpdateTrackPoint( this, m_lastStoredTP );
         m_prev_time = prototype->GetCreateTime().FromUTC();
     }
 }
@@ -420,8 +542,8 @@ void ActiveTrack::OnTimerTrack( wxTimerEvent& event )
     m_TimerTrack.Stop();
     m_track_run++;
 
-    if( m_lastStoredTP )
-        m_prev_dist = DistGreatCircle( gLat, gLon, m_lastStoredTP->m_lat, m_lastStoredTP->m_lon );
+    if( m_lastStoredTP >= 0 )
+        m_prev_dist = DistGreatCircle( gLat, gLon, GetPointLat( m_lastStoredTP ), GetPointLon( m_lastStoredTP ) );
     else
         m_prev_dist = 999.0;
 
@@ -439,8 +561,10 @@ void ActiveTrack::OnTimerTrack( wxTimerEvent& event )
         if( ( trackPointState == firstPoint ) && !g_bTrackDaily )
         {
             wxDateTime now = wxDateTime::Now();
-            if(TrackPoints.empty())
-                TrackPoints.front()->SetCreateTime(now.ToUTC());
+            if(GetnPoints()) {
+                SetPoint( 0, GetPointLat( 0 ), GetPointLon( 0 ), now.ToUTC() );
+                pConfig->UpdateTrackPoint( this, 0 );
+            }
         }
 
     m_TimerTrack.Start( 1000, wxTIMER_CONTINUOUS );
@@ -464,8 +588,8 @@ void ActiveTrack::AddPointNow( bool do_add_point )
 
     switch( trackPointState ) {
         case firstPoint: {
-            TrackPoint *pTrackPoint = AddNewPoint( gpsPoint, now.ToUTC() );
-            m_lastStoredTP = pTrackPoint;
+            AddNewPoint( gpsPoint, now.ToUTC() );
+            m_lastStoredTP = GetnPoints() - 1;
             trackPointState = secondPoint;
             do_add_point = false;
             break;
@@ -485,22 +609,20 @@ void ActiveTrack::AddPointNow( bool do_add_point )
 
             // Scan points skipped so far and see if anyone has XTE over the threshold.
             for( unsigned int i=0; i<skipPoints.size(); i++ ) {
-                double xte = GetXTE( m_lastStoredTP->m_lat, m_lastStoredTP->m_lon, gLat, gLon, skipPoints[i].lat, skipPoints[i].lon );
+                double xte = GetXTE( GetPointLat( m_lastStoredTP ), GetPointLon( m_lastStoredTP ), gLat, gLon, skipPoints[i].lat, skipPoints[i].lon );
                 if( xte > xteMax ) {
                     xteMax = xte;
                     xteMaxIndex = i;
                 }
             }
             if( xteMax > m_allowedMaxXTE ) {
-                TrackPoint *pTrackPoint = AddNewPoint( skipPoints[xteMaxIndex], skipTimes[xteMaxIndex] );
-                pSelect->AddSelectableTrackSegment( m_lastStoredTP->m_lat, m_lastStoredTP->m_lon,
-                        pTrackPoint->m_lat, pTrackPoint->m_lon,
-                        m_lastStoredTP, pTrackPoint, this );
+                AddNewPoint( skipPoints[xteMaxIndex], skipTimes[xteMaxIndex] );
+                pSelect->AddSelectableTrackSegment( this, GetnPoints() - 2 );
 
                 m_prevFixedTP = m_fixedTP;
                 m_fixedTP = m_removeTP;
                 m_removeTP = m_lastStoredTP;
-                m_lastStoredTP = pTrackPoint;
+                m_lastStoredTP = GetnPoints() - 1;
                 for( unsigned int i=0; i<=xteMaxIndex; i++ ) {
                     skipPoints.pop_front();
                     skipTimes.pop_front();
@@ -510,17 +632,16 @@ void ActiveTrack::AddPointNow( bool do_add_point )
                 // (the next to last) point can possibly be eliminated. Here we reduce the allowed
                 // XTE as a function of leg length. (Half the XTE for very short legs).
                 if( GetnPoints() > 2 ) {
-                    double dist = DistGreatCircle( m_fixedTP->m_lat, m_fixedTP->m_lon, m_lastStoredTP->m_lat, m_lastStoredTP->m_lon );
+                    double dist = DistGreatCircle( GetPointLat( m_fixedTP ), GetPointLon( m_fixedTP ),
+                                                   GetPointLat( m_lastStoredTP ), GetPointLon( m_lastStoredTP ) );
                     double xte = GetXTE( m_fixedTP, m_lastStoredTP, m_removeTP );
                     if( xte < m_allowedMaxXTE / wxMax(1.0, 2.0 - dist*2.0) ) {
-                        TrackPoints.pop_back();
-                        TrackPoints.pop_back();
-                        TrackPoints.push_back( m_lastStoredTP );
-                        pSelect->DeletePointSelectableTrackSegments( m_removeTP );
-                        pSelect->AddSelectableTrackSegment( m_fixedTP->m_lat, m_fixedTP->m_lon,
-                                m_lastStoredTP->m_lat, m_lastStoredTP->m_lon,
-                                m_fixedTP, m_lastStoredTP, this );
-                        delete m_removeTP;
+                        pSelect->DeletePointSelectableTrackSegments( this, m_removeTP );
+                        RemovePoint( m_removeTP );
+                        pConfig->DeleteTrackPoint( this, m_removeTP );
+                        if( m_lastStoredTP > m_removeTP )
+                            m_lastStoredTP--;
+                        pSelect->AddSelectableTrackSegment( this, m_lastStoredTP - 1 );
                         m_removeTP = m_fixedTP;
                         m_fixedTP = m_prevFixedTP;
                     }
@@ -535,10 +656,8 @@ void ActiveTrack::AddPointNow( bool do_add_point )
 
     // Check if this is the last point of the track.
     if( do_add_point ) {
-        TrackPoint *pTrackPoint = AddNewPoint( gpsPoint, now.ToUTC() );
-        pSelect->AddSelectableTrackSegment( m_lastStoredTP->m_lat, m_lastStoredTP->m_lon,
-                pTrackPoint->m_lat, pTrackPoint->m_lon,
-                m_lastStoredTP, pTrackPoint, this );
+        AddNewPoint( gpsPoint, now.ToUTC() );
+        pSelect->AddSelectableTrackSegment( this, GetnPoints() - 2 );
     }
 
     m_prev_time = now;
@@ -547,8 +666,8 @@ void ActiveTrack::AddPointNow( bool do_add_point )
 void Track::AddPointToList(std::list< std::list<wxPoint> > &pointlists, int n)
 {
     wxPoint r(INVALID_COORD, INVALID_COORD);
-    if ( (size_t)n < TrackPoints.size() )
-        cc1->GetCanvasPointPix( TrackPoints[n]->m_lat, TrackPoints[n]->m_lon, &r );
+    if ( n < GetnPoints() )
+        cc1->GetCanvasPointPix( m_PointLat[n], m_PointLon[n], &r );
 
     std::list<wxPoint> &pointlist = pointlists.back();
     if(r.x == INVALID_COORD) {
@@ -590,7 +709,7 @@ void Track::Assemble(std::list< std::list<wxPoint> > &pointlists, const LLBBox &
 
         if(last < pos)
             AddPointToList(pointlists, pos);
-        last = wxMin(pos + (1<<level), TrackPoints.size() - 1);
+        last = wxMin(pos + (1<<level), GetnPoints() - 1);
         AddPointToList(pointlists, last);
     } else {
         Assemble(pointlists, box, scale, last, level-1, pos<<1);
@@ -731,24 +850,220 @@ void Track::Draw( ocpnDC& dc, ViewPort &VP, const LLBBox &box )
     }
 #endif
 
-    if(m_HighlightedTrackPoint >= 0)
-        TrackPoints[m_HighlightedTrackPoint]->Draw(dc);
+    if(m_HighlightedTrackPoint >= 0 && m_HighlightedTrackPoint < GetnPoints())
+        GetPoint(m_HighlightedTrackPoint)->Draw(dc);
 }
 
+//  The view of a point, made the first time it is asked for.  It stays with
+//  its point until the point is removed or the track deleted.
 TrackPoint *Track::GetPoint( int nWhichPoint )
 {
-    if(nWhichPoint < (int) TrackPoints.size())
-        return TrackPoints[nWhichPoint];
-    else
+    if(nWhichPoint < 0 || nWhichPoint >= GetnPoints())
         return NULL;
+
+    std::map<int, TrackPoint*>::iterator it = m_PointViews.find( nWhichPoint );
+    if( it != m_PointViews.end() )
+        return it->second;
+
+    TrackPoint *pView = new TrackPoint( m_PointLat[nWhichPoint], m_PointLon[nWhichPoint] );
+    pView->SetTime( GetPointTime( nWhichPoint ) );
+    pView->m_GPXTrkSegNo = GetPointSegNo( nWhichPoint );
+    m_PointViews[nWhichPoint] = pView;
+    return pView;
 }
 
 TrackPoint *Track::GetLastPoint()
 {
-    if(TrackPoints.empty())
+    if(!GetnPoints())
         return NULL;
 
-    return TrackPoints.back();
+    return GetPoint( GetnPoints() - 1 );
+}
+
+wxDateTime Track::GetPointCreateTime( int nWhichPoint ) const
+{
+    return DateTimeFromTime( GetPointTime( nWhichPoint ) );
+}
+
+//  Formats the point's time into buf, TRACKPOINT_TIME_LEN long, as in a GPX
+//  file.  Returns NULL if the point has no time.
+const char *Track::GetPointTimeString( int nWhichPoint, char *buf ) const
+{
+    return FormatTime( GetPointTime( nWhichPoint ), buf );
+}
+
+static bool RunStartsAfter( int nWhichPoint, const TrackSegmentRun &run )
+{
+    return nWhichPoint < run.first;
+}
+
+int Track::GetPointSegNo( int nWhichPoint ) const
+{
+    std::vector<TrackSegmentRun>::const_iterator it =
+            std::upper_bound( m_SegmentRuns.begin(), m_SegmentRuns.end(), nWhichPoint, RunStartsAfter );
+    if( it == m_SegmentRuns.begin() )
+        return 1;
+    return ( it - 1 )->segno;
+}
+
+wxInt64 Track::GetPointTime( int nWhichPoint ) const
+{
+    wxInt32 t = m_PointTime[nWhichPoint];
+    if( t == TRACK_TIME_NONE )
+        return TRACKPOINT_NO_TIME;
+    if( t == TRACK_TIME_FAR )
+        return m_FarTimes.find( nWhichPoint )->second;
+    return m_TimeBase + t;
+}
+
+void Track::SetPointTime( int nWhichPoint, wxInt64 time )
+{
+    m_FarTimes.erase( nWhichPoint );
+
+    if( time == TRACKPOINT_NO_TIME ) {
+        m_PointTime[nWhichPoint] = TRACK_TIME_NONE;
+        return;
+    }
+
+    //  Times are kept relative to the first one the track was given; the few
+    //  more than 68 years from it go in m_FarTimes
+    if( m_TimeBase == TRACKPOINT_NO_TIME )
+        m_TimeBase = time;
+
+    wxInt64 delta = time - m_TimeBase;
+    if( delta > TRACK_TIME_FAR && delta <= wxINT32_MAX )
+        m_PointTime[nWhichPoint] = (wxInt32) delta;
+    else {
+        m_PointTime[nWhichPoint] = TRACK_TIME_FAR;
+        m_FarTimes[nWhichPoint] = time;
+    }
+}
+
+void Track::AppendPoint( double lat, double lon, wxInt64 time, int segno )
+{
+    int n = GetnPoints();
+
+    m_PointLat.push_back( lat );
+    m_PointLon.push_back( lon );
+    m_PointTime.push_back( TRACK_TIME_NONE );
+    SetPointTime( n, time );
+    m_Revision++;
+
+    if( m_SegmentRuns.empty() || m_SegmentRuns.back().segno != segno ) {
+        TrackSegmentRun run = { n, segno };
+        m_SegmentRuns.push_back( run );
+    }
+}
+
+//  Changes a point in the columns, and in its view if it has one
+void Track::SetPoint( int nWhichPoint, double lat, double lon, wxDateTime time )
+{
+    m_PointLat[nWhichPoint] = lat;
+    m_PointLon[nWhichPoint] = lon;
+    SetPointTime( nWhichPoint, TimeFromDateTime( time ) );
+    m_Revision++;
+
+    std::map<int, TrackPoint*>::iterator it = m_PointViews.find( nWhichPoint );
+    if( it != m_PointViews.end() ) {
+        it->second->m_lat = lat;
+        it->second->m_lon = lon;
+        it->second->SetTime( GetPointTime( nWhichPoint ) );
+    }
+}
+
+//  Moves the entries of a per point map after nWhichPoint down by one
+template <class T> static void RenumberAfter( std::map<int, T> &points, int nWhichPoint )
+{
+    typename std::map<int, T>::iterator it = points.upper_bound( nWhichPoint );
+    std::vector< std::pair<int, T> > moved( it, points.end() );
+    points.erase( it, points.end() );
+    for( size_t i = 0; i < moved.size(); i++ )
+        points[moved[i].first - 1] = moved[i].second;
+}
+
+/* Removes one point.  Cheap near the end of the track, which is where the
+   active track trims.  As before, the SubTracks are left alone: their boxes
+   only grow, and FinalizeLastPoint refreshes the tail */
+void Track::RemovePoint( int nWhichPoint )
+{
+    m_PointLat.erase( m_PointLat.begin() + nWhichPoint );
+    m_PointLon.erase( m_PointLon.begin() + nWhichPoint );
+    m_PointTime.erase( m_PointTime.begin() + nWhichPoint );
+    m_Revision++;
+
+    m_FarTimes.erase( nWhichPoint );
+    RenumberAfter( m_FarTimes, nWhichPoint );
+
+    std::map<int, TrackPoint*>::iterator it = m_PointViews.find( nWhichPoint );
+    if( it != m_PointViews.end() ) {
+        delete it->second;
+        m_PointViews.erase( it );
+    }
+    RenumberAfter( m_PointViews, nWhichPoint );
+
+    //  Shift the runs after the point, dropping any left empty
+    int n = GetnPoints();
+    std::vector<TrackSegmentRun> runs;
+    for( size_t i = 0; i < m_SegmentRuns.size(); i++ ) {
+        TrackSegmentRun run = m_SegmentRuns[i];
+        if( run.first > nWhichPoint )
+            run.first--;
+        if( run.first >= n )
+            continue;
+        while( !runs.empty() && runs.back().first == run.first )
+            runs.pop_back();
+        if( runs.empty() || runs.back().segno != run.segno )
+            runs.push_back( run );
+    }
+    m_SegmentRuns.swap( runs );
+}
+
+//  Keeps the points flagged in keeplist, dropping the others with their views
+void Track::KeepPoints( const std::vector<bool> &keeplist )
+{
+    std::vector<double> lat, lon;
+    std::vector<wxInt32> time;
+    std::map<int, wxInt64> far_times;
+    std::vector<TrackSegmentRun> runs;
+    std::map<int, TrackPoint*> views;
+
+    size_t run = 0;
+    for( int i = 0; i < GetnPoints(); i++ ) {
+        while( run + 1 < m_SegmentRuns.size() && m_SegmentRuns[run + 1].first <= i )
+            run++;
+
+        std::map<int, TrackPoint*>::iterator itv = m_PointViews.find( i );
+        if( !keeplist[i] ) {
+            if( itv != m_PointViews.end() )
+                delete itv->second;
+            continue;
+        }
+
+        int k = lat.size();
+        lat.push_back( m_PointLat[i] );
+        lon.push_back( m_PointLon[i] );
+        time.push_back( m_PointTime[i] );
+        if( m_PointTime[i] == TRACK_TIME_FAR )
+            far_times[k] = m_FarTimes[i];
+
+        int segno = m_SegmentRuns[run].segno;
+        if( runs.empty() || runs.back().segno != segno ) {
+            TrackSegmentRun r = { k, segno };
+            runs.push_back( r );
+        }
+
+        if( itv != m_PointViews.end() )
+            views[k] = itv->second;
+    }
+
+    m_PointLat.swap( lat );
+    m_PointLon.swap( lon );
+    m_PointTime.swap( time );
+    m_FarTimes.swap( far_times );
+    m_SegmentRuns.swap( runs );
+    m_PointViews.swap( views );
+    m_Revision++;
+    SubTracks.clear();
 }
 
 static double heading_diff(double x)
@@ -772,8 +1087,8 @@ double Track::ComputeScale(int left, int right)
     // better performance with loss of rendering track accuracy
 
     double max_dist = 0;
-    double lata = TrackPoints[left]->m_lat, lona = TrackPoints[left]->m_lon;
-    double latb = TrackPoints[right]->m_lat, lonb = TrackPoints[right]->m_lon;
+    double lata = m_PointLat[left], lona = m_PointLon[left];
+    double latb = m_PointLat[right], lonb = m_PointLon[right];
 
     double bx = heading_diff(lonb - lona), by = latb - lata;
 
@@ -786,7 +1101,7 @@ double Track::ComputeScale(int left, int right)
 
     if ( lengthSquared == 0.0 ) {
         for(int i = left+1; i < right; i++) {
-            double lat = TrackPoints[i]->m_lat, lon = TrackPoints[i]->m_lon;
+            double lat = m_PointLat[i], lon = m_PointLon[i];
             // v == w case
             double vx = heading_diff(lon - lona);
             double vy = lat - lata;
@@ -798,7 +1113,7 @@ double Track::ComputeScale(int left, int right)
     } else {
         double invLengthSquared = 1/lengthSquared;
         for(int i = left+1; i < right; i++) {
-            double lat = TrackPoints[i]->m_lat, lon = TrackPoints[i]->m_lon;
+            double lat = m_PointLat[i], lon = m_PointLon[i];
 
             double vx = heading_diff(lon - lona);
             double vy = lat - lata;
@@ -827,10 +1142,25 @@ double Track::ComputeScale(int left, int right)
 
 /* Add a point to a track, should be iterated
    on to build up a track from data.  If a track
-   is being slowing enlarged, see AddPointFinalized below */
+   is being slowing enlarged, see AddNewPoint below.
+   The track keeps pNewPoint, as the view of the new point */
 void Track::AddPoint( TrackPoint *pNewPoint )
 {
-    TrackPoints.push_back( pNewPoint );
+    AppendPoint( pNewPoint->m_lat, pNewPoint->m_lon, pNewPoint->m_time, pNewPoint->m_GPXTrkSegNo );
+    m_PointViews[GetnPoints() - 1] = pNewPoint;
+    SubTracks.clear(); // invalidate subtracks
+}
+
+void Track::AddPoint( double lat, double lon, wxDateTime time, int segno )
+{
+    AppendPoint( lat, lon, TimeFromDateTime( time ), segno );
+    SubTracks.clear(); // invalidate subtracks
+}
+
+/* As AddPoint, with the time as found in a GPX file */
+void Track::AddGPXPoint( double lat, double lon, const char *gpx_time, int segno )
+{
+    AppendPoint( lat, lon, ParseTime( gpx_time ), segno );
     SubTracks.clear(); // invalidate subtracks
 }
 
@@ -861,7 +1191,7 @@ void Track::GetPointLists(std::list< std::list<wxPoint> > &pointlists,
     if( IsRunning() ) {
         std::list<wxPoint> new_list;
         pointlists.push_back(new_list);
-        AddPointToList(pointlists, TrackPoints.size()-1);
+        AddPointToList(pointlists, GetnPoints()-1);
         wxPoint r;
         cc1->GetCanvasPointPix( gLat, gLon, &r );
         pointlists.back().push_back(r);
@@ -876,17 +1206,17 @@ void Track::Finalize()
 
 //    OCPNStopWatch sw1;
 
-    int n = TrackPoints.size() - 1;
+    int n = GetnPoints() - 1;
     int level = 0;
     while(n > 0) {
         std::vector <SubTrack> new_level;
         new_level.resize(n);
         if(level == 0)
             for(int i=0; i<n; i++) {
-                new_level[i].m_box.SetFromSegment(TrackPoints[i]->m_lat,
-                                                  TrackPoints[i]->m_lon,
-                                                  TrackPoints[i+1]->m_lat,
-                                                  TrackPoints[i+1]->m_lon);
+                new_level[i].m_box.SetFromSegment(m_PointLat[i],
+                                                  m_PointLon[i],
+                                                  m_PointLat[i+1],
+                                                  m_PointLon[i+1]);
                 new_level[i].m_scale = 0;
             }
         else {
@@ -897,7 +1227,7 @@ void Track::Finalize()
                     new_level[i].m_box.Expand(SubTracks[level-1][p+1].m_box);
 
                 int left = i << level;
-                int right = wxMin(left + (1 << level), TrackPoints.size() - 1);
+                int right = wxMin(left + (1 << level), GetnPoints() - 1);
                 new_level[i].m_scale = ComputeScale(left, right);
             }
         }
@@ -908,8 +1238,8 @@ void Track::Finalize()
         n >>= 1;
         level++;
     }
-//    if(TrackPoints.size() > 100)
-//        printf("fin time %f %d\n", sw1.GetTime(), (int)TrackPoints.size());
+//    if(GetnPoints() > 100)
+//        printf("fin time %f %d\n", sw1.GetTime(), GetnPoints());
 }
 
 // recursive subtracks fixer for appending a single point
@@ -934,7 +1264,7 @@ void Track::InsertSubTracks(LLBBox &box, int level, int pos)
         SubTracks[level][pos].m_scale = 0;
     else {
         int left = pos << level;
-        int right = wxMin(left + (1 << level), TrackPoints.size() - 1);
+        int right = wxMin(left + (1 << level), GetnPoints() - 1);
         SubTracks[level][pos].m_scale = ComputeScale(left, right);
     }
     
@@ -942,40 +1272,36 @@ void Track::InsertSubTracks(LLBBox &box, int level, int pos)
         InsertSubTracks(box, level + 1, pos >> 1);
 }
 
-/* This function adds a new point ensuring the resulting track is finalized
+/* This function brings the subtracks up to date with a point just appended,
+   ensuring the resulting track is finalized
    The runtime of this routine is O(log(n)) which is an an improvment over
    blowing away the subtracks and calling Finalize which is O(n),
    but should not be used for building a large track O(n log(n)) which
    _is_ worse than blowing the subtracks and calling Finalize.
 */
-void Track::AddPointFinalized( TrackPoint *pNewPoint )
+void Track::FinalizeLastPoint()
 {
-    TrackPoints.push_back( pNewPoint );
-
-    int pos = TrackPoints.size() - 1;
+    int pos = GetnPoints() - 1;
 
     if(pos > 0) {
         LLBBox box;
-        box.SetFromSegment(TrackPoints[pos-1]->m_lat,
-                           TrackPoints[pos-1]->m_lon,
-                           TrackPoints[pos]->m_lat,
-                           TrackPoints[pos]->m_lon);
+        box.SetFromSegment(m_PointLat[pos-1],
+                           m_PointLon[pos-1],
+                           m_PointLat[pos],
+                           m_PointLon[pos]);
         InsertSubTracks(box, 0, pos-1);
     }
 }
 
-TrackPoint* Track::AddNewPoint( vector2D point, wxDateTime time )
+void Track::AddNewPoint( vector2D point, wxDateTime time )
 {
-    TrackPoint *tPoint = new TrackPoint( point.lat, point.lon, time );
-
-    AddPointFinalized( tPoint );
+    AppendPoint( point.lat, point.lon, TimeFromDateTime( time ), 1 );
+    FinalizeLastPoint();
 
-    pConfig->AddNewTrackPoint( tPoint, m_GUID );        // This will update the "changes" file only
-    return tPoint;
+    pConfig->AddNewTrackPoint( this, GetnPoints() - 1 );
 }
 
-void Track::DouglasPeuckerReducer( std::vector<TrackPoint*>& list,
-                                   std::vector<bool> & keeplist,
+void Track::DouglasPeuckerReducer( std::vector<bool> & keeplist,
                                    int from, int to, double delta ) {
     keeplist[from] = true;
     keeplist[to] = true;
@@ -985,7 +1311,7 @@ void Track::DouglasPeuckerReducer( std::vector<TrackPoint*>& list,
 
     for( int i=from+1; i<to; i++ ) {
 
-        double dist = 1852.0 * GetXTE( list[from], list[to], list[i] );
+        double dist = 1852.0 * GetXTE( from, to, i );
 
         if( dist > maxdist ) {
             maxdist = dist;
@@ -994,26 +1320,23 @@ void Track::DouglasPeuckerReducer( std::vector<TrackPoint*>& list,
     }
 
     if( maxdist > delta ) {
-        DouglasPeuckerReducer( list, keeplist, from, maxdistIndex, delta );
-        DouglasPeuckerReducer( list, keeplist, maxdistIndex, to, delta );
+        DouglasPeuckerReducer( keeplist, from, maxdistIndex, delta );
+        DouglasPeuckerReducer( keeplist, maxdistIndex, to, delta );
     }
 }
 
 double Track::Length()
 {
-    TrackPoint *l = NULL;
     double total = 0.0;
-    for(size_t i = 0; i < TrackPoints.size(); i++) {
-        TrackPoint *t = TrackPoints[i];
-        if(l) {
-            const double offsetLat = 1e-6;
-            const double deltaLat = l->m_lat - t->m_lat;
-            if ( fabs( deltaLat ) > offsetLat )
-                total += DistGreatCircle( l->m_lat, l->m_lon, t->m_lat, t->m_lon );
-            else
-                total += DistGreatCircle( l->m_lat + copysign( offsetLat, deltaLat ), l->m_lon, t->m_lat, t->m_lon );
-        }
-        l = t;
+    for(int i = 1; i < GetnPoints(); i++) {
+        double llat = m_PointLat[i-1], llon = m_PointLon[i-1];
+        double tlat = m_PointLat[i], tlon = m_PointLon[i];
+        const double offsetLat = 1e-6;
+        const double deltaLat = llat - tlat;
+        if ( fabs( deltaLat ) > offsetLat )
+            total += DistGreatCircle( llat, llon, tlat, tlon );
+        else
+            total += DistGreatCircle( llat + copysign( offsetLat, deltaLat ), llon, tlat, tlon );
     }
 
     return total;
@@ -1023,31 +1346,18 @@ int Track::Simplify( double maxDelta )
 {
     int reduction = 0;
 
-    std::vector<TrackPoint*> pointlist;
-    std::vector<bool> keeplist;
+    std::vector<bool> keeplist( GetnPoints(), false );
 
     ::wxBeginBusyCursor();
 
-    for(size_t i = 0; i < TrackPoints.size(); i++) {
-        TrackPoint *trackpoint = TrackPoints[i];
-
-        pointlist.push_back(trackpoint);
-        keeplist.push_back(false);
-    }
-
-    DouglasPeuckerReducer( pointlist, keeplist, 0, pointlist.size()-1, maxDelta );
+    DouglasPeuckerReducer( keeplist, 0, GetnPoints()-1, maxDelta );
 
     pSelect->DeleteAllSelectableTrackSegments( this );
-    TrackPoints.clear();
 
-    for( size_t i=0; i<pointlist.size(); i++ ) {
-        if( keeplist[i] )
-            TrackPoints.push_back( pointlist[i] );
-        else {
-            delete pointlist[i];
+    for( size_t i=0; i<keeplist.size(); i++ )
+        if( !keeplist[i] )
             reduction++;
-        }
-    }
+    KeepPoints( keeplist );
 
     pSelect->AddAllSelectableTrackSegments( this );
 
@@ -1061,17 +1371,17 @@ Route *Track::RouteFromTrack( wxGenericProgressDialog *pprog )
 
     Route *route = new Route();
 
-    TrackPoint *pWP_src = TrackPoints.front();
-    size_t prpnodeX;
+    int pWP_src = 0;
+    int prpnodeX;
     RoutePoint *pWP_dst, *pWP_prev;
-    TrackPoint *prp_OK = NULL;  // last routepoint known not to exceed xte limit, if not yet added
+    int prp_OK = -1;  // last routepoint known not to exceed xte limit, if not yet added
 
     wxString icon = _T("xmblue");
     if( g_TrackDeltaDistance >= 0.1 ) icon = _T("diamond");
 
     int next_ic = 0;
     int back_ic = 0;
-    int nPoints = TrackPoints.size();
+    int nPoints = GetnPoints();
     bool isProminent = true;
     double delta_dist = 0.;
     double delta_hdg, xte;
@@ -1084,7 +1394,7 @@ Route *Track::RouteFromTrack( wxGenericProgressDialog *pprog )
 
 // add first point
 
-    pWP_dst = new RoutePoint( pWP_src->m_lat, pWP_src->m_lon, icon, _T ( "" ), wxEmptyString );
+    pWP_dst = new RoutePoint( m_PointLat[pWP_src], m_PointLon[pWP_src], icon, _T ( "" ), wxEmptyString );
     route->AddPoint( pWP_dst );
 
     pWP_dst->m_bShowName = false;
@@ -1093,8 +1403,8 @@ Route *Track::RouteFromTrack( wxGenericProgressDialog *pprog )
     pWP_prev = pWP_dst;
 // add intermediate points as needed
 
-    for(size_t i = 1; i < TrackPoints.size();) {
-        TrackPoint *prp = TrackPoints[i];
+    for(int i = 1; i < nPoints;) {
+        int prp = i;
         prpnodeX = i;
         pWP_dst->m_lat = pWP_prev->m_lat;
         pWP_dst->m_lon = pWP_prev->m_lon;
@@ -1104,10 +1414,10 @@ Route *Track::RouteFromTrack( wxGenericProgressDialog *pprog )
         delta_hdg = 0.0;
         back_ic = next_ic;
 
-        DistanceBearingMercator( prp->m_lat, prp->m_lon, pWP_prev->m_lat, pWP_prev->m_lon, &delta_hdg,
+        DistanceBearingMercator( m_PointLat[prp], m_PointLon[prp], pWP_prev->m_lat, pWP_prev->m_lon, &delta_hdg,
                 &delta_dist );
 
-        if( ( delta_dist > ( leg_speed * 6.0 ) ) && !prp_OK ) {
+        if( ( delta_dist > ( leg_speed * 6.0 ) ) && prp_OK < 0 ) {
             int delta_inserts = floor( delta_dist / ( leg_speed * 4.0 ) );
             delta_dist = delta_dist / ( delta_inserts + 1 );
             double tlat = 0.0;
@@ -1135,16 +1445,16 @@ Route *Track::RouteFromTrack( wxGenericProgressDialog *pprog )
         } else {
             isProminent = false;
             if( delta_dist >= ( leg_speed * 4.0 ) ) isProminent = true;
-            if( !prp_OK ) prp_OK = prp;
+            if( prp_OK < 0 ) prp_OK = prp;
         }
-        while( prpnodeX < TrackPoints.size() ) {
+        while( prpnodeX < nPoints ) {
 
-            TrackPoint *prpX = TrackPoints[prpnodeX];
+            int prpX = prpnodeX;
 //            TrackPoint src(pWP_prev->m_lat, pWP_prev->m_lon);
             xte = GetXTE( pWP_src, prpX, prp );
             if( isProminent || ( xte > g_TrackDeltaDistance ) ) {
 
-                pWP_dst = new RoutePoint( prp_OK->m_lat, prp_OK->m_lon, icon, _T ( "" ),
+                pWP_dst = new RoutePoint( m_PointLat[prp_OK], m_PointLon[prp_OK], icon, _T ( "" ),
                         wxEmptyString );
 
                 route->AddPoint( pWP_dst );
@@ -1157,24 +1467,24 @@ Route *Track::RouteFromTrack( wxGenericProgressDialog *pprog )
 
                 pWP_prev = pWP_dst;
                 next_ic = 0;
-                prpnodeX = TrackPoints.size();
-                prp_OK = NULL;
+                prpnodeX = nPoints;
+                prp_OK = -1;
             }
 
-            if( prpnodeX != TrackPoints.size()) prpnodeX--;
+            if( prpnodeX != nPoints) prpnodeX--;
             if( back_ic-- <= 0 ) {
-                prpnodeX = TrackPoints.size();
+                prpnodeX = nPoints;
             }
         }
 
-        if( prp_OK ) {
+        if( prp_OK >= 0 ) {
             prp_OK = prp;
         }
 
-        DistanceBearingMercator( prp->m_lat, prp->m_lon, pWP_prev->m_lat, pWP_prev->m_lon, NULL,
+        DistanceBearingMercator( m_PointLat[prp], m_PointLon[prp], pWP_prev->m_lat, pWP_prev->m_lon, NULL,
                 &delta_dist );
 
-        if( !( ( delta_dist > ( g_TrackDeltaDistance ) ) && !prp_OK ) ) {
+        if( !( ( delta_dist > ( g_TrackDeltaDistance ) ) && prp_OK < 0 ) ) {
             i++;
             next_ic++;
         }
@@ -1183,8 +1493,8 @@ Route *Track::RouteFromTrack( wxGenericProgressDialog *pprog )
 
 // add last point, if needed
     if( delta_dist >= g_TrackDeltaDistance ) {
-        pWP_dst = new RoutePoint( TrackPoints.back()->m_lat,
-                                  TrackPoints.back()->m_lon,
+        pWP_dst = new RoutePoint( m_PointLat.back(),
+                                  m_PointLon.back(),
                                   icon, _T ( "" ), wxEmptyString );
         route->AddPoint( pWP_dst );
 
@@ -1242,11 +1552,11 @@ double Track::GetXTE( double fm1Lat, double fm1Lon, double fm2Lat, double fm2Lon
     return _distance(p, projection);
 }
 
-double Track::GetXTE( TrackPoint *fm1, TrackPoint *fm2, TrackPoint *to )
+double Track::GetXTE( int fm1, int fm2, int to )
 {
-    if( !fm1 || !fm2 || !to ) return 0.0;
+    if( fm1 < 0 || fm2 < 0 || to < 0 ) return 0.0;
     if( fm1 == to ) return 0.0;
     if( fm2 == to ) return 0.0;
-    return GetXTE( fm1->m_lat, fm1->m_lon, fm2->m_lat, fm2->m_lon, to->m_lat, to->m_lon );
+    return GetXTE( m_PointLat[fm1], m_PointLon[fm1], m_PointLat[fm2], m_PointLon[fm2], m_PointLat[to], m_PointLon[to] );
 ;
 }
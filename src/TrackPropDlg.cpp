@@ -1622,11 +1622,9 @@ wxString OCPNTrackListCtrl::OnGetItemText( long item, long column ) const
     if(item < 0 || item >= m_pTrack->GetnPoints())
         return wxEmptyString;
     
-    TrackPoint              *this_point = m_pTrack->GetPoint(item);
-    TrackPoint              *prev_point = item > 0 ? m_pTrack->GetPoint(item-1) : NULL;
-
-    if( ! this_point )
-        return wxEmptyString;
+    //  Straight from the track's columns, so scrolling the list makes no point views
+    double this_lat = m_pTrack->GetPointLat(item), this_lon = m_pTrack->GetPointLon(item);
+    wxDateTime this_time = m_pTrack->GetPointCreateTime(item);
 
     double                  gt_brg, gt_leg_dist;
     double slat, slon;
@@ -1637,8 +1635,8 @@ wxString OCPNTrackListCtrl::OnGetItemText( long item, long column ) const
     }
     else
     {
-        slat = prev_point->m_lat;
-        slon = prev_point->m_lon;
+        slat = m_pTrack->GetPointLat(item-1);
+        slon = m_pTrack->GetPointLon(item-1);
     }
 
     switch( column )
@@ -1651,27 +1649,27 @@ wxString OCPNTrackListCtrl::OnGetItemText( long item, long column ) const
             break;
 
         case 1:
-            DistanceBearingMercator( this_point->m_lat, this_point->m_lon, slat, slon, &gt_brg, &gt_leg_dist );
+            DistanceBearingMercator( this_lat, this_lon, slat, slon, &gt_brg, &gt_leg_dist );
 
             ret.Printf( _T("%6.2f ") + getUsrDistanceUnit(), toUsrDistance( gt_leg_dist ) );
             break;
 
         case 2:
-            DistanceBearingMercator( this_point->m_lat, this_point->m_lon, slat, slon, &gt_brg, &gt_leg_dist );
+            DistanceBearingMercator( this_lat, this_lon, slat, slon, &gt_brg, &gt_leg_dist );
             ret.Printf( _T("%03.0f \u00B0T"), gt_brg );
             break;
 
         case 3:
-            ret = toSDMM( 1, this_point->m_lat, 1 );
+            ret = toSDMM( 1, this_lat, 1 );
             break;
 
         case 4:
-            ret = toSDMM( 2, this_point->m_lon, 1 );
+            ret = toSDMM( 2, this_lon, 1 );
             break;
 
         case 5:
             {
-                wxDateTime timestamp = this_point->GetCreateTime();
+                wxDateTime timestamp = this_time;
                 if( timestamp.IsValid() )
                     ret = timestamp2s( timestamp, m_tz_selection, m_LMT_Offset, TIMESTAMP_FORMAT );
                 else
@@ -1680,13 +1678,13 @@ wxString OCPNTrackListCtrl::OnGetItemText( long item, long column ) const
             break;
 
         case 6:
-            if( ( item > 0 ) && this_point->GetCreateTime().IsValid()
-                    && prev_point->GetCreateTime().IsValid() )
+            if( ( item > 0 ) && this_time.IsValid()
+                    && m_pTrack->GetPointCreateTime(item-1).IsValid() )
             {
-                DistanceBearingMercator( this_point->m_lat, this_point->m_lon, slat, slon, &gt_brg, &gt_leg_dist );
+                DistanceBearingMercator( this_lat, this_lon, slat, slon, &gt_brg, &gt_leg_dist );
                 double speed = 0.;
                 double seconds =
-                        this_point->GetCreateTime().Subtract( prev_point->GetCreateTime() ).GetSeconds().ToDouble();
+                        this_time.Subtract( m_pTrack->GetPointCreateTime(item-1) ).GetSeconds().ToDouble();
 
                 if( seconds > 0. )
                     speed = gt_leg_dist / seconds * 3600;
@@ -115,6 +115,7 @@
 
 #ifdef ocpnUSE_GL
 #include "glChartCanvas.h"
+#include "glTexCacheBuilder.h"
 #endif
 
 #include <wx/image.h>
@@ -128,6 +129,7 @@
 #include "cm93.h"
 #include "s52plib.h"
 #include "s57chart.h"
+#include "SENCBuildScheduler.h"
 #include "mygdal/cpl_csv.h"
 #include "s52utils.h"
 #endif
@@ -183,6 +185,12 @@ int                       g_unit_test_1;
 int                       g_unit_test_2;
 bool                      g_start_fullscreen;
 bool                      g_rebuild_gl_cache;
+bool                      g_build_gl_cache;
+wxString                  g_build_gl_cache_dir;
+bool                      g_benchmark_llregion;
+bool                      g_benchmark_gshhs;
+bool                      g_benchmark_chartstack;
+wxString                  g_ais_replay_file;
 bool                      g_parse_all_enc;
 
 // Files specified on the command line, if any.
@@ -386,6 +394,7 @@ bool                      g_bShowCurrent;
 s52plib                   *ps52plib;
 S57ClassRegistrar         *g_poRegistrar;
 s57RegistrarMgr           *m_pRegistrarMan;
+SENCBuildScheduler        *g_pSENCBuildScheduler;
 
 CM93OffsetDialog          *g_pCM93OffsetDialog;
 #endif
@@ -722,6 +731,7 @@ bool              g_benableUDPNullHeader;
 
 extern wxString OpenCPNVersion; //Gunther
 extern options          *g_pOptions;
+extern int              g_nCPUCount;
 
 int n_NavMessageShown;
 wxString g_config_version_string;
@@ -1061,6 +1071,226 @@ END_EVENT_TABLE()
 
 #include "wx/dynlib.h"
 
+#ifdef ocpnUSE_GL
+//  Fill the compressed raster texture cache, for the -build_gl_raster_cache options
+static bool BuildGLRasterCache()
+{
+    glTexCacheBuilder builder;
+
+    if( !g_build_gl_cache_dir.IsEmpty() ) {
+        if( !builder.AddDirectory( g_build_gl_cache_dir ) ) {
+            wxPrintf( _T("No raster charts found in %s\n"), g_build_gl_cache_dir );
+            return false;
+        }
+    } else {
+        ArrayOfCDI ChartDirArray;
+        pConfig->LoadChartDirArray( ChartDirArray );
+
+        ChartDB chart_db;
+        if( !ChartDirArray.GetCount() || !chart_db.LoadBinary( ChartListFileName, ChartDirArray ) ) {
+            wxPrintf( _T("No chart database, use -build_gl_raster_cache_dir <dir>\n") );
+            return false;
+        }
+        builder.AddChartDB( &chart_db );
+    }
+
+    int nthreads = wxThread::GetCPUCount();
+    if( g_nCPUCount > 0 )
+        nthreads = g_nCPUCount;
+
+    return builder.Run( wxMax( nthreads, 1 ) );
+}
+#endif
+
+//  The coverage of a chart, as the quilt takes it, before clipping to the view
+static LLRegion BenchmarkCoverage( const ChartTableEntry &cte )
+{
+    LLRegion region;
+
+    int nAuxPlyEntries = cte.GetnAuxPlyEntries();
+    for( int ip = 0; ip < nAuxPlyEntries; ip++ ) {
+        LLRegion t_region( cte.GetAuxCntTableEntry( ip ), cte.GetpAuxPlyTableEntry( ip ) );
+        region.Union( t_region );
+    }
+    if( nAuxPlyEntries == 0 && cte.GetnPlyEntries() >= 3 )
+        region = LLRegion( cte.GetnPlyEntries(), cte.GetpPlyTable() );
+
+    for( int ip = 0; ip < cte.GetnNoCovrPlyEntries(); ip++ ) {
+        LLRegion t_region( cte.GetNoCovrCntTableEntry( ip ), cte.GetpNoCovrPlyTableEntry( ip ) );
+        region.Subtract( t_region );
+    }
+    return region;
+}
+
+struct BenchmarkChart
+{
+    int         dbIndex;
+    int         scale;
+
+    bool operator<( const BenchmarkChart &c ) const { return scale < c.scale; }
+};
+
+//  Time the LLRegion operations of the quilt on the charts of the chart database,
+//  with the GLU tessellator and with the native clipper, for -benchmark_llregion.
+//  The coverage of every chart is built from its M_COVR plys, then views around
+//  the charts are composed, largest scale first, as the quilt does.
+static bool BenchmarkLLRegion()
+{
+    ArrayOfCDI ChartDirArray;
+    pConfig->LoadChartDirArray( ChartDirArray );
+
+    ChartDB chart_db;
+    if( !ChartDirArray.GetCount() || !chart_db.LoadBinary( ChartListFileName, ChartDirArray ) ) {
+        wxPrintf( _T("No chart database\n") );
+        return false;
+    }
+
+    std::vector<BenchmarkChart> charts;
+    for( int i = 0; i < chart_db.GetChartTableEntries(); i++ ) {
+        const ChartTableEntry &cte = chart_db.GetChartTableEntry( i );
+        if( fabs( cte.GetLonMax() - cte.GetLonMin() ) > 180. )
+            continue;
+        BenchmarkChart c = { i, cte.GetScale() };
+        charts.push_back( c );
+    }
+    std::sort( charts.begin(), charts.end() );
+    if( charts.empty() ) {
+        wxPrintf( _T("No charts with coverage in the chart database\n") );
+        return false;
+    }
+
+    //  At most 200 views, each twice the size of a chart, centered on it
+    std::vector<LLBBox> views;
+    int step = wxMax( 1, (int)charts.size() / 200 );
+    for( size_t i = 0; i < charts.size(); i += step ) {
+        const LLBBox &box = chart_db.GetChartTableEntry( charts[i].dbIndex ).GetBBox();
+        double lat = ( box.GetMinLat() + box.GetMaxLat() ) / 2, lon = ( box.GetMinLon() + box.GetMaxLon() ) / 2;
+        double dlat = box.GetLatRange(), dlon = box.GetLonRange();
+        LLBBox view;
+        view.Set( wxMax( lat - dlat, -89.9 ), lon - dlon, wxMin( lat + dlat, 89.9 ), lon + dlon );
+        views.push_back( view );
+    }
+
+    wxPrintf( _T("%d charts, %d views\n"), (int)charts.size(), (int)views.size() );
+
+    bool bglu = LLRegion::IsUsingGLUClipper();
+    std::vector<double> coverage_area[2], view_area[2];
+    for( int pass = 0; pass < 2; pass++ ) {
+        LLRegion::UseGLUClipper( pass == 0 );
+
+        wxStopWatch sw;
+        std::vector<LLRegion> coverage( charts.size() );
+        long vertices = 0;
+        for( size_t i = 0; i < charts.size(); i++ ) {
+            coverage[i] = BenchmarkCoverage( chart_db.GetChartTableEntry( charts[i].dbIndex ) );
+            coverage_area[pass].push_back( coverage[i].GetArea() );
+            for( std::list<poly_contour>::iterator j = coverage[i].contours.begin(); j != coverage[i].contours.end(); j++ )
+                vertices += j->size();
+        }
+        long coverage_ms = sw.Time();
+
+        sw.Start();
+        long ops = 0;
+        for( size_t v = 0; v < views.size(); v++ ) {
+            LLRegion view_region( views[v] ), covered;
+            for( size_t i = 0; i < charts.size(); i++ ) {
+                LLRegion region = coverage[i];
+                region.Intersect( view_region );
+                ops++;
+                if( region.Empty() )
+                    continue;
+                region.Subtract( covered );
+                covered.Union( region );
+                ops += 2;
+            }
+            view_area[pass].push_back( covered.GetArea() );
+        }
+        long views_ms = sw.Time();
+
+        wxPrintf( _T("%s: coverage %ld ms (%ld vertices), views %ld ms (%ld operations)\n"),
+                  pass ? _T("native") : _T("GLU   "), coverage_ms, vertices, views_ms, ops );
+    }
+    LLRegion::UseGLUClipper( bglu );
+
+    //  The results should agree to the rounding of LLRegion::Optimize()
+    int ndiffer = 0;
+    double maxdiff = 0;
+    for( int k = 0; k < 2; k++ ) {
+        std::vector<double> *area = k ? view_area : coverage_area;
+        for( size_t i = 0; i < area[0].size(); i++ ) {
+            double diff = fabs( area[0][i] - area[1][i] ) / ( fabs( area[0][i] ) + 1e-6 );
+            maxdiff = wxMax( maxdiff, diff );
+            if( diff > 1e-4 )
+                ndiffer++;
+        }
+    }
+    wxPrintf( _T("%d of %d areas differ, largest relative difference %g\n"),
+              ndiffer, (int)( coverage_area[0].size() + view_area[0].size() ), maxdiff );
+
+    return ndiffer == 0;
+}
+
+//  Time ChartDB::BuildChartStack() on the charts of the chart database, with the
+//  chart table index and with every chart tested, for -benchmark_chartstack.
+//  Stacks are built at the center of the charts and halfway to their corners.
+static bool BenchmarkChartStack()
+{
+    ArrayOfCDI ChartDirArray;
+    pConfig->LoadChartDirArray( ChartDirArray );
+
+    ChartDB chart_db;
+    if( !ChartDirArray.GetCount() || !chart_db.LoadBinary( ChartListFileName, ChartDirArray ) ) {
+        wxPrintf( _T("No chart database\n") );
+        return false;
+    }
+
+    //  At most 2000 charts, 5 positions each
+    int nentries = chart_db.GetChartTableEntries();
+    int step = wxMax( 1, nentries / 2000 );
+    std::vector<float> lats, lons;
+    for( int i = 0; i < nentries; i += step ) {
+        const LLBBox &box = chart_db.GetChartTableEntry( i ).GetBBox();
+        double lat = ( box.GetMinLat() + box.GetMaxLat() ) / 2, lon = ( box.GetMinLon() + box.GetMaxLon() ) / 2;
+        double dlat = box.GetLatRange() / 4, dlon = box.GetLonRange() / 4;
+        for( int k = 0; k < 5; k++ ) {
+            lats.push_back( lat + ( k == 0 ? 0 : k & 1 ? dlat : -dlat ) );
+            lons.push_back( lon + ( k == 0 ? 0 : k & 2 ? dlon : -dlon ) );
+        }
+    }
+    if( lats.empty() ) {
+        wxPrintf( _T("No charts in the chart database\n") );
+        return false;
+    }
+
+    wxPrintf( _T("%d charts, %d positions\n"), nentries, (int)lats.size() );
+
+    std::vector<int> stacks[2];
+    for( int pass = 0; pass < 2; pass++ ) {
+        ChartDB::UseChartTableIndex( pass == 0 );
+
+        wxStopWatch sw;
+        long entries = 0;
+        for( size_t i = 0; i < lats.size(); i++ ) {
+            ChartStack stack;
+            chart_db.BuildChartStack( &stack, lats[i], lons[i] );
+            entries += stack.nEntry;
+            stacks[pass].push_back( stack.nEntry );
+            for( int j = 0; j < stack.nEntry; j++ )
+                stacks[pass].push_back( stack.GetDBIndex( j ) );
+        }
+        long ms = sw.Time();
+
+        wxPrintf( _T("%s: %ld ms, %.1f us per stack (%ld entries)\n"),
+                  pass ? _T("all charts") : _T("index     "), ms, 1000. * ms / lats.size(), entries );
+    }
+    ChartDB::UseChartTableIndex( true );
+
+    bool same = stacks[0] == stacks[1];
+    wxPrintf( _T("Stacks %s\n"), same ? _T("agree") : _T("differ") );
+
+    return same;
+}
+
 #if wxUSE_CMDLINE_PARSER
 void MyApp::OnInitCmdLine( wxCmdLineParser& parser )
 {
@@ -1070,6 +1300,12 @@ void MyApp::OnInitCmdLine( wxCmdLineParser& parser )
     parser.AddSwitch( _T("fullscreen"), wxEmptyString, _("Switch to full screen mode on start.") );
     parser.AddSwitch( _T("no_opengl"), wxEmptyString, _("Disable OpenGL video acceleration. This setting will be remembered.") );
     parser.AddSwitch( _T("rebuild_gl_raster_cache"), wxEmptyString, _T("Rebuild OpenGL raster cache on start.") );
+    parser.AddSwitch( _T("build_gl_raster_cache"), wxEmptyString, _T("Build the OpenGL raster cache for the charts in the chart database, without opening a window, and then exit.") );
+    parser.AddOption( _T("build_gl_raster_cache_dir"), wxEmptyString, _T("Build the OpenGL raster cache for the charts below <dir>, without opening a window, and then exit."), wxCMD_LINE_VAL_STRING );
+    parser.AddSwitch( _T("benchmark_llregion"), wxEmptyString, _T("Time the chart region operations with the GLU tessellator and the native clipper, without opening a window, and then exit.") );
+    parser.AddSwitch( _T("benchmark_chartstack"), wxEmptyString, _T("Time chart stack builds with and without the chart table index, without opening a window, and then exit.") );
+    parser.AddSwitch( _T("benchmark_gshhs"), wxEmptyString, _T("Time land crossing tests on the GSHHS world map data, without opening a window, and then exit.") );
+    parser.AddOption( _T("benchmark_ais_replay"), wxEmptyString, _T("Replay the AIS sentences of NMEA log <file> through the AIS decoder on start, and log the decode rate."), wxCMD_LINE_VAL_STRING );
     parser.AddSwitch( _T("parse_all_enc"), wxEmptyString, _T("Convert all S-57 charts to OpenCPN's internal format on start.") );
     parser.AddOption( _T("unit_test_1"), wxEmptyString, _("Display a slideshow of <num> charts and then exit. Zero or negative <num> specifies no limit."), wxCMD_LINE_VAL_NUMBER );
 
@@ -1090,6 +1326,13 @@ bool MyApp::OnCmdLineParsed( wxCmdLineParser& parser )
     g_start_fullscreen = parser.Found( _T("fullscreen") );
     g_bdisable_opengl = parser.Found( _T("no_opengl") );
     g_rebuild_gl_cache = parser.Found( _T("rebuild_gl_raster_cache") );
+    g_build_gl_cache = parser.Found( _T("build_gl_raster_cache") );
+    if( parser.Found( _T("build_gl_raster_cache_dir"), &g_build_gl_cache_dir ) )
+        g_build_gl_cache = true;
+    g_benchmark_llregion = parser.Found( _T("benchmark_llregion") );
+    g_benchmark_gshhs = parser.Found( _T("benchmark_gshhs") );
+    g_benchmark_chartstack = parser.Found( _T("benchmark_chartstack") );
+    parser.Found( _T("benchmark_ais_replay"), &g_ais_replay_file );
     g_parse_all_enc = parser.Found( _T("parse_all_enc") );
     if( parser.Found( _T("unit_test_1"), &number ) )
     {
@@ -2072,7 +2315,7 @@ bool MyApp::OnInit()
 //  Send the Welcome/warning message if it has never been sent before,
 //  or if the version string has changed at all
 //  We defer until here to allow for localization of the message
-    if( !n_NavMessageShown || ( vs != g_config_version_string ) ) {
+    if( !g_build_gl_cache && !g_benchmark_llregion && !g_benchmark_gshhs && !g_benchmark_chartstack && ( !n_NavMessageShown || ( vs != g_config_version_string ) ) ) {
         if( wxID_CANCEL == ShowNavWarning() )
             return false;
         n_NavMessageShown = 1;
@@ -2140,6 +2383,16 @@ bool MyApp::OnInit()
 //      Establish location and name of chart database
     ChartListFileName = newPrivateFileName(g_Platform->GetPrivateDataDir(), "chartlist.dat", "CHRTLIST.DAT");
 
+#ifdef ocpnUSE_GL
+    //  Build the raster texture cache from the command line, and quit before any window is made
+    if( g_build_gl_cache )
+        exit( BuildGLRasterCache() ? EXIT_SUCCESS : EXIT_FAILURE );
+#endif
+    if( g_benchmark_llregion )
+        exit( BenchmarkLLRegion() ? EXIT_SUCCESS : EXIT_FAILURE );
+    if( g_benchmark_chartstack )
+        exit( BenchmarkChartStack() ? EXIT_SUCCESS : EXIT_FAILURE );
+
 //      Establish location and name of AIS MMSI -> Target Name mapping
     AISTargetNameFileName = newPrivateFileName(g_Platform->GetPrivateDataDir(), "mmsitoname.csv", "MMSINAME.CSV");
 
@@ -2163,6 +2416,9 @@ bool MyApp::OnInit()
         gWorldMapLocation = gDefaultWorldMapLocation;
     }
 
+    if( g_benchmark_gshhs )
+        exit( gshhsCrossesLandBenchmark( 1000000 ) ? EXIT_SUCCESS : EXIT_FAILURE );
+
     //  Check the global Tide/Current data source array
     //  If empty, preset one default (US) Ascii data source
     wxString default_tcdata =  ( g_Platform->GetSharedDataDir() + _T("tcdata") +
@@ -2658,6 +2914,10 @@ extern ocpnGLOptions g_GLOptions;
 
     wxLogMessage( wxString::Format(_("OpenCPN Initialized in %ld ms."), init_sw.Time() ) );
 
+    //  The replayed targets stay, as if they had been received
+    if( !g_ais_replay_file.IsEmpty() && g_pAIS )
+        g_pAIS->ReplayBenchmark( g_ais_replay_file );
+
     OCPNPlatform::Initialize_3( );
     
     if( n_NavMessageShown == 1 ) {
@@ -2979,6 +3239,10 @@ MyFrame::MyFrame( wxFrame *frame, const wxString& title, const wxPoint& pos, con
 MyFrame::~MyFrame()
 {
     FrameTimer1.Stop();
+#ifdef USE_S57
+    delete g_pSENCBuildScheduler;
+    g_pSENCBuildScheduler = NULL;
+#endif
     delete ChartData;
     delete pCurrentStack;
 
@@ -5068,6 +5332,7 @@ Track *MyFrame::TrackOff( bool do_add_point )
         g_pActiveTrack->Stop( do_add_point );
 
         if( g_pActiveTrack->GetnPoints() < 2 ) {
+            pConfig->DeleteConfigTrack( g_pActiveTrack );
             g_pRouteMan->DeleteTrack( g_pActiveTrack );
             return_val = NULL;
         }
@@ -5075,6 +5340,8 @@ Track *MyFrame::TrackOff( bool do_add_point )
             if( g_bTrackDaily ) {
                 Track *pExtendTrack = g_pActiveTrack->DoExtendDaily();
                 if(pExtendTrack) {
+                    pConfig->UpdateTrack( pExtendTrack );
+                    pConfig->DeleteConfigTrack( g_pActiveTrack );
                     g_pRouteMan->DeleteTrack( g_pActiveTrack );
                     return_val = pExtendTrack;
                 }
@@ -6475,6 +6742,14 @@ bool MyFrame::UpdateChartDatabaseInplace( ArrayOfCDI &DirArray, bool b_force, bo
 
     pConfig->UpdateChartDirs( DirArray );
 
+#ifdef USE_S57
+    //  Check the ENC cells and convert stale SENCs in the background
+    if( !g_pSENCBuildScheduler )
+        g_pSENCBuildScheduler = new SENCBuildScheduler;
+    g_pSENCBuildScheduler->SetFocus( vLat, vLon );
+    g_pSENCBuildScheduler->ScheduleChartDB( ChartData );
+#endif
+
     if( b_run ) FrameTimer1.Start( TIMER_GFRAME_1, wxTIMER_CONTINUOUS );
 
     return true;
@@ -7444,6 +7719,17 @@ void MyFrame::OnFrameTimer1( wxTimerEvent& event )
         }
     }
 
+#ifdef USE_S57
+    //  Bring in any cells whose SENC has been built in the background
+    if( g_pSENCBuildScheduler ) {
+        g_pSENCBuildScheduler->SetFocus( vLat, vLon );
+        if( g_pSENCBuildScheduler->TakeCompleted() ) {
+            cc1->InvalidateQuilt();
+            cc1->ReloadVP();
+        }
+    }
+#endif
+
     nBlinkerTick++;
     cc1->DrawBlinkObjects();
 
@@ -9347,9 +9633,8 @@ void MyFrame::OnEvtPlugInMessage( OCPN_MsgEvent & event )
                 v[_T("TotalNodes")] = (*it)->GetnPoints();
                 for(int j = 0; j< (*it)->GetnPoints(); j++)
                 {
-                    TrackPoint *tp = (*it)->GetPoint(j);
-                    v[_T("lat")] = tp->m_lat;
-                    v[_T("lon")] = tp->m_lon;
+                    v[_T("lat")] = (*it)->GetPointLat(j);
+                    v[_T("lon")] = (*it)->GetPointLon(j);
                     v[_T("NodeNr")] = i;
                     i++;
                     wxString msg_id( _T("OCPN_TRACKPOINTS_COORDS") );
@@ -9684,7 +9969,7 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
 
     if( event.GetStream() )
     {
-        if(!event.GetStream()->ChecksumOK(event.GetNMEAString()) )
+        if(!event.ChecksumOK() )
         {
             if( g_nNMEADebug && ( g_total_NMEAerror_messages < g_nNMEADebug ) )
             {
@@ -10327,16 +10612,14 @@ void MyFrame::UpdateAISMOBRoute( AIS_Target_Data *ptarget )
     {
         //   Update Current Ownship point
         RoutePoint *OwnPoint = pAISMOBRoute->GetPoint( 1 );
-        OwnPoint->m_lat = gLat;
-        OwnPoint->m_lon = gLon;
+        OwnPoint->SetPosition( gLat, gLon );
 
         pSelect->DeleteSelectableRoutePoint( OwnPoint );
         pSelect->AddSelectableRoutePoint( gLat, gLon, OwnPoint );
 
         //   Update Current MOB point
         RoutePoint *MOB_Point = pAISMOBRoute->GetPoint( 2 );
-        MOB_Point->m_lat = ptarget->Lat;
-        MOB_Point->m_lon = ptarget->Lon;
+        MOB_Point->SetPosition( ptarget->Lat, ptarget->Lon );
 
         pSelect->DeleteSelectableRoutePoint( MOB_Point );
         pSelect->AddSelectableRoutePoint( ptarget->Lat, ptarget->Lon, MOB_Point );
@@ -471,6 +471,13 @@ int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon, int db_add
 }
 
 
+static bool s_use_chart_table_index = true;
+
+void ChartDB::UseChartTableIndex( bool use )
+{
+      s_use_chart_table_index = use;
+}
+
 int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon)
 {
       int i=0;
@@ -482,11 +489,29 @@ int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon)
       if(!cstk)
             return 0;                           // Chartstack not ready yet
 
-      int nEntry = GetChartTableEntries();
+      const ChartTableIndex &index = GetChartTableIndex();
 
-      for(int db_index=0 ; db_index<nEntry ; db_index++)
+      //  Plugin loading is deferred, so the chart may have been disabled elsewhere.
+      //  Tentatively reenable all plugin charts in the active group so that they appear in the piano.
+      //  They will get disabled later if really not useable
+      const std::vector<int> &plugin_entries = index.GetPlugInEntries();
+      for(unsigned int ip=0 ; ip < plugin_entries.size() ; ip++)
       {
+            if(IsChartInGroup(plugin_entries[ip], g_GroupIndex))
+                  GetpChartTableEntry(plugin_entries[ip])->ReEnable();
+      }
 
+      //  Only charts whose bounding box may contain the position need the full test
+      std::vector<int> candidates;
+      if(s_use_chart_table_index)
+            index.Query(lat, lon, candidates);
+      else
+            for(int db_index=0 ; db_index<GetChartTableEntries() ; db_index++)
+                  candidates.push_back(db_index);
+
+      for(unsigned int ic=0 ; ic<candidates.size() ; ic++)
+      {
+            int db_index = candidates[ic];
             const ChartTableEntry &cte = GetChartTableEntry(db_index);
             
             //    Check to see if the candidate chart is in the currently active group
@@ -509,14 +534,6 @@ int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon)
             bool b_pos_add = false;
             if(b_group_add)
             {
-                //  Plugin loading is deferred, so the chart may have been disabled elsewhere.
-                //  Tentatively reenable the chart so that it appears in the piano.
-                //  It will get disabled later if really not useable
-                  if(cte.GetChartType() == CHART_TYPE_PLUGIN){
-                      ChartTableEntry *pcte = (ChartTableEntry*)&cte;
-                      pcte->ReEnable();
-                  }
-                  
                   if(CheckPositionWithinChart(db_index, lat, lon)  &&  (j < MAXSTACK) )
                       b_pos_add = true;
 
@@ -36,6 +36,8 @@
 #include "wx/tokenzr.h"
 #include "wx/dir.h"
 
+#include <algorithm>
+
 #include "chartdbs.h"
 #include "chartbase.h"
 #include "pluginmanager.h"
@@ -1056,6 +1058,105 @@ std::vector<float> ChartTableEntry::GetReducedAuxPlyPoints( int iTable)
 
 }
 
+///////////////////////////////////////////////////////////////////////
+// ChartTableIndex
+///////////////////////////////////////////////////////////////////////
+
+static const float s_index_cell_size[CHART_INDEX_LEVELS] = { 0.5f, 3.0f, 18.0f };
+static const int s_index_max_span = 4;         // cells per axis before moving up a level
+
+int ChartTableIndex::RowOf(int level, float lat) const
+{
+    int row = (int)floor((lat + 90.) / s_index_cell_size[level]);
+    if(row < 0) row = 0;
+    if(row >= m_nrows[level]) row = m_nrows[level] - 1;
+    return row;
+}
+
+int ChartTableIndex::ColOf(int level, float lon) const
+{
+    int col = (int)floor((lon + 180.) / s_index_cell_size[level]);
+    col %= m_ncols[level];
+    if(col < 0) col += m_ncols[level];
+    return col;
+}
+
+void ChartTableIndex::Build(const ChartTable &table)
+{
+    for(int level = 0 ; level < CHART_INDEX_LEVELS ; level++){
+        m_cells[level].clear();
+        m_ncols[level] = wxRound(360. / s_index_cell_size[level]);
+        m_nrows[level] = wxRound(180. / s_index_cell_size[level]);
+    }
+    m_global.clear();
+    m_plugin_entries.clear();
+
+    for(unsigned int i = 0 ; i < table.GetCount() ; i++){
+        const ChartTableEntry &cte = table[i];
+
+        if(cte.GetChartType() == CHART_TYPE_PLUGIN)
+            m_plugin_entries.push_back(i);
+
+        //  Disabled charts carry an offset latitude (see ChartTableEntry::Disable()),
+        //  index them at their real position so that re-enabling needs no rebuild
+        float lat_min = cte.GetLatMin();
+        float lat_max = cte.GetLatMax();
+        if(lat_max > 90.){
+            lat_min -= 1000.;
+            lat_max -= 1000.;
+        }
+        float lon_min = cte.GetLonMin();
+        float lon_max = cte.GetLonMax();
+
+        bool b_placed = false;
+        if( (lat_max >= lat_min) && (lon_max >= lon_min) && (lon_max - lon_min < 360.) ){
+            for(int level = 0 ; level < CHART_INDEX_LEVELS ; level++){
+                int r0 = RowOf(level, lat_min);
+                int r1 = RowOf(level, lat_max);
+                int c0 = (int)floor((lon_min + 180.) / s_index_cell_size[level]);
+                int c1 = (int)floor((lon_max + 180.) / s_index_cell_size[level]);
+                if( (r1 - r0 >= s_index_max_span) || (c1 - c0 >= s_index_max_span) )
+                    continue;
+
+                for(int r = r0 ; r <= r1 ; r++){
+                    for(int c = c0 ; c <= c1 ; c++){
+                        int col = c % m_ncols[level];
+                        if(col < 0) col += m_ncols[level];
+                        m_cells[level][CellKey(level, r, col)].push_back(i);
+                    }
+                }
+                b_placed = true;
+                break;
+            }
+        }
+
+        if(!b_placed)
+            m_global.push_back(i);
+    }
+
+    m_bvalid = true;
+}
+
+void ChartTableIndex::Query(float lat, float lon, std::vector<int> &result) const
+{
+    result.clear();
+    if(!m_bvalid)
+        return;
+
+    result.insert(result.end(), m_global.begin(), m_global.end());
+
+    for(int level = 0 ; level < CHART_INDEX_LEVELS ; level++){
+        std::map<int, std::vector<int> >::const_iterator it =
+                m_cells[level].find(CellKey(level, RowOf(level, lat), ColOf(level, lon)));
+        if(it != m_cells[level].end())
+            result.insert(result.end(), it->second.begin(), it->second.end());
+    }
+
+    //  Each entry lives in exactly one cell of one level, so there are no duplicates
+    std::sort(result.begin(), result.end());
+}
+
+
 ///////////////////////////////////////////////////////////////////////
 // ChartDatabase
 ///////////////////////////////////////////////////////////////////////
@@ -1136,6 +1237,13 @@ ChartTableEntry *ChartDatabase::GetpChartTableEntry(int index) const
             return (ChartTableEntry *)&m_ChartTableEntryDummy;
 }
 
+const ChartTableIndex &ChartDatabase::GetChartTableIndex()
+{
+    if(!m_chart_index.IsValid())
+        m_chart_index.Build(active_chartTable);
+    return m_chart_index;
+}
+
 bool ChartDatabase::CompareChartDirArray( ArrayOfCDI& test_array )
 {
     //  Compare the parameter "test_array" with this.m_dir_array
@@ -1245,11 +1353,13 @@ bool ChartDatabase::Read(const wxString &filePath)
     entry.SetAvailable(true);
     
     m_nentries = active_chartTable.GetCount();
+    m_chart_index.Invalidate();
     return true;
 
 read_error:
     bValid = false;
     m_nentries = active_chartTable.GetCount();
+    m_chart_index.Invalidate();
     return false;
 }
 
@@ -1605,6 +1715,7 @@ bool ChartDatabase::Update(ArrayOfCDI& dir_array, bool bForce, wxGenericProgress
       }
 
       m_nentries = active_chartTable.GetCount();
+      m_chart_index.Invalidate();
       
       bValid = true;
       return true;
@@ -2224,6 +2335,7 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
       }
 
       m_nentries = active_chartTable.GetCount();
+      m_chart_index.Invalidate();
       
       return nDirEntry;
 }
@@ -2360,6 +2472,7 @@ bool ChartDatabase::AddChart( wxString &chartfilename, ChartClassDescriptor &cha
             }
             
     m_nentries = active_chartTable.GetCount();
+    m_chart_index.Invalidate();
             
     return rv;
 }
@@ -2464,6 +2577,7 @@ bool ChartDatabase::AddSingleChart( wxString &ChartFullPath, bool b_force_full_s
     }
     
     m_nentries = active_chartTable.GetCount();
+    m_chart_index.Invalidate();
     
     return rv;
     
@@ -2521,6 +2635,7 @@ bool ChartDatabase::RemoveSingleChart( wxString &ChartFullPath )
     }
     
     m_nentries = active_chartTable.GetCount();
+    m_chart_index.Invalidate();
     
     return rv;
 }
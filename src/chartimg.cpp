@@ -57,6 +57,13 @@
 #include "chartimg.h"
 #include "ocpn_pixel.h"
 #include "ChartDataInputStream.h"
+#include "MappedFile.h"
+#include "OCPNPlatform.h"
+#include "ssl/sha1.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #ifndef __WXMSW__
 #include <signal.h>
@@ -101,6 +108,8 @@ class MyConfig;
 extern MyConfig        *pConfig;
 #endif
 
+extern OCPNPlatform    *g_Platform;
+
 typedef struct  {
       float y;
       float x;
@@ -659,6 +668,7 @@ found_uclc_file:
       }
       ifss_bitmap = new wxFFileInputStream(*pBitmapFilePath); // open the bitmap file
       ifs_bitmap = new wxBufferedInputStream(*ifss_bitmap);
+      m_BitmapDataPath = *pBitmapFilePath;
 
       if(!ifss_bitmap->IsOk())
       {
@@ -1685,6 +1695,7 @@ InitReturn ChartKAP::Init( const wxString& name, ChartInitFlag init_flags )
 
       ifss_bitmap = stream;
       ifs_bitmap = new wxBufferedInputStream(*ifss_bitmap);
+      m_BitmapDataPath = tempfile.empty() ? name : tempfile;
 
 
 //    Perform common post-init actions in ChartBaseBSB
@@ -1739,6 +1750,7 @@ ChartBaseBSB::ChartBaseBSB()
       ifs_bitmap = NULL;
       ifss_bitmap = NULL;
       ifs_hdr = NULL;
+      m_mapped_bitmap = NULL;
 
       for(int i = 0 ; i < N_BSB_COLORS ; i++)
             pPalettes[i] = NULL;
@@ -1808,6 +1820,8 @@ ChartBaseBSB::~ChartBaseBSB()
       FreeLineCacheRows();
       free (pLineCache);
 
+      delete m_mapped_bitmap;                   // after the line cache, which may point into it
+
       delete pPixCache;
 
 
@@ -1828,7 +1842,9 @@ void ChartBaseBSB::FreeLineCacheRows(int start, int end)
             CachedLine *pt = &pLineCache[ylc];
             if(pt->bValid) {
                 free (pt->pTileOffset);
-                free (pt->pPix);
+                if(!m_mapped_bitmap)
+                    free (pt->pPix);
+                pt->pPix = NULL;
                 pt->bValid = false;
             }
         }
@@ -2029,6 +2045,17 @@ InitReturn ChartBaseBSB::PostInit(void)
       ifs_lp = ifs_bufend;
       ifs_file_offset = -ifs_bufsize;
 
+      //    Map the bitmap data, if possible, so that scan lines are decoded without stream reads
+      if(!m_BitmapDataPath.IsEmpty())
+      {
+          m_mapped_bitmap = new MappedFile(m_BitmapDataPath);
+          if(!m_mapped_bitmap->IsOk())
+          {
+              delete m_mapped_bitmap;
+              m_mapped_bitmap = NULL;
+          }
+      }
+
 
       //    Create and load the line offset index table
       pline_table = NULL;
@@ -2146,15 +2173,19 @@ InitReturn ChartBaseBSB::PostInit(void)
         // Recreate the scan line index if the embedded version seems corrupt
       if(!bline_index_ok)
       {
-          wxString msg(_("   Line Index corrupt, recreating Index for chart "));
-          msg.Append(m_FullPath);
-          wxLogMessage(msg);
-          if(!CreateLineIndex())
+          if(!LoadLineIndexCache())
           {
-                wxString msg(_("   Error creating Line Index for chart "));
-                msg.Append(m_FullPath);
-                wxLogMessage(msg);
-                return INIT_FAIL_REMOVE;
+              wxString msg(_("   Line Index corrupt, recreating Index for chart "));
+              msg.Append(m_FullPath);
+              wxLogMessage(msg);
+              if(!CreateLineIndex())
+              {
+                    wxString msg(_("   Error creating Line Index for chart "));
+                    msg.Append(m_FullPath);
+                    wxLogMessage(msg);
+                    return INIT_FAIL_REMOVE;
+              }
+              SaveLineIndexCache();
           }
       }
 
@@ -2252,6 +2283,85 @@ bool ChartBaseBSB::CreateLineIndex()
 }
 
 
+//    A recreated line index is saved in the private data directory, keyed by the chart path,
+//    so that reopening a chart with a corrupt embedded index does not rescan the whole file.
+//    The header ties the saved index to the size and modification time of the file holding the bitmap.
+
+struct LineIndexCacheHeader
+{
+    char        magic[4];
+    wxInt32     size_y;
+    wxInt64     file_size;
+    wxInt64     file_time;
+};
+
+static void FillLineIndexCacheHeader(LineIndexCacheHeader &hdr, const wxString &path, int size_y)
+{
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, "OLX1", 4);
+    hdr.size_y = size_y;
+    hdr.file_size = wxFileName::GetSize(path).GetValue();
+    hdr.file_time = wxFileName(path).GetModificationTime().GetTicks();
+}
+
+wxString ChartBaseBSB::GetLineIndexCachePath(void)
+{
+    wxCharBuffer buf = m_FullPath.ToUTF8();
+    unsigned char sha1_out[20];
+    sha1( (unsigned char *) buf.data(), strlen(buf.data()), sha1_out );
+
+    wxString name;
+    for (unsigned int i=0 ; i < 20 ; i++)
+        name += wxString::Format(_T("%02X"), sha1_out[i]);
+
+    wxChar separator = wxFileName::GetPathSeparator();
+    return g_Platform->GetPrivateDataDir() + separator + _T("raster_line_index") + separator + name;
+}
+
+bool ChartBaseBSB::LoadLineIndexCache(void)
+{
+    wxString path = GetLineIndexCachePath();
+    if(!wxFileName::FileExists(path))
+        return false;
+
+    wxFFile file(path, _T("rb"));
+    if(!file.IsOpened())
+        return false;
+
+    LineIndexCacheHeader hdr, ref;
+    FillLineIndexCacheHeader(ref, pBitmapFilePath ? *pBitmapFilePath : m_FullPath, Size_Y);
+    if(file.Read(&hdr, sizeof(hdr)) != sizeof(hdr))
+        return false;
+    if(memcmp(hdr.magic, ref.magic, 4) || hdr.size_y != ref.size_y ||
+       hdr.file_size != ref.file_size || hdr.file_time != ref.file_time)
+        return false;
+
+    if(file.Read(pline_table, Size_Y * sizeof(int)) != Size_Y * sizeof(int))
+        return false;
+
+    return true;
+}
+
+void ChartBaseBSB::SaveLineIndexCache(void)
+{
+    wxString path = GetLineIndexCachePath();
+    wxFileName fn(path);
+    if(!fn.DirExists() && !wxFileName::Mkdir(fn.GetPath(), 0755, wxPATH_MKDIR_FULL))
+        return;
+
+    wxFFile file(path, _T("wb"));
+    if(!file.IsOpened())
+        return;
+
+    LineIndexCacheHeader hdr;
+    FillLineIndexCacheHeader(hdr, pBitmapFilePath ? *pBitmapFilePath : m_FullPath, Size_Y);
+    if(file.Write(&hdr, sizeof(hdr)) != sizeof(hdr) ||
+       file.Write(pline_table, Size_Y * sizeof(int)) != Size_Y * sizeof(int)) {
+        file.Close();
+        wxRemoveFile(path);
+    }
+}
+
 //    Invalidate and Free the line cache contents
 void ChartBaseBSB::InvalidateLineCache(void)
 {
@@ -2263,7 +2373,8 @@ void ChartBaseBSB::InvalidateLineCache(void)
                   pt = &pLineCache[ylc];
                   if(pt)
                   {
-                      free (pt->pPix);
+                      if(!m_mapped_bitmap)
+                          free (pt->pPix);
                       pt->pPix = NULL;
                       free (pt->pTileOffset);
                       pt->pTileOffset = NULL;
@@ -3786,6 +3897,121 @@ bool ChartBaseBSB::GetView( wxRect& source, wxRect& dest, ScaleTypeEnum scale_ty
 }
 
 
+//-----------------------------------------------------------------------------------------------
+//    Raster decode worker pool
+//
+//    Once scan lines are decoded from a file mapping, the rows of a raster request are
+//    independent, so they are split into bands and spread over a small persistent pool.
+//    The calling thread decodes bands too, and simply decodes everything itself if another
+//    request already owns the pool.
+//-----------------------------------------------------------------------------------------------
+
+#define DECODE_BAND_MIN_ROWS    32
+
+class RasterDecodePool
+{
+public:
+    RasterDecodePool();
+    ~RasterDecodePool();
+
+    void Run(int nrows, const std::function<void(int, int)> &func);
+
+private:
+    void WorkerLoop();
+    void RunBands(std::unique_lock<std::mutex> &lock);
+
+    std::vector<std::thread> m_threads;
+    std::mutex          m_run_mutex;            // held by the request owning the pool
+    std::mutex          m_mutex;                // guards the band state below
+    std::condition_variable m_work_cond;
+    std::condition_variable m_done_cond;
+
+    const std::function<void(int, int)> *m_func;
+    int                 m_nrows;
+    int                 m_nbands;
+    int                 m_next_band;
+    int                 m_bands_done;
+    bool                m_bquit;
+};
+
+RasterDecodePool::RasterDecodePool()
+    : m_func(NULL), m_nrows(0), m_nbands(0), m_next_band(0), m_bands_done(0), m_bquit(false)
+{
+    int nthreads = wxMin(wxThread::GetCPUCount(), 8) - 1;
+    for(int i = 0 ; i < nthreads ; i++)
+        m_threads.push_back(std::thread(&RasterDecodePool::WorkerLoop, this));
+}
+
+RasterDecodePool::~RasterDecodePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bquit = true;
+    }
+    m_work_cond.notify_all();
+    for(unsigned int i = 0 ; i < m_threads.size() ; i++)
+        m_threads[i].join();
+}
+
+//  Decode bands until none is left to start.  Called with m_mutex held.
+void RasterDecodePool::RunBands(std::unique_lock<std::mutex> &lock)
+{
+    while(m_func && m_next_band < m_nbands) {
+        const std::function<void(int, int)> *func = m_func;
+        int band = m_next_band++;
+        int first = (int)((long long)m_nrows * band / m_nbands);
+        int last = (int)((long long)m_nrows * (band + 1) / m_nbands);
+
+        lock.unlock();
+        (*func)(first, last);
+        lock.lock();
+
+        if(++m_bands_done == m_nbands)
+            m_done_cond.notify_all();
+    }
+}
+
+void RasterDecodePool::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_bquit) {
+        RunBands(lock);
+        if(!m_bquit)
+            m_work_cond.wait(lock);
+    }
+}
+
+void RasterDecodePool::Run(int nrows, const std::function<void(int, int)> &func)
+{
+    int nbands = wxMin((int)m_threads.size() + 1, nrows / DECODE_BAND_MIN_ROWS);
+
+    std::unique_lock<std::mutex> run_lock(m_run_mutex, std::try_to_lock);
+    if(nbands < 2 || !run_lock.owns_lock()) {
+        func(0, nrows);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_func = &func;
+    m_nrows = nrows;
+    m_nbands = nbands;
+    m_next_band = 0;
+    m_bands_done = 0;
+    m_work_cond.notify_all();
+
+    RunBands(lock);
+    while(m_bands_done < m_nbands)
+        m_done_cond.wait(lock);
+    m_func = NULL;
+}
+
+static RasterDecodePool &GetRasterDecodePool()
+{
+    static RasterDecodePool s_pool;
+    return s_pool;
+}
+
+
 bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect& source, int source_stride,
                                    wxRect& dest, int dest_stride, double scale_factor, ScaleTypeEnum scale_type)
 {
@@ -3815,16 +4041,27 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
       if(factor > 1)                // downsampling
       {
 
+            //  When the decoder is re-entrant, rows are decoded directly with m_critSect
+            //  held once for the whole request, so that bands of destination rows
+            //  can be filled concurrently
+            wxCriticalSectionLocker locker(m_critSect);
+
             if(scale_type == RENDER_HIDEF)
             {
-//    Allocate a working buffer based on scale factor
                   int blur_factor = wxMax(2, Factor);
                   int wb_size = (source.width) * (blur_factor * 2) * BPP/8 ;
-                  s_data = (unsigned char *) malloc( wb_size ); // work buffer
+
+                  //    Each destination row averages its own block of source lines.
+                  //    Below a factor of 2 neighbouring blocks overlap, and the shared source
+                  //    lines must not be decoded from two threads at once.
+                  int nrows = dest.height;
+                  std::function<void(int, int)> do_rows = [&](int first, int last)
+                  {
+                  unsigned char *s_data = (unsigned char *) malloc( wb_size ); // work buffer, per band
                   unsigned char *pixel;
                   int y_offset;
 
-                  for (int y = dest.y; y < (dest.y + dest.height); y++)
+                  for (int y = dest.y + first; y < (dest.y + last); y++)
                   {
                   //    Read "blur_factor" lines
 
@@ -3833,9 +4070,12 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
                         s1.y = source.y  + (int)(y * factor);
                         s1.width = source.width;
                         s1.height = blur_factor;
-                        GetChartBits(s1, s_data, 1);
+                        if(IsDecodeReentrant())
+                              DecodeChartRows(s1, s_data, 1, 0, s1.height);
+                        else
+                              GetChartBits(s1, s_data, 1);
 
-                        target_data = data + (y * dest_line_length/*dest_stride * BPP/8*/);
+                        unsigned char *target_data = data + (y * dest_line_length/*dest_stride * BPP/8*/);
 
                         for (int x = 0; x < target_width; x++)
                         {
@@ -3885,6 +4125,14 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
 
                   }  // for y
 
+                  free(s_data);
+                  };
+
+                  if(Factor >= 2)
+                        ForEachRowBand(nrows, do_rows);
+                  else
+                        do_rows(0, nrows);
+
             }           // SCALE_BILINEAR
 
             else if (scale_type == RENDER_LODEF)
@@ -3896,29 +4144,46 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
                         if(source.width > 32767)                  // High underscale can exceed signed math bits
                               scaler = 8;
 
-                        int wb_size = (Size_X) * ((/*Factor +*/ 1) * 2) * BPP/8 ;
-                        s_data = (unsigned char *) malloc( wb_size ); // work buffer
-
                         long x_delta = (source.width<<scaler) / target_width;
                         long y_delta = (source.height<<scaler) / target_height;
 
-                        int y = dest.y;                // starting here
-                        long ys = dest.y * y_delta;
+                        //    Only the span of each source line that is actually sampled is decoded,
+                        //    the same span for every row
+                        long x_start = (source.x << scaler) + (dest.x * x_delta);
+                        long x_end = x_start + (dest.width - 1) * x_delta;
+                        int span_first = (x_start > 0) ? (int)(x_start >> scaler) : 0;
+                        int span_last = (x_end > 0) ? wxMin((int)(x_end >> scaler), Size_X - 1) : -1;
+                        int span_width = span_last - span_first + 1;
+
+                        int wb_size = (wxMax(span_width, 0) + 2) * BPP/8 ;
 
-                        while ( y < dest.y + dest.height)
+                        ForEachRowBand(dest.height, [&](int first, int last)
                         {
-                        //    Read 1 line at the right place from the source
+                        unsigned char *s_data = (unsigned char *) malloc( wb_size ); // work buffer, per band
 
-                              wxRect s1;
-                              s1.x = 0;
-                              s1.y = source.y + (ys >> scaler);
-                              s1.width = Size_X;
-                              s1.height = 1;
-                              GetChartBits(s1, s_data, get_bits_submap);
+                        int y = dest.y + first;                // starting here
+                        long ys = y * y_delta;
 
-                              target_data = data + (y * dest_line_length/*dest_stride * BPP/8*/) + (dest.x * BPP / 8);
+                        while ( y < dest.y + last)
+                        {
+                        //    Read the sampled span of 1 line at the right place from the source
+
+                              if(span_width > 0)
+                              {
+                                    wxRect s1;
+                                    s1.x = span_first;
+                                    s1.y = source.y + (ys >> scaler);
+                                    s1.width = span_width;
+                                    s1.height = 1;
+                                    if(IsDecodeReentrant())
+                                          DecodeChartRows(s1, s_data, get_bits_submap, 0, 1);
+                                    else
+                                          GetChartBits(s1, s_data, get_bits_submap);
+                              }
 
-                              long x = (source.x << scaler) + (dest.x * x_delta);
+                              unsigned char *target_data = data + (y * dest_line_length/*dest_stride * BPP/8*/) + (dest.x * BPP / 8);
+
+                              long x = x_start;
                               long sizex16 = Size_X << scaler;
                               int xt = dest.x;
 
@@ -3936,7 +4201,7 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
                               while ((xt < dest.x + dest.width) && ( x < sizex16))
                               {
 
-                                    unsigned char* src_pixel = &s_data[(x>>scaler)*BPP/8];
+                                    unsigned char* src_pixel = &s_data[((x>>scaler) - span_first)*BPP/8];
 
                                     target_data[0] = src_pixel[0];
                                     target_data[1] = src_pixel[1];
@@ -3961,6 +4226,9 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
                               ys += y_delta;
                         }
 
+                        free(s_data);
+                        });
+
             }     // SCALE_SUBSAMP
 
       }
@@ -4085,18 +4353,31 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
 bool ChartBaseBSB::GetChartBits(wxRect& source, unsigned char *pPix, int sub_samp)
 {
     wxCriticalSectionLocker locker(m_critSect);
-    
+
+    int nrows = (source.height + sub_samp - 1) / sub_samp;
+    ForEachRowBand(nrows, [&](int first, int last) {
+        DecodeChartRows(source, pPix, sub_samp, first, last);
+    });
+
+    return true;
+}
+
+//    Decode output rows [first, last) of a GetChartBits() request, i.e. source lines
+//    source.y + first * sub_samp and on.  Caller must hold m_critSect.
+void ChartBaseBSB::DecodeChartRows(wxRect& source, unsigned char *pPix, int sub_samp, int first, int last)
+{
       int iy;
 #define FILL_BYTE 0
 
 //    Decode the KAP file RLL stream into image pPix
 
       unsigned char *pCP;
-      pCP = pPix;
+      pCP = pPix + (size_t)first * source.width * BPP/8 * sub_samp;
 
-      iy = source.y;
+      iy = source.y + first * sub_samp;
+      int iy_end = wxMin(source.y + last * sub_samp, source.y + source.height);
 
-      while (iy < source.y + source.height)
+      while (iy < iy_end)
       {
             if((iy >= 0) && (iy < Size_Y))
             {
@@ -4147,13 +4428,15 @@ bool ChartBaseBSB::GetChartBits(wxRect& source, unsigned char *pPix, int sub_sam
 
             iy += sub_samp;
       }     // while iy
-
-
-      return true;
 }
 
-
-
+void ChartBaseBSB::ForEachRowBand(int nrows, const std::function<void(int, int)> &func)
+{
+    if(IsDecodeReentrant())
+        GetRasterDecodePool().Run(nrows, func);
+    else
+        func(0, nrows);
+}
 
 
 
@@ -4356,7 +4639,8 @@ private:
     do { \
       free(pt->pTileOffset); \
       pt->pTileOffset = NULL; \
-      free(pt->pPix); \
+      if(!m_mapped_bitmap) \
+          free(pt->pPix); \
       pt->pPix = NULL; \
       pt->bValid = false; \
       return 0; \
@@ -4402,11 +4686,24 @@ int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int
           pt->pPix = (unsigned char *)malloc(Size_X);
 #else
           pt->pTileOffset = (TileOffsetCache *)calloc(sizeof(TileOffsetCache)*(Size_X/TILE_SIZE + 1), 1);
-          pt->pPix = (unsigned char *)malloc(thisline_size);
+          if(m_mapped_bitmap)
+              pt->pPix = NULL;
+          else
+              pt->pPix = (unsigned char *)malloc(thisline_size);
 #endif
           if(pline_table[y] == 0 || pline_table[y+1] == 0)
               FAIL;
 
+#ifndef USE_OLD_CACHE
+          if(m_mapped_bitmap) {
+              //  The raw line is decoded in place from the file mapping, nothing to read or copy
+              if(thisline_size < 0 || (size_t)pline_table[y+1] > m_mapped_bitmap->GetSize())
+                  FAIL;
+              pt->pPix = (unsigned char *)m_mapped_bitmap->GetData() + pline_table[y];
+              lp = pt->pPix;
+          }
+          else {
+#endif
           // as of 2015, in wxWidgets buffered streams don't test for a zero seek
           // so we check here to possibly avoid this seek with a measured performance gain
           if(ifs_bitmap->TellI() != pline_table[y] &&
@@ -4429,6 +4726,9 @@ int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int
           lp = pt->pPix;
 #endif
           ifs_bitmap->Read(lp, thisline_size);
+#ifndef USE_OLD_CACHE
+          }
+#endif
 
 #ifdef USE_OLD_CACHE
           pCL = pt->pPix;
@@ -4755,7 +5055,8 @@ nocachestart:
 #ifndef USE_OLD_CACHE
         free(pt->pTileOffset);
 #endif
-        free(pt->pPix);
+        if(!m_mapped_bitmap)
+            free(pt->pPix);
     }
 
     return 1;
@@ -2512,12 +2512,13 @@ void ChartCanvas::OnRolloverPopupTimerEvent( wxTimerEvent& event )
 
                 if( !m_pTrackRolloverWin->IsActive() ) {
                     wxString s;
-                    TrackPoint *segShow_point_a = (TrackPoint *) m_pRolloverTrackSeg->m_pData1;
-                    TrackPoint *segShow_point_b = (TrackPoint *) m_pRolloverTrackSeg->m_pData2;
+                    //  The segment runs from point m_Data4 of the track to the next
+                    int segShow_point_a = m_pRolloverTrackSeg->m_Data4;
+                    int segShow_point_b = segShow_point_a + 1;
 
                     double brg, dist;
-                    DistanceBearingMercator( segShow_point_b->m_lat, segShow_point_b->m_lon,
-                                             segShow_point_a->m_lat, segShow_point_a->m_lon, &brg, &dist );
+                    DistanceBearingMercator( pt->GetPointLat( segShow_point_b ), pt->GetPointLon( segShow_point_b ),
+                                             pt->GetPointLat( segShow_point_a ), pt->GetPointLon( segShow_point_a ), &brg, &dist );
 
                     if( !pt->m_bIsInLayer )
                         s.Append( _("Track") + _T(": ") );
@@ -2535,8 +2536,8 @@ void ChartCanvas::OnRolloverPopupTimerEvent( wxTimerEvent& event )
                     if( g_bShowTrue )
                         s << wxString::Format( wxString("%03d°  ", wxConvUTF8 ), (int)brg );
                     if( g_bShowMag ){
-                        double latAverage = (segShow_point_b->m_lat + segShow_point_a->m_lat)/2;
-                        double lonAverage = (segShow_point_b->m_lon + segShow_point_a->m_lon)/2;
+                        double latAverage = (pt->GetPointLat( segShow_point_b ) + pt->GetPointLat( segShow_point_a ))/2;
+                        double lonAverage = (pt->GetPointLon( segShow_point_b ) + pt->GetPointLon( segShow_point_a ))/2;
                         double varBrg = gFrame->GetMag( brg, latAverage, lonAverage);
 
                         s << wxString::Format( wxString("%03d°(M)  ", wxConvUTF8 ), (int)varBrg );
@@ -2544,8 +2545,10 @@ void ChartCanvas::OnRolloverPopupTimerEvent( wxTimerEvent& event )
 
                     s << FormatDistanceAdaptive( dist );
 
-                    if(segShow_point_a->GetTimeString() && segShow_point_b->GetTimeString()){
-                        double segmentSpeed = toUsrSpeed( dist / ( (segShow_point_b->GetCreateTime() - segShow_point_a->GetCreateTime()).GetSeconds().ToDouble() / 3600.) );
+                    wxDateTime segShow_time_a = pt->GetPointCreateTime( segShow_point_a );
+                    wxDateTime segShow_time_b = pt->GetPointCreateTime( segShow_point_b );
+                    if(segShow_time_a.IsValid() && segShow_time_b.IsValid()){
+                        double segmentSpeed = toUsrSpeed( dist / ( (segShow_time_b - segShow_time_a).GetSeconds().ToDouble() / 3600.) );
                         s << wxString::Format( _T("  %.1f "), (float)segmentSpeed ) << getUsrSpeedUnit();
                     }
 
@@ -4741,10 +4744,10 @@ void ChartCanvas::UpdateShips()
     ShipDraw( ocpndc );
 
     if( g_pActiveTrack && g_pActiveTrack->IsRunning() ) {
-        TrackPoint* p = g_pActiveTrack->GetLastPoint();
-        if( p ) {
+        int n = g_pActiveTrack->GetnPoints();
+        if( n ) {
             wxPoint px;
-            GetCanvasPointPix( p->m_lat, p->m_lon, &px );
+            GetCanvasPointPix( g_pActiveTrack->GetPointLat( n - 1 ), g_pActiveTrack->GetPointLon( n - 1 ), &px );
             ocpndc.CalcBoundingBox( px.x, px.y );
         }
     }
@@ -6192,14 +6195,11 @@ bool ChartCanvas::MouseEventProcessObjects( wxMouseEvent& event )
                                                         m_pRoutePointEditTarget->SetPointFromDraghandlePoint(VPoint, mouse_x, mouse_y);
                                                         // update the Drag Handle entry in the pSelect list
                                                         pSelect->ModifySelectablePoint( new_cursor_lat, new_cursor_lon, m_pRoutePointEditTarget, SELTYPE_DRAGHANDLE );
-                                                        m_pFoundPoint->m_slat = m_pRoutePointEditTarget->m_lat;             // update the SelectList entry
-                                                        m_pFoundPoint->m_slon = m_pRoutePointEditTarget->m_lon;
+                                                        pSelect->UpdateSelectablePoint( m_pFoundPoint, m_pRoutePointEditTarget->m_lat, m_pRoutePointEditTarget->m_lon );             // update the SelectList entry
                                                     }
                                                     else{
-                                                        m_pRoutePointEditTarget->m_lat = new_cursor_lat;    // update the RoutePoint entry
-                                                        m_pRoutePointEditTarget->m_lon = new_cursor_lon;
-                                                        m_pFoundPoint->m_slat = new_cursor_lat;             // update the SelectList entry
-                                                        m_pFoundPoint->m_slon = new_cursor_lon;
+                                                        m_pRoutePointEditTarget->SetPosition( new_cursor_lat, new_cursor_lon );    // update the RoutePoint entry
+                                                        pSelect->UpdateSelectablePoint( m_pFoundPoint, new_cursor_lat, new_cursor_lon );             // update the SelectList entry
                                                     }
    
                                                    
@@ -6286,14 +6286,11 @@ bool ChartCanvas::MouseEventProcessObjects( wxMouseEvent& event )
                             m_pRoutePointEditTarget->SetPointFromDraghandlePoint(VPoint, mouse_x, mouse_y);
                             // update the Drag Handle entry in the pSelect list
                             pSelect->ModifySelectablePoint( m_cursor_lat, m_cursor_lon, m_pRoutePointEditTarget, SELTYPE_DRAGHANDLE );
-                            m_pFoundPoint->m_slat = m_pRoutePointEditTarget->m_lat;             // update the SelectList entry
-                            m_pFoundPoint->m_slon = m_pRoutePointEditTarget->m_lon;
+                            pSelect->UpdateSelectablePoint( m_pFoundPoint, m_pRoutePointEditTarget->m_lat, m_pRoutePointEditTarget->m_lon );             // update the SelectList entry
                         }
                         else{
-                            m_pRoutePointEditTarget->m_lat = m_cursor_lat;    // update the RoutePoint entry
-                            m_pRoutePointEditTarget->m_lon = m_cursor_lon;
-                            m_pFoundPoint->m_slat = m_cursor_lat;             // update the SelectList entry
-                            m_pFoundPoint->m_slon = m_cursor_lon;
+                            m_pRoutePointEditTarget->SetPosition( m_cursor_lat, m_cursor_lon );    // update the RoutePoint entry
+                            pSelect->UpdateSelectablePoint( m_pFoundPoint, m_cursor_lat, m_cursor_lon );             // update the SelectList entry
                         }
                         
                         
@@ -7511,31 +7508,15 @@ void pupHandler_PasteTrack() {
     Track* pasted = kml.GetParsedTrack();
     if( ! pasted ) return;
 
-    TrackPoint* curPoint;
-
     Track* newTrack = new Track();
-    TrackPoint* newPoint;
-    TrackPoint* prevPoint = NULL;
 
     newTrack->SetName(pasted->GetName());
 
     for( int i = 0; i < pasted->GetnPoints(); i++ ) {
-        curPoint = pasted->GetPoint( i );
+        newTrack->AddPoint( pasted->GetPointLat( i ), pasted->GetPointLon( i ), pasted->GetPointCreateTime( i ) );
 
-        newPoint = new TrackPoint( curPoint );
-
-        wxDateTime now = wxDateTime::Now();
-        newPoint->SetCreateTime(curPoint->GetCreateTime());
-
-        newTrack->AddPoint( newPoint );
-
-        if( prevPoint )
-            pSelect->AddSelectableTrackSegment(
-                prevPoint->m_lat, prevPoint->m_lon,
-                newPoint->m_lat, newPoint->m_lon,
-                prevPoint, newPoint, newTrack );
-
-        prevPoint = newPoint;
+        if( i > 0 )
+            pSelect->AddSelectableTrackSegment( newTrack, i - 1 );
     }
 
     pTrackList->Append( newTrack );
@@ -31,6 +31,7 @@
 #endif //precompiled headers
 
 #include <wx/textfile.h>
+#include <wx/file.h>
 #include <wx/tokenzr.h>
 #include <wx/arrstr.h>
 #include <wx/mstream.h>
@@ -39,6 +40,10 @@
 #include <wx/regex.h>
 
 #include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "mygdal/ogr_api.h"
 #include "s57chart.h"
@@ -54,6 +59,7 @@
 #include "OCPNPlatform.h"
 #include "wx28compat.h"
 #include "ChartDataInputStream.h"
+#include "MappedFile.h"
 
 #include <stdio.h>
 
@@ -1078,107 +1084,166 @@ void CreateDecodeTable ( void )
 }
 
 
-static int   read_and_decode_bytes ( FILE *stream, void *p, int nbytes )
-{
-      if ( 0 == nbytes )                  // declare victory if no bytes requested
-            return 1;
+//    A decoded cell file, and a read cursor over it
 
-      //    read into callers buffer
-      if ( fread ( p, nbytes, 1, stream ) != 1)
-            return 0;
+typedef std::vector<unsigned char> cm93_cell_image;
 
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) p;
+typedef struct{
+      const unsigned char     *p;
+      const unsigned char     *end;
+}cell_stream;
 
-      for ( int i=0 ; i < nbytes ; i++ )
+//    One pass over the whole cell, through the substitution table
+static void decode_cell_image ( const unsigned char *src, unsigned char *dst, size_t nbytes )
+{
+      size_t i = 0;
+      for ( ; i + 4 <= nbytes ; i += 4 )
       {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
+            dst[i]   = Decode_table[src[i]];
+            dst[i+1] = Decode_table[src[i+1]];
+            dst[i+2] = Decode_table[src[i+2]];
+            dst[i+3] = Decode_table[src[i+3]];
+      }
+      for ( ; i < nbytes ; i++ )
+            dst[i] = Decode_table[src[i]];
+}
 
-            q++;
+//    Read and decode a cell file at once, mapped where the platform allows
+static std::shared_ptr<cm93_cell_image> load_cell_image ( const wxString &file_name )
+{
+      std::shared_ptr<cm93_cell_image> image = std::make_shared<cm93_cell_image>();
+
+      MappedFile map ( file_name );
+      if ( map.IsOk() )
+      {
+            image->resize ( map.GetSize() );
+            if ( map.GetSize() )
+                  decode_cell_image ( map.GetData(), &( *image )[0], map.GetSize() );
+            return image;
       }
-      return 1;
+
+      wxFile file;
+      if ( !file.Open ( file_name ) )
+            return std::shared_ptr<cm93_cell_image>();
+
+      wxFileOffset length = file.Length();
+      if ( length <= 0 )
+            return std::shared_ptr<cm93_cell_image>();
+
+      image->resize ( length );
+      if ( file.Read ( &( *image )[0], length ) != length )
+            return std::shared_ptr<cm93_cell_image>();
+
+      decode_cell_image ( &( *image )[0], &( *image )[0], length );
+      return image;
 }
 
+static inline bool read_bytes ( cell_stream *stream, void *p, size_t nbytes )
+{
+      if ( nbytes > ( size_t ) ( stream->end - stream->p ) )
+            return false;
 
-static int read_and_decode_double ( FILE *stream, double *p )
+      memcpy ( p, stream->p, nbytes );
+      stream->p += nbytes;
+      return true;
+}
+
+static inline bool read_double ( cell_stream *stream, double *p )
 {
-      double t;
-      //    read into temp buffer
-      if ( fread ( &t, sizeof ( double ), 1, stream ) != 1)
-            return 0;
+      return read_bytes ( stream, p, sizeof ( double ) );
+}
 
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) &t;
+static inline bool read_int ( cell_stream *stream, int *p )
+{
+      return read_bytes ( stream, p, sizeof ( int ) );
+}
 
-      for ( unsigned int i=0 ; i < sizeof ( double ) ; i++ )
-      {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
+static inline bool read_ushort ( cell_stream *stream, unsigned short *p )
+{
+      return read_bytes ( stream, p, sizeof ( unsigned short ) );
+}
 
-            q++;
-      }
 
-      //    copy to target
-      *p = t;
+//    Decoded cells, most recently used first.  Moving across the cm93 scales
+//    and back loads the same cells over and over; this saves the file read,
+//    any xz decompression, and the decode.  An entry is dropped when its file
+//    changes.
 
-      return 1;
-}
+#define CM93_CELL_CACHE_BYTES   ( 64 * 1024 * 1024 )
 
-static int read_and_decode_int ( FILE *stream, int *p )
+class cm93_cell_cache
 {
-      int t;
-      //    read into temp buffer
-      if ( fread ( &t, sizeof ( int ), 1, stream ) != 1)
-            return 0;
+      public:
+            cm93_cell_cache() : m_bytes ( 0 ) {}
 
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) &t;
+            std::shared_ptr<cm93_cell_image> Find ( const wxString &file_name );
+            void Add ( const wxString &file_name, const std::shared_ptr<cm93_cell_image> &image );
 
-      for ( unsigned int i=0 ; i < sizeof ( int ) ; i++ )
-      {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
+      private:
+            struct Entry
+            {
+                  wxString                            file_name;
+                  time_t                              mtime;
+                  std::shared_ptr<cm93_cell_image>    image;
+            };
+
+            std::list<Entry>        m_entries;
+            size_t                  m_bytes;
+            std::mutex              m_mutex;
+};
 
-            q++;
-      }
+static cm93_cell_cache s_cell_cache;
 
-      //    copy to target
-      *p = t;
+std::shared_ptr<cm93_cell_image> cm93_cell_cache::Find ( const wxString &file_name )
+{
+      std::lock_guard<std::mutex> lock ( m_mutex );
+      for ( std::list<Entry>::iterator it = m_entries.begin() ; it != m_entries.end() ; ++it )
+      {
+            if ( it->file_name != file_name )
+                  continue;
 
-      return 1;
+            if ( it->mtime != ::wxFileModificationTime ( file_name ) )
+            {
+                  m_bytes -= it->image->size();
+                  m_entries.erase ( it );
+                  return std::shared_ptr<cm93_cell_image>();
+            }
+
+            m_entries.splice ( m_entries.begin(), m_entries, it );
+            return m_entries.front().image;
+      }
+      return std::shared_ptr<cm93_cell_image>();
 }
 
-static int read_and_decode_ushort ( FILE *stream, unsigned short *p )
+void cm93_cell_cache::Add ( const wxString &file_name, const std::shared_ptr<cm93_cell_image> &image )
 {
-      unsigned short t;
-      //    read into temp buffer
-      if ( fread ( &t, sizeof ( unsigned short ), 1, stream ) != 1)
-            return 0;
+      if ( image->size() > CM93_CELL_CACHE_BYTES / 4 )
+            return;
 
-      //    decode inplace
-      unsigned char *q = ( unsigned char * ) &t;
+      Entry entry;
+      entry.file_name = file_name;
+      entry.mtime = ::wxFileModificationTime ( file_name );
+      entry.image = image;
 
-      for ( unsigned int i=0 ; i < sizeof ( unsigned short ) ; i++ )
+      std::lock_guard<std::mutex> lock ( m_mutex );
+      for ( std::list<Entry>::iterator it = m_entries.begin() ; it != m_entries.end() ; ++it )
       {
-            unsigned char a = *q;
-            int b = a;
-            unsigned char c = Decode_table[b];
-            *q = c;
-
-            q++;
+            if ( it->file_name == file_name )
+            {
+                  m_bytes -= it->image->size();
+                  m_entries.erase ( it );
+                  break;
+            }
       }
 
-      //    copy to target
-      *p = t;
+      m_entries.push_front ( entry );
+      m_bytes += image->size();
 
-      return 1;
+      while ( m_bytes > CM93_CELL_CACHE_BYTES )
+      {
+            m_bytes -= m_entries.back().image->size();
+            m_entries.pop_back();
+      }
 }
 
 
@@ -1353,7 +1418,7 @@ static int get_dval ( int native_scale )
 }
 
 
-static bool read_header_and_populate_cib ( FILE *stream, Cell_Info_Block *pCIB )
+static bool read_header_and_populate_cib ( cell_stream *stream, Cell_Info_Block *pCIB )
 {
       //    Read header, populate Cell_Info_Block
 
@@ -1365,40 +1430,40 @@ static bool read_header_and_populate_cib ( FILE *stream, Cell_Info_Block *pCIB )
 
       memset ( ( void * ) &header, 0, sizeof ( header ) );
 
-      read_and_decode_double ( stream,&header.lon_min );
-      read_and_decode_double ( stream,&header.lat_min );
-      read_and_decode_double ( stream,&header.lon_max );
-      read_and_decode_double ( stream,&header.lat_max );
-
-      read_and_decode_double ( stream,&header.easting_min );
-      read_and_decode_double ( stream,&header.northing_min );
-      read_and_decode_double ( stream,&header.easting_max );
-      read_and_decode_double ( stream,&header.northing_max );
-
-      read_and_decode_ushort ( stream,&header.usn_vector_records );
-      read_and_decode_int ( stream,&header.n_vector_record_points );
-      read_and_decode_int ( stream,&header.m_46 );
-      read_and_decode_int ( stream,&header.m_4a );
-      read_and_decode_ushort ( stream,&header.usn_point3d_records );
-      read_and_decode_int ( stream,&header.m_50 );
-      read_and_decode_int ( stream,&header.m_54 );
-      read_and_decode_ushort ( stream,&header.usn_point2d_records );
-      read_and_decode_ushort ( stream,&header.m_5a );
-      read_and_decode_ushort ( stream,&header.m_5c );
-      read_and_decode_ushort ( stream,&header.usn_feature_records );
-
-      read_and_decode_int ( stream,&header.m_60 );
-      read_and_decode_int ( stream,&header.m_64 );
-      read_and_decode_ushort ( stream,&header.m_68 );
-      read_and_decode_ushort ( stream,&header.m_6a );
-      read_and_decode_ushort ( stream,&header.m_6c );
-      read_and_decode_int ( stream,&header.m_nrelated_object_pointers );
-
-      read_and_decode_int ( stream,&header.m_72 );
-      read_and_decode_ushort ( stream,&header.m_76 );
-
-      read_and_decode_int ( stream,&header.m_78 );
-      read_and_decode_int ( stream,&header.m_7c );
+      read_double ( stream,&header.lon_min );
+      read_double ( stream,&header.lat_min );
+      read_double ( stream,&header.lon_max );
+      read_double ( stream,&header.lat_max );
+
+      read_double ( stream,&header.easting_min );
+      read_double ( stream,&header.northing_min );
+      read_double ( stream,&header.easting_max );
+      read_double ( stream,&header.northing_max );
+
+      read_ushort ( stream,&header.usn_vector_records );
+      read_int ( stream,&header.n_vector_record_points );
+      read_int ( stream,&header.m_46 );
+      read_int ( stream,&header.m_4a );
+      read_ushort ( stream,&header.usn_point3d_records );
+      read_int ( stream,&header.m_50 );
+      read_int ( stream,&header.m_54 );
+      read_ushort ( stream,&header.usn_point2d_records );
+      read_ushort ( stream,&header.m_5a );
+      read_ushort ( stream,&header.m_5c );
+      read_ushort ( stream,&header.usn_feature_records );
+
+      read_int ( stream,&header.m_60 );
+      read_int ( stream,&header.m_64 );
+      read_ushort ( stream,&header.m_68 );
+      read_ushort ( stream,&header.m_6a );
+      read_ushort ( stream,&header.m_6c );
+      read_int ( stream,&header.m_nrelated_object_pointers );
+
+      read_int ( stream,&header.m_72 );
+      read_ushort ( stream,&header.m_76 );
+
+      read_int ( stream,&header.m_78 );
+      read_int ( stream,&header.m_7c );
 
 
       //    Calculate and record the cell coordinate transform coefficients
@@ -1444,7 +1509,7 @@ static bool read_header_and_populate_cib ( FILE *stream, Cell_Info_Block *pCIB )
       return true;
 }
 
-static bool read_vector_record_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
+static bool read_vector_record_table ( cell_stream *stream, int count, Cell_Info_Block *pCIB )
 {
       bool brv;
 
@@ -1457,28 +1522,16 @@ static bool read_vector_record_table ( FILE *stream, int count, Cell_Info_Block
             p->index = iedge;
 
             unsigned short npoints;
-            brv = ! ( read_and_decode_ushort ( stream, &npoints ) == 0 );
+            brv = ! ( read_ushort ( stream, &npoints ) == 0 );
             if ( !brv )
                   return false;
 
             p->n_points = npoints;
             p->p_points = q;
 
-//           brv = read_and_decode_bytes(stream, q, p->n_points * sizeof(cm93_point));
-//            if(!brv)
-//                  return false;
-
-            unsigned short x, y;
-            for ( int index = 0 ; index <  p->n_points ; index++ )
-            {
-                  if ( !read_and_decode_ushort ( stream, &x ) )
-                        return false;
-                  if ( !read_and_decode_ushort ( stream, &y ) )
-                        return false;
-
-                  q[index].x = x;
-                  q[index].y = y;
-            }
+            //    The file holds the points as cm93_point does, x then y
+            if ( !read_bytes ( stream, q, p->n_points * sizeof ( cm93_point ) ) )
+                  return false;
 
 
             //    Compute and store the min/max of this block of n_points
@@ -1520,7 +1573,7 @@ static bool read_vector_record_table ( FILE *stream, int count, Cell_Info_Block
 }
 
 
-static bool read_3dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
+static bool read_3dpoint_table ( cell_stream *stream, int count, Cell_Info_Block *pCIB )
 {
       geometry_descriptor *p = pCIB->point3d_descriptor_block;
       cm93_point_3d *q = pCIB->p3dpoint_array;
@@ -1528,31 +1581,14 @@ static bool read_3dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB
       for ( int i = 0 ; i < count ; i++ )
       {
             unsigned short npoints;
-            if ( !read_and_decode_ushort ( stream, &npoints ) )
+            if ( !read_ushort ( stream, &npoints ) )
                   return false;
 
             p->n_points = npoints;
             p->p_points = ( cm93_point * ) q;       // might not be the right cast
 
-//            unsigned short t = p->n_points;
-
-//            if(!read_and_decode_bytes(stream, q, t*6))
-//                  return false;
-
-            unsigned short x, y, z;
-            for ( int index = 0 ; index < p->n_points ; index++ )
-            {
-                  if ( !read_and_decode_ushort ( stream, &x ) )
-                        return false;
-                  if ( !read_and_decode_ushort ( stream, &y ) )
-                        return false;
-                  if ( !read_and_decode_ushort ( stream, &z ) )
-                        return false;
-
-                  q[index].x = x;
-                  q[index].y = y;
-                  q[index].z = z;
-            }
+            if ( !read_bytes ( stream, q, p->n_points * sizeof ( cm93_point_3d ) ) )
+                  return false;
 
 
             p++;
@@ -1563,29 +1599,14 @@ static bool read_3dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB
 }
 
 
-static bool read_2dpoint_table ( FILE *stream, int count, Cell_Info_Block *pCIB )
+static bool read_2dpoint_table ( cell_stream *stream, int count, Cell_Info_Block *pCIB )
 {
 
-//      int rv = read_and_decode_bytes(stream, pCIB->p2dpoint_array, count * 4);
-
-      unsigned short x, y;
-      for ( int index = 0 ; index < count ; index++ )
-      {
-            if ( !read_and_decode_ushort ( stream, &x ) )
-                  return false;
-            if ( !read_and_decode_ushort ( stream, &y ) )
-                  return false;
-
-            pCIB->p2dpoint_array[index].x = x;
-            pCIB->p2dpoint_array[index].y = y;
-      }
-
-
-      return true;
+      return read_bytes ( stream, pCIB->p2dpoint_array, count * sizeof ( cm93_point ) );
 }
 
 
-static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_Block *pCIB )
+static bool read_feature_record_table ( cell_stream *stream, int n_features, Cell_Info_Block *pCIB )
 {
       try
       {
@@ -1612,9 +1633,9 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
             {
 
                   // read the object definition
-                  read_and_decode_bytes ( stream, &object_type, 1 );           // read the object type
-                  read_and_decode_bytes ( stream, &geom_prim, 1 );             // read the object geometry primitive type
-                  read_and_decode_ushort ( stream, &obj_desc_bytes );          // read the object byte count
+                  read_bytes ( stream, &object_type, 1 );           // read the object type
+                  read_bytes ( stream, &geom_prim, 1 );             // read the object geometry primitive type
+                  read_ushort ( stream, &obj_desc_bytes );          // read the object byte count
 
                   pobj->otype = object_type;
                   pobj->geotype = geom_prim;
@@ -1625,7 +1646,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                         case 4:              // AREA
                         {
 
-                              if ( !read_and_decode_ushort ( stream, &n_elements ) )
+                              if ( !read_ushort ( stream, &n_elements ) )
                                     return false;
 
                               pobj->n_geom_elements = n_elements;
@@ -1636,7 +1657,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
 
                               for ( unsigned short i = 0 ; i < pobj->n_geom_elements ; i++ )
                               {
-                                    if ( !read_and_decode_ushort ( stream, &index ) )
+                                    if ( !read_ushort ( stream, &index ) )
                                           return false;
 
                                     if ( ( index & 0x1fff ) > pCIB->m_nvector_records )
@@ -1658,7 +1679,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                         case 2:                                         // LINE geometry
                         {
 
-                              if ( !read_and_decode_ushort ( stream, &n_elements ) )      // read geometry element count
+                              if ( !read_ushort ( stream, &n_elements ) )      // read geometry element count
                                     return false;
 
                               pobj->n_geom_elements = n_elements;
@@ -1671,7 +1692,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                               {
                                     unsigned short geometry_index;
 
-                                    if ( !read_and_decode_ushort ( stream, &geometry_index ) )
+                                    if ( !read_ushort ( stream, &geometry_index ) )
                                           return false;
 
 
@@ -1694,7 +1715,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
 
                         case 1:
                         {
-                              if ( !read_and_decode_ushort ( stream, &index ) )
+                              if ( !read_ushort ( stream, &index ) )
                                     return false;
 
                               obj_desc_bytes -= 2;
@@ -1708,7 +1729,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
 
                         case 8:
                         {
-                              if ( !read_and_decode_ushort ( stream, &index ) )
+                              if ( !read_ushort ( stream, &index ) )
                                     return false;
                               obj_desc_bytes -= 2;
 
@@ -1726,7 +1747,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                   if ( ( pobj->geotype & 0x10 ) == 0x10 )        // children/related
                   {
                         unsigned char nrelated;
-                        if ( !read_and_decode_bytes ( stream, &nrelated, 1 ) )
+                        if ( !read_bytes ( stream, &nrelated, 1 ) )
                               return false;
 
                         pobj->n_related_objects = nrelated;
@@ -1739,7 +1760,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                         Object **w = ( Object ** ) pobj->p_related_object_pointer_array;
                         for ( unsigned char j = 0 ; j < pobj->n_related_objects ; j++ )
                         {
-                              if ( !read_and_decode_ushort ( stream, &index ) )
+                              if ( !read_ushort ( stream, &index ) )
                                     return false;
 
                               if ( index > pCIB->m_nfeature_records )
@@ -1757,7 +1778,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                   if ( ( pobj->geotype & 0x20 ) == 0x20 )
                   {
                         unsigned short nrelated;
-                        if ( !read_and_decode_ushort ( stream, &nrelated ) )
+                        if ( !read_ushort ( stream, &nrelated ) )
                               return false;
 
                         pobj->n_related_objects = ( unsigned char ) ( nrelated & 0xFF );
@@ -1773,7 +1794,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                   {
 
                         unsigned char nattr;
-                        if ( !read_and_decode_bytes ( stream, &nattr, 1 ) )
+                        if ( !read_bytes ( stream, &nattr, 1 ) )
                               return false;        //m_od
 
                         pobj->n_attributes = nattr;
@@ -1785,7 +1806,7 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
                         puc10count += obj_desc_bytes;
 
 
-                        if ( !read_and_decode_bytes ( stream, pobj->attributes_block, obj_desc_bytes ) )
+                        if ( !read_bytes ( stream, pobj->attributes_block, obj_desc_bytes ) )
                               return false;           // the attributes....
 
                         if ( ( pobj->geotype & 0x0f ) == 1 )
@@ -1815,27 +1836,17 @@ static bool read_feature_record_table ( FILE *stream, int n_features, Cell_Info_
 
 
 
-bool Ingest_CM93_Cell ( const char * cell_file_name, Cell_Info_Block *pCIB )
+bool Ingest_CM93_Cell ( const cm93_cell_image &image, Cell_Info_Block *pCIB )
 {
 
       try
       {
-
-            int file_length;
-
-            //    Get the file length
-            FILE *flstream = fopen ( cell_file_name, "rb" );
-            if ( !flstream )
+            if ( image.empty() )
                   return false;
 
-            fseek ( flstream, 0, SEEK_END );
-            file_length = ftell ( flstream );
-            fclose ( flstream );
-
-            //    Open the file
-            FILE *stream = fopen ( cell_file_name, "rb" );
-            if ( !stream )
-                  return false;
+            cell_stream stream;
+            stream.p = &image[0];
+            stream.end = stream.p + image.size();
 
             //    Validate the integrity of the cell file
 
@@ -1843,57 +1854,31 @@ bool Ingest_CM93_Cell ( const char * cell_file_name, Cell_Info_Block *pCIB )
             int int0 = 0;
             int int1 = 0;;
 
-            read_and_decode_ushort ( stream, &word0 );     // length of prolog + header (10 + 128)
-            read_and_decode_int ( stream, &int0 );         // length of table 1
-            read_and_decode_int ( stream, &int1 );         // length of table 2
+            read_ushort ( &stream, &word0 );     // length of prolog + header (10 + 128)
+            read_int ( &stream, &int0 );         // length of table 1
+            read_int ( &stream, &int1 );         // length of table 2
 
             int test = word0 + int0 + int1;
-            if ( test != file_length )
-            {
-                  fclose ( stream );
+            if ( test != ( int ) image.size() )
                   return false;                           // file is corrupt
-            }
 
             //    Cell is OK, proceed to ingest
 
 
-            if ( !read_header_and_populate_cib ( stream, pCIB ) )
-            {
-                  fclose ( stream );
+            if ( !read_header_and_populate_cib ( &stream, pCIB ) )
                   return false;
-            }
-
 
-            if ( !read_vector_record_table ( stream, pCIB->m_nvector_records, pCIB ) )
-            {
-                  fclose ( stream );
+            if ( !read_vector_record_table ( &stream, pCIB->m_nvector_records, pCIB ) )
                   return false;
-            }
 
-            if ( !read_3dpoint_table ( stream, pCIB->m_n_point3d_records, pCIB ) )
-            {
-                  fclose ( stream );
+            if ( !read_3dpoint_table ( &stream, pCIB->m_n_point3d_records, pCIB ) )
                   return false;
-            }
 
-            if ( !read_2dpoint_table ( stream, pCIB->m_n_point2d_records, pCIB ) )
-            {
-                  fclose ( stream );
+            if ( !read_2dpoint_table ( &stream, pCIB->m_n_point2d_records, pCIB ) )
                   return false;
-            }
 
-            if ( !read_feature_record_table ( stream, pCIB->m_nfeature_records, pCIB ) )
-            {
-                  fclose ( stream );
+            if ( !read_feature_record_table ( &stream, pCIB->m_nfeature_records, pCIB ) )
                   return false;
-            }
-
-//      int file_end = ftell(stream);
-
-//      wxASSERT(file_end == file_length);
-
-            fclose ( stream );
-
 
             return true;
       }
@@ -4591,34 +4576,44 @@ int cm93chart::loadsubcell ( int cellindex, wxChar sub_char )
       //    Set the member variable to be the actual file name for use in single chart mode info display
       m_LastFileName = file;
 
-      // Decompress if needed
-      if(compfile.Length()) {
-          file = wxFileName::CreateTempFileName(wxFileName(compfile).GetFullName());
-          if(!DecompressXZFile(compfile, file)) {
-              wxRemoveFile(file);
-              return 0;
-          }
-      }
-
       if ( g_bDebugCM93 )
       {
             printf ( "   %s\n", ( const char * ) msg.mb_str()  );
       }
 
-      //    Ingest it
-      if ( !Ingest_CM93_Cell ( ( const char * ) file.mb_str(), &m_CIB ) )
+      //    Seen lately?
+      wxString source = compfile.Length() ? compfile : file;
+      std::shared_ptr<cm93_cell_image> image = s_cell_cache.Find ( source );
+      bool b_cached = ( image.get() != NULL );
+
+      if ( !image )
       {
-            wxString msg ( _T ( "   cm93chart  Error ingesting " ) );
-            msg.Append ( file );
-            wxLogMessage ( msg );
+            // Decompress if needed
+            if(compfile.Length()) {
+                file = wxFileName::CreateTempFileName(wxFileName(compfile).GetFullName());
+                if(!DecompressXZFile(compfile, file)) {
+                    wxRemoveFile(file);
+                    return 0;
+                }
+            }
+
+            image = load_cell_image ( file );
 
             if(compfile.Length())
                 wxRemoveFile(file);
+      }
+
+      //    Ingest it
+      if ( !image || !Ingest_CM93_Cell ( *image, &m_CIB ) )
+      {
+            wxString msg ( _T ( "   cm93chart  Error ingesting " ) );
+            msg.Append ( source );
+            wxLogMessage ( msg );
             return 0;
       }
 
-      if(compfile.Length())
-          wxRemoveFile(file);
+      if ( !b_cached )
+            s_cell_cache.Add ( source, image );
 
       return 1;
 }
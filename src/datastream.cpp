@@ -161,6 +161,9 @@ void DataStream::Init(void)
     m_socket_server = 0;
     m_txenter = 0;
     m_net_protocol = GPSD;
+    m_rx_bytes = 0;
+    m_rx_sentences = 0;
+    m_rx_dropped = 0;
     
     m_socket_timer.SetOwner(this, TIMER_SOCKET);
     m_socketread_watchdog_timer.SetOwner(this, TIMER_SOCKET + 1);
@@ -413,6 +416,9 @@ DataStream::~DataStream()
 void DataStream::Close()
 {
     wxLogMessage( wxString::Format(_T("Closing NMEA Datastream %s"), m_portstring.c_str()) );
+    if(m_rx_bytes)
+        wxLogMessage( wxString::Format(_T("  %ld bytes, %ld sentences received, %ld dropped"),
+                                       (long)m_rx_bytes, (long)m_rx_sentences, (long)m_rx_dropped) );
     
 //    Kill off the Secondary RX Thread if alive
     if(m_pSecondary_Thread)
@@ -534,10 +540,11 @@ void DataStream::OnSocketEvent(wxSocketEvent& event)
             //           m_sock->SetNotify(wxSOCKET_LOST_FLAG);
 
             std::vector<char> data(RD_BUF_SIZE+1);
+            size_t count = 0;
             event.GetSocket()->Read(&data.front(),RD_BUF_SIZE);
             if(!event.GetSocket()->Error())
             {
-                size_t count = event.GetSocket()->LastCount();
+                count = event.GetSocket()->LastCount();
                 if(count)
                 {
                     if(!g_benableUDPNullHeader){
@@ -553,11 +560,16 @@ void DataStream::OnSocketEvent(wxSocketEvent& event)
                 }
             }
 
+            //  Sentences are taken from {pos} on, and the buffer trimmed once at the end.
+            //  All those completed by this read go to the consumer in one event.
+            std::shared_ptr<OCPN_DataStreamBatch> batch = std::make_shared<OCPN_DataStreamBatch>();
+            long ndropped = 0;
+            size_t pos = 0;
             bool done = false;
 
             while(!done){
                 int nmea_tail = 2;
-                size_t nmea_end = m_sock_buffer.find_first_of("*\r\n"); // detect the potential end of a NMEA string by finding the checkum marker or EOL
+                size_t nmea_end = m_sock_buffer.find_first_of("*\r\n", pos); // detect the potential end of a NMEA string by finding the checkum marker or EOL
 
                 if (nmea_end == wxString::npos) // No termination characters: continue reading
                     break;
@@ -567,9 +579,8 @@ void DataStream::OnSocketEvent(wxSocketEvent& event)
 
                 if(nmea_end < m_sock_buffer.size() - nmea_tail){
                     nmea_end += nmea_tail + 1; // move to the char after the 2 checksum digits, if present
-                    if ( nmea_end == 0 ) //The first character in the buffer is a terminator, skip it to avoid infinite loop
-                        nmea_end = 1;
-                    std::string nmea_line = m_sock_buffer.substr(0,nmea_end);
+                    if ( nmea_end == pos ) //The first character in the buffer is a terminator, skip it to avoid infinite loop
+                        nmea_end = pos + 1;
 
                     //  If, due to some logic error, the {nmea_end} parameter is larger than the length of the
                     //  socket buffer, then std::string::substr() will throw an exception.
@@ -577,33 +588,54 @@ void DataStream::OnSocketEvent(wxSocketEvent& event)
                     //  If found, the simple solution is to clear the socket buffer, and carry on
                     //  This has been seen on high volume TCP feeds, Windows only.
                     //  Hard to catch.....
-                    if(nmea_end > m_sock_buffer.size())
-                        m_sock_buffer.clear();
+                    size_t line_start = pos;
+                    if(nmea_end > m_sock_buffer.size()) {
+                        nmea_end = m_sock_buffer.size();
+                        pos = m_sock_buffer.size();
+                    }
                     else
-                        m_sock_buffer = m_sock_buffer.substr(nmea_end);
+                        pos = nmea_end;
 
-                    size_t nmea_start = nmea_line.find_last_of("$!"); // detect the potential start of a NMEA string, skipping preceding chars that may look like the start of a string.
-                    if(nmea_start != wxString::npos){
-                        nmea_line = nmea_line.substr(nmea_start);
+                    // detect the potential start of a NMEA string, skipping preceding chars that may look like the start of a string.
+                    size_t nmea_start = m_sock_buffer.find_last_of("$!", nmea_end - 1);
+                    if(nmea_start != wxString::npos && nmea_start >= line_start){
+                        std::string nmea_line = m_sock_buffer.substr(nmea_start, nmea_end - nmea_start);
                         nmea_line += "\r\n";        // Add cr/lf, possibly superfluous
-                        if( m_consumer && ChecksumOK(nmea_line)){
+                        if( m_consumer ){
                             OCPN_DataStreamEvent Nevent(wxEVT_OCPN_DATASTREAM, 0);
-                            if(nmea_line.size()) {
-                                Nevent.SetNMEAString( nmea_line );
-                                Nevent.SetStream( this );
-                            
-                                m_consumer->AddPendingEvent(Nevent);
-                            }
+                            Nevent.SetNMEAString( nmea_line );
+                            Nevent.SetStream( this );
+
+                            if( Nevent.ChecksumOK() )
+                                batch->events.push_back( Nevent );
+                            else
+                                ndropped++;
                         }
                     }
+                    else
+                        ndropped++;
                 }
                 else
                     done = true;
             }
+            m_sock_buffer.erase(0, pos);
+
+            if(batch->events.size() == 1)
+                m_consumer->AddPendingEvent(batch->events[0]);
+            else if(batch->events.size() > 1) {
+                OCPN_DataStreamEvent Nevent(wxEVT_OCPN_DATASTREAM, 0);
+                Nevent.SetStream( this );
+                Nevent.SetBatch( batch );
+                m_consumer->AddPendingEvent(Nevent);
+            }
 
             // Prevent non-nmea junk from consuming to much memory by limiting carry-over buffer size.
-            if(m_sock_buffer.size()>RD_BUF_SIZE)
+            if(m_sock_buffer.size()>RD_BUF_SIZE) {
                 m_sock_buffer = m_sock_buffer.substr(m_sock_buffer.size()-RD_BUF_SIZE);
+                ndropped++;
+            }
+
+            AddRxStats(count, batch->events.size(), ndropped);
 
             m_dog_value = N_DOG_TIMEOUT;                // feed the dog
             break;
@@ -702,21 +734,19 @@ void DataStream::OnServerSocketEvent(wxSocketEvent& event)
 
 bool DataStream::SentencePassesFilter(const wxString& sentence, FilterDirection direction)
 {
-    wxArrayString filter;
     bool listype = false;
 
     if (direction == FILTER_INPUT)
     {
-        filter = m_input_filter;
         if (m_input_filter_type == WHITELIST)
             listype = true;
     }
     else
     {
-        filter = m_output_filter;
         if (m_output_filter_type == WHITELIST)
             listype = true;
     }
+    const wxArrayString &filter = (direction == FILTER_INPUT) ? m_input_filter : m_output_filter;
     if (filter.Count() == 0) //Empty list means everything passes
         return true;
 
@@ -743,6 +773,65 @@ bool DataStream::SentencePassesFilter(const wxString& sentence, FilterDirection
     return !listype;
 }
 
+//  Compare a filter entry with part of a sentence address, without making substrings
+static bool FilterMatches(const wxString& fs, const char *field)
+{
+    for (size_t i = 0; i < fs.Length(); i++)
+    {
+        if (!field[i] || fs[i] != (wxChar)(unsigned char)field[i])
+            return false;
+    }
+    return true;
+}
+
+//  As above, on the address found when the sentence was read
+bool DataStream::SentencePassesFilter(const NMEA_SentenceHeader& header, FilterDirection direction)
+{
+    bool listype = false;
+
+    if (direction == FILTER_INPUT)
+    {
+        if (m_input_filter_type == WHITELIST)
+            listype = true;
+    }
+    else
+    {
+        if (m_output_filter_type == WHITELIST)
+            listype = true;
+    }
+    const wxArrayString &filter = (direction == FILTER_INPUT) ? m_input_filter : m_output_filter;
+    if (filter.Count() == 0) //Empty list means everything passes
+        return true;
+
+    for (size_t i = 0; i < filter.Count(); i++)
+    {
+        const wxString &fs = filter[i];
+        switch (fs.Length())
+        {
+            case 2:
+                if (FilterMatches(fs, header.address))
+                    return listype;
+                break;
+            case 3:
+                if (FilterMatches(fs, header.address + 2))
+                    return listype;
+                break;
+            case 5:
+                if (FilterMatches(fs, header.address))
+                    return listype;
+                break;
+        }
+    }
+    return !listype;
+}
+
+void DataStream::AddRxStats(long bytes, long sentences, long dropped)
+{
+    m_rx_bytes += bytes;
+    m_rx_sentences += sentences;
+    m_rx_dropped += dropped;
+}
+
 bool DataStream::ChecksumOK( const std::string &sentence )
 {
     if (!m_bchecksumCheck)
@@ -2550,6 +2550,10 @@ void glChartCanvas::RenderRasterChartRegionGL( ChartBase *chart, ViewPort &vp, L
     }
 
     LLBBox box = region.GetBox();
+    //  cached tiles this close to the region are read ahead
+    LLBBox ahead_box = box;
+    ahead_box.EnLarge(wxMax(box.GetLatRange(), box.GetLonRange()) / 2);
+
     int numtiles;
     glTexTile **tiles = pTexFact->GetTiles(numtiles);
     for(int i = 0; i<numtiles; i++) {
@@ -2560,8 +2564,11 @@ void glChartCanvas::RenderRasterChartRegionGL( ChartBase *chart, ViewPort &vp, L
             bool bGLMemCrunch = g_tex_mem_used > g_GLOptions.m_iTextureMemorySize * 1024 * 1024;
             if( bGLMemCrunch)
                 pTexFact->DeleteTexture( tile->rect );
+            else if(!ahead_box.IntersectOut(tile->box))
+                pTexFact->ReadAhead( base_level, tile->rect, global_color_scheme );
         } else {
             bool texture = pTexFact->PrepareTexture( base_level, tile->rect, global_color_scheme );
+            pTexFact->ReadAhead( base_level, tile->rect, global_color_scheme );
             if(!texture) { // failed to load, draw red
                 glDisable(GL_TEXTURE_2D);
                 glColor3f(1, 0, 0);
@@ -3375,11 +3382,9 @@ void glChartCanvas::Render()
 
     m_last_render_time = wxDateTime::Now().GetTicks();
 
-    // we don't care about jobs that are now off screen
-    // clear out and it will be repopulated during render
-    if(g_GLOptions.m_bTextureCompression &&
-       !g_GLOptions.m_bTextureCompressionCaching)
-        g_glTextureManager->ClearJobList();
+    // reorder compression jobs around the new view, and drop
+    // those now off screen if we are not caching
+    g_glTextureManager->SetViewPort(cc1->VPoint);
 
     if(b_timeGL && g_bShowFPS){
         if(n_render % 10){
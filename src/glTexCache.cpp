@@ -30,6 +30,12 @@
 
 #include <stdint.h>
 
+#include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 #include "dychart.h"
 
 #include "viewport.h"
@@ -44,6 +50,7 @@
 #include "chartdb.h"
 #include "OCPNPlatform.h"
 #include "mipmap/mipmap.h"
+#include "MappedFile.h"
 
 #ifndef GL_ETC1_RGB8_OES
 #define GL_ETC1_RGB8_OES                                        0x8D64
@@ -79,6 +86,107 @@ extern bool GetMemoryStatus( int *mem_total, int *mem_used );
 extern wxString CompressedCachePath(wxString path);
 extern glTextureManager   *g_glTextureManager;
 
+//  Cache files mapped at once, a bound on address space rather than descriptors,
+//  since a mapping holds no file open
+#define MAX_MAPPED_CACHE_FILES  (sizeof(void *) < 8 ? 8 : 64)
+#define MAX_READAHEAD_QUEUE     1024
+
+//  Factories holding a mapping of their cache file, most recently used first
+static std::list<glTexFactory*> s_mapped_factories;
+static std::mutex s_map_mutex;          // guards the list and every factory's m_map
+
+//  Touches the pages of cache file ranges on a thread of its own, so the page
+//  faults are taken there rather than when the GUI decompresses the tile.
+//  The queue holds a reference to each mapping, so a mapping evicted meanwhile
+//  stays valid until its ranges are done.
+class CacheReadAhead
+{
+public:
+    CacheReadAhead();
+    ~CacheReadAhead();
+
+    void Queue(const std::shared_ptr<MappedFile> &map, size_t offset, size_t size);
+
+private:
+    struct Range {
+        std::shared_ptr<MappedFile> map;
+        size_t offset, size;
+    };
+
+    void WorkerLoop();
+
+    std::thread             m_thread;
+    std::mutex              m_mutex;        // guards the queue
+    std::condition_variable m_work_cond;
+    std::deque<Range>       m_queue;
+    bool                    m_bquit;
+};
+
+CacheReadAhead::CacheReadAhead()
+{
+    m_bquit = false;
+    m_thread = std::thread(&CacheReadAhead::WorkerLoop, this);
+}
+
+CacheReadAhead::~CacheReadAhead()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bquit = true;
+        m_queue.clear();
+    }
+    m_work_cond.notify_all();
+    m_thread.join();
+}
+
+//  Read ahead is only advice, so a full queue drops the request
+void CacheReadAhead::Queue(const std::shared_ptr<MappedFile> &map, size_t offset, size_t size)
+{
+    if(!size)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_queue.size() >= MAX_READAHEAD_QUEUE)
+            return;
+        Range range;
+        range.map = map;
+        range.offset = offset;
+        range.size = size;
+        m_queue.push_back(range);
+    }
+    m_work_cond.notify_one();
+}
+
+void CacheReadAhead::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_bquit) {
+        if(m_queue.empty()) {
+            m_work_cond.wait(lock);
+            continue;
+        }
+
+        Range range = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+
+        const volatile unsigned char *data = range.map->GetData() + range.offset;
+        unsigned char sum = data[range.size - 1];
+        for(size_t i = 0 ; i < range.size ; i += 4096)
+            sum += data[i];
+        (void)sum;
+        range.map.reset();
+
+        lock.lock();
+    }
+}
+
+static CacheReadAhead &GetCacheReadAhead()
+{
+    static CacheReadAhead s_readahead;
+    return s_readahead;
+}
+
 //      CatalogEntry implementation
 CatalogEntry::CatalogEntry()
 {
@@ -150,6 +258,7 @@ glTexFactory::glTexFactory(ChartBase *chart, int raster_format)
     m_catalogCorrupted = false;
 
     m_fs = 0;
+    m_readahead_scheme = N_COLOR_SCHEMES;
     m_LRUtime = 0;
     m_ntex = 0;
     m_tiles = NULL;
@@ -181,6 +290,7 @@ glTexFactory::glTexFactory(ChartBase *chart, int raster_format)
 
 glTexFactory::~glTexFactory()
 {
+    ReleaseMap();
     delete m_fs;
 
     PurgeBackgroundCompressionPool();
@@ -383,6 +493,20 @@ void glTexFactory::DeleteAllDescriptors( void )
     
 }
 
+//  Lat/lon extent of the tile at rect, once PrepareTiles() has laid them out
+bool glTexFactory::GetTileBox(const wxRect &rect, LLBBox &box) const
+{
+    if(!m_tiles)
+        return false;
+
+    int index = ArrayIndex(rect.x, rect.y);
+    if(index < 0 || index >= m_ntex || !m_tiles[index])
+        return false;
+
+    box = m_tiles[index]->box;
+    return true;
+}
+
 bool glTexFactory::BackgroundCompressionAsJob() const
 {
     return g_glTextureManager->AsJob( m_ChartPath );
@@ -391,7 +515,9 @@ bool glTexFactory::BackgroundCompressionAsJob() const
 void glTexFactory::PurgeBackgroundCompressionPool()
 {
     //  Purge the "todo" list, and allow any running jobs to complete normally
-    g_glTextureManager->PurgeJobList( m_ChartPath );
+    //  There is no manager when the cache is built from the command line
+    if(g_glTextureManager)
+        g_glTextureManager->PurgeJobList( m_ChartPath );
 }
         
 void glTexFactory::DeleteSingleTexture( glTextureDescriptor *ptd )
@@ -893,13 +1019,22 @@ bool glTexFactory::UpdateCacheAllLevels( const wxRect &rect, ColorScheme color_s
     if( !g_GLOptions.m_bTextureCompressionCaching)
         return false;
 
+    //  Anything new?  Look before the mapping is given up for writing
     bool work = false;
-
     for (int level = 0; level < g_mipmap_max_level + 1; level++ )
-        work |= UpdateCacheLevel( rect, level, color_scheme, compcomp_array[level], compcomp_size[level] );
-    if (work) {
+        if(compcomp_array[level] && !GetCacheEntryValue(level, rect.x, rect.y, color_scheme))
+            work = true;
+    if (!work)
+        return false;
+
+    if (OpenCacheFile()) {
+        for (int level = 0; level < g_mipmap_max_level + 1; level++ )
+            UpdateCacheLevel( rect, level, color_scheme, compcomp_array[level], compcomp_size[level] );
         WriteCatalogAndHeader();
-    }    
+    }
+    else
+        work = false;
+    CloseCacheFile();
     
     return work;
 }
@@ -928,18 +1063,12 @@ int glTexFactory::GetTextureLevel( glTextureDescriptor *ptd, const wxRect &rect,
             //      so go load it
             if( p != 0 ) {
                 int size = TextureTileSize(level, true);
-
-                if(m_fs->IsOpened()){
-                    m_fs->Seek(p->texture_offset);
-                    ptd->comp_array[level] = (unsigned char*)malloc(size);
-                    int max_compressed_size = LZ4_COMPRESSBOUND(g_tile_size);
-                    char *compressed_data = (char*)malloc(p->compressed_size);
-                    m_fs->Read(compressed_data, p->compressed_size);
-                    LZ4_decompress_fast(compressed_data, (char*)ptd->comp_array[level], size);
-                    free(compressed_data);
+                unsigned char *cb = (unsigned char*)malloc(size);
+                if(ReadCompressedTile(p, cb, size)) {
+                    ptd->comp_array[level] = cb;
+                    return COMPRESSED_BUFFER_OK;
                 }
-            
-                return COMPRESSED_BUFFER_OK;
+                free(cb);
             }
         }
     }
@@ -953,6 +1082,126 @@ int glTexFactory::GetTextureLevel( glTextureDescriptor *ptd, const wxRect &rect,
 }
 
 
+//  Map the cache file, or reuse the mapping if it reaches at least to end.
+//  Returns NULL if the file cannot be mapped, the callers then read it as a stream.
+std::shared_ptr<MappedFile> glTexFactory::GetMap(size_t end)
+{
+    std::lock_guard<std::mutex> lock(s_map_mutex);
+    s_mapped_factories.remove(this);
+
+    if(m_map && m_map->GetSize() < end)
+        m_map.reset();                  // the file has grown since
+
+    if(!m_map) {
+        m_map = std::make_shared<MappedFile>(m_CompressedCacheFilePath);
+        m_readahead.assign(m_ntex, 0);
+    }
+
+    if(!m_map->IsOk() || m_map->GetSize() < end) {
+        m_map.reset();
+        return m_map;
+    }
+
+    s_mapped_factories.push_front(this);
+    while(s_mapped_factories.size() > MAX_MAPPED_CACHE_FILES) {
+        s_mapped_factories.back()->m_map.reset();
+        s_mapped_factories.pop_back();
+    }
+
+    return m_map;
+}
+
+void glTexFactory::ReleaseMap()
+{
+    std::lock_guard<std::mutex> lock(s_map_mutex);
+    s_mapped_factories.remove(this);
+    m_map.reset();
+}
+
+bool glTexFactory::ReadCacheData(size_t offset, void *data, size_t size)
+{
+    std::shared_ptr<MappedFile> map = GetMap(offset + size);
+    if(map) {
+        memcpy(data, map->GetData() + offset, size);
+        return true;
+    }
+
+    wxFFile fs(m_CompressedCacheFilePath, _T("rb"));
+    if(!fs.IsOpened() || !fs.Seek(offset))
+        return false;
+    return fs.Read(data, size) == size;
+}
+
+//  Decompress one tile level, straight from the mapping if there is one
+bool glTexFactory::ReadCompressedTile(const CatalogEntryValue *p, unsigned char *tex_data, int size)
+{
+    size_t end = (size_t)p->texture_offset + p->compressed_size;
+    std::shared_ptr<MappedFile> map = GetMap(end);
+    if(map)
+        return LZ4_decompress_safe((const char *)map->GetData() + p->texture_offset,
+                                   (char *)tex_data, p->compressed_size, size) == size;
+
+    char *compressed_data = (char*)malloc(p->compressed_size);
+    bool ok = ReadCacheData(p->texture_offset, compressed_data, p->compressed_size) &&
+        LZ4_decompress_safe(compressed_data, (char *)tex_data, p->compressed_size, size) == size;
+    free(compressed_data);
+    return ok;
+}
+
+//  The cache file is only held open while it is being written, and the
+//  mapping is dropped first since the catalog and header are about to move
+bool glTexFactory::OpenCacheFile()
+{
+    ReleaseMap();
+    if(!m_fs)
+        m_fs = new wxFFile(m_CompressedCacheFilePath, _T("rb+"));
+    return m_fs->IsOpened();
+}
+
+void glTexFactory::CloseCacheFile()
+{
+    delete m_fs;
+    m_fs = NULL;
+}
+
+//  Queue the cached levels either side of base_level of this tile for reading
+//  in the background, so that zooming or panning onto it does not wait on the disk
+void glTexFactory::ReadAhead( int base_level, const wxRect &rect, ColorScheme color_scheme )
+{
+    if(!g_GLOptions.m_bTextureCompression || !g_GLOptions.m_bTextureCompressionCaching)
+        return;
+
+    int array_index = ArrayIndex(rect.x, rect.y);
+    if(array_index < 0 || array_index >= m_ntex)
+        return;
+
+    std::shared_ptr<MappedFile> map;
+    int first = wxMax(base_level - 1, 0), last = wxMin(base_level + 1, g_mipmap_max_level);
+    for(int level = first; level <= last; level++) {
+        CatalogEntryValue *p = GetCacheEntryValue(level, rect.x, rect.y, color_scheme);
+        if(!p)
+            continue;
+
+        if(!map) {
+            map = GetMap(0);
+            if(!map)
+                return;
+            if(m_readahead_scheme != color_scheme) {
+                m_readahead.assign(m_ntex, 0);
+                m_readahead_scheme = color_scheme;
+            }
+        }
+
+        if(m_readahead[array_index] & (1 << level))
+            continue;
+        if((size_t)p->texture_offset + p->compressed_size > map->GetSize())
+            continue;
+
+        m_readahead[array_index] |= 1 << level;
+        GetCacheReadAhead().Queue(map, p->texture_offset, p->compressed_size);
+    }
+}
+
 // return not used
 // false? never
 // true 
@@ -965,41 +1214,40 @@ bool glTexFactory::LoadHeader(void)
 
     if(wxFileName::FileExists(m_CompressedCacheFilePath)) {
         
-        m_fs = new wxFFile(m_CompressedCacheFilePath, _T("rb+"));
-        if(m_fs->IsOpened()){
+        CompressedCacheHeader hdr;
+        wxULongLong length = wxFileName::GetSize(m_CompressedCacheFilePath);
+        bool length_ok = length != wxInvalidSize;
+        size_t file_size = length_ok ? (size_t)length.GetValue() : 0;
+
+        if(length_ok && file_size < sizeof( hdr )) {
+            // file exists, and is empty
+            n_catalog_entries = 0;
+            m_catalog_offset = 0;
+            if(OpenCacheFile())
+                WriteCatalogAndHeader();
+            CloseCacheFile();
+        }
         
-            CompressedCacheHeader hdr;
-            
-            //  Header is located at the end of the file
-            wxFileOffset hdr_offset = m_fs->Length() -sizeof( hdr);
-            hdr_offset = m_fs->Seek( hdr_offset );
-            
-            if( sizeof( hdr) == m_fs->Read(&hdr, sizeof( hdr ))) {
-                if( hdr.magic != COMPRESSED_CACHE_MAGIC ||
-                    hdr.chartdate != m_chart_date_binary ||
-                    hdr.chartfile_date != m_chartfile_date_binary ||
-                    hdr.chartfile_size != m_chartfile_size ||
-                    hdr.format != g_raster_format) {
-                    
-                    //  Bad header signature    
-                    delete m_fs;
-                    need_new = true;
-                }
-                else {      // good header
-                    n_catalog_entries = hdr.m_nentries;
-                    m_catalog_offset = hdr.catalog_offset;
-                }
+        //  Header is located at the end of the file
+        else if(length_ok && ReadCacheData(file_size - sizeof( hdr ), &hdr, sizeof( hdr ))) {
+            if( hdr.magic != COMPRESSED_CACHE_MAGIC ||
+                hdr.chartdate != m_chart_date_binary ||
+                hdr.chartfile_date != m_chartfile_date_binary ||
+                hdr.chartfile_size != m_chartfile_size ||
+                hdr.format != g_raster_format) {
+                
+                //  Bad header signature    
+                need_new = true;
             }
-            else{  // file exists, and is empty
-                n_catalog_entries = 0;
-                m_catalog_offset = 0;
-                WriteCatalogAndHeader();
+            else {      // good header
+                n_catalog_entries = hdr.m_nentries;
+                m_catalog_offset = hdr.catalog_offset;
             }
-        }  // is open
+        }
         
-        else{               // some problem opening file, probably permissions on Win7
-            delete m_fs;
+        else{               // some problem reading file, probably permissions on Win7
             need_new = true;
+            ReleaseMap();
             wxRemoveFile(m_CompressedCacheFilePath);
         }
         
@@ -1014,13 +1262,12 @@ bool glTexFactory::LoadHeader(void)
 
     if (need_new) {
         //  Create new file, with empty catalog, and correct header
+        ReleaseMap();
         m_fs = new wxFFile(m_CompressedCacheFilePath, _T("wb"));
         n_catalog_entries = 0;
         m_catalog_offset = 0;
         WriteCatalogAndHeader();
-        delete m_fs;
-
-        m_fs = new wxFFile(m_CompressedCacheFilePath, _T("rb+"));
+        CloseCacheFile();
     }
     m_hdrOK = true;
     return true;
@@ -1063,17 +1310,23 @@ bool glTexFactory::LoadCatalog(void)
         return true;
     }
     
-    m_fs->Seek(m_catalog_offset);
- 
     CatalogEntry ps;
     int buf_size =  ps.GetSerialSize();
-    unsigned char *buf = (unsigned char *)malloc(buf_size);
+
+    //  A corrupt header could claim any number of entries
+    bool bad = n_catalog_entries < 0 || n_catalog_entries > N_COLOR_SCHEMES * MAX_TEX_LEVEL * m_ntex;
+    if(bad)
+        n_catalog_entries = 0;
+
+    unsigned char *buf = (unsigned char *)malloc(buf_size * wxMax(n_catalog_entries, 1));
+    if(!ReadCacheData(m_catalog_offset, buf, buf_size * n_catalog_entries)) {
+        n_catalog_entries = 0;
+        bad = true;
+    }
     
     CatalogEntry p;
-    bool bad = false;
     for(int i=0 ; i < n_catalog_entries ; i++){
-        m_fs->Read(buf, buf_size);
-        p.DeSerialize(buf);
+        p.DeSerialize(buf + i * buf_size);
         if (!AddCacheEntryValue(p))
             bad = true;
     }
@@ -1153,10 +1406,10 @@ bool glTexFactory::UpdateCachePrecomp(unsigned char *data, int data_size, const
     if (GetCacheEntryValue(level, rect.x, rect.y, color_scheme) != 0) 
         return false;
     
-    // Make sure the file exists
+    // Make sure the file is open, see OpenCacheFile()
     wxASSERT(m_fs != 0);
         
-    if( ! m_fs->IsOpened() )
+    if( !m_fs || !m_fs->IsOpened() )
         return false;
 
     //      Create a new catalog entry
@@ -0,0 +1,371 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Headless builder for the compressed raster texture cache
+ * Author:   agent
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+// For compilers that support precompilation, includes "wx.h".
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include <chrono>
+
+#include "dychart.h"
+#include "glTexCacheBuilder.h"
+#include "glTexCache.h"
+#include "glTextureManager.h"
+#include "glChartCanvas.h"
+#include "chartdb.h"
+#include "chartimg.h"
+
+#define REPORT_INTERVAL_MS      2000
+
+extern int g_mipmap_max_level;
+extern GLuint g_raster_format;
+extern ocpnGLOptions g_GLOptions;
+extern int g_tile_size;
+extern int g_uncompressed_tile_size;
+extern ColorScheme global_color_scheme;
+
+static ChartBaseBSB *NewRasterChart(const wxString &path)
+{
+    wxString ext = wxFileName(path).GetExt().Upper();
+    if(ext == _T("KAP"))
+        return new ChartKAP;
+    if(ext == _T("GEO"))
+        return new ChartGEO;
+    return NULL;
+}
+
+glTexCacheBuilder::glTexCacheBuilder()
+    : m_scheme(global_color_scheme), m_next_row(0), m_nactive(0), m_tiles_total(0),
+      m_tiles_done(0), m_tiles_failed(0), m_bytes_in(0.), m_bytes_out(0.)
+{
+}
+
+glTexCacheBuilder::~glTexCacheBuilder()
+{
+    for(unsigned int i = 0 ; i < m_charts.size() ; i++) {
+        delete m_charts[i]->pFact;
+        delete m_charts[i];
+    }
+}
+
+//  There is no GL context to ask, so settle on what SetupCompression() picks
+//  on nearly every desktop driver.  FXT1 compresses on the GPU, and is not
+//  available here.
+void glTexCacheBuilder::SetupCompression()
+{
+    int dim = g_GLOptions.m_iTextureDimension;
+
+    int max_level = 0;
+    for(int d = dim ; d > 0 ; d /= 2)
+        max_level++;
+    g_mipmap_max_level = max_level - 1;
+
+    g_raster_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    g_uncompressed_tile_size = dim * dim * 4;
+    g_tile_size = dim * dim / 2;                // dxt1 is 4 bits per pixel
+
+    g_GLOptions.m_bTextureCompression = true;
+    g_GLOptions.m_bTextureCompressionCaching = true;
+}
+
+void glTexCacheBuilder::AddChart(const wxString &path)
+{
+    m_paths.Add(path);
+}
+
+//  Queue every raster chart in the database, returns the number queued
+int glTexCacheBuilder::AddChartDB(ChartDB *pChartDB)
+{
+    int n = 0;
+    for(int i = 0 ; i < pChartDB->GetChartTableEntries() ; i++) {
+        const ChartTableEntry &cte = pChartDB->GetChartTableEntry(i);
+        if(cte.GetChartType() != CHART_TYPE_KAP && cte.GetChartType() != CHART_TYPE_GEO)
+            continue;
+
+        AddChart(wxString(cte.GetpFullPath(), wxConvUTF8));
+        n++;
+    }
+    return n;
+}
+
+//  Queue every raster chart found below dir, returns the number queued
+int glTexCacheBuilder::AddDirectory(const wxString &dir)
+{
+    if(!wxDir::Exists(dir))
+        return 0;
+
+    wxArrayString files;
+    wxDir::GetAllFiles(dir, &files, wxEmptyString, wxDIR_FILES | wxDIR_DIRS);
+    files.Sort();
+
+    int n = 0;
+    for(unsigned int i = 0 ; i < files.GetCount() ; i++) {
+        wxString ext = wxFileName(files[i]).GetExt().Upper();
+        if(ext != _T("KAP") && ext != _T("GEO"))
+            continue;
+
+        AddChart(files[i]);
+        n++;
+    }
+    return n;
+}
+
+//  Open the chart header, and list the tiles which are missing from its cache.
+//  A cache made for another edition of the chart is started afresh by the
+//  factory, so all its tiles are missing.  Returns the number missing, or -1.
+int glTexCacheBuilder::Plan(Chart *chart)
+{
+    ChartBaseBSB *pheader = NewRasterChart(chart->path);
+    if(!pheader || pheader->Init(chart->path, HEADER_ONLY) != INIT_OK) {
+        wxLogMessage(_T("Raster cache build: cannot open ") + chart->path);
+        delete pheader;
+        return -1;
+    }
+
+    chart->pFact = new glTexFactory(pheader, g_raster_format);
+
+    int dim = g_GLOptions.m_iTextureDimension;
+    int nmissing = 0;
+    for(int y = 0 ; y < pheader->GetSize_Y() ; y += dim) {
+        Row row;
+        row.chart = chart;
+        row.y = y;
+        for(int x = 0 ; x < pheader->GetSize_X() ; x += dim) {
+            wxRect rect(x, y, dim, dim);
+            for(int level = 0 ; level < g_mipmap_max_level + 1 ; level++)
+                if(!chart->pFact->IsLevelInCache(level, rect, m_scheme)) {
+                    row.x.push_back(x);
+                    break;
+                }
+        }
+
+        if(!row.x.empty()) {
+            nmissing += row.x.size();
+            chart->rows_left++;
+            m_rows.push_back(row);
+        }
+    }
+    delete pheader;
+
+    if(!nmissing) {
+        delete chart->pFact;
+        chart->pFact = NULL;
+    }
+    return nmissing;
+}
+
+bool glTexCacheBuilder::Run(int nthreads)
+{
+    SetupCompression();
+
+    wxPrintf(_T("Raster cache build: checking %d charts\n"), (int)m_paths.GetCount());
+    fflush(stdout);
+
+    int ncurrent = 0, nbad = 0;
+    for(unsigned int i = 0 ; i < m_paths.GetCount() ; i++) {
+        Chart *chart = new Chart;
+        chart->path = m_paths[i];
+        chart->pFact = NULL;
+        chart->rows_left = 0;
+
+        int nmissing = Plan(chart);
+        if(nmissing > 0) {
+            m_charts.push_back(chart);
+            m_tiles_total += nmissing;
+            continue;
+        }
+
+        if(nmissing == 0)
+            ncurrent++;
+        else
+            nbad++;
+        delete chart;
+    }
+
+    wxString msg;
+    msg.Printf(_T("Raster cache build: %d charts to build, %d up to date, %d unreadable, %ld tiles"),
+               (int)m_charts.size(), ncurrent, nbad, m_tiles_total);
+    wxPrintf(_T("%s\n"), msg);
+    fflush(stdout);
+    wxLogMessage(msg);
+
+    if(m_rows.empty())
+        return nbad == 0;
+
+    //  A row is the unit of work, more threads than rows would sit idle
+    nthreads = wxMax(1, wxMin(nthreads, (int)m_rows.size()));
+
+    m_sw.Start();
+    std::vector<std::thread> threads;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_nactive = nthreads;
+        for(int i = 0 ; i < nthreads ; i++)
+            threads.push_back(std::thread(&glTexCacheBuilder::WorkerLoop, this));
+
+        while(m_nactive) {
+            m_done_cond.wait_for(lock, std::chrono::milliseconds(REPORT_INTERVAL_MS));
+            Report(m_nactive == 0);
+        }
+    }
+
+    for(unsigned int i = 0 ; i < threads.size() ; i++)
+        threads[i].join();
+
+    return nbad == 0 && m_tiles_failed == 0;
+}
+
+void glTexCacheBuilder::WorkerLoop()
+{
+    Chart *open_chart = NULL;
+    ChartBaseBSB *pchart = NULL;
+    int dim = g_GLOptions.m_iTextureDimension;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_next_row < m_rows.size()) {
+        Row &row = m_rows[m_next_row++];
+        lock.unlock();
+
+        if(row.chart != open_chart) {
+            delete pchart;
+            pchart = NewRasterChart(row.chart->path);
+            if(pchart && pchart->Init(row.chart->path, FULL_INIT) != INIT_OK) {
+                delete pchart;
+                pchart = NULL;
+            }
+            if(pchart)
+                pchart->SetColorScheme(m_scheme, true);
+            open_chart = row.chart;
+        }
+
+        for(unsigned int i = 0 ; i < row.x.size() ; i++) {
+            wxRect rect(row.x[i], row.y, dim, dim);
+            long size = pchart ? BuildTile(row.chart, pchart, rect) : -1;
+
+            lock.lock();
+            if(size < 0)
+                m_tiles_failed++;
+            else {
+                m_tiles_done++;
+                m_bytes_in += (double)dim * dim * 3;
+                m_bytes_out += size;
+            }
+            lock.unlock();
+        }
+
+        lock.lock();
+        if(--row.chart->rows_left == 0) {
+            //  Every row is done, nobody else holds the factory
+            delete row.chart->pFact;
+            row.chart->pFact = NULL;
+        }
+    }
+
+    m_nactive--;
+    lock.unlock();
+    m_done_cond.notify_all();
+
+    delete pchart;
+}
+
+//  Decode, compress and write one tile, all levels.  Returns the bytes
+//  written to the cache, or -1.
+long glTexCacheBuilder::BuildTile(Chart *chart, ChartBaseBSB *pchart, const wxRect &rect)
+{
+    wxRect ncrect(rect);
+    unsigned char *bits = (unsigned char *)malloc(rect.width * rect.height * 4);
+    if(!pchart->GetChartBits(ncrect, bits, 1)) {
+        free(bits);
+        return -1;
+    }
+
+    JobTicket ticket;
+    ticket.pFact = chart->pFact;
+    ticket.m_ChartPath = chart->path;
+    ticket.m_rect = rect;
+    ticket.level0_bits = bits;                  // the ticket owns them now
+    ticket.level_min_request = 0;
+    ticket.ident = 0;
+    ticket.b_throttle = false;
+    ticket.b_abort = false;
+    ticket.b_isaborted = false;
+    ticket.bpost_zip_compress = true;
+    ticket.binplace = false;
+    ticket.b_inCompressAll = true;
+
+    long size = -1;
+    if(ticket.DoJob(rect)) {
+        std::lock_guard<std::mutex> lock(chart->mutex);
+        if(chart->pFact->UpdateCacheAllLevels(rect, m_scheme, ticket.compcomp_bits_array,
+                                              ticket.compcomp_size_array) ||
+           chart->pFact->IsLevelInCache(0, rect, m_scheme)) {
+            size = 0;
+            for(int level = 0 ; level < g_mipmap_max_level + 1 ; level++)
+                size += ticket.compcomp_size_array[level];
+        }
+    }
+
+    for(int level = 0 ; level < g_mipmap_max_level + 1 ; level++) {
+        free(ticket.comp_bits_array[level]);
+        free(ticket.compcomp_bits_array[level]);
+    }
+
+    return size;
+}
+
+//  Called with m_mutex held
+void glTexCacheBuilder::Report(bool final)
+{
+    double secs = m_sw.Time() / 1000.;
+    if(secs <= 0.)
+        return;
+
+    double mb_in = m_bytes_in / (1024. * 1024.) / secs;
+    double mb_out = m_bytes_out / (1024. * 1024.) / secs;
+    long finished = m_tiles_done + m_tiles_failed;
+
+    wxString msg;
+    if(final)
+        msg.Printf(_T("Raster cache build: %ld tiles built, %ld failed, %.0f s, %.1f MB/s decoded, %.2f MB/s written"),
+                   m_tiles_done, m_tiles_failed, secs, mb_in, mb_out);
+    else {
+        long eta = finished ? (long)(secs * (m_tiles_total - finished) / finished) : 0;
+        msg.Printf(_T("Raster cache build: %ld/%ld tiles, %.1f MB/s decoded, %.2f MB/s written, ETA %ld:%02ld:%02ld"),
+                   finished, m_tiles_total, mb_in, mb_out, eta / 3600, (eta / 60) % 60, eta % 60);
+    }
+
+    wxPrintf(_T("%s\n"), msg);
+    fflush(stdout);
+    if(final)
+        wxLogMessage(msg);
+}
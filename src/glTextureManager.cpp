@@ -27,6 +27,8 @@
 #include <wx/wxprec.h>
 #include <wx/progdlg.h>
 
+#include <algorithm>
+
 #include "viewport.h"
 #include "glTexCache.h"
 #include "glTextureDescriptor.h"
@@ -40,6 +42,7 @@
 #include "OCPNPlatform.h"
 #include "FontMgr.h"
 #include "mipmap/mipmap.h"
+#include "georef.h"
 
 #ifndef GL_ETC1_RGB8_OES
 #define GL_ETC1_RGB8_OES                                        0x8D64
@@ -85,6 +88,14 @@ bool g_throttle_squish;
 
 glTextureManager   *g_glTextureManager;
 
+//  Heap order for the pending jobs, the lowest priority value on top, then the newest
+static bool JobTicketOrder(const JobTicket *a, const JobTicket *b)
+{
+    if(a->priority != b->priority)
+        return a->priority > b->priority;
+    return a->serial < b->serial;
+}
+
 #include "ssl/sha1.h"
 
 wxString CompressedCachePath(wxString path)
@@ -193,6 +204,9 @@ WX_DECLARE_OBJARRAY(compress_target, ArrayOfCompressTargets);
 
 JobTicket::JobTicket()
 {
+    pMessageTarget = NULL;
+    priority = 0;
+    serial = 0;
     for(int i=0 ; i < 10 ; i++) {
         compcomp_size_array[i] = 0;
         comp_bits_array[i] = NULL;
@@ -412,13 +426,13 @@ bool JobTicket::DoJob()
     rect.height = dim;
     for( int y = 0; y < ny_tex; y++ ) {
         
-        if( pthread && pthread->m_pMessageTarget ) {
+        if( pMessageTarget ) {
             OCPN_CompressionThreadEvent Nevent(wxEVT_OCPN_COMPRESSIONTHREAD, 0);
             Nevent.nstat = y;
             Nevent.nstat_max = ny_tex;
             Nevent.type = 1;
             Nevent.SetTicket(this);
-            pthread->m_pMessageTarget->AddPendingEvent (Nevent);
+            pMessageTarget->AddPendingEvent (Nevent);
         }
         
         rect.x = 0;
@@ -657,7 +671,6 @@ wxEvent* OCPN_CompressionThreadEvent::Clone() const
     newevent->m_ticket->level_min_request = this->m_ticket->level_min_request;
     newevent->m_ticket->ident = this->m_ticket->ident;
     newevent->m_ticket->b_throttle = this->m_ticket->b_throttle;
-    newevent->m_ticket->pthread = this->m_ticket->pthread;
     newevent->m_ticket->level0_bits = this->m_ticket->level0_bits;
     newevent->m_ticket->m_ChartPath = this->m_ticket->m_ChartPath;
     newevent->m_ticket->b_abort = this->m_ticket->b_abort;
@@ -680,60 +693,135 @@ wxEvent* OCPN_CompressionThreadEvent::Clone() const
 
 
 
-CompressionPoolThread::CompressionPoolThread(JobTicket *ticket, wxEvtHandler *message_target)
+CompressionWorkerPool::CompressionWorkerPool(int nthreads, wxEvtHandler *message_target)
 {
     m_pMessageTarget = message_target;
-    m_ticket = ticket;
-    
-    Create();
+    m_running = 0;
+    m_max_throttled = wxMax(nthreads - 1, 1);
+    m_bquit = false;
+
+    for(int i=0 ; i < nthreads ; i++)
+        m_workers.push_back(new Worker);
+    for(unsigned int i=0 ; i < m_workers.size() ; i++)
+        m_workers[i]->thread = std::thread(&CompressionWorkerPool::WorkerLoop, this, i);
+}
+
+CompressionWorkerPool::~CompressionWorkerPool()
+{
+    //  Jobs already started are finished, queued tickets stay with the manager
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bquit = true;
+        for(unsigned int i=0 ; i < m_workers.size() ; i++)
+            m_workers[i]->queue.clear();
+    }
+    m_work_cond.notify_all();
+    for(unsigned int i=0 ; i < m_workers.size() ; i++) {
+        m_workers[i]->thread.join();
+        delete m_workers[i];
+    }
+}
+
+void CompressionWorkerPool::Submit(JobTicket *ticket)
+{
+    ticket->pMessageTarget = m_pMessageTarget;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        unsigned int index = wxStringHash()(ticket->m_ChartPath) % m_workers.size();
+        m_workers[index]->queue.push_back(ticket);
+    }
+    m_work_cond.notify_all();
+}
+
+//  Called with m_mutex held
+bool CompressionWorkerPool::CanStart(JobTicket *ticket) const
+{
+    return !ticket->b_throttle || ticket->b_abort || m_running < m_max_throttled;
 }
 
-void * CompressionPoolThread::Entry()
+//  Own queue first, in submission order, else the front of the longest other queue.
+//  Called with m_mutex held, returns NULL if nothing may start now.
+JobTicket *CompressionWorkerPool::TakeTicket(unsigned int index)
 {
+    std::deque<JobTicket*> &own = m_workers[index]->queue;
+    for(std::deque<JobTicket*>::iterator it = own.begin() ; it != own.end() ; ++it)
+        if(CanStart(*it)) {
+            JobTicket *ticket = *it;
+            own.erase(it);
+            return ticket;
+        }
 
+    int victim = -1;
+    size_t victim_size = 0;
+    for(unsigned int i=0 ; i < m_workers.size() ; i++) {
+        std::deque<JobTicket*> &queue = m_workers[i]->queue;
+        if(i != index && queue.size() > victim_size && CanStart(queue.front())) {
+            victim = i;
+            victim_size = queue.size();
+        }
+    }
+    if(victim < 0)
+        return NULL;
+
+    JobTicket *ticket = m_workers[victim]->queue.front();
+    m_workers[victim]->queue.pop_front();
+    return ticket;
+}
+
+void CompressionWorkerPool::WorkerLoop(unsigned int index)
+{
 #ifdef __MSVC__
     _set_se_translator(my_translate);
+#endif
+#ifdef __WXMSW__
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#endif
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_bquit) {
+        JobTicket *ticket = TakeTicket(index);
+        if(!ticket) {
+            m_work_cond.wait(lock);
+            continue;
+        }
+
+        m_running++;
+        lock.unlock();
+        RunTicket(ticket);
+        lock.lock();
+        m_running--;
+
+        //  A throttled ticket may have been waiting for this one
+        m_work_cond.notify_all();
+    }
+}
 
-    //  On Windows, if anything in this thread produces a SEH exception (like access violation)
-    //  we handle the exception locally, and simply alow the thread to exit smoothly with no results.
+void CompressionWorkerPool::RunTicket(JobTicket *ticket)
+{
+#ifdef __MSVC__
+    //  On Windows, if anything in this job produces a SEH exception (like access violation)
+    //  we handle the exception locally, and simply return the ticket with no results.
     //  Upstream will notice that nothing got done, and maybe try again later.
-    
     try
 #endif    
     {
-    SetPriority( WXTHREAD_MIN_PRIORITY );
-
-    if(!m_ticket->DoJob())
-        m_ticket->b_isaborted = true;
-
-    if( m_pMessageTarget ) {
-        OCPN_CompressionThreadEvent Nevent(wxEVT_OCPN_COMPRESSIONTHREAD, 0);
-        Nevent.SetTicket(m_ticket);
-        Nevent.type = 0;
-        m_pMessageTarget->QueueEvent(Nevent.Clone());
-        // from here m_ticket is undefined (if deleted in event handler)
+        if(ticket->b_abort || !ticket->DoJob())
+            ticket->b_isaborted = true;
     }
-
-    return 0;
-
-    }           // try
-    
 #ifdef __MSVC__    
     catch (SE_Exception e)
     {
-        if( m_pMessageTarget ) {
-            OCPN_CompressionThreadEvent Nevent(wxEVT_OCPN_COMPRESSIONTHREAD, 0);
-            m_ticket->b_isaborted = true;
-            Nevent.SetTicket(m_ticket);
-            Nevent.type = 0;
-            m_pMessageTarget->QueueEvent(Nevent.Clone());
-        }
-        
-        
-        return 0;
+        ticket->b_isaborted = true;
     }
 #endif    
-    
+
+    if( m_pMessageTarget ) {
+        OCPN_CompressionThreadEvent Nevent(wxEVT_OCPN_COMPRESSIONTHREAD, 0);
+        Nevent.SetTicket(ticket);
+        Nevent.type = 0;
+        m_pMessageTarget->QueueEvent(Nevent.Clone());
+        // from here ticket is undefined (if deleted in event handler)
+    }
 }
 
 //      ProgressInfoItem Implementation
@@ -757,6 +845,9 @@ glTextureManager::glTextureManager()
 
     m_max_jobs =  wxMax(nCPU, 1);
     m_prevMemUsed = 0;    
+    m_serial = 0;
+    m_vp_clat = m_vp_clon = 0;
+    m_vp_radius = 0;
 
     if(bthread_debug)
         printf(" nCPU: %d    m_max_jobs :%d\n", nCPU, m_max_jobs);
@@ -777,12 +868,23 @@ glTextureManager::glTextureManager()
     m_bForeground = false;
     m_timer.Connect(wxEVT_TIMER, wxTimerEventHandler( glTextureManager::OnTimer ), NULL, this);
     m_timer.Start(500);
+
+    m_pool = new CompressionWorkerPool(m_max_jobs, this);
 }
 
 glTextureManager::~glTextureManager()
 {
 //    ClearAllRasterTextures();
-    ClearJobList();
+    PurgeJobList();
+    delete m_pool;
+
+    //  Whatever the pool did not hand back before it stopped
+    wxJobListNode *node = running_list.GetFirst();
+    while(node){
+        delete node->GetData();
+        node = node->GetNext();
+    }
+    running_list.Clear();
 }
 
 #define NBAR_LENGTH 40
@@ -888,7 +990,7 @@ void glTextureManager::OnEvtThread( OCPN_CompressionThreadEvent & event )
         
         if(bthread_debug)
             printf( "    Abort job: %08X  Jobs running: %d             Job count: %lu   \n",
-                    ticket->ident, GetRunningJobCount(), (unsigned long)todo_list.GetCount());
+                    ticket->ident, GetRunningJobCount(), (unsigned long)m_todo.size());
     } else if(!ticket->b_inCompressAll) {
         //   Normal completion from here
         glTextureDescriptor *ptd = ticket->pFact->GetpTD( ticket->m_rect );
@@ -917,7 +1019,7 @@ void glTextureManager::OnEvtThread( OCPN_CompressionThreadEvent & event )
 
         if(bthread_debug)
             printf( "    Finished job: %08X  Jobs running: %d             Job count: %lu   \n",
-                    ticket->ident, GetRunningJobCount(), (unsigned long)todo_list.GetCount());
+                    ticket->ident, GetRunningJobCount(), (unsigned long)m_todo.size());
     }
 
     //      Free all possible memory
@@ -992,27 +1094,17 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
 {
     wxString chart_path = client->GetChartPath();
     if(!b_nolimit) {
-        if(todo_list.GetCount() >= 50){
-            // remove last job which is least important
-            wxJobListNode *node = todo_list.GetLast();
-            JobTicket *ticket = node->GetData();
-            todo_list.DeleteNode(node);
-            delete ticket;
-        }
-
     //  Avoid adding duplicate jobs, i.e. the same chart_path, and the same rectangle
-        wxJobListNode *node = todo_list.GetFirst();
-        while(node){
-            JobTicket *ticket = node->GetData();
-            if( (ticket->m_ChartPath == chart_path) && (ticket->m_rect == rect)) {
-                // bump to front
-                todo_list.DeleteNode(node);
-                todo_list.Insert(ticket);
+        for(unsigned int i = 0 ; i < m_todo.size() ; i++) {
+            JobTicket *ticket = m_todo[i];
+            if( (ticket->m_rect == rect) && (ticket->m_ChartPath == chart_path)) {
+                // renew, it is wanted now
                 ticket->level_min_request = level;
+                ticket->serial = ++m_serial;
+                ticket->priority = JobPriority(ticket);
+                SortJobs();
                 return false;
             }
-        
-            node = node->GetNext();
         }
 
         // avoid duplicate worker jobs
@@ -1042,6 +1134,10 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
     pt->bpost_zip_compress = b_postZip;
     pt->binplace = b_inplace;
     pt->b_inCompressAll = b_inCompressAllCharts;
+    if(!rect.IsEmpty())
+        client->GetTileBox(rect, pt->box);
+    pt->serial = ++m_serial;
+    pt->priority = JobPriority(pt);
     
 
     /* do we compress in ram using builtin libraries, or do we
@@ -1055,11 +1151,12 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
     we can use multiple threads to take advantage of multiple cores */
 
     if(g_raster_format != GL_COMPRESSED_RGB_FXT1_3DFX) {
-        todo_list.Insert(pt); // push to front as a stack
+        m_todo.push_back(pt);
+        std::push_heap(m_todo.begin(), m_todo.end(), JobTicketOrder);
         if(bthread_debug){
             int mem_used;
             GetMemoryStatus(0, &mem_used);
-            printf( "Adding job: %08X  Job Count: %lu  mem_used %d\n", pt->ident, (unsigned long)todo_list.GetCount(), mem_used);
+            printf( "Adding job: %08X  Job Count: %lu  mem_used %d\n", pt->ident, (unsigned long)m_todo.size(), mem_used);
         }
  
         StartTopJob();
@@ -1080,60 +1177,45 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
     return true;
 }
 
+//  Hand the best tickets to the pool, keeping each worker one ticket ahead
+//  so it does not idle waiting for the GUI to dispatch the next one.
 bool glTextureManager::StartTopJob()
 {
-    wxJobListNode *node = todo_list.GetFirst();
-    if(!node)
-        return false;
-
-    JobTicket *ticket = node->GetData();
+    bool bstarted = false;
+    while(!m_todo.empty() && GetRunningJobCount() < 2 * m_pool->GetThreadCount()) {
+        std::pop_heap(m_todo.begin(), m_todo.end(), JobTicketOrder);
+        JobTicket *ticket = m_todo.back();
+        m_todo.pop_back();
 
-    //  Is it possible to start another job?
-    if(GetRunningJobCount() >= wxMax(m_max_jobs - ticket->b_throttle, 1))
-        return false;
-
-    todo_list.DeleteNode(node);
-
-    glTextureDescriptor *ptd = ticket->pFact->GetpTD( ticket->m_rect );
-    // don't need the job if we already have the compressed data
-    if(ptd->comp_array[0]) {
-        delete ticket;
-        return StartTopJob();
-    }
-
-    if(ptd->map_array[0]) {
-        if(ticket->level_min_request == 0) {
-            // give level 0 buffer to the ticket
-            ticket->level0_bits = ptd->map_array[0];
-            ptd->map_array[0] = NULL;
-        } else {
-            // would be nicer to use reference counters
-            int size = TextureTileSize(0, false);
-            ticket->level0_bits = (unsigned char*)malloc(size);
-            memcpy(ticket->level0_bits, ptd->map_array[0], size);
+        glTextureDescriptor *ptd = ticket->pFact->GetpTD( ticket->m_rect );
+        // don't need the job if we already have the compressed data
+        if(ptd->comp_array[0]) {
+            delete ticket;
+            continue;
         }
-    }
 
-    running_list.Append(ticket);
-    DoThreadJob(ticket);
+        if(ptd->map_array[0]) {
+            if(ticket->level_min_request == 0) {
+                // give level 0 buffer to the ticket
+                ticket->level0_bits = ptd->map_array[0];
+                ptd->map_array[0] = NULL;
+            } else {
+                // would be nicer to use reference counters
+                int size = TextureTileSize(0, false);
+                ticket->level0_bits = (unsigned char*)malloc(size);
+                memcpy(ticket->level0_bits, ptd->map_array[0], size);
+            }
+        }
 
-    return true;
-}
+        if(bthread_debug)
+            printf( "  Starting job: %08X  Jobs running: %d Jobs left: %lu\n", ticket->ident, GetRunningJobCount(), (unsigned long)m_todo.size());
 
+        running_list.Append(ticket);
+        m_pool->Submit(ticket);
+        bstarted = true;
+    }
 
-bool glTextureManager::DoThreadJob(JobTicket* pticket)
-{
-    if(bthread_debug)
-        printf( "  Starting job: %08X  Jobs running: %d Jobs left: %lu\n", pticket->ident, GetRunningJobCount(), (unsigned long)todo_list.GetCount());
-    
-///    qDebug() << "Starting job" << GetRunningJobCount() <<  (unsigned long)todo_list.GetCount() << g_tex_mem_used;
-    CompressionPoolThread *t = new CompressionPoolThread( pticket, this);
-    pticket->pthread = t;
-    
-    t->Run();
-    
-    return true;
-    
+    return bstarted;
 }
 
 bool glTextureManager::AsJob( wxString const &chart_path ) const
@@ -1155,17 +1237,19 @@ void glTextureManager::PurgeJobList( wxString chart_path )
 {
     if(chart_path.Len()){    
         //  Remove all pending jobs relating to the passed chart path
-        wxJobListNode *next, *tnode = todo_list.GetFirst();
-        while(tnode){
-            JobTicket *ticket = tnode->GetData();
-            next = tnode->GetNext();
+        unsigned int n = 0;
+        for(unsigned int i = 0 ; i < m_todo.size() ; i++) {
+            JobTicket *ticket = m_todo[i];
             if(ticket->m_ChartPath.IsSameAs(chart_path)){
                 if(bthread_debug)
                     printf("Pool:  Purge pending job for purged chart\n");
-                todo_list.DeleteNode(tnode);
                 delete ticket;
-            }
-            tnode = next;
+            } else
+                m_todo[n++] = ticket;
+        }
+        if(n < m_todo.size()) {
+            m_todo.resize(n);
+            SortJobs();
         }
 
         wxJobListNode *node = running_list.GetFirst();
@@ -1178,18 +1262,12 @@ void glTextureManager::PurgeJobList( wxString chart_path )
         }
             
         if(bthread_debug)
-            printf("Pool:  Purge, todo count: %lu\n", (long unsigned)todo_list.GetCount());
+            printf("Pool:  Purge, todo count: %lu\n", (long unsigned)m_todo.size());
     }
     else {
-        wxJobListNode *node = todo_list.GetFirst();
-        while(node){
-            JobTicket *ticket = node->GetData();
-            delete ticket;
-            node = node->GetNext();
-        }
-        todo_list.Clear();
+        ClearJobList();
         //  Mark all running tasks for "abort"
-        node = running_list.GetFirst();
+        wxJobListNode *node = running_list.GetFirst();
         while(node){
             JobTicket *ticket = node->GetData();
             ticket->b_abort = true;
@@ -1200,13 +1278,80 @@ void glTextureManager::PurgeJobList( wxString chart_path )
 
 void glTextureManager::ClearJobList()
 {
-    wxJobListNode *node = todo_list.GetFirst();
-    while(node){
-        JobTicket *ticket = node->GetData();
-        delete ticket;
-        node = node->GetNext();
+    for(unsigned int i = 0 ; i < m_todo.size() ; i++)
+        delete m_todo[i];
+    m_todo.clear();
+}
+
+//  Distance of the tile from the centre of the last rendered viewport, in
+//  viewport radii, plus the mipmap level asked for.  Tiles off screen sort
+//  behind everything visible.
+double glTextureManager::JobPriority(JobTicket *ticket)
+{
+    double priority = ticket->level_min_request;
+    if(!ticket->box.GetValid() || !m_vp_box.GetValid())
+        return priority;
+
+    if(m_vp_box.IntersectOut(ticket->box))
+        priority += 1000;
+
+    double lat = (ticket->box.GetMinLat() + ticket->box.GetMaxLat()) / 2;
+    double lon = (ticket->box.GetMinLon() + ticket->box.GetMaxLon()) / 2;
+    double dlon = fabs(lon - m_vp_clon);
+    if(dlon > 180)
+        dlon = 360 - dlon;
+    dlon *= cos(m_vp_clat * PI / 180);
+    double dlat = lat - m_vp_clat;
+
+    return priority + sqrt(dlat*dlat + dlon*dlon) / m_vp_radius;
+}
+
+void glTextureManager::SortJobs()
+{
+    std::make_heap(m_todo.begin(), m_todo.end(), JobTicketOrder);
+}
+
+//  Called as each frame is rendered.  Pending jobs are ordered again around
+//  the new view.  Unless the results go to the disk cache, jobs for tiles no
+//  longer on screen are cancelled, and any running ones aborted.
+void glTextureManager::SetViewPort(ViewPort &vp)
+{
+    LLBBox &box = vp.GetBBox();
+    if(!box.GetValid())
+        return;
+
+    m_vp_box = box;
+    m_vp_clat = vp.clat;
+    m_vp_clon = vp.clon;
+    double coslat = cos(vp.clat * PI / 180);
+    m_vp_radius = wxMax(sqrt(box.GetLatRange()*box.GetLatRange() +
+                             box.GetLonRange()*box.GetLonRange()*coslat*coslat) / 2, 1e-6);
+
+    bool b_cancel = g_GLOptions.m_bTextureCompression &&
+        !g_GLOptions.m_bTextureCompressionCaching;
+
+    unsigned int n = 0;
+    for(unsigned int i = 0 ; i < m_todo.size() ; i++) {
+        JobTicket *ticket = m_todo[i];
+        if(b_cancel && ticket->box.GetValid() && m_vp_box.IntersectOut(ticket->box)) {
+            delete ticket;
+            continue;
+        }
+        ticket->priority = JobPriority(ticket);
+        m_todo[n++] = ticket;
+    }
+    m_todo.resize(n);
+    SortJobs();
+
+    if(b_cancel) {
+        wxJobListNode *node = running_list.GetFirst();
+        while(node){
+            JobTicket *ticket = node->GetData();
+            if(ticket->box.GetValid() && m_vp_box.IntersectOut(ticket->box))
+                ticket->b_abort = true;
+            node = node->GetNext();
+        }
     }
-    todo_list.Clear();
 }
 
 
@@ -1294,7 +1439,7 @@ bool glTextureManager::TextureCrunch(double factor)
     return true;
 }
 
-#define MAX_CACHE_FACTORY 50
+#define MAX_CACHE_FACTORY 200
 bool glTextureManager::FactoryCrunch(double factor)
 {
     if (m_chart_texfactory_hash.size() == 0) {
@@ -1326,8 +1471,8 @@ bool glTextureManager::FactoryCrunch(double factor)
             continue;
         wxString chart_full_path = ptf->GetChartPath();
         
-        // we better have to find one because glTexFactory keep cache texture open
-        // and ocpn will eventually run out of file descriptors
+        // factories no longer hold their cache file open, the mappings
+        // are bounded separately, so this is only about memory
         if( cc1->GetVP().b_quilt )          // quilted
         {
             if( cc1->m_pQuilt && cc1->m_pQuilt->IsComposed() &&
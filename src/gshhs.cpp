@@ -39,6 +39,8 @@
 
 #include <wx/file.h>
 
+#include <atomic>
+
 #ifdef ocpnUSE_GL
 #include "glChartCanvas.h"
 #endif
@@ -633,11 +635,9 @@ void GshhsPolyReader::InitializeLoadQuality( int quality )  // 5 levels: 0=low .
     }
 }
 
-static inline bool my_intersects( const wxLineF &line1, const wxLineF &line2 )
+static inline bool segments_intersect( double x1, double y1, double x2, double y2,
+                                       double x3, double y3, double x4, double y4 )
 {
-    double x1 = line1.m_p1.x, y1 = line1.m_p1.y, x2 = line1.m_p2.x, y2 = line1.m_p2.y;
-    double x3 = line2.m_p1.x, y3 = line2.m_p1.y, x4 = line2.m_p2.x, y4 = line2.m_p2.y;
-
     // implementation is based on Graphics Gems III's "Faster Line Segment Intersection"
     double ax = x2 - x1, ay = y2 - y1;
     double bx = x3 - x4, by = y3 - y4;
@@ -645,7 +645,7 @@ static inline bool my_intersects( const wxLineF &line1, const wxLineF &line2 )
 
 #  define INTER_LIMIT 1e-7
     double denominator = ay * bx - ax * by;
-    if( denominator < 1e-10 ) {
+    if( fabs(denominator) < 1e-10 ) {
         if(fabs((y1*ax - ay*x1)*bx - (y3*bx - by*x3)*ax) > INTER_LIMIT)
             return false; /* different intercepts, no intersection */
         if(fabs((x1*ay - ax*y1)*by - (x3*by - bx*y3)*ay) > INTER_LIMIT)
@@ -665,6 +665,12 @@ static inline bool my_intersects( const wxLineF &line1, const wxLineF &line2 )
     return true;
 }
 
+static inline bool my_intersects( const wxLineF &line1, const wxLineF &line2 )
+{
+    return segments_intersect( line1.m_p1.x, line1.m_p1.y, line1.m_p2.x, line1.m_p2.y,
+                               line2.m_p1.x, line2.m_p1.y, line2.m_p2.x, line2.m_p2.y );
+}
+
 bool GshhsPolyReader::crossing1( wxLineF trajectWorld )
 {
     double x1 = trajectWorld.p1().x, y1 = trajectWorld.p1().y;
@@ -779,6 +785,174 @@ bool GshhsPolyReader::crossing1( wxLineF trajectWorld )
     return false;
 }
 
+void GshhsPolyReader::BuildLandIndex( GshhsLandIndex &index )
+{
+    for( int i = 0; i < 360; i++ ) {
+        for( int j = 0; j < 180; j++ ) {
+            GshhsPolyCell *cel = allCells[i][j], *tmp = NULL;
+            if( !cel ) {
+                /* read the cell without keeping it, the index holds
+                   everything needed for crossing tests */
+                mutex1.Lock();
+                cel = tmp = new GshhsPolyCell( fpoly, i, j - 90, &polyHeader );
+                mutex1.Unlock();
+            }
+
+            index.AddCell( i, j - 90, cel->getPoly1() );
+            delete tmp;
+        }
+    }
+}
+
+//========================================================================
+
+static inline int floor_div( int a, int b )
+{
+    return a >= 0 ? a / b : -( ( b - 1 - a ) / b );
+}
+
+GshhsLandIndex::GshhsLandIndex()
+{
+    for( int i = 0; i < 360; i++ )
+        for( int j = 0; j < 180; j++ )
+            m_cell[i][j] = -1;
+    m_ncells = 0;
+}
+
+void GshhsLandIndex::AddCell( int x0, int y0, const contour_list &poly1 )
+{
+    std::vector<GshhsLandEdge> sub[GSSH_SUBM*GSSH_SUBM];
+    size_t count = 0;
+
+    for( unsigned int pi = 0; pi < poly1.size(); pi++ ) {
+        const contour &c = poly1[pi];
+        if( c.empty() )
+            continue;
+
+        double lx = c[c.size()-1].x - x0, ly = c[c.size()-1].y - y0;
+        if( lx > 180 ) lx -= 360; else if( lx < -180 ) lx += 360;
+
+        for( unsigned int pj = 0; pj < c.size(); pj++ ) {
+            double x = c[pj].x - x0, y = c[pj].y - y0;
+            if( x > 180 ) x -= 360; else if( x < -180 ) x += 360;
+
+            // skip the zero length segments sometimes found in gshhs data
+            if( lx == x && ly == y )
+                continue;
+
+            /* file the edge in every sub cell its bounding box touches,
+               sub cell k spans [k, k+1] / GSSH_SUBM inclusive */
+            int sx0 = wxMax( (int) ceil( GSSH_SUBM*wxMin( lx, x ) ) - 1, 0 );
+            int sx1 = wxMin( (int) floor( GSSH_SUBM*wxMax( lx, x ) ), GSSH_SUBM - 1 );
+            int sy0 = wxMax( (int) ceil( GSSH_SUBM*wxMin( ly, y ) ) - 1, 0 );
+            int sy1 = wxMin( (int) floor( GSSH_SUBM*wxMax( ly, y ) ), GSSH_SUBM - 1 );
+
+            GshhsLandEdge e = { (float) lx, (float) ly, (float) x, (float) y };
+            for( int sy = sy0; sy <= sy1; sy++ )
+                for( int sx = sx0; sx <= sx1; sx++ ) {
+                    sub[sy*GSSH_SUBM + sx].push_back( e );
+                    count++;
+                }
+
+            lx = x, ly = y;
+        }
+    }
+
+    if( !count )
+        return;
+
+    int cx = ( ( x0 % 360 ) + 360 ) % 360, cy = y0 + 90;
+    wxASSERT( cy >= 0 && cy < 180 );
+    m_cell[cx][cy] = m_offsets.size();
+    m_ncells++;
+
+    m_edges.reserve( m_edges.size() + count );
+    for( int k = 0; k < GSSH_SUBM*GSSH_SUBM; k++ ) {
+        m_offsets.push_back( m_edges.size() );
+        m_edges.insert( m_edges.end(), sub[k].begin(), sub[k].end() );
+    }
+    m_offsets.push_back( m_edges.size() );
+}
+
+bool GshhsLandIndex::CrossesSubCell( int clon, int clat, double x1, double y1,
+                                     double x2, double y2 ) const
+{
+    int cx = floor_div( clon, GSSH_SUBM ), cy = floor_div( clat, GSSH_SUBM );
+    int cell = m_cell[( ( cx % 360 ) + 360 ) % 360][cy + 90];
+    if( cell < 0 )
+        return false;
+
+    int k = ( clat - cy*GSSH_SUBM )*GSSH_SUBM + clon - cx*GSSH_SUBM;
+    const GshhsLandEdge *e = &m_edges[0] + m_offsets[cell + k];
+    const GshhsLandEdge *end = &m_edges[0] + m_offsets[cell + k + 1];
+
+    /* test in cell relative coordinates to match the stored edges */
+    x1 -= cx, x2 -= cx, y1 -= cy, y2 -= cy;
+    double minx = wxMin( x1, x2 ) - INTER_LIMIT, maxx = wxMax( x1, x2 ) + INTER_LIMIT;
+    double miny = wxMin( y1, y2 ) - INTER_LIMIT, maxy = wxMax( y1, y2 ) + INTER_LIMIT;
+
+    for( ; e != end; e++ ) {
+        if( ( e->x1 < minx && e->x2 < minx ) || ( e->x1 > maxx && e->x2 > maxx ) ||
+            ( e->y1 < miny && e->y2 < miny ) || ( e->y1 > maxy && e->y2 > maxy ) )
+            continue;
+        if( segments_intersect( x1, y1, x2, y2, e->x1, e->y1, e->x2, e->y2 ) )
+            return true;
+    }
+    return false;
+}
+
+bool GshhsLandIndex::Crosses( double lat1, double lon1, double lat2, double lon2 ) const
+{
+    if( !m_ncells )
+        return false;
+
+    double x1 = lon1, y1 = lat1, x2 = lon2, y2 = lat2;
+    if( fabs( x2 - x1 ) > 180 ) { /* dont go long way around world */
+        if( x1 > x2 ) x1 -= 360;
+        else x2 -= 360;
+    }
+
+    double minx = wxMin( x1, x2 ), maxx = wxMax( x1, x2 );
+    double miny = wxMin( y1, y2 ), maxy = wxMax( y1, y2 );
+    const int latlimit = GSSH_SUBM*90;
+
+    int clonmin = (int) floor( GSSH_SUBM*minx );
+    int clonmax = wxMax( (int) ceil( GSSH_SUBM*maxx ), clonmin + 1 );
+
+    /* only visit the sub cells the segment passes through: for each column
+       of sub cells take the latitude span of the segment within it */
+    for( int clon = clonmin; clon < clonmax; clon++ ) {
+        double xa = wxMax( (double) clon / GSSH_SUBM, minx );
+        double xb = wxMin( (double) ( clon + 1 ) / GSSH_SUBM, maxx );
+        double ya = miny, yb = maxy;
+        if( x1 != x2 ) {
+            double m = ( y2 - y1 ) / ( x2 - x1 );
+            ya = y1 + ( xa - x1 )*m, yb = y1 + ( xb - x1 )*m;
+            if( ya > yb ) { double t = ya; ya = yb; yb = t; }
+        }
+
+        int clatmin = wxMax( (int) floor( GSSH_SUBM*ya - 1e-9 ), -latlimit );
+        int clatmax = wxMin( wxMax( (int) ceil( GSSH_SUBM*yb + 1e-9 ), clatmin + 1 ), latlimit );
+
+        for( int clat = clatmin; clat < clatmax; clat++ )
+            if( CrossesSubCell( clon, clat, x1, y1, x2, y2 ) )
+                return true;
+    }
+
+    return false;
+}
+
+int GshhsLandIndex::CrossesBatch( const double *segments, int count, bool *result ) const
+{
+    int crossings = 0;
+    for( int i = 0; i < count; i++, segments += 4 ) {
+        result[i] = Crosses( segments[0], segments[1], segments[2], segments[3] );
+        if( result[i] )
+            crossings++;
+    }
+    return crossings;
+}
+
 void GshhsPolyReader::readPolygonFileHeader( FILE *polyfile, PolygonFileHeader *header )
 {
     fseek( polyfile, 0, SEEK_SET );
@@ -1372,36 +1546,103 @@ int GshhsReader::selectBestQuality( ViewPort &vp )
 
 /* so plugins can determine if a line segment crosses land, must call from main
    thread once at startup to initialize array */
-static GshhsReader *reader = NULL;
+static std::atomic<GshhsLandIndex *> land_index( NULL );
+static wxMutex land_index_mutex;
+
 void gshhsCrossesLandInit()
 {
-    if( ! reader ) {
-        reader = new GshhsReader();
-    }
+    wxMutexLocker lock( land_index_mutex );
+    if( land_index.load() )
+        return;
+
+    wxStopWatch sw;
+    GshhsReader *reader = new GshhsReader();
+
     /* load best possible quality for crossing tests */
     int bestQuality = 4;
     while( !reader->qualityAvailable[bestQuality] && bestQuality > 0)
         bestQuality--;
     reader->LoadQuality(bestQuality);
-    wxLogMessage("GSHHG: Loaded quality %d for land crossing detection.", bestQuality);
+
+    GshhsLandIndex *index = new GshhsLandIndex();
+    reader->BuildLandIndex( *index );
+    delete reader;
+
+    land_index.store( index );
+    wxLogMessage("GSHHG: Loaded quality %d for land crossing detection, %lu edges in %lu cells, %ld ms.",
+                 bestQuality, (unsigned long) index->GetEdgeCount(),
+                 (unsigned long) index->GetCellCount(), sw.Time());
 }
 
+/* not safe while other threads may still be testing segments */
 void gshhsCrossesLandReset() {
-    if( reader )
-        delete reader;
-    reader = NULL;
+    wxMutexLocker lock( land_index_mutex );
+    delete land_index.exchange( NULL );
 }
 
-bool gshhsCrossesLand(double lat1, double lon1, double lat2, double lon2)
+static const GshhsLandIndex *gshhsLandIndex()
 {
-    if( ! reader ) {
+    GshhsLandIndex *index = land_index.load();
+    if( !index ) {
         gshhsCrossesLandInit();
+        index = land_index.load();
+    }
+    return index;
+}
+
+bool gshhsCrossesLand(double lat1, double lon1, double lat2, double lon2)
+{
+    return gshhsLandIndex()->Crosses(lat1, lon1, lat2, lon2);
+}
+
+int gshhsCrossesLandBatch(const double *segments, int count, bool *result)
+{
+    return gshhsLandIndex()->CrossesBatch(segments, count, result);
+}
+
+/* time the crossing test, one at a time and batched, over a repeatable set
+   of random segments of up to a degree in length, and report the rates */
+bool gshhsCrossesLandBenchmark(int count)
+{
+    const GshhsLandIndex *index = gshhsLandIndex();
+    if( !index->GetEdgeCount() ) {
+        wxPrintf( _T("No GSHHG data\n") );
+        return false;
+    }
+
+    std::vector<double> segments( 4*count );
+    unsigned int seed = 12345;
+    for( int i = 0; i < 4*count; i += 4 ) {
+        double r[4];
+        for( int k = 0; k < 4; k++ ) {
+            seed = seed*1103515245 + 12345;
+            r[k] = ( ( seed >> 8 ) & 0xffff ) / 65536.0;
+        }
+        segments[i] = r[0]*160 - 80;
+        segments[i+1] = r[1]*360 - 180;
+        segments[i+2] = segments[i] + r[2] - .5;
+        segments[i+3] = segments[i+1] + r[3] - .5;
     }
-    if(lon1 < 0)
-        lon1 += 360;
-    if(lon2 < 0)
-        lon2 += 360;
 
-    wxLineF trajectWorld(lon1, lat1, lon2, lat2);
-    return reader->crossing1(trajectWorld);
+    wxStopWatch sw;
+    int crossings = 0;
+    for( int i = 0; i < count; i++ )
+        if( index->Crosses( segments[4*i], segments[4*i+1], segments[4*i+2], segments[4*i+3] ) )
+            crossings++;
+    long ms = wxMax( sw.Time(), 1L );
+
+    bool *result = new bool[count];
+    sw.Start();
+    int batch_crossings = index->CrossesBatch( &segments[0], count, result );
+    long batch_ms = wxMax( sw.Time(), 1L );
+    delete [] result;
+
+    wxString msg = wxString::Format( _T("GSHHG: land crossing benchmark, %d segments, %d crossing land, ")
+                                     _T("%ld ms, %.0f queries/s, batched %ld ms, %.0f queries/s"),
+                                     count, crossings, ms, count * 1000.0 / ms,
+                                     batch_ms, count * 1000.0 / batch_ms );
+    wxLogMessage( msg );
+    wxPrintf( _T("%s\n"), msg.c_str() );
+
+    return batch_crossings == crossings;
 }
@@ -89,19 +89,24 @@ KmlPastebufferType Kml::ParseTrack( TiXmlNode* node, wxString& name ) {
     if( 0 == strncmp( node->ToElement()->Value(), "LineString", 10 ) ) {
         dPointList coordinates;
         if( ParseCoordinates( node, coordinates ) > 2 ) {
-            TrackPoint* trackpoint = NULL;
-            TrackPoint* prevPoint = NULL;
-
-            for( unsigned int i=0; i<coordinates.size(); i++ ) {
-                trackpoint = new TrackPoint(coordinates[i].y, coordinates[i].x);
-                parsedTrack->AddPoint( trackpoint );
-            }
+            for( unsigned int i=0; i<coordinates.size(); i++ )
+                parsedTrack->AddPoint( coordinates[i].y, coordinates[i].x, wxInvalidDateTime );
         }
         return KML_PASTE_TRACK;
     }
 
     if( 0 == strncmp( node->ToElement()->Value(), "gx:Track", 8 ) ) {
-        TrackPoint* trackpoint = NULL;
+        //  Read the times first, so each point goes into the track whole
+        TiXmlElement* when = node->FirstChildElement( "when" );
+
+        wxDateTime whenTime;
+        std::vector<wxDateTime> whenTimes;
+
+        for( ; when; when=when->NextSiblingElement( "when" ) ) {
+            whenTime.ParseFormat( wxString( when->GetText(), wxConvUTF8 ), _T("%Y-%m-%dT%H:%M:%SZ") );
+            whenTimes.push_back( whenTime );
+        }
+
         TiXmlElement* point = node->FirstChildElement( "gx:coord" );
         int pointCounter = 0;
 
@@ -114,23 +119,11 @@ KmlPastebufferType Kml::ParseTrack( TiXmlNode* node, wxString& name ) {
             std::getline( ss, txtCoord, ' ' );
             lat = atof( txtCoord.c_str() );
 
-            parsedTrack->AddPoint( new TrackPoint(lat, lon) );
+            parsedTrack->AddPoint( lat, lon,
+                    pointCounter < (int) whenTimes.size() ? whenTimes[pointCounter] : wxInvalidDateTime );
             pointCounter++;
         }
 
-        TiXmlElement* when = node->FirstChildElement( "when" );
-
-        wxDateTime whenTime;
-
-        int i = 0;
-        for( ; when; when=when->NextSiblingElement( "when" ) ) {
-            trackpoint = parsedTrack->GetPoint(i);
-            if( ! trackpoint ) continue;
-            whenTime.ParseFormat( wxString( when->GetText(), wxConvUTF8 ), _T("%Y-%m-%dT%H:%M:%SZ") );
-            trackpoint->SetCreateTime(whenTime);
-            i++;
-        }
-
         return KML_PASTE_TRACK;
     }
     return KML_PASTE_INVALID;
@@ -502,22 +495,18 @@ wxString Kml::MakeKmlFromTrack( Track* track ) {
     std::stringstream lineStringCoords;
 
     for(int i=0; i<track->GetnPoints(); i++) {
-        TrackPoint *trackpoint = track->GetPoint(i);
-
         TiXmlElement* when = new TiXmlElement( "when" );
         gxTrack->LinkEndChild( when );
 
-        wxDateTime whenTime( trackpoint->GetCreateTime() );
+        wxDateTime whenTime( track->GetPointCreateTime(i) );
         TiXmlText* whenVal = new TiXmlText( whenTime.Format( _T("%Y-%m-%dT%H:%M:%SZ") ).mb_str( wxConvUTF8 ) );
         when->LinkEndChild( whenVal );
     }
 
     for(int i=0; i<track->GetnPoints(); i++) {
-        TrackPoint *trackpoint = track->GetPoint(i);
-
         TiXmlElement* coord = new TiXmlElement( "gx:coord" );
         gxTrack->LinkEndChild( coord );
-        wxString coordStr = wxString::Format( _T("%f %f 0.0"), trackpoint->m_lon, trackpoint->m_lat );
+        wxString coordStr = wxString::Format( _T("%f %f 0.0"), track->GetPointLon(i), track->GetPointLat(i) );
         TiXmlText* coordVal = new TiXmlText( coordStr.mb_str( wxConvUTF8 ) );
         coord->LinkEndChild( coordVal );
     }
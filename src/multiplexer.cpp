@@ -246,6 +246,15 @@ void Multiplexer::SetGPSHandler(wxEvtHandler *handler)
 
 void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
 {
+    //  The sentences from one read of an input thread, each as its own event
+    if( event.GetBatchCount() ) {
+        for( size_t i = 0; i < event.GetBatchCount(); i++ )
+            OnEvtStream( event.GetBatchItem( i ) );
+        return;
+    }
+
+    //  The sentence was classified when it was read, route on that
+    const NMEA_SentenceHeader &header = event.GetHeader();
     wxString message = event.ProcessNMEA4Tags();
     
     DataStream *stream = event.GetStream();
@@ -260,16 +269,27 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
         //  If there is no datastream, as for PlugIns, then pass everything
         bool bpass = true;
         if( stream )
-            bpass = stream->SentencePassesFilter( message, FILTER_INPUT );
+            bpass = stream->SentencePassesFilter( header, FILTER_INPUT );
 
         if( bpass ) {
-            if( message.Mid(3,3).IsSameAs(_T("VDM")) ||
-                message.Mid(1,5).IsSameAs(_T("FRPOS")) ||
-                message.Mid(1,4).IsSameAs(_T("CDDS")) ||
-                message.Mid(3,3).IsSameAs(_T("TLL")) ||
-                message.Mid(3,3).IsSameAs(_T("TTM")) ||
-                message.Mid(3,3).IsSameAs(_T("OSD")) ||
-                ( g_bWplIsAprsPosition && message.Mid(3,3).IsSameAs(_T("WPL")) ) )
+            bool b_ais = false;
+            switch( header.id ) {
+                case NMEA_ID_VDM:
+                case NMEA_ID_FRPOS:
+                case NMEA_ID_CDDS:
+                case NMEA_ID_TLL:
+                case NMEA_ID_TTM:
+                case NMEA_ID_OSD:
+                    b_ais = true;
+                    break;
+                case NMEA_ID_WPL:
+                    b_ais = g_bWplIsAprsPosition;
+                    break;
+                default:
+                    break;
+            }
+
+            if( b_ais )
             {
                 if( m_aisconsumer )
                     m_aisconsumer->AddPendingEvent(event);
@@ -285,15 +305,8 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
 
             //Send to plugins
             if ( g_pi_manager ){
-                if(stream){                     // Is this a real or a virtual stream?
-                    if( stream->ChecksumOK(event.GetNMEAString()) )
-                        g_pi_manager->SendNMEASentenceToAllPlugIns( message );
-                }
-                else{
-                    if( CheckSumCheck(event.GetNMEAString()) )
-                        g_pi_manager->SendNMEASentenceToAllPlugIns( message );
-                }
-                    
+                if( event.ChecksumOK() )
+                    g_pi_manager->SendNMEASentenceToAllPlugIns( message );
             }
 
            //Send to all the other outputs
@@ -306,7 +319,7 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
                             bool bout_filter = true;
 
                             bool bxmit_ok = true;
-                            if(s->SentencePassesFilter( message, FILTER_OUTPUT ) ) {
+                            if(s->SentencePassesFilter( header, FILTER_OUTPUT ) ) {
                                 bxmit_ok = s->SendSentence(message);
                                 bout_filter = false;
                             }
@@ -329,11 +342,11 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
             //Send to the Debug Window, if open
             //  Special formatting for non-printable characters helps debugging NMEA problems
         if (NMEALogWindow::Get().Active()) {
-            std::string str= event.GetNMEAString();    
+            const std::string &str= event.GetNMEAString();    
             wxString fmsg;
             
             bool b_error = false;
-            for ( std::string::iterator it=str.begin(); it!=str.end(); ++it){
+            for ( std::string::const_iterator it=str.begin(); it!=str.end(); ++it){
                 if(isprint(*it))
                     fmsg += *it;
                 else{
@@ -110,7 +110,8 @@ class OGRS57DataSource
 
     S57Writer           *poWriter;
 
-    static S57ClassRegistrar *poRegistrar;
+    S57ClassRegistrar   *poRegistrar;       // per source, SENC builds may run on several threads
+    int                 bOwnRegistrar;
 
     int                 bClassCountSet;
     int                 anClassCount[MAX_CLASSES];
@@ -33,7 +33,6 @@
 #include "cpl_conv.h"
 #include "cpl_string.h"
 
-S57ClassRegistrar *OGRS57DataSource::poRegistrar = NULL;
 
 /************************************************************************/
 /*                          OGRS57DataSource()                          */
@@ -49,6 +48,9 @@ OGRS57DataSource::OGRS57DataSource()
     papoModules = NULL;
     poWriter = NULL;
 
+    poRegistrar = NULL;
+    bOwnRegistrar = FALSE;
+
     pszName = NULL;
 
 //    poSpatialRef = new OGRSpatialReference();
@@ -98,6 +100,9 @@ OGRS57DataSource::~OGRS57DataSource()
 
     CSLDestroy( papszOptions );
 
+    if( bOwnRegistrar )
+        delete poRegistrar;
+
 //    delete poSpatialRef;
 
 /*
@@ -244,11 +249,13 @@ int OGRS57DataSource::Open( const char * pszFilename, int bTestOpen, CallBackFun
     if( poRegistrar == NULL )
     {
         poRegistrar = new S57ClassRegistrar();
+        bOwnRegistrar = TRUE;
 
         if( !poRegistrar->LoadInfo( NULL, FALSE ) )
         {
             delete poRegistrar;
             poRegistrar = NULL;
+            bOwnRegistrar = FALSE;
         }
     }
 
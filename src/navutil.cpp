@@ -469,7 +469,9 @@ MyConfig::MyConfig( const wxString &appName, const wxString &vendorName,
     g_pConnectionParams = new wxArrayOfConnPrm();
 }
 
-void MyConfig::CreateRotatingNavObjBackup()
+//  pStore, if given, is the open navobj store in file.  Its backups are taken through
+//  the store, so that edits still in the write ahead log are included.
+void MyConfig::CreateRotatingNavObjBackup( const wxString &file, NavObjectStore *pStore )
 {
 
     // Avoid nonsense log errors...
@@ -481,9 +483,13 @@ void MyConfig::CreateRotatingNavObjBackup()
     //to prevent the user trying to "fix" the problem by continuously starting the
     //application to overwrite all of his good backups...
     if( g_navobjbackups > 0 ) {
+#ifdef USE_NAVOBJ_DB
+        if( pStore )
+            pStore->Checkpoint();       // so that the file size below means something
+#endif
         wxFile f;
-        wxString oldname = m_sNavObjSetFile;
-        wxString newname = wxString::Format( _T("%s.1"), m_sNavObjSetFile.c_str() );
+        wxString oldname = file;
+        wxString newname = wxString::Format( _T("%s.1"), file.c_str() );
 
         wxFileOffset s_diff = 1;
         if( ::wxFileExists( newname ) ) {
@@ -504,23 +510,28 @@ void MyConfig::CreateRotatingNavObjBackup()
         {
             for( int i = g_navobjbackups - 1; i >= 1; i-- )
             {
-                oldname = wxString::Format( _T("%s.%d"), m_sNavObjSetFile.c_str(), i );
-                newname = wxString::Format( _T("%s.%d"), m_sNavObjSetFile.c_str(), i + 1 );
+                oldname = wxString::Format( _T("%s.%d"), file.c_str(), i );
+                newname = wxString::Format( _T("%s.%d"), file.c_str(), i + 1 );
                 if( wxFile::Exists( oldname ) )
                     wxCopyFile( oldname, newname );
             }
 
-            if( wxFile::Exists( m_sNavObjSetFile ) )
+            if( wxFile::Exists( file ) )
             {
-                newname = wxString::Format( _T("%s.1"), m_sNavObjSetFile.c_str() );
-                wxCopyFile( m_sNavObjSetFile, newname );
+                newname = wxString::Format( _T("%s.1"), file.c_str() );
+#ifdef USE_NAVOBJ_DB
+                if( pStore )
+                    pStore->Backup( newname );
+                else
+#endif
+                    wxCopyFile( file, newname );
             }
         }
     }
     //try to clean the backups the user doesn't want - breaks if he deleted some by hand as it tries to be effective...
     for( int i = g_navobjbackups + 1; i <= 99; i++ )
-        if( wxFile::Exists( wxString::Format( _T("%s.%d"), m_sNavObjSetFile.c_str(), i ) ) ) wxRemoveFile(
-                wxString::Format( _T("%s.%d"), m_sNavObjSetFile.c_str(), i ) );
+        if( wxFile::Exists( wxString::Format( _T("%s.%d"), file.c_str(), i ) ) ) wxRemoveFile(
+                wxString::Format( _T("%s.%d"), file.c_str(), i ) );
         else
             break;
 }
@@ -1427,9 +1438,27 @@ void MyConfig::LoadS57Config()
 
 void MyConfig::LoadNavObjects()
 {
+    CreateRotatingNavObjBackup( m_sNavObjSetFile );
+
+#ifdef USE_NAVOBJ_DB
+    //  The store, once filled, holds the objects; navobj.xml is read only to fill it
+    wxFileName store_file( m_sNavObjSetFile );
+    store_file.SetExt( _T("db") );
+    m_sNavObjSetStoreFile = store_file.GetFullPath();
+
+    NavObjectStore *pNavObjectStore = new NavObjectStore( m_sNavObjSetStoreFile );
+    if( pNavObjectStore->IsOpen() && !pNavObjectStore->IsNew() ) {
+        CreateRotatingNavObjBackup( m_sNavObjSetStoreFile, pNavObjectStore );
+
+        wxLogMessage( _T("Loading navobjects from navobj.db") );
+        pNavObjectStore->LoadAllObjects();
+        m_pNavObjectChangesSet = pNavObjectStore;
+        return;
+    }
+#endif
+
     //      next thing to do is read tracks, etc from the NavObject XML file,
     wxLogMessage( _T("Loading navobjects from navobj.xml") );
-    CreateRotatingNavObjBackup();
 
     if( NULL == m_pNavObjectInputSet )
         m_pNavObjectInputSet = new NavObjectCollection1();
@@ -1468,6 +1497,16 @@ void MyConfig::LoadNavObjects()
            
     }
 
+#ifdef USE_NAVOBJ_DB
+    if( pNavObjectStore->IsOpen() ) {
+        wxLogMessage( _T("Moving navobjects into navobj.db") );
+        pNavObjectStore->Sync();
+        m_pNavObjectChangesSet = pNavObjectStore;
+        return;
+    }
+    delete pNavObjectStore;
+#endif
+
     m_pNavObjectChangesSet = new NavObjectChanges(m_sNavObjSetChangesFile);
 }
 
@@ -1637,7 +1676,7 @@ void MyConfig::AddNewTrack( Track *pt )
 
 void MyConfig::UpdateTrack( Track *pt )
 {
-    if( pt->m_bIsInLayer && !m_bSkipChangeSetUpdate )
+    if( !pt->m_bIsInLayer && !m_bSkipChangeSetUpdate )
         m_pNavObjectChangesSet->AddTrack( pt, "update" );
 }
 
@@ -1665,10 +1704,22 @@ void MyConfig::DeleteWayPoint( RoutePoint *pWP )
         m_pNavObjectChangesSet->AddWP( pWP, "delete" );
 }
 
-void MyConfig::AddNewTrackPoint( TrackPoint *pWP, const wxString& parent_GUID )
+void MyConfig::AddNewTrackPoint( Track *pt, int index )
 {
-    if( !m_bSkipChangeSetUpdate )
-        m_pNavObjectChangesSet->AddTrackPoint( pWP, "add", parent_GUID );
+    if( !pt->m_bIsInLayer && !m_bSkipChangeSetUpdate )
+        m_pNavObjectChangesSet->AddTrackPoint( pt, index, "add" );
+}
+
+void MyConfig::UpdateTrackPoint( Track *pt, int index )
+{
+    if( !pt->m_bIsInLayer && !m_bSkipChangeSetUpdate )
+        m_pNavObjectChangesSet->AddTrackPoint( pt, index, "update" );
+}
+
+void MyConfig::DeleteTrackPoint( Track *pt, int index )
+{
+    if( !pt->m_bIsInLayer && !m_bSkipChangeSetUpdate )
+        m_pNavObjectChangesSet->AddTrackPoint( pt, index, "delete" );
 }
 
 bool MyConfig::UpdateChartDirs( ArrayOfCDI& dir_array )
@@ -2266,6 +2317,9 @@ void MyConfig::UpdateSettings()
 
 void MyConfig::UpdateNavObj( void )
 {
+    //  The store writes only what changed
+    if( m_pNavObjectChangesSet && m_pNavObjectChangesSet->Sync() )
+        return;
 
 //   Create the NavObjectCollection, and save to specified file
     NavObjectCollection1 *pNavObjectSet = new NavObjectCollection1();
@@ -2614,7 +2668,7 @@ void MyConfig::UI_ImportGPX( wxWindow* parent, bool islayer, wxString dirpath, b
                 }
                 else {
                     int wpt_dups;
-                    pSet->LoadAllGPXObjects( !pSet->IsOpenCPN(), wpt_dups ); // Import with full visibility of names and objects
+                    pSet->LoadAllGPXObjects( !pSet->IsOpenCPN(), wpt_dups, false, true ); // Import with full visibility of names and objects
                     if(wpt_dups > 0) {
                         OCPNMessageBox(parent, wxString::Format(_("%d duplicate waypoints detected during import and ignored."), wpt_dups), _("OpenCPN Info"), wxICON_INFORMATION|wxOK, 10);
                     }
@@ -2667,43 +2721,13 @@ void SwitchInlandEcdisMode( bool Switch )
 //-------------------------------------------------------------------------
 RoutePoint *WaypointExists( const wxString& name, double lat, double lon )
 {
-    RoutePoint *pret = NULL;
 //    if( g_bIsNewLayer ) return NULL;
-    wxRoutePointListNode *node = pWayPointMan->GetWaypointList()->GetFirst();
-    bool Exists = false;
-    while( node ) {
-        RoutePoint *pr = node->GetData();
-
-//        if( pr->m_bIsInLayer ) return NULL;
-
-        if( fabs( lat - pr->m_lat ) < 1.e-6 && fabs( lon - pr->m_lon ) < 1.e-6 ) {
-            if( name == pr->GetName() ) {
-                Exists = true;
-                pret = pr;
-                break;
-            }
-        }
-        node = node->GetNext();
-    }
-
-    return pret;
+    return pWayPointMan->FindWaypointByNameAndPosition( name, lat, lon );
 }
 
 RoutePoint *WaypointExists( const wxString& guid )
 {
-    wxRoutePointListNode *node = pWayPointMan->GetWaypointList()->GetFirst();
-    while( node ) {
-        RoutePoint *pr = node->GetData();
-
-//        if( pr->m_bIsInLayer ) return NULL;
-
-        if( guid == pr->m_GUID ) {
-            return pr;
-        }
-        node = node->GetNext();
-    }
-
-    return NULL;
+    return pWayPointMan->FindRoutePointByGUID( guid );
 }
 
 bool WptIsInRouteList( RoutePoint *pr )
@@ -3110,6 +3110,14 @@ bool PlugIn_GSHHS_CrossesLand(double lat1, double lon1, double lat2, double lon2
     return gshhsCrossesLand(lat1, lon1, lat2, lon2);
 }
 
+int PlugIn_GSHHS_CrossesLandBatch(const double *segments, int count, bool *result)
+{
+    if(count <= 0)
+        return 0;
+
+    return gshhsCrossesLandBatch(segments, count, result);
+}
+
 
 void PlugInPlaySound( wxString &sound_file )
 {
@@ -3291,8 +3299,7 @@ bool UpdateSingleWaypoint( PlugIn_Waypoint *pwaypoint )
         double lat_save = prp->m_lat;
         double lon_save = prp->m_lon;
 
-        prp->m_lat = pwaypoint->m_lat;
-        prp->m_lon = pwaypoint->m_lon;
+        prp->SetPosition( pwaypoint->m_lat, pwaypoint->m_lon );
         prp->SetIconName( pwaypoint->m_IconName );
         prp->SetName( pwaypoint->m_MarkName );
         prp->m_MarkDescription = pwaypoint->m_MarkDescription;
@@ -3322,8 +3329,7 @@ bool UpdateSingleWaypoint( PlugIn_Waypoint *pwaypoint )
 
         SelectItem *pFind = pSelect->FindSelection( lat_save, lon_save, SELTYPE_ROUTEPOINT );
         if( pFind ) {
-            pFind->m_slat = pwaypoint->m_lat;             // update the SelectList entry
-            pFind->m_slon = pwaypoint->m_lon;
+            pSelect->UpdateSelectablePoint( pFind, pwaypoint->m_lat, pwaypoint->m_lon );             // update the SelectList entry
         }
 
         if(!prp->m_btemp)
@@ -3508,23 +3514,17 @@ bool AddPlugInTrack( PlugIn_Track *ptrack, bool b_permanent )
     Track *track = new Track();
 
     PlugIn_Waypoint *pwp;
-    TrackPoint *pWP_src;
     int ip = 0;
 
     wxPlugin_WaypointListNode *pwpnode = ptrack->pWaypointList->GetFirst();
     while( pwpnode ) {
         pwp = pwpnode->GetData();
 
-        TrackPoint *pWP = new TrackPoint( pwp->m_lat, pwp->m_lon );
-        pWP->SetCreateTime( pwp->m_CreateTime );
-        
-        track->AddPoint( pWP );
+        track->AddPoint( pwp->m_lat, pwp->m_lon, pwp->m_CreateTime );
 
         if(ip > 0)
-            pSelect->AddSelectableTrackSegment( pWP_src->m_lat, pWP_src->m_lon, pWP->m_lat,
-                                                pWP->m_lon, pWP_src, pWP, track );
+            pSelect->AddSelectableTrackSegment( track, ip - 1 );
         ip++;
-        pWP_src = pWP;
 
         pwpnode = pwpnode->GetNext(); //PlugInWaypoint
     }
@@ -63,6 +63,8 @@
 #include "OCPNPlatform.h"
 #include "Track.h"
 
+#include <algorithm>
+
 //#include <wx/arrimpl.cpp> // this is a magic incantation which must be done!
 //WX_DEFINE_ARRAY(MarkIcon *, ArrayOfMarkIcon);
 //WX_DEFINE_OBJARRAY( ArrayOfMarkIcon); 
@@ -1100,6 +1102,136 @@ void Routeman::ZeroCurrentXTEToActivePoint()
     m_arrival_min = 1e6;
 }
 
+//--------------------------------------------------------------------------------
+//      RoutePointIndex   Implementation
+//--------------------------------------------------------------------------------
+
+#define ROUTEPOINT_INDEX_CELL_SIZE      ( 1. / 64. )            // degrees
+#define ROUTEPOINT_INDEX_MAX_CELLS      1024                    // larger queries scan the list
+
+RoutePointIndex::RoutePointIndex()
+{
+    m_next_order = 0;
+}
+
+void RoutePointIndex::Clear()
+{
+    m_cells.clear();
+    m_filed.clear();
+    m_guids.clear();
+    m_next_order = 0;
+}
+
+void RoutePointIndex::Reserve(size_t n)
+{
+    m_filed.reserve( m_filed.size() + n );
+    m_guids.reserve( m_guids.size() + n );
+}
+
+wxUint64 RoutePointIndex::CellKey(int cx, int cy)
+{
+    return ( (wxUint64) (wxUint32) cx << 32 ) | (wxUint32) cy;
+}
+
+void RoutePointIndex::Add(RoutePoint *prp)
+{
+    if( m_filed.count( prp ) )
+        return;
+
+    Filed f;
+    f.order = m_next_order++;
+    f.cx = (int) floor( prp->m_lon / ROUTEPOINT_INDEX_CELL_SIZE );
+    f.cy = (int) floor( prp->m_lat / ROUTEPOINT_INDEX_CELL_SIZE );
+    f.guid = std::string( prp->m_GUID.mb_str() );
+
+    m_cells[CellKey( f.cx, f.cy )].push_back( prp );
+    m_guids[f.guid].push_back( prp );
+    m_filed[prp] = f;
+}
+
+void RoutePointIndex::Remove(RoutePoint *prp)
+{
+    std::unordered_map<RoutePoint *, Filed>::iterator it = m_filed.find( prp );
+    if( it == m_filed.end() )
+        return;
+
+    std::unordered_map<wxUint64, std::vector<RoutePoint *> >::iterator itc = m_cells.find( CellKey( it->second.cx, it->second.cy ) );
+    if( itc != m_cells.end() ) {
+        itc->second.erase( std::remove( itc->second.begin(), itc->second.end(), prp ), itc->second.end() );
+        if( itc->second.empty() ) m_cells.erase( itc );
+    }
+
+    std::unordered_map<std::string, std::vector<RoutePoint *> >::iterator itg = m_guids.find( it->second.guid );
+    if( itg != m_guids.end() ) {
+        itg->second.erase( std::remove( itg->second.begin(), itg->second.end(), prp ), itg->second.end() );
+        if( itg->second.empty() ) m_guids.erase( itg );
+    }
+
+    m_filed.erase( it );
+}
+
+void RoutePointIndex::Update(RoutePoint *prp)
+{
+    std::unordered_map<RoutePoint *, Filed>::iterator it = m_filed.find( prp );
+    if( it == m_filed.end() )
+        return;
+
+    int cx = (int) floor( prp->m_lon / ROUTEPOINT_INDEX_CELL_SIZE );
+    int cy = (int) floor( prp->m_lat / ROUTEPOINT_INDEX_CELL_SIZE );
+    if( ( cx == it->second.cx ) && ( cy == it->second.cy ) )
+        return;
+
+    std::vector<RoutePoint *> &old_cell = m_cells[CellKey( it->second.cx, it->second.cy )];
+    old_cell.erase( std::remove( old_cell.begin(), old_cell.end(), prp ), old_cell.end() );
+    if( old_cell.empty() ) m_cells.erase( CellKey( it->second.cx, it->second.cy ) );
+
+    it->second.cx = cx;
+    it->second.cy = cy;
+    m_cells[CellKey( cx, cy )].push_back( prp );
+}
+
+bool RoutePointIndex::GetCandidates(double lat, double lon, double radius_deg, std::vector<RoutePoint *> &result) const
+{
+    int x0 = (int) floor( ( lon - radius_deg ) / ROUTEPOINT_INDEX_CELL_SIZE );
+    int x1 = (int) floor( ( lon + radius_deg ) / ROUTEPOINT_INDEX_CELL_SIZE );
+    int y0 = (int) floor( ( lat - radius_deg ) / ROUTEPOINT_INDEX_CELL_SIZE );
+    int y1 = (int) floor( ( lat + radius_deg ) / ROUTEPOINT_INDEX_CELL_SIZE );
+
+    if( ( (double) ( x1 - x0 + 1 ) * ( y1 - y0 + 1 ) ) > ROUTEPOINT_INDEX_MAX_CELLS )
+        return false;
+
+    std::vector<std::pair<long long, RoutePoint *> > found;
+    for( int cy = y0; cy <= y1; cy++ ) {
+        for( int cx = x0; cx <= x1; cx++ ) {
+            std::unordered_map<wxUint64, std::vector<RoutePoint *> >::const_iterator it = m_cells.find( CellKey( cx, cy ) );
+            if( it == m_cells.end() ) continue;
+            for( unsigned int i = 0; i < it->second.size(); i++ )
+                found.push_back( std::make_pair( m_filed.find( it->second[i] )->second.order, it->second[i] ) );
+        }
+    }
+    std::sort( found.begin(), found.end() );
+
+    result.clear();
+    for( unsigned int i = 0; i < found.size(); i++ )
+        result.push_back( found[i].second );
+
+    return true;
+}
+
+RoutePoint *RoutePointIndex::FindGUID(const wxString &guid) const
+{
+    std::unordered_map<std::string, std::vector<RoutePoint *> >::const_iterator it = m_guids.find( std::string( guid.mb_str() ) );
+    if( it == m_guids.end() )
+        return NULL;
+
+    //  In list order, and still carrying this GUID
+    for( unsigned int i = 0; i < it->second.size(); i++ ) {
+        if( it->second[i]->m_GUID == guid )
+            return it->second[i];
+    }
+    return NULL;
+}
+
 //--------------------------------------------------------------------------------
 //      WayPointman   Implementation
 //--------------------------------------------------------------------------------
@@ -1166,10 +1298,25 @@ bool WayPointman::AddRoutePoint(RoutePoint *prp)
     
     wxRoutePointListNode *prpnode = m_pWayPointList->Append(prp);
     prp->SetManagerListNode( prpnode );
+    m_index.Add( prp );
     
     return true;
 }
 
+//  Adds a batch of points, e.g. from a GPX import, in the given order
+void WayPointman::AddRoutePoints(const std::vector<RoutePoint *> &points)
+{
+    m_index.Reserve( points.size() );
+
+    for( unsigned int i = 0; i < points.size(); i++ ) {
+        RoutePoint *prp = points[i];
+        if( !prp )
+            continue;
+        prp->SetManagerListNode( m_pWayPointList->Append( prp ) );
+        m_index.Add( prp );
+    }
+}
+
 bool WayPointman::RemoveRoutePoint(RoutePoint *prp)
 {
     if(!prp)
@@ -1183,10 +1330,29 @@ bool WayPointman::RemoveRoutePoint(RoutePoint *prp)
         m_pWayPointList->DeleteObject(prp);
     
     prp->SetManagerListNode( NULL );
+    m_index.Remove( prp );
     
     return true;
 }
 
+//      Keep the index in step with a managed RoutePoint which has moved
+void WayPointman::UpdateRoutePointPosition(RoutePoint *prp)
+{
+    if(prp)
+        m_index.Update( prp );
+}
+
+//      Points possibly within radius_deg of lat/lon, in list order
+void WayPointman::GetCandidates(double lat, double lon, double radius_deg, std::vector<RoutePoint *> &result)
+{
+    if( m_index.GetCandidates( lat, lon, radius_deg, result ) )
+        return;
+
+    result.clear();
+    for( wxRoutePointListNode *node = m_pWayPointList->GetFirst(); node; node = node->GetNext() )
+        result.push_back( node->GetData() );
+}
+
 void WayPointman::ProcessUserIcons( ocpnStyle::Style* style )
 {
     wxString msg;
@@ -2011,57 +2177,103 @@ wxString WayPointman::CreateGUID( RoutePoint *pRP )
 
 RoutePoint *WayPointman::FindRoutePointByGUID(const wxString &guid)
 {
-    wxRoutePointListNode *prpnode = m_pWayPointList->GetFirst();
-    while( prpnode ) {
-        RoutePoint *prp = prpnode->GetData();
-
-        if( prp->m_GUID == guid ) return ( prp );
-
-        prpnode = prpnode->GetNext(); //RoutePoint
-    }
+    return m_index.FindGUID( guid );
+}
 
-    return NULL;
+//      Distance measure used by the nearby waypoint queries, in meters
+static double WaypointDistance( double lat, double lon, RoutePoint *pr )
+{
+    double a = lat - pr->m_lat;
+    double b = lon - pr->m_lon;
+    return sqrt( ( a * a ) + ( b * b ) ) * 60. * 1852.;
 }
 
 RoutePoint *WayPointman::GetNearbyWaypoint( double lat, double lon, double radius_meters )
 {
-    //    Iterate on the RoutePoint list, checking distance
+    //    Iterate on the RoutePoints near the position, checking distance
+    std::vector<RoutePoint *> candidates;
+    GetCandidates( lat, lon, radius_meters / ( 60. * 1852. ), candidates );
 
-    wxRoutePointListNode *node = m_pWayPointList->GetFirst();
-    while( node ) {
-        RoutePoint *pr = node->GetData();
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        RoutePoint *pr = candidates[i];
+        if( WaypointDistance( lat, lon, pr ) < radius_meters ) return pr;
+    }
+    return NULL;
 
-        double a = lat - pr->m_lat;
-        double b = lon - pr->m_lon;
-        double l = sqrt( ( a * a ) + ( b * b ) );
+}
 
-        if( ( l * 60. * 1852. ) < radius_meters ) return pr;
+RoutePoint *WayPointman::GetOtherNearbyWaypoint( double lat, double lon, double radius_meters,
+        const wxString &guid )
+{
+    //    Iterate on the RoutePoints near the position, checking distance
+    std::vector<RoutePoint *> candidates;
+    GetCandidates( lat, lon, radius_meters / ( 60. * 1852. ), candidates );
 
-        node = node->GetNext();
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        RoutePoint *pr = candidates[i];
+        if( WaypointDistance( lat, lon, pr ) < radius_meters ) if( pr->m_GUID != guid ) return pr;
     }
     return NULL;
 
 }
 
-RoutePoint *WayPointman::GetOtherNearbyWaypoint( double lat, double lon, double radius_meters,
-        const wxString &guid )
+//      All waypoints within radius_meters, in list order
+int WayPointman::GetWaypointsInRadius( double lat, double lon, double radius_meters, std::vector<RoutePoint *> &result )
 {
-    //    Iterate on the RoutePoint list, checking distance
+    std::vector<RoutePoint *> candidates;
+    GetCandidates( lat, lon, radius_meters / ( 60. * 1852. ), candidates );
 
-    wxRoutePointListNode *node = m_pWayPointList->GetFirst();
-    while( node ) {
-        RoutePoint *pr = node->GetData();
+    result.clear();
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        if( WaypointDistance( lat, lon, candidates[i] ) < radius_meters )
+            result.push_back( candidates[i] );
+    }
+    return result.size();
+}
+
+//      Up to k waypoints nearest to lat/lon, and within max_radius_meters, nearest first
+int WayPointman::GetNearestWaypoints( double lat, double lon, unsigned int k, double max_radius_meters,
+                                      std::vector<RoutePoint *> &result )
+{
+    result.clear();
+    if( k == 0 )
+        return 0;
+
+    //  Widen the search until it holds k points, so that they are the k nearest
+    double radius = wxMin( max_radius_meters, ROUTEPOINT_INDEX_CELL_SIZE * 60. * 1852. );
+    std::vector<RoutePoint *> found;
+    while( 1 ) {
+        GetWaypointsInRadius( lat, lon, radius, found );
+        if( ( found.size() >= k ) || ( radius >= max_radius_meters ) )
+            break;
+        radius = wxMin( max_radius_meters, radius * 4 );
+    }
 
-        double a = lat - pr->m_lat;
-        double b = lon - pr->m_lon;
-        double l = sqrt( ( a * a ) + ( b * b ) );
+    std::vector<std::pair<double, unsigned int> > ranked;
+    for( unsigned int i = 0; i < found.size(); i++ )
+        ranked.push_back( std::make_pair( WaypointDistance( lat, lon, found[i] ), i ) );
+    std::sort( ranked.begin(), ranked.end() );
 
-        if( ( l * 60. * 1852. ) < radius_meters ) if( pr->m_GUID != guid ) return pr;
+    for( unsigned int i = 0; ( i < ranked.size() ) && ( i < k ); i++ )
+        result.push_back( found[ranked[i].second] );
 
-        node = node->GetNext();
+    return result.size();
+}
+
+//      The first waypoint with this name at (within 1e-6 degree of) this position
+RoutePoint *WayPointman::FindWaypointByNameAndPosition( const wxString &name, double lat, double lon )
+{
+    std::vector<RoutePoint *> candidates;
+    GetCandidates( lat, lon, 1.e-6, candidates );
+
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        RoutePoint *pr = candidates[i];
+        if( fabs( lat - pr->m_lat ) < 1.e-6 && fabs( lon - pr->m_lon ) < 1.e-6 ) {
+            if( name == pr->GetName() )
+                return pr;
+        }
     }
     return NULL;
-
 }
 
 void WayPointman::ClearRoutePointFonts( void )
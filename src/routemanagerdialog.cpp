@@ -1457,9 +1457,7 @@ void RouteManagerDialog::OnTrkRightClick( wxListEvent &event )
 
 static bool CompareTracks( Track* track1, Track* track2 )
 {
-    TrackPoint* start1 = track1->GetPoint(0);
-    TrackPoint* start2 = track2->GetPoint(0);
-    return start1->GetCreateTime() < start2->GetCreateTime();
+    return track1->GetPointCreateTime(0) < track2->GetPointCreateTime(0);
 }
 
 void RouteManagerDialog::OnTrkMenuSelected( wxCommandEvent &event )
@@ -1505,6 +1503,7 @@ void RouteManagerDialog::OnTrkMenuSelected( wxCommandEvent &event )
             int pointsBefore = track->GetnPoints();
 
             int reduction = track->Simplify( precision );
+            pConfig->UpdateTrack( track );
             gFrame->Refresh( false );
 
             reduction = 100 * reduction / pointsBefore;
@@ -1542,9 +1541,6 @@ void RouteManagerDialog::OnTrkMenuSelected( wxCommandEvent &event )
         case TRACK_MERGE: {
             Track* targetTrack = NULL;
             Track* mergeTrack = NULL;
-            TrackPoint* tPoint;
-            TrackPoint* newPoint;
-            TrackPoint* lastPoint;
             std::vector<Track*> mergeList;
             std::vector<Track*> deleteList;
             bool runningSkipped = false;
@@ -1561,7 +1557,6 @@ void RouteManagerDialog::OnTrkMenuSelected( wxCommandEvent &event )
             std::sort(mergeList.begin(), mergeList.end(), CompareTracks );
 
             targetTrack = mergeList[ 0 ];
-            lastPoint = targetTrack->GetLastPoint();
 
             for(auto const& mergeTrack: mergeList) {
                 if(mergeTrack == *mergeList.begin())
@@ -1573,15 +1568,11 @@ void RouteManagerDialog::OnTrkMenuSelected( wxCommandEvent &event )
                 }
 
                 for(int i=0; i<mergeTrack->GetnPoints(); i++) {
-                    tPoint = mergeTrack->GetPoint(i);
-                    newPoint = new TrackPoint( tPoint->m_lat, tPoint->m_lon, tPoint->GetCreateTime() );
+                    targetTrack->AddPoint( mergeTrack->GetPointLat(i), mergeTrack->GetPointLon(i),
+                                           mergeTrack->GetPointCreateTime(i) );
 
-                    targetTrack->AddPoint( newPoint );
-
-                    pSelect->AddSelectableTrackSegment( lastPoint->m_lat, lastPoint->m_lon, newPoint->m_lat,
-                            newPoint->m_lon, lastPoint, newPoint, targetTrack );
-
-                    lastPoint = newPoint;
+                    if( targetTrack->GetnPoints() > 1 )
+                        pSelect->AddSelectableTrackSegment( targetTrack, targetTrack->GetnPoints() - 2 );
                 }
                 deleteList.push_back( mergeTrack );
             }
@@ -1733,6 +1724,7 @@ void RouteManagerDialog::OnTrkToggleVisibility( wxMouseEvent &event )
             Track *track = node->GetData();
             if(track){
                 track->SetVisible( !track->IsVisible() );
+                pConfig->UpdateTrack( track );
                 m_pTrkListCtrl->SetItemImage( clicked_index, track->IsVisible() ? 0 : 1 );
             }
         }
@@ -89,7 +89,6 @@ static TexFontCache s_txf[TXF_CACHE];
 
 //    Implement all lists
 #include <wx/listimpl.cpp>
-WX_DEFINE_LIST( TextObjList );
 
 
 //    Implement all arrays
@@ -367,6 +366,8 @@ s52plib::s52plib( const wxString& PLib, bool b_forceLegacy )
     m_bShowS57Text = false;
     m_bShowS57ImportantTextOnly = false;
     m_colortable_index = 0;
+    m_textStatsFrames = 0;
+    m_textStatsFiled = m_textStatsQueries = m_textStatsTests = 0;
 
     _symb_symR = NULL;
     bUseRasterSym = false;
@@ -500,6 +501,85 @@ void s52plib::DestroyLUP( LUPrec *pLUP )
     
     delete pLUP->ATTCArray;
     delete pLUP->INST;
+
+    for( int i = 0; i < pLUP->nATTCCond; i++ ) {
+        free( pLUP->ATTCCond[i].ilist );
+        free( pLUP->ATTCCond[i].sval );
+    }
+    free( pLUP->ATTCCond );
+    pLUP->ATTCCond = NULL;
+    pLUP->nATTCCond = 0;
+}
+
+//      Pack a 6 character S57 attribute acronym into an integer code
+static inline wxUint64 PackAttributeCode( const char *acronym )
+{
+    wxUint64 code = 0;
+    for( int i = 0; i < 6; i++ )
+        code = ( code << 8 ) | (unsigned char) acronym[i];
+    return code;
+}
+
+//      Compile the LUP attribute conditions (e.g. "CATLAM1", "DRVAL1?") into
+//      packed attribute codes and typed values, so that FindBestLUP() need not
+//      convert and parse the ATTCArray strings on every lookup.
+void s52plib::CompileLUPAttributes( LUPrec *pLUP )
+{
+    if( !pLUP->ATTCArray || pLUP->ATTCCond )
+        return;
+
+    int n = pLUP->ATTCArray->GetCount();
+    pLUP->ATTCCond = (LUPAttCond *) calloc( wxMax( n, 1 ), sizeof(LUPAttCond) );
+    pLUP->nATTCCond = n;
+
+    for( int i = 0; i < n; i++ ) {
+        LUPAttCond *pc = &pLUP->ATTCCond[i];
+
+        wxCharBuffer buffer = pLUP->ATTCArray->Item( i ).ToUTF8();
+        const char *slatc = buffer.data();
+        if( !slatc || ( strlen( slatc ) < 6 ) ) {
+            pc->type = LUP_ATTC_INVALID;
+            continue;
+        }
+
+        pc->code = PackAttributeCode( slatc );
+
+        const char *slatv = slatc + 6;
+        if( *slatv == ' ' )
+            pc->type = LUP_ATTC_ANY;               // any object value will match wild card (S52 para 8.3.3.4)
+        else if( *slatv == '?' )
+            pc->type = LUP_ATTC_UNDEFINED;
+        else
+            pc->type = LUP_ATTC_VALUE;
+
+        pc->ival = atoi( slatv );
+        pc->fval = atof( slatv );
+        pc->sval = strdup( slatv );
+
+        //  Comma separated integer list
+        int nlist = 1;
+        for( const char *c = slatv; *c; c++ )
+            if( *c == ',' ) nlist++;
+        pc->ilist = (int *) malloc( nlist * sizeof(int) );
+        const char *c = slatv;
+        while( *c && ( pc->nilist < nlist ) ) {
+            pc->ilist[pc->nilist++] = atoi( c );
+            c = strchr( c, ',' );
+            if( !c ) break;
+            c++;
+        }
+    }
+}
+
+void s52plib::CompileLUPArrays( void )
+{
+    LUPArrayContainer *lacs[] = { line_LAC, areaPlain_LAC, areaSymbol_LAC, pointSimple_LAC, pointPaper_LAC };
+
+    for( unsigned int il = 0; il < sizeof( lacs ) / sizeof( lacs[0] ); il++ ) {
+        wxArrayOfLUPrec *pa = lacs[il]->GetLUPArray();
+        for( unsigned int i = 0; i < pa->GetCount(); i++ )
+            CompileLUPAttributes( pa->Item( i ) );
+    }
 }
 
 void s52plib::DestroyRulesChain( Rules *top )
@@ -737,159 +817,104 @@ LUPrec *s52plib::FindBestLUP( wxArrayOfLUPrec *LUPArray, unsigned int startIndex
     LUPrec *LUP = LUPArray->Item( startIndex );
 
     int nATTMatch = 0;
-    int countATT = 0;
     bool bmatch_found = false;
 
     if( pObj->att_array == NULL )
         goto check_LUP;       // object has no attributes to compare, so return "best" LUP
-        
-    for( unsigned int i = 0; i < count; ++i ) {
-        LUPrec *LUPCandidate = LUPArray->Item( startIndex + i );
-        
-        if( !LUPCandidate->ATTCArray )
-            continue;        // this LUP has no attributes coded
 
-        countATT = 0;
-        char *currATT = pObj->att_array;
-        int attIdx = 0;
+    {
+        //  Index the object attribute acronyms the same way as the compiled LUP conditions
+        wxUint64 obj_codes_static[32];
+        std::vector<wxUint64> obj_codes_dyn;
+        wxUint64 *obj_codes = obj_codes_static;
+        if( pObj->n_attr > 32 ) {
+            obj_codes_dyn.resize( pObj->n_attr );
+            obj_codes = &obj_codes_dyn[0];
+        }
+        for( int iatt = 0; iatt < pObj->n_attr; iatt++ )
+            obj_codes[iatt] = PackAttributeCode( pObj->att_array + ( 6 * iatt ) );
 
-        for( unsigned int iLUPAtt = 0; iLUPAtt < LUPCandidate->ATTCArray->GetCount(); iLUPAtt++ ) {
+        for( unsigned int i = 0; i < count; ++i ) {
+            LUPrec *LUPCandidate = LUPArray->Item( startIndex + i );
 
-            // Get the LUP attribute name
-            wxString LATTC = LUPCandidate->ATTCArray->Item( iLUPAtt );
-            char *slatc = NULL;
-            wxCharBuffer buffer=LATTC.ToUTF8();
-            slatc = buffer.data();
-            //  Get the LUP attribute value as a string
-                        
-            if( slatc && (strlen(slatc) < 6) )
-                goto next_LUP_Attr;         // LUP attribute value not UTF8 convertible (never seen in PLIB 3.x)
+            if( !LUPCandidate->ATTCArray )
+                continue;        // this LUP has no attributes coded
+
+            if( !LUPCandidate->ATTCCond )
+                CompileLUPAttributes( LUPCandidate );
+
+            //       According to S52 specs, match must be perfect,
+            //         and the first 100% match is selected
+            int nattrs_on_candidate = LUPCandidate->nATTCCond;
+            bool bcandidate_match = ( nattrs_on_candidate > 0 );
+
+            for( int iLUPAtt = 0; bcandidate_match && ( iLUPAtt < nattrs_on_candidate ); iLUPAtt++ ) {
+                const LUPAttCond *pc = &LUPCandidate->ATTCCond[iLUPAtt];
+
+                bool attValMatch = false;
+
+                //  ANY matches on attribute name alone, UNDEFINED is never counted
+                //TODO  Find an ENC with "UNKNOWN" DRVAL1 or DRVAL2 and debug the UNDEFINED case
+                if( ( pc->type == LUP_ATTC_ANY ) || ( pc->type == LUP_ATTC_VALUE ) ) {
+                    int attIdx = 0;
+                    while( ( attIdx < pObj->n_attr ) && ( obj_codes[attIdx] != pc->code ) )
+                        attIdx++;
 
-            if( slatc ){
-                char *slatv = slatc + 6;
-                while( attIdx < pObj->n_attr ) {
-                    if( 0 == strncmp( slatc, currATT, 6 ) ) {
+                    if( attIdx < pObj->n_attr ) {
                         //OK we have an attribute name match
-                        
-                        
-                        bool attValMatch = false;
-                        
-                        // special case (i)
-                        if( !strncmp( slatv, " ", 1 ) ) {        // any object value will match wild card (S52 para 8.3.3.4)
-                            ++countATT;
-                            goto next_LUP_Attr;
-                        }
-                        
-                        // special case (ii)
-                        //TODO  Find an ENC with "UNKNOWN" DRVAL1 or DRVAL2 and debug this code
-                        if( !strncmp( slatv, "?", 1) ){          // if LUP attribute value is "undefined"
+                        if( pc->type == LUP_ATTC_ANY )
+                            attValMatch = true;
+                        else {
+                            //checking against object attribute value
+                            S57attVal *v = ( pObj->attVal->Item( attIdx ) );
+
+                            switch( v->valType ){
+                                case OGR_INT: // S57 attribute type 'E' enumerated, 'I' integer
+                                    attValMatch = ( pc->ival == v->value.integer );
+                                    break;
+
+                                case OGR_INT_LST: // S57 attribute type 'L' list: comma separated integer
+                                {
+                                    int *b = (int*) v->value.ptr;
+                                    attValMatch = ( pc->nilist > 0 );
+                                    for( int il = 0; attValMatch && ( il < pc->nilist ); il++ )
+                                        attValMatch = ( pc->ilist[il] == b[il] );
+                                    break;
+                                }
 
-                        //  Match if the object does NOT contain this attribute
-                            goto next_LUP_Attr;
-                        }
-                        
-                        
-                        //checking against object attribute value
-                        S57attVal *v = ( pObj->attVal->Item( attIdx ) );
-                        
-                        switch( v->valType ){
-                            case OGR_INT: // S57 attribute type 'E' enumerated, 'I' integer
-                            {
-                                int LUP_att_val = atoi( slatv );
-                                if( LUP_att_val == v->value.integer )
-                                    attValMatch = true;
-                                break;
-                            }
-                            
-                            case OGR_INT_LST: // S57 attribute type 'L' list: comma separated integer
-                            {
-                                int a;
-                                char ss[41];
-                                strncpy( ss, slatv, 39 );
-                                ss[40] = '\0';
-                                char *s = &ss[0];
-
-                                int *b = (int*) v->value.ptr;
-                                sscanf( s, "%d", &a );
-                                
-                                while( *s != '\0' ) {
-                                    if( a == *b ) {
-                                        sscanf( ++s, "%d", &a );
-                                        b++;
-                                        attValMatch = true;
-                                        
-                                    } else
-                                        attValMatch = false;
+                                case OGR_REAL: // S57 attribute type'F' float
+                                {
+                                    double obj_val = *(double*) ( v->value.ptr );
+                                    attValMatch = ( obj_val == pc->fval );
+                                    break;
                                 }
-                                break;
-                            }
-                            case OGR_REAL: // S57 attribute type'F' float
-                            {
-                                double obj_val = *(double*) ( v->value.ptr );
-                                float att_val = atof( slatv );
-                                if( fabs( obj_val - att_val ) < 1e-6 )
-                                    if( obj_val == att_val  )
-                                        attValMatch = true;
-                                break;
-                            }
-                            
 
-                            case OGR_CONST_STR:
-                            case OGR_STR: // S57 attribute type'A' code string, 'S' free text
-                            {
-                                //    Strings must be exact match
-                                //    n.b. OGR_STR is used for S-57 attribute type 'L', comma-separated list
-                                
-                                //wxString cs( (char *) v->value, wxConvUTF8 ); // Attribute from object
-                                //if( LATTC.Mid( 6 ) == cs )
-                                if( !strcmp((char *) v->value.ptr, slatv))
-                                    attValMatch = true;
-                                break;
-                            }
-                            
-                            default:
-                                break;
-                        } //switch
-                        
-                        // value match
-                        if( attValMatch )
-                            ++countATT;
-                                                
-                        goto next_LUP_Attr;
-                    } // if attribute name match
-                    
-                    //  Advance to the next S57obj attribute
-                    currATT += 6;
-                    ++attIdx;
-                    
-                } //while
-            } //if
-            
-next_LUP_Attr:
-         
-            currATT = pObj->att_array; // restart the object attribute list
-            attIdx = 0;
-        } // for iLUPAtt
-        
-        //      Create a "match score", defined as fraction of candidate LUP attributes
-        //      actually matched by feature.
-        //      Used later for resolving "ties"
-        
-        int nattr_matching_on_candidate = countATT;
-        int nattrs_on_candidate = LUPCandidate->ATTCArray->GetCount();
-        double candidate_score = ( 1. * nattr_matching_on_candidate )
-        / ( 1. * nattrs_on_candidate );
-        
-        //       According to S52 specs, match must be perfect,
-        //         and the first 100% match is selected
-        if( candidate_score == 1.0 ) {
-            LUP = LUPCandidate;
-            bmatch_found = true;
-            break; // selects the first 100% match
-        }
-        
-    } //for loop
-    
+                                case OGR_CONST_STR:
+                                case OGR_STR: // S57 attribute type'A' code string, 'S' free text
+                                    //    Strings must be exact match
+                                    //    n.b. OGR_STR is used for S-57 attribute type 'L', comma-separated list
+                                    attValMatch = !strcmp( (char *) v->value.ptr, pc->sval );
+                                    break;
+
+                                default:
+                                    break;
+                            } //switch
+                        }
+                    }
+                }
+
+                if( !attValMatch )
+                    bcandidate_match = false;
+            } // for iLUPAtt
+
+            if( bcandidate_match ) {
+                LUP = LUPCandidate;
+                bmatch_found = true;
+                break; // selects the first 100% match
+            }
+
+        } //for loop
+    }
 
 check_LUP:
 //  In strict mode, we require at least one attribute to match exactly
@@ -1170,6 +1195,9 @@ int s52plib::S52_load_Plib( const wxString& PLib, bool b_forceLegacy )
 
     PreloadOBJLFromCSV( oc_file );
 
+    //  Compile the LUP attribute conditions once, for fast lookup
+    CompileLUPArrays();
+
     return 1;
 }
 
@@ -2292,23 +2320,125 @@ bool s52plib::RenderText( wxDC *pdc, S52_TextC *ptext, int x, int y, wxRect *pRe
 
 
 
-//    Return true if test_rect overlaps any rect in the current text rectangle list, except itself
-bool s52plib::CheckTextRectList( const wxRect &test_rect, S52_TextC *ptext )
+//-----------------------------------------------------------------------------
+//    S52TextGrid implementation
+//-----------------------------------------------------------------------------
+
+#define TEXT_GRID_CELL_SIZE 64              // pixels
+
+S52TextGrid::S52TextGrid()
+{
+    m_origin_x = m_origin_y = 0;
+    m_nQueries = m_nTests = 0;
+}
+
+void S52TextGrid::Clear()
+{
+    m_cells.clear();
+    m_filed.clear();
+    m_origin_x = m_origin_y = 0;
+    m_nQueries = m_nTests = 0;
+}
+
+void S52TextGrid::CellRange( const wxRect &rect, int &x0, int &y0, int &x1, int &y1 ) const
+{
+    //  Cells are fixed relative to the grid origin, which moves with AdjustTextList()
+    x0 = (int) floor( (double) ( rect.x - m_origin_x ) / TEXT_GRID_CELL_SIZE );
+    y0 = (int) floor( (double) ( rect.y - m_origin_y ) / TEXT_GRID_CELL_SIZE );
+    x1 = (int) floor( (double) ( rect.x + rect.width - 1 - m_origin_x ) / TEXT_GRID_CELL_SIZE );
+    y1 = (int) floor( (double) ( rect.y + rect.height - 1 - m_origin_y ) / TEXT_GRID_CELL_SIZE );
+    x1 = wxMax( x0, x1 );
+    y1 = wxMax( y0, y1 );
+}
+
+void S52TextGrid::Remove( S52_TextC *ptext, const wxRect &rect )
+{
+    int x0, y0, x1, y1;
+    CellRange( rect, x0, y0, x1, y1 );
+    for( int cy = y0; cy <= y1; cy++ ) {
+        for( int cx = x0; cx <= x1; cx++ ) {
+            std::unordered_map<wxInt64, std::vector<S52_TextC *> >::iterator it = m_cells.find( CellKey( cx, cy ) );
+            if( it == m_cells.end() ) continue;
+            std::vector<S52_TextC *> &cell = it->second;
+            for( unsigned int i = 0; i < cell.size(); i++ ) {
+                if( cell[i] == ptext ) {
+                    cell[i] = cell.back();
+                    cell.pop_back();
+                    break;
+                }
+            }
+            if( cell.empty() ) m_cells.erase( it );
+        }
+    }
+}
+
+void S52TextGrid::Add( S52_TextC *ptext )
 {
-    //    Iterate over the current object list, looking at rText
+    std::unordered_map<S52_TextC *, wxRect>::iterator it = m_filed.find( ptext );
+    if( it != m_filed.end() ) {
+        if( it->second == ptext->rText ) return;
+        Remove( ptext, it->second );
+        m_filed.erase( it );
+    }
+
+    int x0, y0, x1, y1;
+    CellRange( ptext->rText, x0, y0, x1, y1 );
+    for( int cy = y0; cy <= y1; cy++ )
+        for( int cx = x0; cx <= x1; cx++ )
+            m_cells[CellKey( cx, cy )].push_back( ptext );
 
-    for( TextObjList::Node *node = m_textObjList.GetFirst(); node; node = node->GetNext() ) {
-        wxRect *pcurrent_rect = &( node->GetData()->rText );
+    m_filed[ptext] = ptext->rText;
+}
 
-        if( pcurrent_rect->Intersects( test_rect ) ) {
-            if( node->GetData() != ptext )
-                return true;
+//    Return true if test_rect overlaps any filed text rect, except that of pexclude
+bool S52TextGrid::Intersects( const wxRect &test_rect, const S52_TextC *pexclude )
+{
+    m_nQueries++;
 
+    int x0, y0, x1, y1;
+    CellRange( test_rect, x0, y0, x1, y1 );
+    for( int cy = y0; cy <= y1; cy++ ) {
+        for( int cx = x0; cx <= x1; cx++ ) {
+            std::unordered_map<wxInt64, std::vector<S52_TextC *> >::const_iterator it = m_cells.find( CellKey( cx, cy ) );
+            if( it == m_cells.end() ) continue;
+            const std::vector<S52_TextC *> &cell = it->second;
+            for( unsigned int i = 0; i < cell.size(); i++ ) {
+                m_nTests++;
+                if( cell[i] != pexclude && cell[i]->rText.Intersects( test_rect ) )
+                    return true;
+            }
         }
     }
     return false;
 }
 
+//    Apply a pan offset to all filed rects, dropping those which leave the screen.
+//    The grid origin moves with the rects, so nothing needs to be rehashed.
+void S52TextGrid::Offset( int dx, int dy, const wxRect &rScreen )
+{
+    m_origin_x += dx;
+    m_origin_y += dy;
+
+    std::vector<S52_TextC *> gone;
+    for( std::unordered_map<S52_TextC *, wxRect>::iterator it = m_filed.begin(); it != m_filed.end(); ++it ) {
+        it->first->rText.Offset( dx, dy );
+        it->second.Offset( dx, dy );
+        if( !it->second.Intersects( rScreen ) ) gone.push_back( it->first );
+    }
+
+    for( unsigned int i = 0; i < gone.size(); i++ ) {
+        Remove( gone[i], m_filed[gone[i]] );
+        m_filed.erase( gone[i] );
+    }
+}
+
+
+//    Return true if test_rect overlaps any rect in the current text rectangle list, except itself
+bool s52plib::CheckTextRectList( const wxRect &test_rect, S52_TextC *ptext )
+{
+    return m_textGrid.Intersects( test_rect, ptext );
+}
+
 bool s52plib::TextRenderCheck( ObjRazRules *rzRules )
 {
     if( !m_bShowS57Text ) return false;
@@ -2474,7 +2604,6 @@ int s52plib::RenderT_All( ObjRazRules *rzRules, Rules *rules, ViewPort *vp, bool
         //  text renders in its rule set.  RDOCAL is one example.  There are others
         //  We need to cache only the first text structure, but should update the render rectangle
         //  to reflect all texts rendered for this object,  in order to process the declutter logic.
-        bool b_dupok = false;
         if( b_free_text ) {
             delete text;
         
@@ -2487,30 +2616,17 @@ int s52plib::RenderT_All( ObjRazRules *rzRules, Rules *rules, ViewPort *vp, bool
                 wxRect r0 = text->rText;
                 r0 = r0.Union(rect);
                 text->rText = r0;
-            
-                b_dupok = true;                 // OK to add a duplicate text structure to the declutter list, just for this case.
             }
         }
         else
             text->rText = rect;
         
         
-        //      If this text was actually drawn, add a pointer to its rect to the de-clutter list if it doesn't already exist
+        //      If this text was actually drawn, add it to the de-clutter grid.
+        //      A text already in the grid is refiled, since its rect may just have changed.
         if( m_bDeClutterText ) {
-            if( bwas_drawn ) {
-                bool b_found = false;
-                for( TextObjList::Node *node = m_textObjList.GetFirst(); node; node =  node->GetNext() ) {
-                    S52_TextC *oc = node->GetData();
-
-                    if( oc == text ) {
-                        if(!b_dupok)
-                            b_found = true;
-                        break;
-                    }
-                }
-                if( !b_found )
-                    m_textObjList.Append( text );
-            }
+            if( bwas_drawn || m_textGrid.Contains( text ) )
+                m_textGrid.Add( text );
         }
 
         //  Update the object Bounding box
@@ -8948,8 +9064,25 @@ void s52plib::PrepareForRender()
 
 void s52plib::ClearTextList( void )
 {
+    //      Accumulate the declutter counts of the frame, and log them now and then
+    if( m_textGrid.GetQueryCount() ) {
+        m_textStatsFrames++;
+        m_textStatsFiled += m_textGrid.GetCount();
+        m_textStatsQueries += m_textGrid.GetQueryCount();
+        m_textStatsTests += m_textGrid.GetTestCount();
+    }
+    if( m_textStatsSW.Time() > 600000 ) {
+        if( m_textStatsFrames )
+            wxLogMessage( _T("S52 text declutter: %ld frames, %.0f texts drawn, %.0f queries, %.0f rect tests (%.1f per query)"),
+                          m_textStatsFrames, m_textStatsFiled, m_textStatsQueries, m_textStatsTests,
+                          m_textStatsTests / m_textStatsQueries );
+        m_textStatsFrames = 0;
+        m_textStatsFiled = m_textStatsQueries = m_textStatsTests = 0;
+        m_textStatsSW.Start();
+    }
+
     //      Clear the current text rectangle list
-    m_textObjList.Clear();
+    m_textGrid.Clear();
 
 }
 
@@ -8964,21 +9097,9 @@ void s52plib::AdjustTextList( int dx, int dy, int screenw, int screenh )
 {
     return;
     wxRect rScreen( 0, 0, screenw, screenh );
-    //    Iterate over the text rectangle list
-    //        1.  Apply the specified offset to the list elements
-    //        2.. Remove any list elements that are off screen after applied offset
-
-    TextObjList::Node *node = m_textObjList.GetFirst();
-    TextObjList::Node *next;
-    while( node ) {
-        next = node->GetNext();
-        wxRect *pcurrent = &( node->GetData()->rText );
-        pcurrent->Offset( dx, dy );
-        if( !pcurrent->Intersects( rScreen ) ) {
-            m_textObjList.DeleteNode( node );
-        }
-        node = next;
-    }
+    //    Apply the specified offset to the text rectangles,
+    //    removing any that are off screen after applied offset
+    m_textGrid.Offset( dx, dy, rScreen );
 }
 
 bool s52plib::GetPointPixArray( ObjRazRules *rzRules, wxPoint2DDouble* pd, wxPoint *pp, int nv, ViewPort *vp )
@@ -60,6 +60,7 @@
 #include "pluginmanager.h"                      // for S57 lights overlay
 
 #include "Osenc.h"
+#include "SENCBuildScheduler.h"
 
 #ifdef __MSVC__
 #define _CRTDBG_MAP_ALLOC
@@ -110,6 +111,7 @@ extern MyFrame*          gFrame;
 extern PlugInManager     *g_pi_manager;
 extern bool              g_b_overzoom_x;
 extern bool              g_b_EnableVBO;
+extern SENCBuildScheduler *g_pSENCBuildScheduler;
 
 int                      g_SENC_LOD_pixels;
 
@@ -263,6 +265,8 @@ s57chart::s57chart()
     m_next_safe_cnt = 1e6;
     m_LineVBO_name = -1;
     m_line_vertex_buffer = 0;
+    m_element_arena = NULL;
+    m_point_arena = NULL;
     m_this_chart_context =  0;
     m_Chart_Skew = 0;
 
@@ -292,30 +296,36 @@ s57chart::~s57chart()
     for (unsigned i=0; i<m_pcs_vector.size(); i++)
         delete m_pcs_vector.at(i);
  
-    for (unsigned i=0; i<m_pve_vector.size(); i++)
-        delete m_pve_vector.at(i);
-    
-    m_pcs_vector.clear();
-    m_pve_vector.clear();
-
-    for( VE_Hash::iterator it = m_ve_hash.begin(); it != m_ve_hash.end(); ++it ) {
-        VE_Element *pedge = it->second;
-        if(pedge){
-            free(pedge->pPoints);
-            delete pedge;
+    //  Edge and connected node elements live in the arenas, if there are any
+    if( !m_element_arena ) {
+        for (unsigned i=0; i<m_pve_vector.size(); i++)
+            delete m_pve_vector.at(i);
+
+        for( VE_Hash::iterator it = m_ve_hash.begin(); it != m_ve_hash.end(); ++it ) {
+            VE_Element *pedge = it->second;
+            if(pedge){
+                free(pedge->pPoints);
+                delete pedge;
+            }
         }
-    }
-    m_ve_hash.clear();
 
-    for( VC_Hash::iterator itc = m_vc_hash.begin(); itc != m_vc_hash.end(); ++itc ) {
-        VC_Element *pcs = itc->second;
-        if(pcs) {
-            free(pcs->pPoint);
-            delete pcs;
+        for( VC_Hash::iterator itc = m_vc_hash.begin(); itc != m_vc_hash.end(); ++itc ) {
+            VC_Element *pcs = itc->second;
+            if(pcs) {
+                free(pcs->pPoint);
+                delete pcs;
+            }
         }
     }
+    
+    m_pcs_vector.clear();
+    m_pve_vector.clear();
+    m_ve_hash.clear();
     m_vc_hash.clear();
 
+    delete m_point_arena;
+    delete m_element_arena;
+
 #ifdef ocpnUSE_GL
     if(s_glDeleteBuffers && (m_LineVBO_name > 0))
         s_glDeleteBuffers(1, (GLuint *)&m_LineVBO_name);
@@ -459,6 +469,16 @@ static void free_mps(mps_container *mps)
     free( mps );
 }
 
+//  Objects ingested into a chart's element arena are destroyed in place,
+//  their storage is released with the arena
+static void DestroyS57Obj( S57Obj *obj )
+{
+    if( obj->m_arena )
+        obj->~S57Obj();
+    else
+        delete obj;
+}
+
 void s57chart::FreeObjectsAndRules()
 {
 //      Delete the created ObjRazRules, including the S57Objs
@@ -475,12 +495,12 @@ void s57chart::FreeObjectsAndRules()
             while( top != NULL ) {
                 top->obj->nRef--;
                 if( 0 == top->obj->nRef )
-                    delete top->obj;
+                    DestroyS57Obj( top->obj );
 
                 if( top->child ) {
                     ObjRazRules *ctop = top->child;
                     while( ctop ) {
-                        delete ctop->obj;
+                        DestroyS57Obj( ctop->obj );
 
                         if( ps52plib ) ps52plib->DestroyLUP( ctop->LUP );
                         delete ctop->LUP;
@@ -1360,7 +1380,10 @@ void s57chart::AssembleLineGeometry( void )
         VE_Element *pedge = it->second;
         if(pedge){
             m_pve_vector.push_back(pedge);
-            free(pedge->pPoints);
+            if(m_point_arena)
+                pedge->pPoints = NULL;
+            else
+                free(pedge->pPoints);
         }
     }
     m_ve_hash.clear();
@@ -1369,14 +1392,20 @@ void s57chart::AssembleLineGeometry( void )
     // and we can empty the connector hashmap,
     // and at the same time free up the point storage in the VC_Elements, since all the points
     // are now in the VBO buffer
-    for( VC_Hash::iterator itc = m_vc_hash.begin(); itc != m_vc_hash.end(); ++itc ) {
-        VC_Element *pcs = itc->second;
-        if(pcs)
-            free(pcs->pPoint);
-        delete pcs;
+    if( !m_point_arena ) {
+        for( VC_Hash::iterator itc = m_vc_hash.begin(); itc != m_vc_hash.end(); ++itc ) {
+            VC_Element *pcs = itc->second;
+            if(pcs)
+                free(pcs->pPoint);
+            delete pcs;
+        }
     }
     m_vc_hash.clear();
 
+    //  Points ingested from the SENC, and the VC_Elements, go in one piece
+    delete m_point_arena;
+    m_point_arena = NULL;
+
 
 
 
@@ -2402,13 +2431,19 @@ InitReturn s57chart::Init( const wxString& name, ChartInitFlag flags )
     if( ext == _T("000") ) {
         if( m_bbase_file_attr_known ) {
 
-            int sret = FindOrCreateSenc( m_FullPath );
-            if( sret != BUILD_SENC_OK ) {
-                if( sret == BUILD_SENC_NOK_RETRY ) ret_value = INIT_FAIL_RETRY;
-                else
-                    ret_value = INIT_FAIL_REMOVE;
-            } else
-                ret_value = PostInit( flags, m_global_color_scheme );
+            //  If the SENC is being rebuilt in the background, don't wait for it here.
+            //  Other charts stand in until the scheduler reports the cell ready.
+            if( g_pSENCBuildScheduler && g_pSENCBuildScheduler->IsBuilding( m_FullPath ) )
+                ret_value = INIT_FAIL_NOERROR;
+            else {
+                int sret = FindOrCreateSenc( m_FullPath );
+                if( sret != BUILD_SENC_OK ) {
+                    if( sret == BUILD_SENC_NOK_RETRY ) ret_value = INIT_FAIL_RETRY;
+                    else
+                        ret_value = INIT_FAIL_REMOVE;
+                } else
+                    ret_value = PostInit( flags, m_global_color_scheme );
+            }
 
         }
 
@@ -2461,11 +2496,40 @@ wxString s57chart::buildSENCName( const wxString& name)
     return tsfn.GetFullPath();
 }
 
+//      Thumbnails live in the global SENC directory, named for the cell
+wxString s57chart::buildThumbnailName( const wxString& SENCFileName )
+{
+    wxString SENCdir = g_SENCPrefix;
+    if( SENCdir.Last() != wxFileName::GetPathSeparator() )
+        SENCdir.Append( wxFileName::GetPathSeparator() );
+
+    wxFileName s57File( SENCFileName );
+    wxFileName ThumbFileName( SENCdir, s57File.GetName().Mid( 13 ), _T("BMP") );
+
+    return ThumbFileName.GetFullPath();
+}
+
 //-----------------------------------------------------------------------------------------------
 //    Find or Create a relevent SENC file from a given .000 ENC file
 //    Returns with error code, and associated SENC file name in m_S57FileName
 //-----------------------------------------------------------------------------------------------
 InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
+{
+    bool bbuild_new_senc;
+    InitReturn ret = CheckSenc( name, bbuild_new_senc );
+    if( ret != INIT_OK )
+        return ret;
+
+    if( bbuild_new_senc )
+        return RebuildSenc( b_progress );
+
+    return INIT_OK;
+}
+
+//-----------------------------------------------------------------------------------------------
+//    Look for the SENC of a given .000 ENC file, and decide whether it must be (re)built
+//-----------------------------------------------------------------------------------------------
+InitReturn s57chart::CheckSenc( const wxString& name, bool &bbuild_new_senc )
 {
     //  This method may be called for a compressed .000 cell, so check and decompress if necessary
     wxString ext;
@@ -2496,9 +2560,7 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
     //      Establish location for SENC files
     m_SENCFileName = buildSENCName( name );
     
-    int build_ret_val = 1;
-
-    bool bbuild_new_senc = false;
+    bbuild_new_senc = false;
     m_bneed_new_thumbnail = false;
 
     wxFileName FileName000( m_TempFilePath );
@@ -2615,14 +2677,19 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
         }
     }
 
-    if( bbuild_new_senc ) {
-        m_bneed_new_thumbnail = true; // force a new thumbnail to be built in PostInit()
-        build_ret_val = BuildSENCFile( m_TempFilePath, m_SENCFileName, b_progress );
-        if( BUILD_SENC_NOK_PERMANENT == build_ret_val ) 
-            return INIT_FAIL_REMOVE;
-        if( BUILD_SENC_NOK_RETRY == build_ret_val )
-            return INIT_FAIL_RETRY;
-    }
+    return INIT_OK;
+}
+
+//  Builds the SENC that CheckSenc() found missing or out of date.
+//  Builds off the main thread must pass a registrar of their own.
+InitReturn s57chart::RebuildSenc( bool b_progress, S57ClassRegistrar *poRegistrar )
+{
+    m_bneed_new_thumbnail = true; // force a new thumbnail to be built in PostInit()
+    int build_ret_val = BuildSENCFile( m_TempFilePath, m_SENCFileName, b_progress, poRegistrar );
+    if( BUILD_SENC_NOK_PERMANENT == build_ret_val ) 
+        return INIT_FAIL_REMOVE;
+    if( BUILD_SENC_NOK_RETRY == build_ret_val )
+        return INIT_FAIL_RETRY;
 
     return INIT_OK;
 }
@@ -2642,12 +2709,7 @@ InitReturn s57chart::PostInit( ChartInitFlag flags, ColorScheme cs )
 //      Check for and if necessary rebuild Thumbnail
 //      Going to be in the global (user) SENC file directory
 #if 1
-    wxString SENCdir = g_SENCPrefix;
-    if( SENCdir.Last() != wxFileName::GetPathSeparator() )
-        SENCdir.Append( wxFileName::GetPathSeparator() );
-    
-    wxFileName s57File(m_SENCFileName);
-    wxFileName ThumbFileName( SENCdir, s57File.GetName().Mid( 13 ), _T("BMP") );
+    wxFileName ThumbFileName( buildThumbnailName( m_SENCFileName ) );
 
     if( !ThumbFileName.FileExists() || m_bneed_new_thumbnail )
     {
@@ -4280,9 +4342,14 @@ bool s57chart::GetBaseFileAttr( const wxString& file000 )
     return true;
 }
 
-int s57chart::BuildSENCFile( const wxString& FullPath000, const wxString& SENCFileName, bool b_progress )
+int s57chart::BuildSENCFile( const wxString& FullPath000, const wxString& SENCFileName, bool b_progress,
+                             S57ClassRegistrar *poRegistrar )
 {
-    OCPNPlatform::ShowBusySpinner();
+    //  May be called from the background SENC builders, each with its own registrar,
+    //  as the registrar keeps the selected class in the object
+    bool b_main = wxThread::IsMain();
+    if( b_main )
+        OCPNPlatform::ShowBusySpinner();
     
     //  LOD calculation
     double display_ppm = 1 / .00025;     // nominal for most LCD displays
@@ -4295,13 +4362,14 @@ int s57chart::BuildSENCFile( const wxString& FullPath000, const wxString& SENCFi
     
     Osenc senc;
 
-    senc.setRegistrar( g_poRegistrar );
+    senc.setRegistrar( poRegistrar ? poRegistrar : g_poRegistrar );
     senc.setRefLocn(ref_lat, ref_lon);
     senc.SetLODMeters(m_LOD_meters);
 
     int ret = senc.createSenc200( FullPath000, SENCFileName, b_progress );
 
-    OCPNPlatform::HideBusySpinner();
+    if( b_main )
+        OCPNPlatform::HideBusySpinner();
     
     if(ret == ERROR_INGESTING000)
         return BUILD_SENC_NOK_PERMANENT;
@@ -4326,7 +4394,12 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
 
     sencfile.setRefLocn(ref_lat, ref_lon);
 
-    int srv = sencfile.ingest200(FullPath, &Objects, &VEs, &VCs);
+    if( !m_element_arena )
+        m_element_arena = new OsencArena;
+    if( !m_point_arena )
+        m_point_arena = new OsencArena;
+
+    int srv = sencfile.ingest200(FullPath, &Objects, &VEs, &VCs, m_element_arena, m_point_arena);
 
     if(srv != SENC_NO_ERROR){
         wxLogMessage( sencfile.getLastError() );
@@ -4357,7 +4430,8 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
     for( int i = 0; i < n_ve_elements; i++ ) {
 
         VE_Element *vep = VEs.at( i );
-        if(vep && vep->nCount){
+        //  Current SENCs carry the bounding box of each edge
+        if(vep && vep->nCount && !vep->edgeBBox.GetValid()){
             //  Get a bounding box for the edge
             double east_max = -1e7; double east_min = 1e7;
             double north_max = -1e7; double north_min = 1e7;
@@ -4450,7 +4524,7 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
                 msg.Prepend( _T("   Could not find LUP for ") );
                 LogMessageOnce( msg );
             }
-            delete obj;
+            DestroyS57Obj( obj );
             obj = NULL;
             Objects[i] = NULL;
         } else {
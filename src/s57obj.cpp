@@ -107,16 +107,20 @@ S57Obj::~S57Obj()
     //  Don't delete any allocated records of simple copy clones
     if( !bIsClone ) {
         if( attVal ) {
-            for( unsigned int iv = 0; iv < attVal->GetCount(); iv++ ) {
-                S57attVal *vv = attVal->Item( iv );
-                void *v2 = vv->value.ptr;
-                if (vv->valType != OGR_INT && vv->valType != OGR_CONST_STR)
-                    free( v2 );
-                delete vv;
+            //  Attribute records and values in the arena are released along with it
+            if( !m_arena ) {
+                for( unsigned int iv = 0; iv < attVal->GetCount(); iv++ ) {
+                    S57attVal *vv = attVal->Item( iv );
+                    void *v2 = vv->value.ptr;
+                    if (vv->valType != OGR_INT && vv->valType != OGR_CONST_STR)
+                        free( v2 );
+                    delete vv;
+                }
             }
             delete attVal;
         }
-        free( att_array );
+        if( !m_arena )
+            free( att_array );
 
         if( pPolyTessGeo ) {
 #ifdef ocpnUSE_GL
@@ -169,6 +173,7 @@ void S57Obj::Init()
     bIsClone = false;
     Scamin = 10000000;                              // ten million enough?
     nRef = 0;
+    m_arena = NULL;
 
     bIsAton = false;
     bIsAssociable = false;
@@ -211,16 +216,50 @@ S57Obj::S57Obj( const char* featureName )
 }
 
 
+//  Attribute records and values come from the arena, if this object has one.
+//  Otherwise they come from the heap, and are freed one by one in the dtor.
+S57attVal *S57Obj::NewAttValue()
+{
+    if( m_arena )
+        return (S57attVal *)m_arena->Alloc( sizeof(S57attVal) );
+    return new S57attVal;
+}
+
+void *S57Obj::AllocAttribute( size_t size )
+{
+    if( m_arena )
+        return m_arena->Alloc( size );
+    return malloc( size );
+}
+
+void S57Obj::AddAttributeAcronym( const char *acronym )
+{
+    if( m_arena ) {
+        //  Arena storage cannot be realloc'd, so grow the acronym array by doubling,
+        //  at each power of two, leaving the abandoned copy to be released with the arena
+        if( n_attr == 0 || ( n_attr >= 4 && !( n_attr & ( n_attr - 1 ) ) ) ) {
+            int n_alloc = wxMax( 4, 2 * n_attr );
+            char *pnew = (char *)m_arena->Alloc( 6 * n_alloc );
+            if( n_attr )
+                memcpy( pnew, att_array, 6 * n_attr );
+            att_array = pnew;
+        }
+    }
+    else
+        att_array = (char *)realloc(att_array, 6*(n_attr + 1));
+
+    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
+    n_attr++;
+}
+
 bool S57Obj::AddIntegerAttribute( const char *acronym, int val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = NewAttValue();
 
     pattValTmp->valType = OGR_INT;
     pattValTmp->value.integer = val;
 
-    att_array = (char *)realloc(att_array, 6*(n_attr + 1));
-    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
-    n_attr++;
+    AddAttributeAcronym( acronym );
 
     attVal->Add( pattValTmp );
 
@@ -237,17 +276,15 @@ bool S57Obj::AddIntegerListAttribute( const char *acronym, int *pval, int nValue
 
 bool S57Obj::AddDoubleAttribute( const char *acronym, double val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = NewAttValue();
 
-    double *pAVI = (double *) malloc( sizeof(double) );         //new double;
+    double *pAVI = (double *)AllocAttribute( sizeof(double) );  //new double;
     *pAVI = val;
 
     pattValTmp->valType = OGR_REAL;
     pattValTmp->value.ptr = pAVI;
 
-    att_array = (char *)realloc(att_array, 6*(n_attr + 1));
-    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
-    n_attr++;
+    AddAttributeAcronym( acronym );
 
     attVal->Add( pattValTmp );
 
@@ -261,17 +298,15 @@ bool S57Obj::AddDoubleListAttribute( const char *acronym, double *pval, int nVal
 
 bool S57Obj::AddStringAttribute( const char *acronym, char *val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = NewAttValue();
 
-    char *pAVS = (char *)malloc(strlen(val) + 1);   //new string
+    char *pAVS = (char *)AllocAttribute( strlen(val) + 1 );    //new string
     strcpy(pAVS, val);
 
     pattValTmp->valType = OGR_STR;
     pattValTmp->value.ptr = pAVS;
 
-    att_array = (char *)realloc(att_array, 6*(n_attr + 1));
-    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
-    n_attr++;
+    AddAttributeAcronym( acronym );
 
     attVal->Add( pattValTmp );
 
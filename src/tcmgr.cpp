@@ -175,12 +175,14 @@ double time2mean (time_t t, IDX_entry *pIDX)
     if (pIDX->epoch_year != new_year)
         happy_new_year (pIDX, new_year);
 
+    const double *speed = pIDX->m_cst_speeds;
+    const double *mpy = pIDX->m_multipliers;
+    const double *phase = pIDX->m_phases;
+    double dt = (long)(t - pIDX->epoch) + pIDX->pref_sta_data->meridian;
+
     for (a=0; a<pIDX->num_csts; a++) {
-        if (pIDX->m_cst_speeds[a] < 6e-6) {
-            tide += pIDX->m_work_buffer[a] *
-                    cos (pIDX->m_cst_speeds[a] * ((long)(t - pIDX->epoch) + pIDX->pref_sta_data->meridian) +
-                    pIDX->m_cst_epochs[a][pIDX->epoch_year-pIDX->first_year] - pIDX->pref_sta_data->epoch[a]);
-        }
+        if (speed[a] < 6e-6)
+            tide += mpy[a] * cos (speed[a] * dt + phase[a]);
     }
 
     return tide;
@@ -411,15 +413,24 @@ double _time2dt_tide (time_t t, int deriv, IDX_entry *pIDX)
     int a, b;
     double term, tempd;
 
+    //  Flat per station arrays, so the constituent loop is a straight multiply-add
+    const double *speed = pIDX->m_cst_speeds;
+    const double *mpy = pIDX->m_multipliers;
+    const double *phase = pIDX->m_phases;
+    double dt = (long)(t - pIDX->epoch) + pIDX->pref_sta_data->meridian;
+
     tempd = M_PI / 2.0 * deriv;
+    if (deriv == 0) {
+        for (a=0; a<pIDX->num_csts; a++)
+            dt_tide += mpy[a] * cos(speed[a] * dt + phase[a]);
+        return dt_tide;
+    }
+
     for (a=0; a<pIDX->num_csts; a++)
     {
-        term = pIDX->m_work_buffer[a] *
-               cos(tempd +
-                   pIDX->m_cst_speeds[a] * ((long)(t - pIDX->epoch) + pIDX->pref_sta_data->meridian) +
-                   pIDX->m_cst_epochs[a][pIDX->epoch_year-pIDX->first_year] - pIDX->pref_sta_data->epoch[a]);
+        term = mpy[a] * cos(tempd + speed[a] * dt + phase[a]);
         for (b = deriv; b > 0; b--)
-            term *= pIDX->m_cst_speeds[a];
+            term *= speed[a];
         dt_tide += term;
     }
     return dt_tide;
@@ -590,14 +601,15 @@ void figure_max_amplitude (IDX_entry *pIDX)
     }
 }
 
-/* Figure out normalized multipliers for constituents for a particular year. */
+/* Figure out normalized multipliers, and the phase at the epoch, for constituents for a particular year. */
 void figure_multipliers (IDX_entry *pIDX, int year)
 {
     int a;
 
     figure_max_amplitude( pIDX );
     for (a = 0; a < pIDX->num_csts; a++) {
-        pIDX->m_work_buffer[a] = pIDX->pref_sta_data->amplitude[a] * pIDX->m_cst_nodes[a][year-pIDX->first_year] / pIDX->max_amplitude;  // BOGUS_amplitude?
+        pIDX->m_multipliers[a] = pIDX->pref_sta_data->amplitude[a] * pIDX->m_cst_nodes[a][year-pIDX->first_year] / pIDX->max_amplitude;  // BOGUS_amplitude?
+        pIDX->m_phases[a] = pIDX->m_cst_epochs[a][year-pIDX->first_year] - pIDX->pref_sta_data->epoch[a];
     }
 }
 
@@ -685,11 +697,33 @@ void set_epoch (IDX_entry *pIDX, int year)
 }
 
 /* Re-initialize for a different year */
+/* The multipliers, phases and epoch depend only on the reference station and the year,
+ * so they are kept per station for the current and adjacent year, and only computed
+ * when a slot holds some other year. */
 void happy_new_year (IDX_entry *pIDX, int new_year)
 {
     pIDX->epoch_year = new_year;
-    figure_multipliers ( pIDX, new_year );
-    set_epoch ( pIDX, new_year );
+
+    if (pIDX->m_tables_sta != pIDX->pref_sta_data) {
+        free( pIDX->m_tables );
+        pIDX->m_tables = (double *) malloc (4 * pIDX->num_csts * sizeof (double));
+        pIDX->m_tables_year[0] = pIDX->m_tables_year[1] = 0;
+        pIDX->m_tables_sta = pIDX->pref_sta_data;
+        pIDX->max_amplitude = 0.0;                  // Force multiplier re-compute
+    }
+
+    int slot = new_year & 1;
+    pIDX->m_multipliers = pIDX->m_tables + (slot * 2 * pIDX->num_csts);
+    pIDX->m_phases = pIDX->m_multipliers + pIDX->num_csts;
+
+    if (pIDX->m_tables_year[slot] != new_year) {
+        figure_multipliers ( pIDX, new_year );
+        set_epoch ( pIDX, new_year );
+        pIDX->m_tables_epoch[slot] = pIDX->epoch;
+        pIDX->m_tables_year[slot] = new_year;
+    }
+    else
+        pIDX->epoch = pIDX->m_tables_epoch[slot];
 }
 
 //      TCMgr Implementation
@@ -799,10 +833,9 @@ bool TCMgr::GetTideOrCurrent(time_t t, int idx, float &tcvalue, float& dir)
             return false;
     }
 
-    pIDX->max_amplitude = 0.0;                // Force multiplier re-compute
     int yott = yearoftimet( t );
 
-    happy_new_year (pIDX, yott);              //Calculate new multipliers
+    happy_new_year (pIDX, yott);              //Select this year's multipliers
 
     //    Finally, calculate the tide/current
 
@@ -817,6 +850,38 @@ bool TCMgr::GetTideOrCurrent(time_t t, int idx, float &tcvalue, float& dir)
     return(true); // Got it!
 }
 
+//  Evaluate one station at each of n times, e.g. the samples of a tide curve.
+//  The station lookup and harmonic data load are done once for the whole series.
+bool TCMgr::GetTideOrCurrentSeries(const time_t *t, int n, int idx, float *tcvalue, float *dir)
+{
+    for( int i = 0; i < n; i++ ) {
+        dir[i] = 0;
+        tcvalue[i] = 0;
+    }
+
+    IDX_entry *pIDX = &m_Combined_IDX_array[idx];    // point to the index entry
+
+    if( !pIDX || !pIDX->IDX_Useable )
+        return false;
+
+    if(pIDX->pDataSource) {
+        if(pIDX->pDataSource->LoadHarmonicData(pIDX) != TC_NO_ERROR)
+            return false;
+    }
+
+    for( int i = 0; i < n; i++ ) {
+        int yott = yearoftimet( t[i] );
+        if( yott != pIDX->epoch_year )
+            happy_new_year (pIDX, yott);
+
+        double level = time2asecondary (t[i], pIDX);
+        dir[i] = ( level >= 0 ) ? pIDX->IDX_flood_dir : pIDX->IDX_ebb_dir;
+        tcvalue[i] = level;
+    }
+
+    return true;
+}
+
 extern wxDateTime gTimeSource;
 
 bool TCMgr::GetTideOrCurrent15(time_t t_d, int idx, float &tcvalue, float& dir, bool &bnew_val)
@@ -916,9 +981,8 @@ bool TCMgr::GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now,
             return false;
     }
 
-    pIDX->max_amplitude = 0.0;                // Force multiplier re-compute
     int yott = yearoftimet( t );
-    happy_new_year (pIDX, yott);              //Force new multipliers
+    happy_new_year (pIDX, yott);              //Select this year's multipliers
 
     //    Finally, process the tide flow sens
 
@@ -963,7 +1027,6 @@ void TCMgr::GetHightOrLowTide(time_t t, int sch_step_1, int sch_step_2, float ti
     }
 
 
-    pIDX->max_amplitude = 0.0;                // Force multiplier re-compute
     int yott = yearoftimet( t );
     happy_new_year (pIDX, yott);
 
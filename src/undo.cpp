@@ -101,13 +101,11 @@ void doUndoMoveWaypoint( UndoAction* action ) {
     wxRealPoint* lastPoint = (wxRealPoint*) action->before[0];
     lat = currentPoint->m_lat;
     lon = currentPoint->m_lon;
-    currentPoint->m_lat = lastPoint->y;
-    currentPoint->m_lon = lastPoint->x;
+    currentPoint->SetPosition( lastPoint->y, lastPoint->x );
     lastPoint->y = lat;
     lastPoint->x = lon;
     SelectItem* selectable = (SelectItem*) action->selectable[0];
-    selectable->m_slat = currentPoint->m_lat;
-    selectable->m_slon = currentPoint->m_lon;
+    pSelect->UpdateSelectablePoint( selectable, currentPoint->m_lat, currentPoint->m_lon );
 
     if( ( NULL != pMarkPropDialog ) && ( pMarkPropDialog->IsShown() ) ){
        if( currentPoint == pMarkPropDialog->GetRoutePoint() ) pMarkPropDialog->UpdateProperties(true);